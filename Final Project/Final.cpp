@@ -1,8 +1,26 @@
 #include <iostream>         // cout, cerr
+#include <algorithm>        // min
 #include <cstdlib>          // EXIT_FAILURE
+#include <filesystem>       // create_directories
+#include <memory>           // unique_ptr
+#include <string>           // string, to_string
 #include <GL/glew.h>        // GLEW library
 #include <GLFW/glfw3.h>     // GLFW library
-#include "cylinder.h"
+#include "diagnostics.h"
+#include "frameUniforms.h"
+#include "gpuCulling.h"
+#include "importedMesh.h"
+#include "instanceBuffer.h"
+#include "lodManager.h"
+#include "meshBufferArena.h"
+#include "meshCache.h"
+#include "renderQueue.h"
+#include "shaderReflection.h"
+#include "segmentedCylinder.h"
+#include "shaderProgram.h"
+#include "simplifiedMesh.h"
+#include "vertexLayout.h"
+#include "weldedMesh.h"
 
 #define PI 3.1415927
 
@@ -28,6 +46,7 @@ using namespace std; // Standard namespace
 namespace
 {
     const char* const WINDOW_TITLE = "Michael Linsenbigler Final Project"; // Macro for window title
+    const double TITLE_UPDATE_INTERVAL = 0.5; // Seconds between updates of frame statistics in window title
 
     // Variables for window width and height
     const int WINDOW_WIDTH = 800;
@@ -36,11 +55,36 @@ namespace
     // Stores the GL data relative to a given mesh
     struct GLMesh
     {
-        GLuint vao;           // Handle for the vertex array object
-        GLuint vbo;           // Handles for the vertex buffer objects
-        GLuint nXboxVertices;    // Number of vertices of the mesh
+        std::unique_ptr<static_meshes_3D::WeldedMesh> xbox; // Xbox, vent, speaker and table welded into one indexed mesh
+        std::unique_ptr<static_meshes_3D::SimplifiedMesh> speaker; // LOD chain of the speaker part, simplified from the welded xbox
+        std::shared_ptr<const static_meshes_3D::SegmentedCylinder> can; // Can body with its LOD chain
+        std::shared_ptr<const static_meshes_3D::SegmentedCylinder> canTop; // Can top, the same cached mesh scaled by its model matrix
+        std::unique_ptr<static_meshes_3D::SegmentedCylinder> canField; // Can of the can field, quantized (16 bytes per vertex fetched by every instance)
+        std::unique_ptr<static_meshes_3D::ImportedMesh> imported; // Mesh imported from OBJ / glTF file given on the command line (optional)
     };
 
+    // Parts of the xbox mesh (index ranges, in order of xboxVerts), every face of the body box is a range of its own,
+    // so that only faces turned to the camera are drawn
+    enum XboxMeshPart
+    {
+        XBOX_BODY_FRONT,
+        XBOX_BODY_BACK,
+        XBOX_BODY_TOP,
+        XBOX_BODY_BOTTOM,
+        XBOX_BODY_LEFT,
+        XBOX_BODY_RIGHT,
+        XBOX_VENT,
+        XBOX_SPEAKER,
+        XBOX_TABLE
+    };
+
+    static_assert(XBOX_BODY_RIGHT < static_meshes_3D::StaticMeshIndexed3D::MAX_MASKED_INDEX_RANGES,
+        "Faces of the xbox body do not fit into index range bitmask");
+
+    // Box of the xbox body in model space (bounds of the body part of xboxVerts)
+    const glm::vec3 XBOX_BODY_MIN(-0.8f, 0.2f, -1.0f);
+    const glm::vec3 XBOX_BODY_MAX(2.8f, 2.0f, 0.0f);
+
     // Main GLFW window
     GLFWwindow* gWindow = nullptr;
 
@@ -72,6 +116,52 @@ namespace
     float gDeltaTime = 0.0f; // time between current frame and last frame
     float gLastFrame = 0.0f;
 
+    // Viewport height, LODs are selected from projected screen-space error
+    int gViewportHeight = WINDOW_HEIGHT;
+
+    // LOD selection of the cans and the speaker, F toggles cross-fading of LOD switches
+    static_meshes_3D::LodManager gLodManager;
+    int gCanInstance = -1;
+    int gCanTopInstance = -1;
+    int gSpeakerInstance = -1;
+
+    // Field of about 100k cans rendered with one instanced draw, I toggles it
+    const int CAN_FIELD_SIZE = 316; // Cans along one side of the field
+    const int CAN_FIELD_LOD = 2; // LOD of the field cans (9 slices)
+    static_meshes_3D::InstanceBuffer gCanField;
+    bool gIsCanFieldVisible = false;
+
+    // Can field is frustum-culled on the GPU and drawn with multi-draw indirect, G toggles it (plain instanced draw otherwise)
+    std::unique_ptr<static_meshes_3D::GpuCuller> gCanFieldCuller;
+    bool gIsGpuCullingEnabled = true;
+
+    // Command line switch of diagnostic (e.g. --validate-gpu-culling, see runDiagnostic) run in hidden window instead of the scene
+    std::string gDiagnosticSwitch;
+
+    // Frame and light uniform blocks shared by all programs, written once per frame
+    static_meshes_3D::FrameUniformBuffer gFrameUniforms;
+
+    // Draws of a frame sorted to minimize state changes
+    static_meshes_3D::RenderQueue gRenderQueue;
+
+    // Reflection of the light shader program and handles of its uniforms, resolved once after linking
+    static_meshes_3D::ShaderReflection gProgramReflection;
+    static_meshes_3D::RenderProgram gRenderProgram;
+    static_meshes_3D::UniformHandle<bool> gInstancedUniform;
+    static_meshes_3D::UniformHandle<bool> gDrawIndirectUniform;
+
+    // Procedural meshes shared by all their instances
+    static_meshes_3D::MeshCache gMeshCache;
+
+    // Directory of generated meshes stored between runs
+    const char* const MESH_FILE_CACHE_DIRECTORY = "meshCache";
+
+    // OBJ / glTF file to import and draw next to the scene (first command line argument, nullptr if not given)
+    const char* gImportFileName = nullptr;
+
+    // Can top is the can mesh scaled from radius 0.65 and height 2.0 to radius 0.60 and height 2.1
+    const glm::vec3 CAN_TOP_SCALE(0.60f / 0.65f, 2.1f / 2.0f, 0.60f / 0.65f);
+
     // light color
     glm::vec3 gLightColor(1.0f, 1.0f, 0.8f);
     glm::vec3 gFillLightColor(1.0f, 0.8f, 0.8f);
@@ -80,6 +170,22 @@ namespace
     glm::vec3 keyLightPos(-5.0f, 5.0f, -5.0f);
     glm::vec3 fillLightPos(3.0f, -5.0f, 0.0f);
 
+    // Vertex layouts
+    using namespace static_meshes_3D::vertex_attributes;
+    using LightShaderInputs = static_meshes_3D::VertexLayout<Position, Normal, TextureCoordinate>; // Inputs of lightVertexShaderSource
+    using XboxVertexLayout = static_meshes_3D::VertexLayout<Position, Normal, TextureCoordinate>; // Interleaved layout of xboxVerts
+    using CanVertexLayout = static_meshes_3D::VertexLayout<Position, TextureCoordinate, Normal>; // Layout of the cans
+
+    // Gets layout to build a mesh rendered by the light shader with, so that every such mesh is checked to provide all inputs of the shader
+    template<typename Layout>
+    constexpr Layout lightShaderLayout()
+    {
+        static_assert(Layout::template provides<LightShaderInputs>(), "Mesh vertex layout does not provide all inputs of the light shader");
+        return Layout();
+    }
+
+    // Shared vertex buffer of finished scene meshes with the xbox layout, they are all rendered from one VAO
+    static_meshes_3D::MeshBufferArena gMeshArena(XboxVertexLayout(), 1 << 14);
 }
 
 /* User-defined Function prototypes to:
@@ -95,6 +201,7 @@ void UMouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 void UMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void UCreateMesh(GLMesh& mesh);
 void UDestroyMesh(GLMesh& mesh);
+unsigned int UGetVisibleXboxBodyFaces(const glm::mat4& model);
 bool UCreateTexture(const char* filename, GLuint& textureId);
 void UDestroyTexture(GLuint textureId);
 void URender();
@@ -103,29 +210,101 @@ void UDestroyShaderProgram(GLuint programId);
 bool orthoP = false;
 
 
+// Attribute locations below are hardcoded in the shader source, so check them against vertex layouts
+static_assert(Position::LOCATION == 0 && Normal::LOCATION == 1 && TextureCoordinate::LOCATION == 2,
+    "lightVertexShaderSource attribute locations do not match vertex attribute locations");
+static_assert(static_meshes_3D::InstanceBuffer::DEFAULT_BINDING == 0, "lightVertexShaderSource instance binding does not match instance buffer binding");
+static_assert(InstanceIndex::LOCATION == 3, "lightVertexShaderSource instance index location does not match instance index attribute location");
+static_assert(static_meshes_3D::FrameUniformBuffer::FRAME_BINDING == 0 && static_meshes_3D::FrameUniformBuffer::LIGHT_BINDING == 1,
+    "light shader uniform block bindings do not match frame uniform buffer bindings");
+
 const GLchar* lightVertexShaderSource = GLSL(440,
 
     layout(location = 0) in vec3 position; // VAP position 0 for vertex position data
     layout(location = 1) in vec3 normal; // VAP position 1 for normals
     layout(location = 2) in vec2 textureCoordinate;
+    layout(location = 3) in uint instanceIndex; // Instance selected by base instance of indirect draws
 
     out vec3 vertexNormal; // For outgoing normals to fragment shader
     out vec3 vertexFragmentPos; // For outgoing color / pixels to fragment shader
     out vec2 vertexTextureCoordinate;
+    out vec4 vertexTint;
+    flat out float vertexTextureLayer;
 
     //Uniform / Global variables for the  transform matrices
     uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
+
+    // Camera of the frame shared by all programs (see FrameUniforms)
+    layout(std140, binding = 0) uniform FrameData
+    {
+        mat4 view;
+        mat4 projection;
+        mat4 viewProjection;
+        vec3 viewPosition;
+    };
+
+    // Per-instance data of instanced draws (see InstanceData), used instead of model matrix when instanced is set
+    struct Instance
+    {
+        mat4 model;
+        mat3 normalMatrix;
+        vec4 tint;
+        float textureLayer;
+    };
+
+    layout(std430, binding = 0) readonly buffer Instances
+    {
+        Instance instances[];
+    };
+
+    uniform bool instanced;
+    uniform bool drawIndirect; // Instance is given by instanceIndex attribute instead of gl_InstanceID
+
+    // Dequantization of packed vertices (identity for float vertices)
+    uniform vec3 positionScale;
+    uniform vec3 positionBias;
+    uniform vec2 uvScale;
+    uniform vec2 uvBias;
+    uniform bool octahedralNormals;
+
+// Decodes unit vector from octahedral encoding
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+    {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0f); // Transforms vertices into clip coordinates
+    vec3 decodedPosition = positionBias + positionScale * position;
+    vec3 decodedNormal = octahedralNormals ? decodeOctahedral(normal.xy) : normal;
+
+    mat4 instanceModel = model;
+    mat3 normalMatrix;
+    vertexTint = vec4(1.0);
+    vertexTextureLayer = 0.0;
+    if (instanced)
+    {
+        uint instance = drawIndirect ? instanceIndex : uint(gl_InstanceID);
+        instanceModel = instances[instance].model;
+        normalMatrix = instances[instance].normalMatrix; // Precomputed per instance instead of inverting matrix per vertex
+        vertexTint = instances[instance].tint;
+        vertexTextureLayer = instances[instance].textureLayer;
+    }
+    else {
+        normalMatrix = mat3(transpose(inverse(model)));
+    }
 
-    vertexFragmentPos = vec3(model * vec4(position, 1.0f)); // Gets fragment / pixel position in world space only (exclude view and projection)
+    gl_Position = viewProjection * instanceModel * vec4(decodedPosition, 1.0f); // Transforms vertices into clip coordinates
 
-    vertexNormal = mat3(transpose(inverse(model))) * normal; // get normal vectors in world space only and exclude normal translation properties
-    vertexTextureCoordinate = textureCoordinate;
+    vertexFragmentPos = vec3(instanceModel * vec4(decodedPosition, 1.0f)); // Gets fragment / pixel position in world space only (exclude view and projection)
+
+    vertexNormal = normalMatrix * decodedNormal; // get normal vectors in world space only and exclude normal translation properties
+    vertexTextureCoordinate = uvBias + uvScale * textureCoordinate;
 }
 );
 
@@ -136,22 +315,64 @@ const GLchar* lightFragmentShaderSource = GLSL(440,
     in vec3 vertexNormal; // For incoming normals
     in vec3 vertexFragmentPos; // For incoming fragment position
     in vec2 vertexTextureCoordinate;
+    in vec4 vertexTint;
+    flat in float vertexTextureLayer;
 
     out vec4 fragmentColor; // For outgoing object color to the GPU
 
     // Uniform / Global variables for object color, light color, light position, and camera/view position
-    uniform vec3 lightColor;
-    uniform vec3 fillLightColor;
-    uniform vec3 keyLightPos;
-    uniform vec3 fillLightPos;
-    uniform vec3 viewPosition;
+    // Camera of the frame shared by all programs (see FrameUniforms)
+    layout(std140, binding = 0) uniform FrameData
+    {
+        mat4 view;
+        mat4 projection;
+        mat4 viewProjection;
+        vec3 viewPosition;
+    };
+
+    // Lights of the frame shared by all programs (see LightUniforms)
+    layout(std140, binding = 1) uniform LightData
+    {
+        vec3 lightColor;
+        vec3 fillLightColor;
+        vec3 keyLightPos;
+        vec3 fillLightPos;
+    };
+
     uniform sampler2D uTexture; // Useful when working with multiple textures
+    uniform float lodFade = 1.0; // LOD cross-fade: 1 opaque, 0..1 fading in, -1..0 fading out
+    uniform bool useTextureLayers; // Instances sample their layer of uTextureLayers instead of uTexture
+    uniform sampler2DArray uTextureLayers; // Array texture of instances (on texture unit 1)
 
     vec4 calculateKeyLight();
     vec4 calculateFillLight();
 
+// Threshold of 4x4 ordered dither matrix at the fragment, in (0, 1)
+float ditherThreshold()
+{
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    return (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+}
+
+// Texture color of the fragment tinted by its instance
+vec4 tintedTextureColor()
+{
+    vec4 color = useTextureLayers ? texture(uTextureLayers, vec3(vertexTextureCoordinate, vertexTextureLayer)) : texture(uTexture, vertexTextureCoordinate);
+    return color * vertexTint;
+}
+
 void main()
 {
+    // LOD fading in covers fragments below its fade, LOD fading out the complementary ones, so together they cover every fragment once
+    if (lodFade < 1.0)
+    {
+        float threshold = ditherThreshold();
+        if (lodFade >= 0.0 ? threshold >= lodFade : threshold < 1.0 + lodFade)
+        {
+            discard;
+        }
+    }
 
     vec4 keyPhong = calculateKeyLight();
     vec4 fillPhong = calculateFillLight();
@@ -181,7 +402,7 @@ vec4 calculateKeyLight() {
     vec3 specular = specularIntensity * specularComponent * lightColor;
 
     // Texture holds the color to be used for all three components
-    vec4 textureColor = texture(uTexture, vertexTextureCoordinate);
+    vec4 textureColor = tintedTextureColor();
 
     // Calculate phong result
     vec3 phong = (ambient + diffuse + specular) * textureColor.xyz;
@@ -211,7 +432,7 @@ vec4 calculateFillLight() {
     vec3 specular = specularIntensity * specularComponent * fillLightColor;
 
     // Texture holds the color to be used for all three components
-    vec4 textureColor = texture(uTexture, vertexTextureCoordinate);
+    vec4 textureColor = tintedTextureColor();
 
     // Calculate phong result
     vec3 phong = (ambient + diffuse + specular) * textureColor.xyz;
@@ -243,9 +464,35 @@ void flipImageVertically(unsigned char* image, int width, int height, int channe
 
 int main(int argc, char* argv[])
 {
+    // Command line: [diagnostic switch, e.g. --validate-gpu-culling] [OBJ / glTF file to import]
+    for (int i = 1; i < argc; i++)
+    {
+        if (static_meshes_3D::isDiagnosticSwitch(argv[i])) {
+            gDiagnosticSwitch = argv[i];
+        }
+        else {
+            gImportFileName = argv[i];
+        }
+    }
+
     if (!UInitialize(argc, argv, &gWindow))
         return EXIT_FAILURE;
 
+    // Diagnostics run without the mesh file cache, so that they always measure and validate freshly generated meshes
+    if (!gDiagnosticSwitch.empty())
+    {
+        const bool hasPassed = static_meshes_3D::runDiagnostic(gDiagnosticSwitch);
+        glfwTerminate();
+        return hasPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Generated meshes of the scene are loaded from the mesh file cache, if previous run stored them
+    std::error_code cacheDirectoryError;
+    std::filesystem::create_directories(MESH_FILE_CACHE_DIRECTORY, cacheDirectoryError);
+    if (!cacheDirectoryError) {
+        static_meshes_3D::StaticMeshIndexed3D::setMeshFileCacheDirectory(MESH_FILE_CACHE_DIRECTORY);
+    }
+
     // Create the mesh
     UCreateMesh(gMesh);
 
@@ -253,6 +500,17 @@ int main(int argc, char* argv[])
     if (!UCreateShaderProgram(lightVertexShaderSource, lightFragmentShaderSource, gProgramId))
         return EXIT_FAILURE;
 
+    // Create ring of frame uniform blocks shared by the programs
+    if (!gFrameUniforms.create())
+        return EXIT_FAILURE;
+
+    // Resolve uniform handles once, rendering then sets uniforms without looking them up
+    if (!gProgramReflection.reflect(gProgramId))
+        return EXIT_FAILURE;
+    gRenderProgram = static_meshes_3D::getRenderProgram(gProgramReflection);
+    gInstancedUniform = gProgramReflection.getUniform<bool>("instanced");
+    gDrawIndirectUniform = gProgramReflection.getUniform<bool>("drawIndirect");
+
     // Load texture
     const char* texFilename = "white-tiles1.jpg";
     if (!UCreateTexture(texFilename, vidGameTex))
@@ -292,16 +550,10 @@ int main(int argc, char* argv[])
     }
     // tell opengl for each sampler to which texture unit it belongs to
     glUseProgram(gProgramId);
-    // We set xbox as 0
-    glUniform1i(glGetUniformLocation(gProgramId, "uXbox"), 0);
-    // We set table as 1
-    glUniform1i(glGetUniformLocation(gProgramId, "uTable"), 1);
-    // Set vent as 2
-    glUniform1i(glGetUniformLocation(gProgramId, "uVent"), 2);
-    // Set can as 3
-    glUniform1i(glGetUniformLocation(gProgramId, "uCan"), 3);
-    // Set can top as 4
-    glUniform1i(glGetUniformLocation(gProgramId, "uCanTop"), 4);
+    // Textures of all objects are bound to unit 0 by the render queue
+    gProgramReflection.getUniform<int>("uTexture").set(0);
+    // Array texture of instances is on unit 1, so that it never shares unit with 2D textures
+    gProgramReflection.getUniform<int>("uTextureLayers").set(1);
 
 
     // Sets the background color of the window to black (it will be implicitely used by glClear)
@@ -330,7 +582,8 @@ int main(int argc, char* argv[])
     // Release mesh data
     UDestroyMesh(gMesh);
 
-    // Release shader program
+    // Release frame uniform blocks and shader program
+    gFrameUniforms.deleteBuffer();
     UDestroyShaderProgram(gProgramId);
 
     exit(EXIT_SUCCESS); // Terminates the program successfully
@@ -351,6 +604,11 @@ bool UInitialize(int argc, char* argv[], GLFWwindow** window)
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
+    // Diagnostics render into their own framebuffer, so their window stays hidden
+    if (!gDiagnosticSwitch.empty()) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
+
     // GLFW: window creation
     // ---------------------
     * window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE, NULL, NULL);
@@ -409,12 +667,42 @@ void UProcessInput(GLFWwindow* window)
         gCamera.ProcessKeyboard(DOWN, gDeltaTime);
     if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
         orthoP = !orthoP;
+
+    // Toggle LOD cross-fading once per key press
+    static bool wasFadeKeyPressed = false;
+    const bool isFadeKeyPressed = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+    if (isFadeKeyPressed && !wasFadeKeyPressed)
+    {
+        gLodManager.setCrossFadeEnabled(!gLodManager.isCrossFadeEnabled());
+    }
+    wasFadeKeyPressed = isFadeKeyPressed;
+
+    // Toggle instanced can field once per key press
+    static bool wasCanFieldKeyPressed = false;
+    const bool isCanFieldKeyPressed = glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS;
+    if (isCanFieldKeyPressed && !wasCanFieldKeyPressed)
+    {
+        gIsCanFieldVisible = !gIsCanFieldVisible;
+        cout << "Can field of " << gCanField.getNumInstances() << " instances " << (gIsCanFieldVisible ? "shown" : "hidden") << endl;
+    }
+    wasCanFieldKeyPressed = isCanFieldKeyPressed;
+
+    // Toggle GPU culling of can field once per key press
+    static bool wasCullingKeyPressed = false;
+    const bool isCullingKeyPressed = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+    if (isCullingKeyPressed && !wasCullingKeyPressed)
+    {
+        gIsGpuCullingEnabled = !gIsGpuCullingEnabled;
+        cout << "GPU culling of can field " << (gIsGpuCullingEnabled ? "enabled" : "disabled") << endl;
+    }
+    wasCullingKeyPressed = isCullingKeyPressed;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 void UResizeWindow(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
+    gViewportHeight = height;
 }
 
 
@@ -516,95 +804,133 @@ void URender()
         //cout << "perspective" << endl;
     }
 
+    // LODs of this frame are selected for this projection (field of view is gCamera.Zoom) and viewport height
+    gLodManager.beginFrame(projection, gViewportHeight, gDeltaTime);
+
     // Set the shader to be used
     glUseProgram(gProgramId);
 
-    // Retrieves and passes transform matrices to the Shader program
-    GLint modelLoc = glGetUniformLocation(gProgramId, "model");
-    GLint viewLoc = glGetUniformLocation(gProgramId, "view");
-    GLint projLoc = glGetUniformLocation(gProgramId, "projection");
-
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    // Camera and lights are written once per frame into the frame uniform blocks, every program reads them from there
+    static_meshes_3D::FrameUniforms frameUniforms;
+    frameUniforms.view = view;
+    frameUniforms.projection = projection;
+    frameUniforms.viewProjection = projection * view;
+    frameUniforms.viewPosition = gCamera.Position;
 
-    // Reference matrix uniforms from the Shader program for the cub color, light color, light position, and camera position
-    GLint lightColorLoc = glGetUniformLocation(gProgramId, "lightColor");
-    GLint fillLightColorLoc = glGetUniformLocation(gProgramId, "fillLightColor");
-    GLint keyLightPositionLoc = glGetUniformLocation(gProgramId, "keyLightPos");
-    GLint fillLightPositionLoc = glGetUniformLocation(gProgramId, "fillLightPos");
-    GLint viewPositionLoc = glGetUniformLocation(gProgramId, "viewPosition");
+    static_meshes_3D::LightUniforms lightUniforms;
+    lightUniforms.lightColor = gLightColor;
+    lightUniforms.fillLightColor = gFillLightColor;
+    lightUniforms.keyLightPos = keyLightPos;
+    lightUniforms.fillLightPos = fillLightPos;
 
-    // Pass color, light, and camera data to the Shader program's corresponding uniforms
-    glUniform3f(lightColorLoc, gLightColor.r, gLightColor.g, gLightColor.b);
-    glUniform3f(fillLightColorLoc, gFillLightColor.r, gFillLightColor.g, gFillLightColor.b);
-    glUniform3f(keyLightPositionLoc, keyLightPos.x, keyLightPos.y, keyLightPos.z);
-    glUniform3f(fillLightPositionLoc, fillLightPos.x, fillLightPos.y, fillLightPos.z);
+    gFrameUniforms.update(frameUniforms, lightUniforms);
 
-    const glm::vec3 cameraPosition = gCamera.Position;
-    glUniform3f(viewPositionLoc, cameraPosition.x, cameraPosition.y, cameraPosition.z);
+    // Draws are collected and rendered sorted by program, texture and mesh, so shared state is set only once
+    gRenderQueue.begin(view);
 
-    // Activate the VBOs contained within the mesh's VAO
-    glBindVertexArray(gMesh.vao);
-
-    // bind textures on corresponding texture units
-    glActiveTexture(GL_TEXTURE0);
-
-    //tex and draw xbox
-    glBindTexture(GL_TEXTURE_2D, vidGameTex);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-
-    //tex and draw the table
-    glBindTexture(GL_TEXTURE_2D, tableTex);
-    glDrawArrays(GL_TRIANGLES, 78, 6);
-
-    //tex vent
-    glBindTexture(GL_TEXTURE_2D, ventTex);
-
-    //tex and draw vent
-    glBindTexture(GL_TEXTURE_2D, ventTex);
-    glDrawArrays(GL_TRIANGLES, 36, 18);
+    //tex and draw xbox, table and vent
+    gRenderQueue.submitRanges(gMesh.xbox.get(), UGetVisibleXboxBodyFaces(model), { &gRenderProgram, vidGameTex }, model);
+    gRenderQueue.submit(gMesh.xbox.get(), XBOX_TABLE, { &gRenderProgram, tableTex }, model);
+    gRenderQueue.submit(gMesh.xbox.get(), XBOX_VENT, { &gRenderProgram, ventTex }, model);
 
     //place speaker
     translation = glm::translate(glm::vec3(0.1f, -1.2f, 0.0f));
     //rotation = glm::rotate(.0f, glm::vec3(0.8f, 0.0f, 0.0f));
     model = translation * rotation * scale;
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
 
     //tex and draw speaker
-    glBindTexture(GL_TEXTURE_2D, speakerTex);
-    //glDrawArrays(GL_TRIANGLES, 54, 24);
-    glDrawArrays(GL_TRIANGLES, 54, 24);
-
-    //tex can
-    glBindTexture(GL_TEXTURE_2D, canTex);
+    gRenderQueue.submitLod(gLodManager, gSpeakerInstance, gMesh.speaker.get(), { &gRenderProgram, speakerTex }, model);
 
     //place can
     translation = glm::translate(glm::vec3(-1.0f, 0.0f, 0.1f));
     rotation = glm::rotate(45.0f, glm::vec3(0.8f, 0.0f, 0.0f));
     model = translation * rotation * scale;
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
 
-    //draw can
-    static_meshes_3D::Cylinder C(0.65, 36, 2.0, true, true, true);
-    C.render();
-
-    //tex can top
-    glBindTexture(GL_TEXTURE_2D, canTopTex);
+    //tex and draw can
+    gRenderQueue.submitLod(gLodManager, gCanInstance, gMesh.can.get(), { &gRenderProgram, canTex }, model);
 
     //place can top   
     translation = glm::translate(glm::vec3(-1.0f, 0.0f, 0.12f));
     rotation = glm::rotate(45.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-    model = translation * rotation * scale;
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+    model = translation * rotation * scale * glm::scale(CAN_TOP_SCALE);
+
+    //tex and draw can top
+    gRenderQueue.submitLod(gLodManager, gCanTopInstance, gMesh.canTop.get(), { &gRenderProgram, canTopTex }, model);
+
+    gRenderQueue.flush();
+
+    //tex and draw imported mesh - only its meshlets in view and not facing away from the camera
+    if (gMesh.imported)
+    {
+        translation = glm::translate(glm::vec3(1.5f, 0.0f, 0.0f));
+        model = translation * scale;
+        glUseProgram(gProgramId);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, tableTex);
+        gRenderProgram.model.set(model);
+        gRenderProgram.lodFade.set(1.0f);
+        static_meshes_3D::setDequantizationUniforms(gRenderProgram.dequantization, gMesh.imported->getQuantizationParameters());
+        const glm::vec3 cameraPosition(glm::inverse(model) * glm::vec4(gCamera.Position, 1.0f));
+        gMesh.imported->renderVisibleMeshlets(frameUniforms.viewProjection * model, cameraPosition);
+    }
 
-    //draw can top
-    static_meshes_3D::Cylinder C1(0.60, 36, 2.1, true, true, true);
-    C1.render();
+    //tex and draw can field - all cans with one instanced draw, or cans surviving GPU culling with one indirect draw,
+    //instance buffer is uploaded only when the field changes
+    if (gIsCanFieldVisible)
+    {
+        // Culling binds its compute program, so it's dispatched before the field state is set
+        const bool isCulledOnGpu = gIsGpuCullingEnabled && gCanFieldCuller->cull(frameUniforms.viewProjection);
+
+        glUseProgram(gProgramId);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, canTex);
+        gRenderProgram.lodFade.set(1.0f);
+        static_meshes_3D::setDequantizationUniforms(gRenderProgram.dequantization, gMesh.canField->getQuantizationParameters());
+        gInstancedUniform.set(true);
+        gDrawIndirectUniform.set(isCulledOnGpu);
+        gCanField.bind();
+        if (isCulledOnGpu) {
+            gCanFieldCuller->render();
+        }
+        else {
+            gMesh.canField->renderLodInstanced(CAN_FIELD_LOD, gCanField.getNumInstances());
+        }
+        gInstancedUniform.set(false);
+        gDrawIndirectUniform.set(false);
+    }
 
     // Deactivate the Vertex Array Object
     glBindVertexArray(0);
 
+    // Region of this frame is not written again until GPU has finished its draws
+    gFrameUniforms.endFrame();
+
+    // Report triangles rendered per LOD in this frame, title is rebuilt only every TITLE_UPDATE_INTERVAL, as setting it
+    // costs a window system call, uniform lookups are averaged over frames since the last update
+    static double lastTitleUpdateTime = 0.0;
+    static int numFramesSinceTitleUpdate = 0;
+    numFramesSinceTitleUpdate++;
+    const double currentTime = glfwGetTime();
+    if (currentTime - lastTitleUpdateTime >= TITLE_UPDATE_INTERVAL)
+    {
+        const auto& lodStats = gLodManager.getFrameStats();
+        std::string title = std::string(WINDOW_TITLE) + " | LOD triangles:";
+        for (int lod = 0; lod < gMesh.can->getLodCount(); lod++) {
+            title += " " + std::to_string(lod) + ": " + std::to_string(lodStats.numTrianglesPerLod[lod]);
+        }
+        const auto& queueStats = gRenderQueue.getFrameStats();
+        const auto& avoided = queueStats.stateChangesAvoided;
+        title += " | state changes avoided: " + std::to_string(avoided.numProgramChanges + avoided.numTextureChanges
+            + avoided.numTransformUploads + avoided.numDequantizationUploads);
+        title += " | uniform lookups eliminated: "
+            + std::to_string(static_meshes_3D::ShaderReflection::getNumLookupsEliminated() / numFramesSinceTitleUpdate) + " per frame";
+        static_meshes_3D::ShaderReflection::resetNumLookupsEliminated();
+        glfwSetWindowTitle(gWindow, title.c_str());
+
+        lastTitleUpdateTime = currentTime;
+        numFramesSinceTitleUpdate = 0;
+    }
+
     // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
     glfwSwapBuffers(gWindow);
 }
@@ -619,11 +945,11 @@ void UCreateMesh(GLMesh& mesh)
         // Vertex Positions        // Normals          //Texture
 
          2.8f,  2.0f,  0.0f,    0.0f,  1.0f,  0.0f,   0.0f,   0.0f,   // top right 0
-         2.8f,  0.2f,  0.0f,    0.0f,  1.0f,  0.0f,   0.0f,   REPEAT, // bottom right 1
         -0.8f,  2.0f,  0.0f,    0.0f,  1.0f,  0.0f,   REPEAT, REPEAT, // top left 3
+         2.8f,  0.2f,  0.0f,    0.0f,  1.0f,  0.0f,   0.0f,   REPEAT, // bottom right 1
         -0.8f,  2.0f,  0.0f,    0.0f,  1.0f,  0.0f,   REPEAT, 0.0f,   // top left 3
-         2.8f,  0.2f,  0.0f,    0.0f,  1.0f,  0.0f,   0.0f,   0.0f,   // bottom right 1
         -0.8f,  0.2f,  0.0f,    0.0f,  1.0f,  0.0f,   REPEAT, REPEAT, // bottom left 2
+         2.8f,  0.2f,  0.0f,    0.0f,  1.0f,  0.0f,   0.0f,   0.0f,   // bottom right 1
 
 
          2.8f,  2.0f, -1.0f,    0.0f, -1.0f,  0.0f,   0.0f, 0.0f,     // 4 back top right
@@ -635,11 +961,11 @@ void UCreateMesh(GLMesh& mesh)
 
 
         -0.8f,  2.0f, -1.0f,    0.0f,  0.0f, -1.0f,   0.0f, 0.0f,     // 7 back top left
-         2.8f,  2.0f, -1.0f,    0.0f,  0.0f, -1.0f,   0.0f, REPEAT,   // 4 back top right
          2.8f,  2.0f,  0.0f,    0.0f,  0.0f, -1.0f,   REPEAT, REPEAT, // top right 0
+         2.8f,  2.0f, -1.0f,    0.0f,  0.0f, -1.0f,   0.0f, REPEAT,   // 4 back top right
          2.8f,  2.0f,  0.0f,    0.0f,  0.0f, -1.0f,   0.0f, 0.0f,     // top right 0
-        -0.8f,  2.0f,  0.0f,    0.0f,  0.0f, -1.0f,   0.0f, REPEAT,   // top left 3
         -0.8f,  2.0f, -1.0f,    0.0f,  0.0f, -1.0f,   REPEAT, REPEAT, // 7 back top left
+        -0.8f,  2.0f,  0.0f,    0.0f,  0.0f, -1.0f,   0.0f, REPEAT,   // top left 3
 
 
          2.8f,  0.2f,  0.0f,    0.0f,  0.0f,  1.0f,    REPEAT, REPEAT, // bottom right 1
@@ -651,11 +977,11 @@ void UCreateMesh(GLMesh& mesh)
 
 
         -0.8f,  2.0f, -1.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 0.0f,     // 7 back top left
-        -0.8f,  2.0f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, REPEAT,   // top left 3
         -0.8f,  0.2f,  0.0f,   -1.0f,  0.0f,  0.0f,    REPEAT, REPEAT, // bottom left 2 
+        -0.8f,  2.0f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, REPEAT,   // top left 3
         -0.8f,  0.2f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 0.0f,     // bottom left 2
-        -0.8f,  0.2f, -1.0,    -1.0f,  0.0f,  0.0f,    0.0f, REPEAT,   // 6 back bot left
         -0.8f,  2.0f, -1.0f,   -1.0f,  0.0f,  0.0f,    REPEAT, REPEAT, // 7 back top left
+        -0.8f,  0.2f, -1.0,    -1.0f,  0.0f,  0.0f,    0.0f, REPEAT,   // 6 back bot left
 
 
          2.8f,  0.2f, -1.0f,    1.0f,  0.0f,  0.0f,    REPEAT, REPEAT, // 5 back bot  right
@@ -668,16 +994,16 @@ void UCreateMesh(GLMesh& mesh)
 
         // xbox vent
          1.6f,  1.8f,  0.0f,    0.0f,  1.0f,  0.0f,    0.0f, 0.0f,    // 8 top of vent pyramid
-         2.3f,  1.0f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f, 0.0f,    // 9 right side of vent pyramid
          1.6f,  1.1f,  0.1f,    0.0f,  1.0f,  0.0f,    1.0f, 1.0f,    // 11 center apex
+         2.3f,  1.0f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f, 0.0f,    // 9 right side of vent pyramid
 
          1.6f,  0.3f,  0.0f,    1.0f,  0.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
          2.3f,  1.0f,  0.0f,    1.0f,  0.0f,  0.0f,    0.0f, 1.0f,    // 9 right side of vent pyramid  
          1.6f,  1.1f,  0.1f,    1.0f,  0.0f,  0.0f,    1.0f, 1.0f,    // 11 center apex
 
          1.6f,  0.3f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
-         1.0f,  1.0f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 1.0f,    // 12 left side of vent pyramid
          1.6f,  1.1f,  0.1f,   -1.0f,  0.0f,  0.0f,    1.0f, 1.0f,    // 11 center apex
+         1.0f,  1.0f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 1.0f,    // 12 left side of vent pyramid
 
          1.0f,  1.0f,  0.0f,    0.0f, -1.0f,  0.0f,    0.0f, 0.0f,    // 12 left side of vent pyramid
          1.6f,  1.1f,  0.1f,    0.0f, -1.0f,  0.0f,    1.0f, 0.0f,    // 11 center apex
@@ -688,14 +1014,14 @@ void UCreateMesh(GLMesh& mesh)
          1.0f,  1.0f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 1.0f,    // 12 left side of vent pyramid
 
          1.6f,  1.8f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f, 1.0f,    // 8 top of vent pyramid
-         1.6f,  0.3f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
          2.3f,  1.0f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f, 0.0f,    // 9 right side of vent pyramid
+         1.6f,  0.3f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
 
 
          // Speaker
          1.6f,  1.8f,  0.0f,    0.0f,  1.0f,  0.0f,    0.0f, 0.0f,    // 8 top of vent pyramid
-         2.3f,  1.0f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f, 0.0f,    // 9 right side of vent pyramid
          1.9f,  1.2f,  0.8f,    0.0f,  1.0f,  0.0f,    1.0f, 1.0f,    // 13 right center apex
+         2.3f,  1.0f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f, 0.0f,    // 9 right side of vent pyramid
 
          1.9f,  1.2f,  0.8f,    0.5f,  0.0f,  0.0f,    1.0f, 1.0f,    // 13 right center apex
          1.2f, -1.0f,  0.0f,    0.5f,  0.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
@@ -706,63 +1032,122 @@ void UCreateMesh(GLMesh& mesh)
          0.8f, -0.3f,  0.8f,    0.5f,  0.0f,  0.0f,    1.0f, 0.0f,    // 11 left center apex
 
          1.2f, -1.0f,  0.0f,    1.0f,  1.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
-         0.2f,  0.0f,  0.0f,    1.0f,  1.0f,  0.0f,    0.0f, 1.0f,    // 12 left side of vent pyramid
          0.8f, -0.3f,  0.8f,    1.0f,  1.0f,  0.0f,    1.0f, 1.0f,    // 11 left center apex
+         0.2f,  0.0f,  0.0f,    1.0f,  1.0f,  0.0f,    0.0f, 1.0f,    // 12 left side of vent pyramid
 
          0.2f,  0.0f,  0.0f,    0.0f, -1.0f,  0.0f,    0.0f, 0.0f,    // 12 left side of vent pyramid
          0.8f, -0.3f,  0.8f,    0.0f, -1.0f,  0.0f,    1.0f, 1.0f,    // 11 left center apex
          1.6f,  1.8f,  0.0f,    0.0f, -1.0f,  0.0f,    1.0f, 0.0f,    // 8 top of vent pyramid
 
          1.6f,  1.8f,  0.0f,    0.0f, -1.0f,  0.0f,    0.0f, 0.0f,    // 8 top of vent pyramid
-         1.9f,  1.2f,  0.8f,    0.0f, -1.0f,  0.0f,    1.0f, 0.0f,    // 13 right center apex
          0.8f, -0.3f,  0.8f,    0.0f, -1.0f,  0.0f,    1.0f, 1.0f,    // 11 left center apex
+         1.9f,  1.2f,  0.8f,    0.0f, -1.0f,  0.0f,    1.0f, 0.0f,    // 13 right center apex
 
          1.6f,  1.8f,  0.0f,    0.0f, -1.0f,  0.0f,    1.0f, 1.0f,    // 8 top of vent pyramid
          1.2f, -1.0f,  0.0f,    0.0f, -1.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
          0.2f,  0.0f,  0.0f,    0.0f, -1.0f,  0.0f,    0.0f, 1.0f,    // 12 left side of vent pyramid
 
          1.6f,  1.8f,  0.0f,    0.0f, -1.0f,  0.0f,    1.0f, 1.0f,    // 8 top of vent pyramid
-         1.2f, -1.0f,  0.0f,    0.0f, -1.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
          2.3f,  1.0f,  0.0f,    0.0f, -1.0f,  0.0f,    1.0f, 0.0f,    // 9 right side of vent pyramid
+         1.2f, -1.0f,  0.0f,    0.0f, -1.0f,  0.0f,    0.0f, 0.0f,    // 10 bottom of vent pyramid
 
 
         -5.0f,  5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    0.0f, 0.0f,    // plane for table
-         5.0f,  5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    1.0f, 1.0f,
         -5.0f, -5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    0.0f, 1.0f,
+         5.0f,  5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    1.0f, 1.0f,
          5.0f,  5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    1.0f, 0.0f,
-         5.0f, -5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    1.0f, 1.0f,
-        -5.0f, -5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    0.0f, 0.0f
+        -5.0f, -5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    0.0f, 0.0f,
+         5.0f, -5.0f, -1.1f,    0.0f,  1.0f,  0.0f,    1.0f, 1.0f
 
     };
 
-    const GLuint floatsPerVertex = 3;
-    const GLuint floatsPerNorm = 3;
-    const GLuint floatsPerUV = 2;
+    static_assert(sizeof(xboxVerts) % XboxVertexLayout::STRIDE == 0, "xboxVerts does not match its vertex layout");
+    const size_t nXboxVertices = sizeof(xboxVerts) / XboxVertexLayout::STRIDE;
 
+    // Weld repeated vertices of the triangle soup into indexed mesh, every part of the soup stays drawable on its own
+    const std::vector<int> xboxPartSizes = { 6, 6, 6, 6, 6, 6, 18, 24, 6 }; // Body faces (see XboxMeshPart), vent, speaker, table
+    mesh.xbox = std::make_unique<static_meshes_3D::WeldedMesh>(lightShaderLayout<XboxVertexLayout>(), xboxVerts, nXboxVertices, xboxPartSizes);
 
-    mesh.nXboxVertices = sizeof(xboxVerts) / (sizeof(xboxVerts[0]) * (floatsPerVertex + floatsPerUV + floatsPerNorm));
+    // Hand-typed normals of xboxVerts are not consistent, so they are generated from the triangles (wound counter-clockwise
+    // seen from outside), box edges stay hard
+    mesh.xbox->generateNormals();
 
+    const auto& weldStats = mesh.xbox->getWeldStats();
+    cout << "Xbox mesh welded from " << weldStats.numSoupVertices << " to " << weldStats.numWeldedVertices
+         << " vertices, " << weldStats.bytesSaved << " bytes saved" << endl;
 
-    glGenVertexArrays(1, &mesh.vao); // we can also generate multiple VAOs or buffers at the same time
-    glBindVertexArray(mesh.vao);
-
-    // Create VBO
-    glGenBuffers(1, &mesh.vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo); // Activates the buffer
-    glBufferData(GL_ARRAY_BUFFER, sizeof(xboxVerts), xboxVerts, GL_STATIC_DRAW);// Sends vertex or coordinate data to the GPU
-
-    // Strides between vertex coordinates
-    GLint stride = sizeof(float) * (floatsPerVertex + floatsPerUV + floatsPerNorm);
+    // Speaker gets LOD chain simplified from its part of the xbox, flat faces with hard edges end the chain early
+    mesh.speaker = std::make_unique<static_meshes_3D::SimplifiedMesh>(*mesh.xbox, XBOX_SPEAKER);
+    cout << "Speaker LOD triangles:";
+    for (int lod = 0; lod < mesh.speaker->getLodCount(); lod++) {
+        cout << " " << mesh.speaker->getLodTriangleCount(lod);
+    }
+    cout << endl;
+    gSpeakerInstance = gLodManager.addInstance(mesh.speaker.get());
+
+    // Finished xbox meshes live in the shared arena, their own VAOs and VBOs are released
+    mesh.xbox->moveToArena(gMeshArena);
+    mesh.speaker->moveToArena(gMeshArena);
+    const auto arenaStats = gMeshArena.getStats();
+    cout << "Mesh arena: " << arenaStats.numAllocations << " meshes in " << arenaStats.numPages << " pages, "
+         << arenaStats.usedBytes << " of " << arenaStats.capacityBytes << " bytes used" << endl;
+
+    // Cans keep four LODs (36, 18, 9 and 4 slices), LOD manager picks one of them every frame.
+    // Both cans ask the cache for the same mesh, so they share one VAO / VBO and differ in transforms only.
+    mesh.can = gMeshCache.get<static_meshes_3D::SegmentedCylinder>(0.65f, 2.0f, 36, 1, 4, lightShaderLayout<CanVertexLayout>());
+    mesh.canTop = gMeshCache.get<static_meshes_3D::SegmentedCylinder>(0.65f, 2.0f, 36, 1, 4, lightShaderLayout<CanVertexLayout>());
+    gCanInstance = gLodManager.addInstance(mesh.can.get());
+    gCanTopInstance = gLodManager.addInstance(mesh.canTop.get());
+
+    // Can field stands on the table plane around the scene, in the same frame as the xbox (rotation and scale of URender)
+    const glm::mat4 sceneTransform = glm::rotate(37.0f, glm::vec3(1.0, 0.0f, 1.0f)) * glm::scale(glm::vec3(0.5f, 0.5f, 0.5f));
+    const glm::mat4 standingCan = glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    const float canSpacing = 1.6f;
+    const float canBoundingRadius = glm::length(glm::vec2(0.65f, 1.0f)) * 0.5f; // Radius and half height of the can, scaled as the scene
+    // Field cans are drawn by thousands, so their own copy of the can is quantized to cut vertex fetch (cached cans stay float)
+    mesh.canField = std::make_unique<static_meshes_3D::SegmentedCylinder>(0.65f, 2.0f, 36, 1, 4, lightShaderLayout<CanVertexLayout>());
+    if (mesh.canField->quantize())
+    {
+        const auto& quantizationError = mesh.canField->getQuantizationError();
+        cout << "Can field mesh quantized (" << mesh.canField->getGpuByteSize() << " bytes on the GPU), max position error " << quantizationError.maxPositionError
+             << ", max normal error " << quantizationError.maxNormalErrorDegrees << " degrees" << endl;
+    }
 
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
+    const int canFieldLod = std::min(CAN_FIELD_LOD, mesh.canField->getLodCount() - 1);
+    gCanField.clear();
+    gCanFieldCuller = std::make_unique<static_meshes_3D::GpuCuller>(mesh.canField.get());
+    for (int i = 0; i < CAN_FIELD_SIZE; i++)
+    {
+        for (int j = 0; j < CAN_FIELD_SIZE; j++)
+        {
+            const glm::vec3 position((i - CAN_FIELD_SIZE / 2) * canSpacing, (j - CAN_FIELD_SIZE / 2) * canSpacing, -1.1f + 1.0f);
+            const glm::vec4 tint(0.6f + 0.4f * float(i % 5) / 4.0f, 0.6f + 0.4f * float(j % 7) / 6.0f, 0.6f + 0.4f * float((i + j) % 3) / 2.0f, 1.0f);
+            const glm::mat4 canModel = sceneTransform * glm::translate(position) * standingCan;
+            const int instance = gCanField.addInstance(canModel, tint);
+            gCanFieldCuller->addObject(canFieldLod, glm::vec4(glm::vec3(canModel[3]), canBoundingRadius), instance);
+        }
+    }
 
-    glVertexAttribPointer(1, floatsPerNorm, GL_FLOAT, GL_FALSE, stride, (char*)(sizeof(float) * floatsPerVertex));
-    glEnableVertexAttribArray(1);
+    const auto cacheStats = gMeshCache.getStats();
+    cout << "Mesh cache: " << cacheStats.numHits << " hits, " << cacheStats.numMisses << " misses, "
+         << cacheStats.bytesSaved << " bytes saved" << endl;
 
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (floatsPerVertex + floatsPerNorm)));
-    glEnableVertexAttribArray(2);
+    if (gImportFileName != nullptr)
+    {
+        static_assert(static_meshes_3D::ImportedMesh::Layout::provides<LightShaderInputs>(), "Imported mesh does not provide all inputs of the light shader");
+        mesh.imported = std::make_unique<static_meshes_3D::ImportedMesh>(gImportFileName, static_meshes_3D::VertexStorage::Interleaved);
+        if (mesh.imported->isImported() && mesh.imported->buildMeshlets())
+        {
+            const auto& importStats = mesh.imported->getImportStats();
+            cout << "Imported " << gImportFileName << ": " << importStats.numTriangles << " triangles, " << importStats.numVertices
+                 << " vertices, parsed in " << importStats.parseMilliseconds << " ms by " << importStats.numThreads << " threads ("
+                 << importStats.parseMegabytesPerSecond << " MB/s), " << importStats.totalMilliseconds << " ms in total, "
+                 << mesh.imported->getMeshlets().getNumMeshlets() << " meshlets" << endl;
+        }
+        else {
+            mesh.imported.reset();
+        }
+    }
 
     glBindVertexArray(0); //Unbind the VAO
 }
@@ -770,8 +1155,35 @@ void UCreateMesh(GLMesh& mesh)
 
 void UDestroyMesh(GLMesh& mesh)
 {
-    glDeleteVertexArrays(1, &mesh.vao);
-    glDeleteBuffers(2, &mesh.vbo);
+    mesh.xbox.reset();
+    mesh.speaker.reset();
+    mesh.can.reset();
+    mesh.canTop.reset();
+    mesh.imported.reset();
+    gCanFieldCuller.reset();
+    mesh.canField.reset();
+    gMeshArena.deleteArena();
+    gCanField.deleteBuffer();
+}
+
+// Gets bitmask of xbox body faces turned to the camera (bit of XboxMeshPart), faces turned away are hidden by the convex box
+unsigned int UGetVisibleXboxBodyFaces(const glm::mat4& model)
+{
+    const unsigned int allFaces = (1u << (XBOX_BODY_RIGHT + 1)) - 1;
+    if (orthoP) {
+        return allFaces;
+    }
+
+    // Face is seen from the camera in front of its plane, camera inside the box sees all of them
+    const glm::vec3 eye = glm::vec3(glm::inverse(model) * glm::vec4(gCamera.Position, 1.0f));
+    unsigned int faces = 0;
+    faces |= eye.z > XBOX_BODY_MAX.z ? 1u << XBOX_BODY_FRONT : 0u;
+    faces |= eye.z < XBOX_BODY_MIN.z ? 1u << XBOX_BODY_BACK : 0u;
+    faces |= eye.y > XBOX_BODY_MAX.y ? 1u << XBOX_BODY_TOP : 0u;
+    faces |= eye.y < XBOX_BODY_MIN.y ? 1u << XBOX_BODY_BOTTOM : 0u;
+    faces |= eye.x < XBOX_BODY_MIN.x ? 1u << XBOX_BODY_LEFT : 0u;
+    faces |= eye.x > XBOX_BODY_MAX.x ? 1u << XBOX_BODY_RIGHT : 0u;
+    return faces != 0 ? faces : allFaces;
 }
 
 /*Generate and load the texture*/
@@ -823,56 +1235,9 @@ void UDestroyTexture(GLuint textureId)
 // Implements the UCreateShaders function
 bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSource, GLuint& programId)
 {
-    // Compilation and linkage error reporting
-    int success = 0;
-    char infoLog[512];
-
-    // Create a Shader program object.
-    programId = glCreateProgram();
-
-    // Create the vertex and fragment shader objects
-    GLuint vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
-    GLuint fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Retrive the shader source
-    glShaderSource(vertexShaderId, 1, &vtxShaderSource, NULL);
-    glShaderSource(fragmentShaderId, 1, &fragShaderSource, NULL);
-
-    // Compile the vertex shader, and print compilation errors (if any)
-    glCompileShader(vertexShaderId); // compile the vertex shader
-    // check for shader compile errors
-    glGetShaderiv(vertexShaderId, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShaderId, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-
-        return false;
-    }
-
-    glCompileShader(fragmentShaderId); // compile the fragment shader
-    // check for shader compile errors
-    glGetShaderiv(fragmentShaderId, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShaderId, sizeof(infoLog), NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-
-        return false;
-    }
-
-    // Attached compiled shaders to the shader program
-    glAttachShader(programId, vertexShaderId);
-    glAttachShader(programId, fragmentShaderId);
-
-    glLinkProgram(programId);   // links the shader program
-    // check for linking errors
-    glGetProgramiv(programId, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(programId, sizeof(infoLog), NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-
+    // Compilation and linkage errors are reported by createShaderProgram
+    programId = static_meshes_3D::createShaderProgram("scene", vtxShaderSource, fragShaderSource);
+    if (programId == 0) {
         return false;
     }
 
@@ -881,7 +1246,6 @@ bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSou
     return true;
 }
 
-
 void UDestroyShaderProgram(GLuint programId)
 {
     glDeleteProgram(programId);
@@ -0,0 +1,63 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "capsule.h"
+#include "sinCosTable.h"
+
+namespace static_meshes_3D {
+
+float Capsule::getRadius() const
+{
+    return _radius;
+}
+
+float Capsule::getCylinderHeight() const
+{
+    return _cylinderHeight;
+}
+
+int Capsule::getSlices() const
+{
+    return _numSlices;
+}
+
+int Capsule::getCapStacks() const
+{
+    return _capStacks;
+}
+
+float Capsule::generateLod(int lod)
+{
+    // Rows 0..capStacks are top hemisphere, rows capStacks + 1..2 * capStacks + 1 bottom one,
+    // the cylinder is the band between the two equators. Stack angles go over quarter circle,
+    // so they are taken from table of four times as many segments.
+    const auto numSlices = getLodSegments(_numSlices, 3, lod);
+    const auto capStacks = getLodSegments(_capStacks, 1, lod);
+    const auto lastRow = 2 * capStacks + 1;
+    const auto& sliceTable = getSinCosTable(numSlices);
+    const auto& stackTable = getSinCosTable(4 * capStacks);
+    addSurface(numSlices, lastRow, true, false, [this, capStacks, lastRow, &sliceTable, &stackTable](int i, int j, glm::vec3& position, glm::vec3& normal)
+    {
+        const auto isTopHemisphere = j <= capStacks;
+        const auto capStack = isTopHemisphere ? j : j - 1;
+
+        // Poles are exact, so that their triangles collapse and get skipped
+        const auto isPole = j == 0 || j == lastRow;
+        const auto stackSine = isPole ? 0.0f : stackTable.getSines()[capStack];
+        const auto stackCosine = j == 0 ? 1.0f : (j == lastRow ? -1.0f : stackTable.getCosines()[capStack]);
+
+        normal = glm::vec3(sliceTable.getCosines()[i] * stackSine, stackCosine, sliceTable.getSines()[i] * stackSine);
+        const auto hemisphereCenter = glm::vec3(0.0f, isTopHemisphere ? _cylinderHeight / 2.0f : -_cylinderHeight / 2.0f, 0.0f);
+        position = hemisphereCenter + normal * _radius;
+    });
+
+    return std::max(getChordError(_radius, numSlices), getChordError(_radius, 4 * capStacks));
+}
+
+std::vector<unsigned char> Capsule::getMeshFileKey() const
+{
+    return makeMeshFileKey("Capsule", _radius, _cylinderHeight, _numSlices, _capStacks);
+}
+
+} // namespace static_meshes_3D
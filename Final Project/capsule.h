@@ -0,0 +1,70 @@
+#pragma once
+
+// Project
+#include "parametricMesh.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Capsule along Y axis - cylinder of given height closed by two hemispheres of the same radius.
+ */
+class Capsule : public ParametricMesh
+{
+public:
+    /**
+     * Creates capsule with compile-time vertex layout (all float attributes by default), attributes not present in the layout are not stored.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    Capsule(float radius, float cylinderHeight, int numSlices, int capStacks, int lodCount = 1,
+        Layout layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+        : ParametricMesh(lodCount, layout, vertexStorage)
+        , _radius(radius)
+        , _cylinderHeight(cylinderHeight)
+        , _numSlices(numSlices)
+        , _capStacks(capStacks)
+    {
+        initializeData();
+    }
+
+    /**
+     * Makes MeshCache key of the capsule created with given constructor arguments (see Cylinder::cacheKey), number of LODs is part of it.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    static std::vector<unsigned char> cacheKey(float radius, float cylinderHeight, int numSlices, int capStacks, int lodCount = 1,
+        Layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+    {
+        return makeGeneratorKey("Capsule", Layout::getFormat(), vertexStorage, radius, cylinderHeight, numSlices, capStacks, clampLodCount(lodCount));
+    }
+
+    /**
+     * Gets capsule radius.
+     */
+    float getRadius() const;
+
+    /**
+     * Gets height of the cylindrical part (total height is cylinder height plus two radii).
+     */
+    float getCylinderHeight() const;
+
+    /**
+     * Gets number of slices of the finest LOD.
+     */
+    int getSlices() const;
+
+    /**
+     * Gets number of stacks of one hemisphere of the finest LOD.
+     */
+    int getCapStacks() const;
+
+protected:
+    float generateLod(int lod) override;
+    std::vector<unsigned char> getMeshFileKey() const override;
+
+private:
+    float _radius; // Radius of the cylinder and hemispheres
+    float _cylinderHeight; // Height of the cylindrical part
+    int _numSlices; // Number of slices around Y axis
+    int _capStacks; // Number of stacks of one hemisphere
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,58 @@
+// STL
+#include <cmath>
+
+// Project
+#include "cone.h"
+#include "sinCosTable.h"
+
+namespace static_meshes_3D {
+
+float Cone::getRadius() const
+{
+    return _radius;
+}
+
+float Cone::getHeight() const
+{
+    return _height;
+}
+
+int Cone::getSlices() const
+{
+    return _numSlices;
+}
+
+int Cone::getHeightSegments() const
+{
+    return _heightSegments;
+}
+
+float Cone::generateLod(int lod)
+{
+    // Side rows go from apex (radius 0, its triangles collapse and get skipped) to the base
+    const auto numSlices = getLodSegments(_numSlices, 3, lod);
+    const auto heightSegments = getLodSegments(_heightSegments, 1, lod);
+    const auto halfHeight = _height / 2.0f;
+    const auto slantLength = std::sqrt(_height * _height + _radius * _radius);
+    const auto& sliceTable = getSinCosTable(numSlices);
+    addSurface(numSlices, heightSegments, true, false, [this, heightSegments, halfHeight, slantLength, &sliceTable](int i, int j, glm::vec3& position, glm::vec3& normal)
+    {
+        const auto sliceCosine = sliceTable.getCosines()[i];
+        const auto sliceSine = sliceTable.getSines()[i];
+        const auto t = float(j) / float(heightSegments);
+
+        normal = glm::vec3(_height * sliceCosine, _radius, _height * sliceSine) / slantLength;
+        position = glm::vec3(sliceCosine * _radius * t, halfHeight - _height * t, sliceSine * _radius * t);
+    });
+
+    addDisk(glm::vec3(0.0f, -halfHeight, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), _radius, numSlices);
+
+    return getChordError(_radius, numSlices);
+}
+
+std::vector<unsigned char> Cone::getMeshFileKey() const
+{
+    return makeMeshFileKey("Cone", _radius, _height, _numSlices, _heightSegments);
+}
+
+} // namespace static_meshes_3D
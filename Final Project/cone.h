@@ -0,0 +1,70 @@
+#pragma once
+
+// Project
+#include "parametricMesh.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Cone along Y axis with apex at the top and base disk at the bottom.
+ */
+class Cone : public ParametricMesh
+{
+public:
+    /**
+     * Creates cone with compile-time vertex layout (all float attributes by default), attributes not present in the layout are not stored.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    Cone(float radius, float height, int numSlices, int heightSegments = 1, int lodCount = 1,
+        Layout layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+        : ParametricMesh(lodCount, layout, vertexStorage)
+        , _radius(radius)
+        , _height(height)
+        , _numSlices(numSlices)
+        , _heightSegments(heightSegments)
+    {
+        initializeData();
+    }
+
+    /**
+     * Makes MeshCache key of the cone created with given constructor arguments (see Cylinder::cacheKey), number of LODs is part of it.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    static std::vector<unsigned char> cacheKey(float radius, float height, int numSlices, int heightSegments = 1, int lodCount = 1,
+        Layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+    {
+        return makeGeneratorKey("Cone", Layout::getFormat(), vertexStorage, radius, height, numSlices, heightSegments, clampLodCount(lodCount));
+    }
+
+    /**
+     * Gets radius of the base.
+     */
+    float getRadius() const;
+
+    /**
+     * Gets cone height.
+     */
+    float getHeight() const;
+
+    /**
+     * Gets number of slices of the finest LOD.
+     */
+    int getSlices() const;
+
+    /**
+     * Gets number of segments along height of the finest LOD.
+     */
+    int getHeightSegments() const;
+
+protected:
+    float generateLod(int lod) override;
+    std::vector<unsigned char> getMeshFileKey() const override;
+
+private:
+    float _radius; // Radius of the base
+    float _height; // Height from base to apex
+    int _numSlices; // Number of slices around Y axis
+    int _heightSegments; // Number of segments from apex to base
+};
+
+} // namespace static_meshes_3D
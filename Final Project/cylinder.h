@@ -1,20 +1,52 @@
 #pragma once
 
+// STL
+#include <type_traits>
+
+// GLM
+#include <glm/glm.hpp>
+
 // Project
-#include "staticMesh3D.h"
+#include "staticMeshIndexed3D.h"
+#include "sinCosTable.h"
 
 namespace static_meshes_3D {
 
 /**
- * Cylinder static mesh with given radius, number of slices and height.
+ * Cylinder static mesh with given radius, number of slices and height. Side and both covers are triangle lists
+ * in one index buffer, so the whole cylinder is rendered with one draw call.
  */
-class Cylinder : public StaticMesh3D
+class Cylinder : public StaticMeshIndexed3D
 {
 public:
-    Cylinder(float radius, int numSlices, float height,
-        bool withPositions = true, bool withTextureCoordinates = true, bool withNormals = true);
+    /**
+     * Creates cylinder with compile-time vertex layout, e.g. Cylinder(0.65f, 36, 2.0f, VertexLayout<Position, Normal>()).
+     * Vertices are generated for the layout, so attributes not present in it are never computed.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    Cylinder(float radius, int numSlices, float height, Layout layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+        : StaticMeshIndexed3D(layout, vertexStorage)
+        , _radius(radius)
+        , _numSlices(numSlices)
+        , _height(height)
+    {
+        initializeDataWithLayout<Layout>();
+    }
+
+    /**
+     * Makes MeshCache key of the cylinder created with given constructor arguments. Arguments get parameter types and defaults
+     * of the constructor, so the same cylinder gets the same key however its arguments are spelled (the key equals its mesh file key).
+     */
+    template<typename Layout = DefaultVertexLayout>
+    static std::vector<unsigned char> cacheKey(float radius, int numSlices, float height, Layout = Layout(),
+        VertexStorage vertexStorage = VertexStorage::Planar)
+    {
+        return makeGeneratorKey("Cylinder", Layout::getFormat(), vertexStorage, radius, numSlices, height);
+    }
 
-    void render() const override;
+    /**
+     * Renders every distinct vertex position once as a point (seam and cover rim vertices are skipped).
+     */
     void renderPoints() const override;
 
     /**
@@ -37,11 +69,122 @@ private:
     int _numSlices; // Number of cylinder slices
     float _height; // Height of the cylinder
 
-    int _numVerticesSide; // How many vertices to render side of the cylinder
-    int _numVerticesTopBottom; // How many vertices to render top / bottom of the cylinder
-    int _numVerticesTotal; // Just a sum of both numbers above
-    
-    void initializeData() override;
+    int _numUniquePositions; // How many vertices at the beginning of the VBO have distinct positions
+
+    /**
+     * Loads cylinder from the mesh file cache, or generates its vertices with given vertex layout (attributes not present
+     * in the layout are not generated at all).
+     */
+    template<typename Layout>
+    void initializeDataWithLayout();
 };
 
-} // namespace static_meshes_3D
\ No newline at end of file
+template<typename Layout>
+inline void Cylinder::initializeDataWithLayout()
+{
+    using namespace vertex_attributes;
+
+    // Vertices with distinct positions go first in the cached data too
+    if (loadFromMeshFileCache(makeMeshFileKey("Cylinder", _radius, _numSlices, _height)))
+    {
+        _numUniquePositions = _numSlices * 2 + 2;
+        return;
+    }
+
+    // Vertices with distinct positions go first - side vertices without the seam and centers of the covers,
+    // then seam of the side and rims of the covers, which differ from them only in texture coordinates and normals
+    _numUniquePositions = _numSlices * 2 + 2;
+    _numVertices = (_numSlices + 1) * 2 + (_numSlices + 2) * 2;
+    _numIndices = _numSlices * 12;
+    const auto topCenterVertex = _numSlices * 2;
+    const auto bottomCenterVertex = topCenterVertex + 1;
+    const auto seamVertex = _numUniquePositions;
+    const auto topRimVertex = seamVertex + 2;
+    const auto bottomRimVertex = topRimVertex + _numSlices + 1;
+    const auto sideVertex = [this, seamVertex](int slice) { return slice < _numSlices ? slice * 2 : seamVertex; };
+
+    // Vertices and indices are written straight to the mapped GPU buffers, as slices are already in vertex cache friendly order
+    // and reordering vertices would break the distinct positions going first. Every attribute of a run of vertices is written
+    // as one span, attributes not present in the layout are neither computed nor written.
+    const auto numVertices = static_cast<size_t>(_numVertices);
+    void* indexData = nullptr;
+    const auto vertexData = beginDirectIndexedUpload(GL_STATIC_DRAW, indexData);
+    const auto writeVertices = [&](int firstVertex, int count, const auto& positionOf, const auto& textureCoordinateOf, const auto& normalOf)
+    {
+        Layout::template generateAttributeSpan<Position>(vertexData, _vertexStorage, numVertices, firstVertex, count, positionOf);
+        Layout::template generateAttributeSpan<TextureCoordinate>(vertexData, _vertexStorage, numVertices, firstVertex, count, textureCoordinateOf);
+        Layout::template generateAttributeSpan<Normal>(vertexData, _vertexStorage, numVertices, firstVertex, count, normalOf);
+    };
+
+    // Sines / cosines for given number of slices come from the shared table
+    const auto& sinCosTable = getSinCosTable(_numSlices);
+    const auto sines = sinCosTable.getSines();
+    const auto cosines = sinCosTable.getCosines();
+
+    // Add cylinder side vertices - top and bottom vertex of every slice, seam slice goes after centers of the covers
+    // I have decided to map the texture twice around cylinder, looks fine
+    const auto halfHeight = _height / 2.0f;
+    const auto sliceTextureStepU = 2.0f / float(_numSlices);
+    const auto writeSide = [&](int firstVertex, int firstSlice, int count)
+    {
+        writeVertices(firstVertex, count * 2,
+            [&](size_t i) { const auto slice = firstSlice + i / 2; return glm::vec3(cosines[slice] * _radius, i % 2 == 0 ? halfHeight : -halfHeight, sines[slice] * _radius); },
+            [&](size_t i) { return glm::vec2(sliceTextureStepU * float(firstSlice + i / 2), i % 2 == 0 ? 1.0f : 0.0f); },
+            [&](size_t i) { const auto slice = firstSlice + i / 2; return glm::vec3(cosines[slice], 0.0f, sines[slice]); });
+    };
+    writeSide(0, 0, _numSlices);
+    writeSide(seamVertex, _numSlices, 1);
+
+    // Add centers of both covers
+    const glm::vec2 topBottomCenterTexCoord(0.5f, 0.5f);
+    writeVertices(topCenterVertex, 2,
+        [&](size_t i) { return glm::vec3(0.0f, i == 0 ? halfHeight : -halfHeight, 0.0f); },
+        [&](size_t) { return topBottomCenterTexCoord; },
+        [](size_t i) { return glm::vec3(0.0f, i == 0 ? 1.0f : -1.0f, 0.0f); });
+
+    // Add rims of top and bottom cylinder cover
+    writeVertices(topRimVertex, _numSlices + 1,
+        [&](size_t i) { return glm::vec3(cosines[i] * _radius, halfHeight, sines[i] * _radius); },
+        [&](size_t i) { return glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y + cosines[i] * 0.5f); },
+        [](size_t) { return glm::vec3(0.0f, 1.0f, 0.0f); });
+    writeVertices(bottomRimVertex, _numSlices + 1,
+        [&](size_t i) { return glm::vec3(cosines[i] * _radius, -halfHeight, -sines[i] * _radius); },
+        [&](size_t i) { return glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y - cosines[i] * 0.5f); },
+        [](size_t) { return glm::vec3(0.0f, -1.0f, 0.0f); });
+
+    // Side quads and cover triangles, all wound counter-clockwise when looking from outside
+    const auto writeIndices = [&](auto indices)
+    {
+        using Index = std::remove_pointer_t<decltype(indices)>;
+        const auto addTriangle = [&indices](int a, int b, int c)
+        {
+            *indices++ = Index(a);
+            *indices++ = Index(b);
+            *indices++ = Index(c);
+        };
+
+        for (auto i = 0; i < _numSlices; i++)
+        {
+            const auto top = sideVertex(i), nextTop = sideVertex(i + 1);
+            addTriangle(top, nextTop, top + 1);
+            addTriangle(nextTop, nextTop + 1, top + 1);
+        }
+        for (auto i = 0; i < _numSlices; i++) {
+            addTriangle(topCenterVertex, topRimVertex + i + 1, topRimVertex + i);
+        }
+        for (auto i = 0; i < _numSlices; i++) {
+            addTriangle(bottomCenterVertex, bottomRimVertex + i + 1, bottomRimVertex + i);
+        }
+    };
+
+    if (getIndexType() == GL_UNSIGNED_SHORT) {
+        writeIndices(static_cast<GLushort*>(indexData));
+    }
+    else {
+        writeIndices(static_cast<GLuint*>(indexData));
+    }
+
+    finishDirectIndexedUpload();
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,1313 @@
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Project
+#include "diagnostics.h"
+#include "cylinder.h"
+#include "gpuCulling.h"
+#include "instanceBuffer.h"
+#include "meshBufferArena.h"
+#include "meshCache.h"
+#include "meshFile.h"
+#include "meshNormals.h"
+#include "segmentedCylinder.h"
+#include "shaderProgram.h"
+#include "shaderReflection.h"
+#include "simplifiedMesh.h"
+#include "sphere.h"
+#include "timing.h"
+#include "vertexBufferObject.h"
+#include "vertexLayout.h"
+#include "weldedMesh.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+const float CAN_RADIUS = 0.65f;
+const float CAN_HEIGHT = 2.0f;
+const float CAN_SPACING = 1.6f;
+const int CAN_LOD = 2;
+const int VALIDATED_CAN_FIELD_SIZE = 316; // Cans along one side of the validated field (as in the scene)
+const size_t NUM_PATCHED_VALUES = 1024; // Values in the buffer of dirty ranges validation
+const int NUM_VALIDATED_INSTANCES = 16; // Instances in the instance buffer of dirty ranges validation
+const int MESHLET_SPHERE_SLICES = 256; // Slices of the sphere split into meshlets (stacks are half of them)
+const float MESHLET_CAMERA_DISTANCE = 4.0f; // Distance of cameras looking at the sphere split into meshlets
+const float MAX_QUANTIZED_NORMAL_ERROR_DEGREES = 0.05f; // Allowed angle between original and decoded octahedral normal
+const int SIMPLIFIED_SPHERE_SLICES = 64; // Slices of the simplified sphere (stacks are half of them)
+const float SIMPLIFIED_TRIANGLE_RATIO = 0.5f; // Triangles of every simplified LOD relative to the previous one
+const float MIN_NORMAL_COSINE = 0.999f; // Minimal cosine between generated and analytic normal (about 2.5 degrees)
+const float MIN_TANGENT_COSINE = 0.99f; // Minimal cosine between generated and analytic tangent
+const size_t ARENA_PAGE_VERTICES = 256; // Page size of the validated arena (small, so that few allocations fill and fragment it)
+
+const int BENCHMARK_FRAMEBUFFER_SIZE = 256; // Width and height of the framebuffer benchmarks render into
+const int STREAMED_GRID_SIZE = 256; // Streamed points along one side of their grid
+const size_t NUM_STREAMED_POINTS = STREAMED_GRID_SIZE * STREAMED_GRID_SIZE; // Points written every frame by streaming benchmark
+const int FETCHED_CYLINDER_SLICES = 256; // Slices of cylinders of vertex fetch benchmark (high, so that vertex fetch dominates)
+const float BENCHMARK_CYLINDER_SPACING = 1.2f; // Distance between centers of neighbouring cylinders of benchmarks
+const int SUBMITTED_CYLINDER_SLICES = 36; // Slices of cylinders of submission benchmark (as cans of the scene)
+
+constexpr ResourceName VIEW_PROJECTION_UNIFORM("viewProjection");
+constexpr ResourceName FIELD_SIZE_UNIFORM("fieldSize");
+constexpr ResourceName SPACING_UNIFORM("spacing");
+constexpr ResourceName OFFSET_UNIFORM("offset");
+
+const char* const POSITION_VERTEX_SHADER = R"(#version 440 core
+    layout(location = 0) in vec3 position;
+    uniform mat4 viewProjection;
+    void main()
+    {
+        gl_Position = viewProjection * vec4(position, 1.0);
+    }
+)";
+
+// Places instances on a square field, fetches (and uses) all vertex attributes
+const char* const FIELD_VERTEX_SHADER = R"(#version 440 core
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec3 normal;
+    layout(location = 2) in vec2 textureCoordinate;
+    uniform mat4 viewProjection;
+    uniform int fieldSize;
+    uniform float spacing;
+    out vec3 color;
+    void main()
+    {
+        vec2 cell = vec2(gl_InstanceID % fieldSize, gl_InstanceID / fieldSize) - 0.5 * fieldSize;
+        gl_Position = viewProjection * vec4(position + vec3(cell.x, 0.0, cell.y) * spacing, 1.0);
+        color = abs(normal) * vec3(textureCoordinate, 1.0);
+    }
+)";
+
+const char* const COLOR_FRAGMENT_SHADER = R"(#version 440 core
+    in vec3 color;
+    out vec4 fragmentColor;
+    void main()
+    {
+        fragmentColor = vec4(color, 1.0);
+    }
+)";
+
+// Places instances on a square field as FIELD_VERTEX_SHADER does, but fetches positions only (as depth-only pass)
+const char* const FIELD_POSITION_VERTEX_SHADER = R"(#version 440 core
+    layout(location = 0) in vec3 position;
+    uniform mat4 viewProjection;
+    uniform int fieldSize;
+    uniform float spacing;
+    void main()
+    {
+        vec2 cell = vec2(gl_InstanceID % fieldSize, gl_InstanceID / fieldSize) - 0.5 * fieldSize;
+        gl_Position = viewProjection * vec4(position + vec3(cell.x, 0.0, cell.y) * spacing, 1.0);
+    }
+)";
+
+// Moves every drawn mesh by its own offset, set by uniform before each draw as the scene does with model matrices
+const char* const OFFSET_VERTEX_SHADER = R"(#version 440 core
+    layout(location = 0) in vec3 position;
+    uniform mat4 viewProjection;
+    uniform vec3 offset;
+    void main()
+    {
+        gl_Position = viewProjection * vec4(position + offset, 1.0);
+    }
+)";
+
+const char* const CONSTANT_FRAGMENT_SHADER = R"(#version 440 core
+    out vec4 fragmentColor;
+    void main()
+    {
+        fragmentColor = vec4(1.0);
+    }
+)";
+
+/**
+ * Offscreen color and depth framebuffer, bound while it lives. Benchmarks render into it, because headless context has
+ * no default framebuffer and window of the application may be hidden.
+ */
+class BenchmarkFramebuffer
+{
+public:
+    explicit BenchmarkFramebuffer(int size)
+    {
+        glGenRenderbuffers(2, _renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, _renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size, size);
+        glBindRenderbuffer(GL_RENDERBUFFER, _renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+
+        glGenFramebuffers(1, &_framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _renderbuffers[1]);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Benchmark framebuffer is not complete!" << std::endl;
+        }
+
+        glViewport(0, 0, size, size);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    ~BenchmarkFramebuffer()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &_framebuffer);
+        glDeleteRenderbuffers(2, _renderbuffers);
+    }
+
+    BenchmarkFramebuffer(const BenchmarkFramebuffer&) = delete;
+    BenchmarkFramebuffer& operator=(const BenchmarkFramebuffer&) = delete;
+
+private:
+    GLuint _framebuffer = 0; // Framebuffer object
+    GLuint _renderbuffers[2] = {}; // Color and depth renderbuffers
+};
+
+// Reports all pending OpenGL errors of a diagnostic, returns true if there were none
+bool checkErrors(const char* diagnosticName)
+{
+    auto isClean = true;
+    for (auto error = glGetError(); error != GL_NO_ERROR; error = glGetError())
+    {
+        std::cerr << diagnosticName << " raised OpenGL error 0x" << std::hex << error << std::dec << "!" << std::endl;
+        isClean = false;
+    }
+    return isClean;
+}
+
+// Writes streamed points of a frame - grid filling the view, waving differently every frame, so that every frame has new data
+void writeStreamedPoints(glm::vec3* points, int frame)
+{
+    for (size_t i = 0; i < NUM_STREAMED_POINTS; i++)
+    {
+        const auto x = float(i % STREAMED_GRID_SIZE) / STREAMED_GRID_SIZE * 2.0f - 1.0f;
+        const auto y = float(i / STREAMED_GRID_SIZE) / STREAMED_GRID_SIZE * 2.0f - 1.0f;
+        points[i] = glm::vec3(x, y, 0.5f * std::sin(frame * 0.1f + x * 4.0f));
+    }
+}
+
+// Prints transfer statistics of one streaming path
+void printTransferStats(const char* pathName, const VertexBufferObject::TransferStats& stats, double milliseconds)
+{
+    const auto numFrames = std::max(stats.numFrames, 1);
+    std::cout << "  " << std::left << std::setw(17) << pathName << std::right << stats.bytesTotal / numFrames << " bytes per frame, "
+              << stats.stallMilliseconds / numFrames << " ms per frame stalled on GPU, " << milliseconds / numFrames << " ms per frame in total" << std::endl;
+}
+
+/**
+ * Cylinder as it was rendered before it became indexed mesh (positions only) - side is triangle strip and both covers
+ * are triangle fans, so rendering it takes three glDrawArrays calls. Kept just as baseline of the submission benchmark.
+ */
+class LegacyCylinder
+{
+public:
+    static const int NUM_DRAW_CALLS = 3; // Draw calls of one render call
+
+    LegacyCylinder(float radius, int numSlices, float height)
+        : _numVerticesSide((numSlices + 1) * 2)
+        , _numVerticesCover(numSlices + 2)
+    {
+        using namespace vertex_attributes;
+        glGenVertexArrays(1, &_vao);
+        glBindVertexArray(_vao);
+        _vbo.createVBO();
+        _vbo.bindVBO();
+
+        std::vector<float> sines, cosines;
+        for (auto i = 0; i <= numSlices; i++)
+        {
+            const auto sliceAngle = 2.0f * glm::pi<float>() * i / numSlices;
+            sines.push_back(std::sin(sliceAngle));
+            cosines.push_back(std::cos(sliceAngle));
+        }
+
+        // Side strip, then top and bottom fans (center and rim, bottom rim goes the other way round to face down)
+        const auto halfHeight = height / 2.0f;
+        for (auto i = 0; i <= numSlices; i++)
+        {
+            _vbo.addData(glm::vec3(cosines[i] * radius, halfHeight, sines[i] * radius));
+            _vbo.addData(glm::vec3(cosines[i] * radius, -halfHeight, sines[i] * radius));
+        }
+        _vbo.addData(glm::vec3(0.0f, halfHeight, 0.0f));
+        for (auto i = 0; i <= numSlices; i++) {
+            _vbo.addData(glm::vec3(cosines[i] * radius, halfHeight, sines[i] * radius));
+        }
+        _vbo.addData(glm::vec3(0.0f, -halfHeight, 0.0f));
+        for (auto i = 0; i <= numSlices; i++) {
+            _vbo.addData(glm::vec3(cosines[i] * radius, -halfHeight, -sines[i] * radius));
+        }
+
+        _vbo.uploadDataToGPU(GL_STATIC_DRAW);
+        glEnableVertexAttribArray(Position::LOCATION);
+        glVertexAttribPointer(Position::LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+    }
+
+    ~LegacyCylinder()
+    {
+        _vbo.deleteVBO();
+        glDeleteVertexArrays(1, &_vao);
+    }
+
+    LegacyCylinder(const LegacyCylinder&) = delete;
+    LegacyCylinder& operator=(const LegacyCylinder&) = delete;
+
+    void render() const
+    {
+        glBindVertexArray(_vao);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVerticesSide);
+        glDrawArrays(GL_TRIANGLE_FAN, _numVerticesSide, _numVerticesCover);
+        glDrawArrays(GL_TRIANGLE_FAN, _numVerticesSide + _numVerticesCover, _numVerticesCover);
+    }
+
+private:
+    GLuint _vao = 0; // Vertex array object
+    VertexBufferObject _vbo; // Side and cover vertices
+    int _numVerticesSide; // Vertices of the side strip
+    int _numVerticesCover; // Vertices of one cover fan
+};
+
+/**
+ * Submits numCylinders cylinders numFrames times, each of them with its own offset uniform.
+ *
+ * @param submitMilliseconds  Receives CPU time per frame spent submitting the draws
+ * @param totalMilliseconds   Receives time per frame including waiting for the GPU to finish them
+ */
+template<typename Mesh>
+void measureSubmitTime(const Mesh& cylinder, const UniformHandle<glm::vec3>& offset, int numCylinders, int numFrames,
+    double& submitMilliseconds, double& totalMilliseconds)
+{
+    const auto gridSize = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numCylinders))));
+    const auto submitFrame = [&]
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        for (auto i = 0; i < numCylinders; i++)
+        {
+            offset.set(glm::vec3(i % gridSize - gridSize / 2, 0.0f, i / gridSize - gridSize / 2) * BENCHMARK_CYLINDER_SPACING);
+            cylinder.render();
+        }
+    };
+
+    // One frame warms up the driver, it's not measured
+    submitFrame();
+    glFinish();
+
+    submitMilliseconds = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0; frame < numFrames; frame++)
+    {
+        const auto submitStart = std::chrono::steady_clock::now();
+        submitFrame();
+        submitMilliseconds += millisecondsSince(submitStart);
+        glFlush();
+    }
+    glFinish();
+
+    const auto divisor = std::max(numFrames, 1);
+    submitMilliseconds /= divisor;
+    totalMilliseconds = millisecondsSince(start) / divisor;
+}
+
+// Measures time of rendering the cylinder field numFrames times with given program, returns milliseconds per frame. Every
+// frame is one draw call, so time between two glFinish calls is GPU time (software rasterizers do not time queries well).
+double measureFieldFrameTime(const Cylinder& cylinder, GLuint programId, int fieldSize, int numFrames)
+{
+    glUseProgram(programId);
+    ShaderReflection reflection;
+    reflection.reflect(programId);
+
+    // Camera looks down at the whole field from its corner
+    const auto fieldExtent = fieldSize * BENCHMARK_CYLINDER_SPACING * 0.5f;
+    const auto view = glm::lookAt(glm::vec3(fieldExtent, fieldExtent, fieldExtent), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const auto projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 10.0f * fieldExtent);
+    reflection.getUniform<glm::mat4>(VIEW_PROJECTION_UNIFORM).set(projection * view);
+    reflection.getUniform<int>(FIELD_SIZE_UNIFORM).set(fieldSize);
+    reflection.getUniform<float>(SPACING_UNIFORM).set(BENCHMARK_CYLINDER_SPACING);
+
+    // One frame warms up caches and compiles the vertex fetch for the layout, it's not measured
+    const auto numInstances = static_cast<GLsizei>(fieldSize * fieldSize);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    cylinder.renderInstanced(numInstances);
+    glFinish();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0; frame < numFrames; frame++)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        cylinder.renderInstanced(numInstances);
+    }
+    glFinish();
+    return millisecondsSince(start) / std::max(numFrames, 1);
+}
+
+/**
+ * Makes unindexed triangle soup of 2x2x2 box centered in origin, with positions, normals and texture coordinates
+ * (vertex layout of the xbox parts).
+ *
+ * @param hasFaceNormals  True for normals of box faces, false for the same up normal everywhere
+ */
+std::vector<float> makeBoxSoup(bool hasFaceNormals)
+{
+    std::vector<float> soup;
+    for (auto axis = 0; axis < 3; axis++)
+    {
+        for (const auto side : { -1.0f, 1.0f })
+        {
+            // Corners of the face wound counter-clockwise seen from outside
+            glm::vec3 faceNormal(0.0f), u(0.0f), v(0.0f);
+            faceNormal[axis] = side;
+            u[(axis + 1) % 3] = 1.0f;
+            v[(axis + 2) % 3] = side;
+            const auto normal = hasFaceNormals ? faceNormal : glm::vec3(0.0f, 1.0f, 0.0f);
+            const glm::vec2 corners[] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+            for (const auto& corner : corners)
+            {
+                const auto position = faceNormal + u * corner.x + v * corner.y;
+                soup.insert(soup.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z,
+                    corner.x * 0.5f + 0.5f, corner.y * 0.5f + 0.5f });
+            }
+        }
+    }
+    return soup;
+}
+
+/**
+ * Diagnostic selectable from command line.
+ */
+struct Diagnostic
+{
+    const char* commandLineSwitch; // Switch selecting the diagnostic
+    bool (*run)(); // Runs the diagnostic with default parameters
+};
+
+const Diagnostic DIAGNOSTICS[] = {
+    { "--validate-gpu-culling", [] { return validateGpuCulling(VALIDATED_CAN_FIELD_SIZE); } },
+    { "--validate-dirty-ranges", [] { return validateDirtyRanges(); } },
+    { "--validate-mesh-arena", [] { return validateMeshArena(); } },
+    { "--validate-mesh-cache", [] { return validateMeshCache(); } },
+    { "--validate-mesh-file", [] { return validateMeshFile(); } },
+    { "--validate-meshlets", [] { return validateMeshlets(); } },
+    { "--validate-quantization", [] { return validateQuantization(); } },
+    { "--validate-simplification", [] { return validateSimplification(); } },
+    { "--validate-normals", [] { return validateNormals(); } },
+    { "--benchmark-streaming", [] { return benchmarkStreaming(); } },
+    { "--benchmark-vertex-fetch", [] { return benchmarkVertexFetch(); } },
+    { "--benchmark-cylinder-submission", [] { return benchmarkCylinderSubmission(); } }
+};
+
+const Diagnostic* findDiagnostic(const std::string& commandLineSwitch)
+{
+    for (const auto& diagnostic : DIAGNOSTICS)
+    {
+        if (commandLineSwitch == diagnostic.commandLineSwitch) {
+            return &diagnostic;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+bool validateGpuCulling(int fieldSize, int numDirections)
+{
+    using namespace vertex_attributes;
+    const SegmentedCylinder can(CAN_RADIUS, CAN_HEIGHT, 36, 1, 4, VertexLayout<Position, TextureCoordinate, Normal>());
+    GpuCuller culler(&can);
+
+    // Standing cans on a square grid around the origin, one object per can
+    const float boundingRadius = glm::length(glm::vec2(CAN_RADIUS, CAN_HEIGHT * 0.5f));
+    for (auto i = 0; i < fieldSize; i++)
+    {
+        for (auto j = 0; j < fieldSize; j++)
+        {
+            const glm::vec3 center((i - fieldSize / 2) * CAN_SPACING, 0.0f, (j - fieldSize / 2) * CAN_SPACING);
+            culler.addObject(CAN_LOD, glm::vec4(center, boundingRadius), static_cast<GLuint>(i * fieldSize + j));
+        }
+    }
+
+    const auto projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+    const auto fieldExtent = fieldSize * CAN_SPACING * 0.5f;
+    auto numMatchingViews = 0;
+    for (auto d = 0; d < numDirections; d++)
+    {
+        // Cameras move across the field and turn around, so that views see the field from inside, from its edge and partly
+        const auto angle = glm::radians(360.0f * d / numDirections);
+        const auto t = numDirections > 1 ? float(d) / (numDirections - 1) : 0.5f;
+        const glm::vec3 eye(fieldExtent * (2.0f * t - 1.0f), 3.0f, fieldExtent * (1.5f * t - 1.0f));
+        const auto view = glm::lookAt(eye, eye + glm::vec3(std::cos(angle), -0.3f, std::sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+        if (culler.validate(projection * view)) {
+            numMatchingViews++;
+        }
+    }
+
+    std::cout << "GPU culling of " << culler.getNumObjects() << " cans matches CPU reference in " << numMatchingViews << " of "
+              << numDirections << " views (draw count " << (culler.isDrawCountSupported() ? "read from GPU" : "not supported") << ")" << std::endl;
+
+    // Culler attaches InstanceIndex attribute to its own VAO, the mesh may be shared with renderers not using it
+    GLint isInstanceIndexEnabled = GL_FALSE;
+    glBindVertexArray(can.getVertexArrayID());
+    glGetVertexAttribiv(InstanceIndex::LOCATION, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &isInstanceIndexEnabled);
+    glBindVertexArray(0);
+    if (isInstanceIndexEnabled != GL_FALSE) {
+        std::cerr << "GPU culling validation failed - culler has changed VAO of the mesh!" << std::endl;
+    }
+
+    return numMatchingViews == numDirections && isInstanceIndexEnabled == GL_FALSE;
+}
+
+bool validateDirtyRanges()
+{
+    // Buffer is filled by direct upload, which has to keep the in-memory copy for later updates
+    std::vector<GLuint> values(NUM_PATCHED_VALUES);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<GLuint>(i);
+    }
+
+    const auto bufferSize = values.size() * sizeof(GLuint);
+    VertexBufferObject vbo;
+    vbo.createVBO();
+    vbo.bindVBO();
+    vbo.setCpuCopyPolicy(VertexBufferObject::CpuCopyPolicy::Keep);
+    vbo.beginDirectUpload(bufferSize, GL_DYNAMIC_DRAW);
+    vbo.addRawData(values.data(), bufferSize);
+    vbo.finishDirectUpload();
+    auto isValid = vbo.getCpuCopySize() >= bufferSize;
+
+    // Every round patches given ranges of values (first, count) with new values, flushes them and compares GPU data with expected ones
+    struct PatchedRange
+    {
+        size_t first;
+        size_t count;
+    };
+
+    auto round = 0;
+    const auto patchAndCompare = [&](const char* roundName, const std::vector<PatchedRange>& ranges, int expectedMergedRanges, bool isOrphaningExpected)
+    {
+        round++;
+        for (const auto& range : ranges)
+        {
+            for (auto i = range.first; i < range.first + range.count; i++) {
+                values[i] = static_cast<GLuint>(round * NUM_PATCHED_VALUES + i);
+            }
+            vbo.updateRawData(range.first * sizeof(GLuint), values.data() + range.first, range.count * sizeof(GLuint));
+        }
+
+        const auto numOrphans = vbo.getTransferStats().numOrphans;
+        vbo.flushDirtyRanges();
+        std::vector<GLuint> gpuValues(values.size());
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, bufferSize, gpuValues.data());
+
+        const auto& stats = vbo.getTransferStats();
+        const auto isMatching = gpuValues == values && stats.numRangesLastFrame == expectedMergedRanges
+            && (stats.numOrphans > numOrphans) == isOrphaningExpected;
+        std::cout << "  " << std::left << std::setw(20) << roundName << std::right << ranges.size() << " ranges flushed as "
+                  << stats.numRangesLastFrame << ", " << stats.bytesLastFrame << " bytes: " << (isMatching ? "match" : "MISMATCH") << std::endl;
+        isValid = isValid && isMatching;
+    };
+
+    // Overlapping and adjacent ranges are merged into one, the separate one stays alone
+    const std::vector<PatchedRange> mergedRanges = { { 10, 20 }, { 25, 10 }, { 35, 5 }, { 100, 3 } };
+    std::cout << "Dirty ranges of " << bufferSize << " bytes buffer with kept in-memory copy:" << std::endl;
+    vbo.setDirtyUploadMethod(VertexBufferObject::DirtyUploadMethod::BufferSubData);
+    patchAndCompare("glBufferSubData:", mergedRanges, 2, false);
+    vbo.setDirtyUploadMethod(VertexBufferObject::DirtyUploadMethod::FlushMappedRange);
+    patchAndCompare("flushed mapping:", mergedRanges, 2, false);
+    patchAndCompare("orphaning:", { { 0, NUM_PATCHED_VALUES * 3 / 4 } }, 1, true);
+    vbo.deleteVBO();
+
+    // Instance buffer is rebuilt when the set of instances changes, otherwise it flushes dirty ranges of changed instances
+    InstanceBuffer instances;
+    const auto readBackMatches = [&instances]()
+    {
+        std::vector<InstanceData> gpuInstances(instances.getNumInstances());
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuInstances.size() * sizeof(InstanceData), gpuInstances.data());
+        for (auto i = 0; i < instances.getNumInstances(); i++)
+        {
+            if (memcmp(&gpuInstances[i], &instances.getInstance(i), sizeof(InstanceData)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (auto i = 0; i < NUM_VALIDATED_INSTANCES; i++) {
+        instances.addInstance(glm::translate(glm::mat4(1.0f), glm::vec3(float(i), 0.0f, 0.0f)), glm::vec4(1.0f), 0.0f);
+    }
+    instances.bind();
+    auto isInstanceBufferValid = readBackMatches();
+    instances.setInstanceMaterial(3, glm::vec4(0.5f), 2.0f);
+    auto scaledModel = glm::mat4(2.0f);
+    scaledModel[3][3] = 1.0f;
+    instances.setInstanceModel(NUM_VALIDATED_INSTANCES - 1, scaledModel);
+    instances.bind();
+    isInstanceBufferValid = isInstanceBufferValid && readBackMatches() && instances.getNumUploads() == 2;
+    instances.removeInstance(0);
+    instances.setInstanceMaterial(0, glm::vec4(0.25f), 1.0f);
+    instances.bind();
+    instances.bind();
+    isInstanceBufferValid = isInstanceBufferValid && readBackMatches() && instances.getNumUploads() == 3
+        && instances.getNumInstances() == NUM_VALIDATED_INSTANCES - 1;
+    std::cout << "  " << std::left << std::setw(20) << "instance buffer:" << std::right << instances.getNumUploads() << " uploads of "
+              << instances.getNumInstances() << " instances: " << (isInstanceBufferValid ? "match" : "MISMATCH") << std::endl;
+    instances.deleteBuffer();
+    isValid = isValid && isInstanceBufferValid;
+
+    return checkErrors("Dirty ranges validation") && isValid;
+}
+
+bool validateMeshArena()
+{
+    using namespace vertex_attributes;
+    typedef VertexLayout<Position, Normal> ArenaLayout;
+    MeshBufferArena arena(ArenaLayout(), ARENA_PAGE_VERTICES);
+    auto isValid = true;
+    const auto check = [&isValid](bool condition, const char* failure)
+    {
+        if (!condition)
+        {
+            std::cerr << "Mesh arena validation failed - " << failure << "!" << std::endl;
+            isValid = false;
+        }
+    };
+
+    // Every allocation gets data derived from its handle, so that data moved by compaction can be checked
+    const auto makeAllocationData = [&arena](MeshBufferArena::Handle handle)
+    {
+        std::vector<float> data(arena.getAllocation(handle).numVertices * arena.getVertexByteSize() / sizeof(float));
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = float(handle * 10000 + i);
+        }
+        return data;
+    };
+    const auto isAllocationIntact = [&arena, &makeAllocationData](MeshBufferArena::Handle handle)
+    {
+        std::vector<float> data(makeAllocationData(handle).size());
+        arena.download(handle, data.data());
+        return data == makeAllocationData(handle);
+    };
+
+    // Freed range leaves a hole, that the best fitting allocation takes
+    const auto a = arena.allocate(100);
+    const auto b = arena.allocate(50);
+    const auto c = arena.allocate(80);
+    for (const auto handle : { a, b, c }) {
+        arena.upload(handle, makeAllocationData(handle).data());
+    }
+    check(arena.getStats().numPages == 1, "allocations fitting one page have taken more pages");
+    arena.free(b);
+    check(arena.getStats().numFreeBlocks == 2 && arena.getStats().fragmentation > 0.0f, "freed range has not left a hole");
+    const auto d = arena.allocate(40);
+    arena.upload(d, makeAllocationData(d).data());
+    check(arena.getAllocation(d).firstVertex == 100, "allocation has not taken the best fitting free block");
+
+    // Allocation larger than a page gets a page of its own, compaction packs fragmented pages
+    arena.free(a);
+    const auto e = arena.allocate(ARENA_PAGE_VERTICES + 44);
+    arena.upload(e, makeAllocationData(e).data());
+    check(arena.getStats().numPages == 2, "oversized allocation has not got a page of its own");
+    const auto fragmentation = arena.getStats().fragmentation;
+    const auto numMoved = arena.compact();
+    const auto stats = arena.getStats();
+    check(numMoved == 2 && stats.numFreeBlocks == 1 && stats.fragmentation == 0.0f, "compaction has not packed the allocations");
+    check(isAllocationIntact(c) && isAllocationIntact(d) && isAllocationIntact(e), "allocation data have changed");
+    std::cout << "Mesh arena: " << stats.numAllocations << " allocations in " << stats.numPages << " pages, fragmentation "
+              << fragmentation << " -> " << stats.fragmentation << " after compaction moved " << numMoved << " allocations" << std::endl;
+    arena.deleteArena();
+
+    // Meshes render the same from arena as from their own VAO
+    const BenchmarkFramebuffer framebuffer(BENCHMARK_FRAMEBUFFER_SIZE);
+    const auto programId = createShaderProgram("benchmark", POSITION_VERTEX_SHADER, CONSTANT_FRAGMENT_SHADER);
+    if (programId == 0) {
+        return false;
+    }
+
+    ShaderReflection reflection;
+    reflection.reflect(programId);
+    glUseProgram(programId);
+
+    // Oblique projection shows side and top cover, so that cylinders with different number of slices look different
+    glm::mat4 viewProjection(0.8f);
+    viewProjection[2] = glm::vec4(0.4f, 0.4f, 0.5f, 0.0f);
+    viewProjection[3][3] = 1.0f;
+    reflection.getUniform<glm::mat4>(VIEW_PROJECTION_UNIFORM).set(viewProjection);
+    const auto renderImage = [](const Cylinder& cylinder)
+    {
+        std::vector<unsigned char> pixels(BENCHMARK_FRAMEBUFFER_SIZE * BENCHMARK_FRAMEBUFFER_SIZE * 4);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        cylinder.render();
+        glReadPixels(0, 0, BENCHMARK_FRAMEBUFFER_SIZE, BENCHMARK_FRAMEBUFFER_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        return pixels;
+    };
+
+    // Meshes of the arena layout share one page and its VAO, whatever storage they have been created with
+    std::vector<std::unique_ptr<Cylinder>> cylinders;
+    std::vector<std::vector<glm::vec3>> positions, normals;
+    std::vector<std::vector<unsigned char>> images;
+    const VertexStorage storages[] = { VertexStorage::Planar, VertexStorage::Interleaved, VertexStorage::SplitPosition };
+    for (const auto storage : storages)
+    {
+        cylinders.push_back(std::make_unique<Cylinder>(0.5f, 8 + 4 * static_cast<int>(cylinders.size()), 1.0f, ArenaLayout(), storage));
+        std::vector<glm::vec2> textureCoordinates;
+        std::vector<GLuint> indices;
+        positions.emplace_back();
+        normals.emplace_back();
+        cylinders.back()->readGeometry(positions.back(), textureCoordinates, normals.back(), indices);
+        images.push_back(renderImage(*cylinders.back()));
+        check(std::count(images.back().begin(), images.back().end(), 255) > 0, "mesh has not been rendered");
+        check(cylinders.back()->moveToArena(arena), "mesh has not been moved to the arena");
+    }
+    check(cylinders[0]->getVertexArrayID() == cylinders[2]->getVertexArrayID(), "meshes in one page do not share its VAO");
+    Cylinder otherLayoutCylinder(0.5f, 8, 1.0f, VertexLayout<Normal, Position>());
+    check(!otherLayoutCylinder.moveToArena(arena), "mesh of another layout has been moved to the arena");
+
+    // Destroyed mesh frees its range, remaining meshes are moved by compaction and must still read back the same geometry
+    cylinders[1].reset();
+    arena.compact();
+    for (const auto i : { 0, 2 })
+    {
+        std::vector<glm::vec3> arenaPositions, arenaNormals;
+        std::vector<glm::vec2> textureCoordinates;
+        std::vector<GLuint> indices;
+        cylinders[i]->readGeometry(arenaPositions, textureCoordinates, arenaNormals, indices);
+        check(arenaPositions == positions[i] && arenaNormals == normals[i], "mesh geometry has changed in the arena");
+        check(renderImage(*cylinders[i]) == images[i], "mesh renders differently from the arena");
+    }
+    std::cout << "Cylinders with " << cylinders.size() << " vertex storages share arena page: " << (isValid ? "match" : "MISMATCH") << std::endl;
+
+    cylinders.clear();
+    arena.deleteArena();
+    glUseProgram(0);
+    glDeleteProgram(programId);
+    return checkErrors("Mesh arena validation") && isValid;
+}
+
+bool validateMeshCache()
+{
+    using namespace vertex_attributes;
+    MeshCache cache;
+    auto isValid = true;
+    const auto check = [&isValid](bool condition, const char* failure)
+    {
+        if (!condition)
+        {
+            std::cerr << "Mesh cache validation failed - " << failure << "!" << std::endl;
+            isValid = false;
+        }
+    };
+
+    // Spellings of the same mesh share it
+    const auto can = cache.get<SegmentedCylinder>(CAN_RADIUS, CAN_HEIGHT, 36);
+    check(cache.get<SegmentedCylinder>(double(CAN_RADIUS), double(CAN_HEIGHT), 36) == can, "double arguments have built another mesh");
+    check(cache.get<SegmentedCylinder>(CAN_RADIUS, CAN_HEIGHT, 36, 1, 1, DefaultVertexLayout(), VertexStorage::Planar) == can,
+        "spelled out default arguments have built another mesh");
+    const auto cylinder = cache.get<Cylinder>(CAN_RADIUS, 36, CAN_HEIGHT, VertexLayout<Position, Normal>());
+    check(cache.get<Cylinder>(double(CAN_RADIUS), short(36), CAN_HEIGHT, VertexLayout<Position, Normal>(), VertexStorage::Planar) == cylinder,
+        "cylinder with converted arguments has built another mesh");
+
+    // Meshes, that differ in layout, storage or LODs, don't
+    check(cache.get<SegmentedCylinder>(CAN_RADIUS, CAN_HEIGHT, 36, 1, 1, VertexLayout<Position, Normal>()) != can, "other layout has shared the mesh");
+    check(cache.get<SegmentedCylinder>(CAN_RADIUS, CAN_HEIGHT, 36, 1, 1, DefaultVertexLayout(), VertexStorage::Interleaved) != can,
+        "other storage has shared the mesh");
+    check(cache.get<SegmentedCylinder>(CAN_RADIUS, CAN_HEIGHT, 36, 1, CAN_LOD) != can, "other number of LODs has shared the mesh");
+
+    const auto stats = cache.getStats();
+    check(stats.numHits == 3 && stats.numMisses == 5, "hits and misses are not as expected");
+    std::cout << "Mesh cache: " << stats.numHits << " hits, " << stats.numMisses << " misses, " << stats.bytesSaved << " bytes saved" << std::endl;
+    return checkErrors("Mesh cache validation") && isValid;
+}
+
+bool validateMeshFile()
+{
+    auto isValid = true;
+    const auto check = [&isValid](bool condition, const char* failure)
+    {
+        if (!condition)
+        {
+            std::cerr << "Mesh file validation failed - " << failure << "!" << std::endl;
+            isValid = false;
+        }
+    };
+
+    std::error_code directoryError;
+    const auto directory = std::filesystem::temp_directory_path(directoryError) / "meshFileValidation";
+    std::filesystem::create_directories(directory, directoryError);
+    if (directoryError)
+    {
+        std::cerr << "Mesh file validation failed - could not create directory " << directory.string() << "!" << std::endl;
+        return false;
+    }
+
+    // One triangle with one index range
+    const uint64_t keyHash = 42;
+    const float vertices[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+    const uint32_t indices[] = { 0, 1, 2 };
+    const MeshFileRange range = { 0, 3, 0.5f, 0 };
+    MeshFileHeader header = {};
+    header.attributeFlags = MESH_FILE_POSITIONS;
+    header.numVertices = 3;
+    header.vertexByteSize = 3 * sizeof(float);
+    header.numIndices = 3;
+    header.indexByteSize = sizeof(uint32_t);
+    header.numIndexRanges = 1;
+    header.keyHash = keyHash;
+
+    const auto fileName = (directory / "triangle.mesh").string();
+    check(MeshFile::save(fileName, header, &range, vertices, indices), "file has not been saved");
+    {
+        MeshFile meshFile;
+        check(meshFile.open(fileName, keyHash), "saved file has not been opened");
+        check(meshFile.getHeader().fileSize == std::filesystem::file_size(fileName) && meshFile.getHeader().version == MESH_FILE_VERSION,
+            "header does not describe the file");
+        check(memcmp(meshFile.getVertexData(), vertices, sizeof(vertices)) == 0 && memcmp(meshFile.getIndexData(), indices, sizeof(indices)) == 0
+            && memcmp(meshFile.getIndexRanges(), &range, sizeof(range)) == 0, "file contents differ from saved mesh");
+
+        MeshFile otherKeyFile;
+        check(!otherKeyFile.open(fileName, keyHash + 1), "file of other key has been opened");
+    }
+
+    // Damaged copies of the file, each is rewritten from saved contents
+    std::vector<char> contents(std::filesystem::file_size(fileName));
+    std::ifstream(fileName, std::ios::binary).read(contents.data(), contents.size());
+    const auto opensDamaged = [&fileName, &contents, keyHash](const std::function<void(std::vector<char>&)>& damage)
+    {
+        auto damagedContents = contents;
+        damage(damagedContents);
+        std::ofstream(fileName, std::ios::binary | std::ios::trunc).write(damagedContents.data(), damagedContents.size());
+        MeshFile meshFile;
+        return meshFile.open(fileName, keyHash);
+    };
+
+    std::cout << "Mesh file: " << contents.size() << " bytes, damaged copies below are expected to be rejected" << std::endl;
+    check(!opensDamaged([](std::vector<char>& data) { data.resize(data.size() - MESH_FILE_ALIGNMENT); }), "truncated file has been opened");
+    check(!opensDamaged([](std::vector<char>& data) { data[offsetof(MeshFileHeader, version)] ^= 1; }), "file of other version has been opened");
+    check(!opensDamaged([](std::vector<char>& data) { data[offsetof(MeshFileHeader, numVertices)] ^= 1; }), "file with damaged header has been opened");
+    check(!opensDamaged([](std::vector<char>& data) { data[sizeof(MeshFileHeader) + offsetof(MeshFileRange, error)] ^= 1; }),
+        "file with damaged index range has been opened");
+
+    std::filesystem::remove_all(directory, directoryError);
+    return checkErrors("Mesh file validation") && isValid;
+}
+
+bool validateMeshlets()
+{
+    using namespace vertex_attributes;
+    auto isValid = true;
+    const auto check = [&isValid](bool condition, const char* failure)
+    {
+        if (!condition)
+        {
+            std::cerr << "Meshlet validation failed - " << failure << "!" << std::endl;
+            isValid = false;
+        }
+    };
+
+    Sphere sphere(1.0f, MESHLET_SPHERE_SLICES, MESHLET_SPHERE_SLICES / 2, 1, VertexLayout<Position, Normal>());
+    check(sphere.buildMeshlets(), "meshlets have not been built");
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> textureCoordinates;
+    std::vector<GLuint> indices;
+    sphere.readGeometry(positions, textureCoordinates, normals, indices);
+    const auto& meshletSet = sphere.getMeshlets();
+    const auto& meshlets = meshletSet.getMeshlets();
+
+    // Meshlets follow each other in the index buffer, vertices of their triangles lie within their bounding spheres
+    GLuint nextIndex = 0;
+    auto isPartitioned = !meshlets.empty(), isBounded = true;
+    for (const auto& meshlet : meshlets)
+    {
+        isPartitioned = isPartitioned && meshlet.firstIndex == nextIndex && meshlet.numTriangles > 0
+            && meshlet.numTriangles <= MESHLET_MAX_TRIANGLES && meshlet.numVertices <= MESHLET_MAX_VERTICES;
+        nextIndex += meshlet.numTriangles * 3;
+
+        const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+        for (auto i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.numTriangles * 3 && i < indices.size(); i++) {
+            isBounded = isBounded && glm::length(positions[indices[i]] - center) <= meshlet.radius * 1.0001f + 1e-5f;
+        }
+    }
+    check(isPartitioned && nextIndex == indices.size(), "meshlets do not split the index buffer within limits");
+    check(isBounded, "bounding sphere of a meshlet does not contain its vertices");
+
+    // Camera on Z axis looking towards -Z with 45 degrees perspective, composed by hand (view only translates)
+    const auto getViewProjection = [](float cameraZ)
+    {
+        const auto nearPlane = 0.1f, farPlane = 100.0f;
+        const auto focalLength = 1.0f / std::tan(glm::radians(45.0f) * 0.5f);
+        glm::mat4 viewProjection(0.0f);
+        viewProjection[0][0] = focalLength;
+        viewProjection[1][1] = focalLength;
+        viewProjection[2][2] = (farPlane + nearPlane) / (nearPlane - farPlane);
+        viewProjection[2][3] = -1.0f;
+        viewProjection[3][2] = -cameraZ * viewProjection[2][2] + 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+        viewProjection[3][3] = cameraZ;
+        return viewProjection;
+    };
+
+    // Every triangle facing the camera must be drawn by some visible meshlet
+    const glm::vec3 frontCamera(0.0f, 0.0f, MESHLET_CAMERA_DISTANCE);
+    std::vector<MeshletSet::DrawRange> visibleRanges;
+    const auto numFrontMeshlets = meshletSet.cull(getViewProjection(frontCamera.z), frontCamera, visibleRanges);
+    auto isConservative = true;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const auto& p0 = positions[indices[i]];
+        const auto normal = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+        if (glm::dot(normal, frontCamera - p0) <= 0.0f) {
+            continue;
+        }
+
+        const auto isInRange = std::any_of(visibleRanges.begin(), visibleRanges.end(), [i](const MeshletSet::DrawRange& range) {
+            return static_cast<int>(i) >= range.firstIndex && static_cast<int>(i) < range.firstIndex + range.numIndices; });
+        isConservative = isConservative && isInRange;
+    }
+    const auto numMeshlets = meshletSet.getNumMeshlets();
+    check(isConservative, "meshlet with a front-facing triangle has been culled");
+    check(numFrontMeshlets > 0 && numFrontMeshlets < numMeshlets * 3 / 4, "back-facing meshlets have not been culled");
+
+    const glm::vec3 awayCamera(0.0f, 0.0f, -MESHLET_CAMERA_DISTANCE);
+    const auto numAwayMeshlets = meshletSet.cull(getViewProjection(awayCamera.z), awayCamera, visibleRanges);
+    check(numAwayMeshlets == 0, "meshlets behind the camera have not been culled");
+
+    // Visible meshlets render the same image as the whole sphere, range draw after them is not disturbed by them
+    const BenchmarkFramebuffer framebuffer(BENCHMARK_FRAMEBUFFER_SIZE);
+    const auto programId = createShaderProgram("benchmark", POSITION_VERTEX_SHADER, CONSTANT_FRAGMENT_SHADER);
+    if (programId == 0) {
+        return false;
+    }
+
+    ShaderReflection reflection;
+    reflection.reflect(programId);
+    glUseProgram(programId);
+    reflection.getUniform<glm::mat4>(VIEW_PROJECTION_UNIFORM).set(getViewProjection(frontCamera.z));
+    glEnable(GL_CULL_FACE);
+    const auto renderImage = [](const std::function<void()>& draw)
+    {
+        std::vector<unsigned char> pixels(BENCHMARK_FRAMEBUFFER_SIZE * BENCHMARK_FRAMEBUFFER_SIZE * 4);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        draw();
+        glReadPixels(0, 0, BENCHMARK_FRAMEBUFFER_SIZE, BENCHMARK_FRAMEBUFFER_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        return pixels;
+    };
+
+    const auto wholeImage = renderImage([&sphere]() { sphere.render(); });
+    auto numRenderedMeshlets = 0;
+    const auto meshletImage = renderImage([&]() { numRenderedMeshlets = sphere.renderVisibleMeshlets(getViewProjection(frontCamera.z), frontCamera); });
+    const auto rangeImage = renderImage([&]()
+    {
+        sphere.renderVisibleMeshlets(getViewProjection(awayCamera.z), awayCamera);
+        sphere.renderIndexRanges(1);
+    });
+    glDisable(GL_CULL_FACE);
+    check(std::count(wholeImage.begin(), wholeImage.end(), 255) > 0, "sphere has not been rendered");
+    check(numRenderedMeshlets == numFrontMeshlets, "other meshlets have been rendered than culled");
+    const auto areImagesMatching = meshletImage == wholeImage && rangeImage == wholeImage;
+    check(meshletImage == wholeImage, "visible meshlets do not render the whole sphere");
+    check(rangeImage == wholeImage, "range draw after meshlet draw does not render the whole sphere");
+
+    std::cout << "Meshlets: " << numMeshlets << " meshlets of " << indices.size() / 3 << " triangles, " << numFrontMeshlets
+              << " visible from the front, " << numAwayMeshlets << " looking away, rendered images "
+              << (areImagesMatching ? "match" : "MISMATCH") << std::endl;
+    glUseProgram(0);
+    glDeleteProgram(programId);
+    return checkErrors("Meshlet validation") && isValid;
+}
+
+bool validateQuantization()
+{
+    using namespace vertex_attributes;
+    auto isValid = true;
+    const auto check = [&isValid](bool condition, const char* failure)
+    {
+        if (!condition)
+        {
+            std::cerr << "Quantization validation failed - " << failure << "!" << std::endl;
+            isValid = false;
+        }
+    };
+
+    // Can of the can field with all attributes
+    SegmentedCylinder can(CAN_RADIUS, CAN_HEIGHT, 36, 1, 4, VertexLayout<Position, TextureCoordinate, Normal>());
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> textureCoordinates;
+    std::vector<GLuint> indices;
+    can.readGeometry(positions, textureCoordinates, normals, indices);
+    const auto indexByteSize = indices.size() * can.getIndexByteSize();
+    const auto floatByteSize = can.getGpuByteSize() - indexByteSize;
+    check(can.quantize() && can.isQuantized(), "mesh has not been quantized");
+    const auto quantizedByteSize = can.getGpuByteSize() - indexByteSize;
+    check(quantizedByteSize * 2 == floatByteSize, "quantized vertices do not take half of the float ones");
+
+    // Quantized vertices and indices are read back from buffers of the mesh VAO
+    GLint vertexBuffer = 0, indexBuffer = 0;
+    glBindVertexArray(can.getVertexArrayID());
+    glGetVertexAttribiv(Position::LOCATION, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vertexBuffer);
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &indexBuffer);
+    glBindVertexArray(0);
+    std::vector<QuantizedVertex> quantizedVertices(quantizedByteSize / sizeof(QuantizedVertex));
+    glGetNamedBufferSubData(vertexBuffer, 0, quantizedVertices.size() * sizeof(QuantizedVertex), quantizedVertices.data());
+    std::vector<unsigned char> indexData(indexByteSize);
+    glGetNamedBufferSubData(indexBuffer, 0, indexData.size(), indexData.data());
+
+    // Every index refers to a quantized vertex and its original one (read back vertices got numbers in order of first use)
+    const auto& parameters = can.getQuantizationParameters();
+    const auto fromSnorm16 = [](int16_t value) { return std::max(float(value) / 32767.0f, -1.0f); };
+    QuantizationError measuredError;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        GLuint quantizedIndex = 0;
+        if (can.getIndexType() == GL_UNSIGNED_SHORT) {
+            quantizedIndex = reinterpret_cast<const GLushort*>(indexData.data())[i];
+        }
+        else {
+            quantizedIndex = reinterpret_cast<const GLuint*>(indexData.data())[i];
+        }
+
+        const auto& vertex = quantizedVertices[quantizedIndex];
+        const auto position = parameters.positionBias + parameters.positionScale
+            * glm::vec3(fromSnorm16(vertex.position[0]), fromSnorm16(vertex.position[1]), fromSnorm16(vertex.position[2]));
+        const auto textureCoordinate = parameters.uvBias + parameters.uvScale
+            * glm::vec2(vertex.textureCoordinate[0] / 65535.0f, vertex.textureCoordinate[1] / 65535.0f);
+        const auto cosAngle = glm::clamp(glm::dot(decodeOctahedralNormal(vertex.normal), glm::normalize(normals[indices[i]])), -1.0f, 1.0f);
+        measuredError.maxPositionError = std::max(measuredError.maxPositionError, glm::length(position - positions[indices[i]]));
+        measuredError.maxTextureCoordinateError = std::max(measuredError.maxTextureCoordinateError,
+            glm::length(textureCoordinate - textureCoordinates[indices[i]]));
+        measuredError.maxNormalErrorDegrees = std::max(measuredError.maxNormalErrorDegrees, std::acos(cosAngle) * 180.0f / glm::pi<float>());
+    }
+
+    // Views of the mesh VAO (as GPU culler makes) read the quantized vertices too
+    const auto vertexArrayView = can.createVertexArrayView();
+    GLint viewPositionType = 0;
+    glBindVertexArray(vertexArrayView);
+    glGetVertexAttribiv(Position::LOCATION, GL_VERTEX_ATTRIB_ARRAY_TYPE, &viewPositionType);
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &vertexArrayView);
+    check(viewPositionType == GL_SHORT, "view of the mesh VAO does not read quantized positions");
+
+    const auto& reportedError = can.getQuantizationError();
+    check(parameters.octahedralNormals, "normals are not octahedral-encoded");
+    check(measuredError.maxPositionError <= glm::length(parameters.positionScale) / 32767.0f, "position error exceeds quantization step");
+    check(measuredError.maxTextureCoordinateError <= glm::length(parameters.uvScale) / 65535.0f, "texture coordinate error exceeds quantization step");
+    check(measuredError.maxNormalErrorDegrees <= MAX_QUANTIZED_NORMAL_ERROR_DEGREES, "normal error exceeds its limit");
+    check(measuredError.maxPositionError <= reportedError.maxPositionError + 1e-6f
+        && measuredError.maxTextureCoordinateError <= reportedError.maxTextureCoordinateError + 1e-6f
+        && measuredError.maxNormalErrorDegrees <= reportedError.maxNormalErrorDegrees + 1e-3f, "errors exceed the reported ones");
+
+    std::cout << "Quantization: can vertices " << floatByteSize << " -> " << quantizedByteSize << " bytes, max position error "
+              << measuredError.maxPositionError << ", texture coordinate error " << measuredError.maxTextureCoordinateError
+              << ", normal error " << measuredError.maxNormalErrorDegrees << " degrees (reported " << reportedError.maxPositionError << ", "
+              << reportedError.maxTextureCoordinateError << ", " << reportedError.maxNormalErrorDegrees << ")" << std::endl;
+    return checkErrors("Quantization validation") && isValid;
+}
+
+bool validateSimplification()
+{
+    using namespace vertex_attributes;
+    auto isValid = true;
+    const auto check = [&isValid](bool condition, const char* failure)
+    {
+        if (!condition)
+        {
+            std::cerr << "Simplification validation failed - " << failure << "!" << std::endl;
+            isValid = false;
+        }
+    };
+    const auto printLods = [](const char* name, const SimplifiedMesh& mesh)
+    {
+        std::cout << "  " << std::left << std::setw(12) << name << std::right << "LOD triangles:";
+        for (auto lod = 0; lod < mesh.getLodCount(); lod++) {
+            std::cout << " " << mesh.getLodTriangleCount(lod);
+        }
+        std::cout << std::endl;
+    };
+
+    // Smooth sphere simplifies down the whole chain
+    std::cout << "Simplified LOD chains:" << std::endl;
+    Sphere sphere(1.0f, SIMPLIFIED_SPHERE_SLICES, SIMPLIFIED_SPHERE_SLICES / 2, 1, VertexLayout<Position, Normal>());
+    const SimplifiedMesh simplifiedSphere(sphere, -1, ParametricMesh::MAX_LOD_COUNT, SIMPLIFIED_TRIANGLE_RATIO);
+    printLods("sphere:", simplifiedSphere);
+    check(simplifiedSphere.getLodCount() == ParametricMesh::MAX_LOD_COUNT, "sphere chain has ended early");
+    check(simplifiedSphere.getLodTriangleCount(0) == sphere.getLodTriangleCount(0), "first LOD is not the source mesh");
+    for (auto lod = 1; lod < simplifiedSphere.getLodCount(); lod++)
+    {
+        const auto maxTriangles = static_cast<int>(simplifiedSphere.getLodTriangleCount(lod - 1) * SIMPLIFIED_TRIANGLE_RATIO);
+        check(simplifiedSphere.getLodTriangleCount(lod) > 0 && simplifiedSphere.getLodTriangleCount(lod) <= maxTriangles,
+            "LOD has more triangles than requested");
+    }
+
+    // Flat shaded box soup welded as the xbox is keeps all its triangles
+    const auto boxSoup = makeBoxSoup(true);
+    typedef VertexLayout<Position, Normal, TextureCoordinate> SoupLayout;
+    WeldedMesh box(SoupLayout(), boxSoup.data(), boxSoup.size() * sizeof(float) / SoupLayout::STRIDE);
+    const SimplifiedMesh simplifiedBox(box, -1, ParametricMesh::MAX_LOD_COUNT, SIMPLIFIED_TRIANGLE_RATIO);
+    printLods("welded box:", simplifiedBox);
+    check(box.getWeldStats().numWeldedVertices == 24, "box corners have not been welded per face");
+
+    // Slightly shifted corners weld with tolerance, but not exactly
+    auto shiftedSoup = boxSoup;
+    for (size_t i = 0; i < shiftedSoup.size(); i += SoupLayout::STRIDE / sizeof(float)) {
+        shiftedSoup[i] += (i % 3) * 1e-5f;
+    }
+    std::vector<unsigned int> remap;
+    const auto shiftedSoupBytes = reinterpret_cast<const unsigned char*>(shiftedSoup.data());
+    const auto numShiftedVertices = shiftedSoup.size() * sizeof(float) / SoupLayout::STRIDE;
+    check(weldVertices(shiftedSoupBytes, numShiftedVertices, SoupLayout::STRIDE, 1e-3f, remap) == 24, "shifted corners have not been welded with tolerance");
+    check(weldVertices(shiftedSoupBytes, numShiftedVertices, SoupLayout::STRIDE, 0.0f, remap) > 24, "shifted corners have been welded exactly");
+    check(simplifiedBox.getLodCount() == 1 && simplifiedBox.getLodTriangleCount(0) == 12, "box with hard edges has been simplified");
+
+    return checkErrors("Simplification validation") && isValid;
+}
+
+bool validateNormals()
+{
+    using namespace vertex_attributes;
+    auto isValid = true;
+    const auto check = [&isValid](bool condition, const char* failure)
+    {
+        if (!condition)
+        {
+            std::cerr << "Normal validation failed - " << failure << "!" << std::endl;
+            isValid = false;
+        }
+    };
+
+    // Box with the same normal everywhere (as hand-typed xbox normals are) gets hard face normals, split at its edges
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> textureCoordinates;
+    std::vector<GLuint> indices;
+    const auto boxSoup = makeBoxSoup(false);
+    typedef VertexLayout<Position, Normal, TextureCoordinate> SoupLayout;
+    WeldedMesh box(SoupLayout(), boxSoup.data(), boxSoup.size() * sizeof(float) / SoupLayout::STRIDE);
+    check(box.generateNormals(), "box normals have not been generated");
+    box.readGeometry(positions, textureCoordinates, normals, indices);
+    auto hasFaceNormals = indices.size() == 36;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const auto& p0 = positions[indices[i]];
+        const auto faceNormal = glm::normalize(glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0));
+        for (auto corner = 0; corner < 3; corner++) {
+            hasFaceNormals = hasFaceNormals && glm::dot(normals[indices[i + corner]], faceNormal) >= MIN_NORMAL_COSINE;
+        }
+    }
+    std::cout << "Generated normals:" << std::endl;
+    std::cout << "  box:    " << positions.size() << " vertices" << std::endl;
+    check(positions.size() == 24, "box vertices have not been split at hard edges");
+    check(hasFaceNormals, "box corner does not have normal of its face");
+
+    // Smooth sphere gets radial normals and tangents along its slices (u), bitangents along its stacks (v goes from north pole down)
+    Sphere sphere(1.0f, SIMPLIFIED_SPHERE_SLICES, SIMPLIFIED_SPHERE_SLICES / 2);
+    check(sphere.generateNormals(), "sphere normals have not been generated");
+    sphere.readGeometry(positions, textureCoordinates, normals, indices);
+    std::vector<glm::vec4> tangents;
+    generateTangents(positions.data(), textureCoordinates.data(), normals.data(), positions.size(), indices.data(), indices.size(), tangents);
+
+    auto hasRadialNormals = true, hasOrthonormalTangents = true, hasSurfaceTangents = true;
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        const auto& normal = normals[i];
+        const auto tangent = glm::vec3(tangents[i]);
+        hasRadialNormals = hasRadialNormals && glm::dot(normal, glm::normalize(positions[i])) >= MIN_NORMAL_COSINE;
+        hasOrthonormalTangents = hasOrthonormalTangents && std::abs(glm::length(tangent) - 1.0f) < 1e-4f
+            && std::abs(glm::dot(tangent, normal)) < 1e-4f && std::abs(tangents[i].w) == 1.0f;
+
+        // Tangent frames are compared away from poles, where slices converge
+        const auto ringRadius = glm::length(glm::vec2(positions[i].x, positions[i].z));
+        if (ringRadius < 0.1f) {
+            continue;
+        }
+        const auto sliceDirection = glm::vec3(-positions[i].z, 0.0f, positions[i].x) / ringRadius;
+        const auto stackDirection = glm::normalize(glm::vec3(positions[i].x * positions[i].y, -ringRadius * ringRadius, positions[i].z * positions[i].y));
+        const auto bitangent = glm::cross(normal, tangent) * tangents[i].w;
+        hasSurfaceTangents = hasSurfaceTangents && glm::dot(tangent, sliceDirection) >= MIN_TANGENT_COSINE
+            && glm::dot(bitangent, stackDirection) >= MIN_TANGENT_COSINE;
+    }
+    std::cout << "  sphere: " << positions.size() << " vertices, " << tangents.size() << " tangents" << std::endl;
+    check(tangents.size() == positions.size(), "not every vertex has a tangent");
+    check(hasRadialNormals, "sphere normal is not radial");
+    check(hasOrthonormalTangents, "tangent is not a unit vector orthogonal to the normal");
+    check(hasSurfaceTangents, "tangent frame does not follow texture coordinates");
+
+    return checkErrors("Normal validation") && isValid;
+}
+
+bool benchmarkStreaming(int numFrames)
+{
+    using namespace vertex_attributes;
+    const BenchmarkFramebuffer framebuffer(BENCHMARK_FRAMEBUFFER_SIZE);
+    const auto programId = createShaderProgram("benchmark", POSITION_VERTEX_SHADER, CONSTANT_FRAGMENT_SHADER);
+    if (programId == 0) {
+        return false;
+    }
+
+    ShaderReflection reflection;
+    reflection.reflect(programId);
+    glUseProgram(programId);
+    reflection.getUniform<glm::mat4>(VIEW_PROJECTION_UNIFORM).set(glm::mat4(1.0f));
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glEnableVertexAttribArray(Position::LOCATION);
+    const auto frameSize = NUM_STREAMED_POINTS * sizeof(glm::vec3);
+
+    // Map / unmap path - whole buffer is mapped every frame, mapping waits until GPU has finished drawing previous frame from it
+    VertexBufferObject mappedVBO;
+    mappedVBO.createVBO();
+    mappedVBO.bindVBO();
+    mappedVBO.uploadDataToGPU(nullptr, frameSize, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(Position::LOCATION, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    const auto mappedStart = std::chrono::steady_clock::now();
+    for (auto frame = 0; frame < numFrames; frame++)
+    {
+        const auto points = static_cast<glm::vec3*>(mappedVBO.mapSubBufferToMemory(GL_MAP_WRITE_BIT, 0, frameSize));
+        if (points == nullptr) {
+            break;
+        }
+
+        writeStreamedPoints(points, frame);
+        mappedVBO.unmapBuffer();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(NUM_STREAMED_POINTS));
+        glFlush();
+    }
+    glFinish();
+    const auto mappedMilliseconds = millisecondsSince(mappedStart);
+
+    // Streaming path - every frame writes the next region of the ring, it waits only for the frame written numRegions frames ago
+    VertexBufferObject streamingVBO;
+    streamingVBO.createStreamingVBO(GL_ARRAY_BUFFER, frameSize);
+    const auto streamingStart = std::chrono::steady_clock::now();
+    for (auto frame = 0; frame < numFrames; frame++)
+    {
+        const auto points = static_cast<glm::vec3*>(streamingVBO.beginStreamingRegion());
+        if (points == nullptr) {
+            break;
+        }
+
+        writeStreamedPoints(points, frame);
+        glBindBuffer(GL_ARRAY_BUFFER, streamingVBO.getBufferID());
+        glVertexAttribPointer(Position::LOCATION, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(streamingVBO.getStreamingRegionOffset()));
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(NUM_STREAMED_POINTS));
+        streamingVBO.endStreamingRegion(frameSize);
+        glFlush();
+    }
+    glFinish();
+    const auto streamingMilliseconds = millisecondsSince(streamingStart);
+
+    std::cout << "Streaming " << frameSize / 1024 << " KB of vertices per frame, " << numFrames << " frames:" << std::endl;
+    printTransferStats("persistent ring:", streamingVBO.getTransferStats(), streamingMilliseconds);
+    printTransferStats("map / unmap:", mappedVBO.getTransferStats(), mappedMilliseconds);
+
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &vao);
+    glUseProgram(0);
+    glDeleteProgram(programId);
+    mappedVBO.deleteVBO();
+    streamingVBO.deleteVBO();
+    return checkErrors("Streaming benchmark");
+}
+
+bool benchmarkVertexFetch(int fieldSize, int numFrames)
+{
+    const BenchmarkFramebuffer framebuffer(BENCHMARK_FRAMEBUFFER_SIZE);
+    const auto fullProgramId = createShaderProgram("benchmark", FIELD_VERTEX_SHADER, COLOR_FRAGMENT_SHADER);
+    const auto positionProgramId = createShaderProgram("benchmark", FIELD_POSITION_VERTEX_SHADER, CONSTANT_FRAGMENT_SHADER);
+    if (fullProgramId == 0 || positionProgramId == 0)
+    {
+        glDeleteProgram(fullProgramId);
+        glDeleteProgram(positionProgramId);
+        return false;
+    }
+
+    const VertexStorage storages[] = { VertexStorage::Planar, VertexStorage::Interleaved, VertexStorage::SplitPosition };
+    const char* const storageNames[] = { "planar:", "interleaved:", "split position:" };
+    std::cout << "Vertex fetch of " << fieldSize * fieldSize << " cylinders with " << FETCHED_CYLINDER_SLICES << " slices, "
+              << numFrames << " frames (GPU time per frame):" << std::endl;
+    for (auto i = 0; i < 3; i++)
+    {
+        const Cylinder cylinder(0.5f, FETCHED_CYLINDER_SLICES, 1.0f, DefaultVertexLayout(), storages[i]);
+        const auto fullMilliseconds = measureFieldFrameTime(cylinder, fullProgramId, fieldSize, numFrames);
+        const auto positionMilliseconds = measureFieldFrameTime(cylinder, positionProgramId, fieldSize, numFrames);
+        std::cout << "  " << std::left << std::setw(16) << storageNames[i] << std::right << fullMilliseconds << " ms all attributes, "
+                  << positionMilliseconds << " ms positions only" << std::endl;
+    }
+
+    glUseProgram(0);
+    glDeleteProgram(fullProgramId);
+    glDeleteProgram(positionProgramId);
+    return checkErrors("Vertex fetch benchmark");
+}
+
+bool benchmarkCylinderSubmission(int numCylinders, int numFrames)
+{
+    using namespace vertex_attributes;
+    const BenchmarkFramebuffer framebuffer(BENCHMARK_FRAMEBUFFER_SIZE);
+    const auto programId = createShaderProgram("benchmark", OFFSET_VERTEX_SHADER, CONSTANT_FRAGMENT_SHADER);
+    if (programId == 0) {
+        return false;
+    }
+
+    ShaderReflection reflection;
+    reflection.reflect(programId);
+    glUseProgram(programId);
+    const auto fieldExtent = std::sqrt(static_cast<float>(numCylinders)) * BENCHMARK_CYLINDER_SPACING * 0.5f;
+    const auto view = glm::lookAt(glm::vec3(fieldExtent, fieldExtent, fieldExtent), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const auto projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 10.0f * fieldExtent);
+    reflection.getUniform<glm::mat4>(VIEW_PROJECTION_UNIFORM).set(projection * view);
+    const auto offset = reflection.getUniform<glm::vec3>(OFFSET_UNIFORM);
+
+    double legacySubmitMilliseconds, legacyTotalMilliseconds;
+    {
+        const LegacyCylinder legacyCylinder(0.5f, SUBMITTED_CYLINDER_SLICES, 1.0f);
+        measureSubmitTime(legacyCylinder, offset, numCylinders, numFrames, legacySubmitMilliseconds, legacyTotalMilliseconds);
+    }
+
+    double indexedSubmitMilliseconds, indexedTotalMilliseconds;
+    {
+        const Cylinder indexedCylinder(0.5f, SUBMITTED_CYLINDER_SLICES, 1.0f, VertexLayout<Position>());
+        measureSubmitTime(indexedCylinder, offset, numCylinders, numFrames, indexedSubmitMilliseconds, indexedTotalMilliseconds);
+    }
+
+    std::cout << "Submission of " << numCylinders << " cylinders with " << SUBMITTED_CYLINDER_SLICES << " slices, " << numFrames << " frames (per frame):" << std::endl;
+    std::cout << "  " << std::left << std::setw(23) << "strip + 2 fans:" << std::right << numCylinders * LegacyCylinder::NUM_DRAW_CALLS
+              << " draw calls, " << legacySubmitMilliseconds << " ms CPU submit, " << legacyTotalMilliseconds << " ms in total" << std::endl;
+    std::cout << "  " << std::left << std::setw(23) << "indexed triangle list:" << std::right << numCylinders
+              << " draw calls, " << indexedSubmitMilliseconds << " ms CPU submit, " << indexedTotalMilliseconds << " ms in total" << std::endl;
+
+    glUseProgram(0);
+    glDeleteProgram(programId);
+    return checkErrors("Cylinder submission benchmark");
+}
+
+bool isDiagnosticSwitch(const std::string& argument)
+{
+    return findDiagnostic(argument) != nullptr;
+}
+
+bool runDiagnostic(const std::string& diagnosticSwitch)
+{
+    const auto diagnostic = findDiagnostic(diagnosticSwitch);
+    if (diagnostic == nullptr)
+    {
+        std::cerr << "Unknown diagnostic " << diagnosticSwitch << "!" << std::endl;
+        return false;
+    }
+
+    return diagnostic->run();
+}
+
+} // namespace static_meshes_3D
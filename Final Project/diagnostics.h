@@ -0,0 +1,150 @@
+#pragma once
+
+// STL
+#include <string>
+
+namespace static_meshes_3D {
+
+/**
+ * Validates GPU frustum culling against its CPU reference (see GpuCuller::validate) on a field of cans, seen from
+ * cameras looking around the field. Needs just a current OpenGL 4.3 context, so it runs in a hidden window as well as
+ * in a headless (EGL surfaceless) context. VAO of the culled mesh must stay untouched by the culler. Result is reported to std::cout.
+ *
+ * @param fieldSize      Cans along one side of the square field
+ * @param numDirections  Number of validated views
+ *
+ * @return True, if GPU and CPU results match in all views, false otherwise.
+ */
+bool validateGpuCulling(int fieldSize, int numDirections = 16);
+
+/**
+ * Validates partial updates of VBO with kept in-memory copy (VertexBufferObject::updateRawData / flushDirtyRanges). Buffer
+ * filled by direct upload gets overlapping, adjacent and separate ranges patched, which are flushed with every dirty upload
+ * method and with orphaning, and read back from the GPU after every flush. Instance buffer built on the same dirty ranges
+ * is checked the same way after instances are changed, added and removed. Result is reported to std::cout.
+ *
+ * @return True, if GPU data match the in-memory copy after every flush and ranges were merged as expected, false otherwise.
+ */
+bool validateDirtyRanges();
+
+/**
+ * Validates shared buffer arena (MeshBufferArena) - best fit allocation, freeing, pages for oversized allocations and compaction,
+ * which must keep data of all allocations intact. Then cylinders created with different vertex storages are moved into
+ * one arena page, one of them is destroyed and the rest is compacted, and geometry read back from the arena is compared
+ * with the geometry they were created with. Result is reported to std::cout.
+ *
+ * @return True, if all checks have passed, false otherwise (failed checks are reported to std::cerr).
+ */
+bool validateMeshArena();
+
+/**
+ * Validates keys of the mesh cache (MeshCache) - the same mesh asked for with arguments of other types (double instead
+ * of float) or with default arguments spelled out must be served by the mesh built first, while different vertex layout,
+ * vertex storage or number of LODs must build a new one. Result is reported to std::cout.
+ *
+ * @return True, if the cache has built expected meshes only, false otherwise (failed checks are reported to std::cerr).
+ */
+bool validateMeshCache();
+
+/**
+ * Validates binary mesh files (MeshFile) - saved file must open with its blobs and index ranges intact, while file
+ * of other generator key or version, truncated file or file with damaged header or index ranges must be rejected.
+ * Files are written to a temporary directory. Result is reported to std::cout.
+ *
+ * @return True, if all checks have passed, false otherwise (failed checks are reported to std::cerr).
+ */
+bool validateMeshFile();
+
+/**
+ * Validates meshlets of a finely tessellated sphere (StaticMeshIndexed3D::buildMeshlets) - they must split its index
+ * buffer into consecutive pieces within vertex and triangle limits with bounding spheres containing their vertices.
+ * Culling from a camera looking at the sphere must keep every front-facing triangle while dropping back-facing meshlets,
+ * culling from a camera looking away must drop all of them. Sphere rendered with back-face culling from visible meshlets
+ * only (and by a range draw following the meshlet draw) must look the same as the whole sphere. Result is reported to std::cout.
+ *
+ * @return True, if all checks have passed, false otherwise (failed checks are reported to std::cerr).
+ */
+bool validateMeshlets();
+
+/**
+ * Validates vertex quantization (StaticMesh3D::quantize) of the can drawn by the can field - quantized vertices must take
+ * half of the float ones, and vertices read back from the GPU and decoded as the vertex shader does must stay within
+ * one quantization step of the original attributes, as well as within errors the mesh reports. View of the mesh VAO
+ * (see StaticMeshIndexed3D::createVertexArrayView) must read quantized vertices as well. Result is reported to std::cout.
+ *
+ * @return True, if all checks have passed, false otherwise (failed checks are reported to std::cerr).
+ */
+bool validateQuantization();
+
+/**
+ * Validates LOD chains made by quadric error simplification (SimplifiedMesh). Chain of a finely tessellated sphere must
+ * start with all its triangles and every next LOD must have at most the requested fraction of triangles of the previous one.
+ * Chain of a flat shaded box welded from triangle soup (as the xbox is) must end at the source, as its hard edges can't
+ * be collapsed. Box corners must weld per face, slightly shifted corners with tolerance only. Result is reported to std::cout.
+ *
+ * @return True, if all checks have passed, false otherwise (failed checks are reported to std::cerr).
+ */
+bool validateSimplification();
+
+/**
+ * Validates generated normals and tangent frames (meshNormals.h). Box with the same normal everywhere must get hard face normals,
+ * split at its edges, smooth sphere must get radial normals and tangent frames following its texture coordinates.
+ * Result is reported to std::cout.
+ *
+ * @return True, if all checks have passed, false otherwise (failed checks are reported to std::cerr).
+ */
+bool validateNormals();
+
+/**
+ * Compares streaming of per-frame vertex data through persistently mapped ring of regions (VertexBufferObject::createStreamingVBO)
+ * with mapping the whole buffer every frame (glMapBufferRange / glUnmapBuffer). Every frame rewrites the buffer and draws
+ * it as points, bytes per frame and time CPU spent stalled on GPU are reported to std::cout for both paths.
+ *
+ * @param numFrames  Number of measured frames
+ *
+ * @return True, if both paths have run without OpenGL errors, false otherwise.
+ */
+bool benchmarkStreaming(int numFrames = 200);
+
+/**
+ * Renders square field of high-slice-count cylinders (one instanced draw) with every vertex storage (see VertexStorage),
+ * once fetching all vertex attributes and once fetching positions only (as depth-only pass does). Time per frame is
+ * reported to std::cout for every storage, so that the storage can be chosen by measured vertex fetch throughput.
+ *
+ * @param fieldSize  Cylinders along one side of the square field
+ * @param numFrames  Number of measured frames of every storage and pass
+ *
+ * @return True, if all storages have rendered without OpenGL errors, false otherwise.
+ */
+bool benchmarkVertexFetch(int fieldSize = 32, int numFrames = 20);
+
+/**
+ * Compares submission of cylinders as they were rendered before (side strip and two cover fans, three glDrawArrays calls
+ * per cylinder) with indexed Cylinder (one glDrawElements call). Every cylinder is drawn with its own offset uniform, as
+ * scene objects are. Draw calls, CPU time spent submitting them and total time per frame are reported to std::cout for both paths.
+ *
+ * @param numCylinders  Number of cylinders drawn every frame
+ * @param numFrames     Number of measured frames of every path
+ *
+ * @return True, if both paths have run without OpenGL errors, false otherwise.
+ */
+bool benchmarkCylinderSubmission(int numCylinders = 10000, int numFrames = 10);
+
+/**
+ * Checks, if command line argument selects a diagnostic (see runDiagnostic).
+ */
+bool isDiagnosticSwitch(const std::string& argument);
+
+/**
+ * Runs diagnostic selected by command line switch - --validate-gpu-culling, --validate-dirty-ranges, --validate-mesh-arena,
+ * --validate-mesh-cache, --validate-mesh-file, --validate-meshlets, --validate-quantization, --validate-simplification,
+ * --validate-normals, --benchmark-streaming, --benchmark-vertex-fetch or --benchmark-cylinder-submission. Diagnostics need a current OpenGL 4.5
+ * context only, they render into their own framebuffer.
+ *
+ * @param diagnosticSwitch  Command line switch of the diagnostic
+ *
+ * @return True, if the diagnostic has passed, false otherwise (or if the switch is unknown).
+ */
+bool runDiagnostic(const std::string& diagnosticSwitch);
+
+} // namespace static_meshes_3D
@@ -0,0 +1,77 @@
+// STL
+#include <cstring>
+#include <iostream>
+
+// Project
+#include "frameUniforms.h"
+
+namespace static_meshes_3D {
+
+FrameUniformBuffer::~FrameUniformBuffer()
+{
+    deleteBuffer();
+}
+
+bool FrameUniformBuffer::create()
+{
+    if (_vbo.isStreaming()) {
+        return true;
+    }
+
+    // Regions and the light block are placed at multiples of streaming alignment, it has to satisfy the GL one
+    GLint offsetAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    const auto alignment = VertexBufferObject::STREAMING_REGION_ALIGNMENT;
+    if (offsetAlignment <= 0 || alignment % static_cast<size_t>(offsetAlignment) != 0)
+    {
+        std::cerr << "Uniform buffer offset alignment " << offsetAlignment << " is not supported by frame uniform buffer!" << std::endl;
+        return false;
+    }
+
+    _lightDataOffset = (sizeof(FrameUniforms) + alignment - 1) / alignment * alignment;
+    _vbo.createStreamingVBO(GL_UNIFORM_BUFFER, _lightDataOffset + sizeof(LightUniforms), NUM_REGIONS);
+    _isFrameWritten = false;
+    return _vbo.isStreaming();
+}
+
+void FrameUniformBuffer::update(const FrameUniforms& frame, const LightUniforms& lights)
+{
+    // Region of the previous frame is fenced, even if endFrame has been forgotten
+    endFrame();
+
+    auto region = static_cast<unsigned char*>(_vbo.beginStreamingRegion());
+    if (region == nullptr) {
+        return;
+    }
+
+    memcpy(region, &frame, sizeof(FrameUniforms));
+    memcpy(region + _lightDataOffset, &lights, sizeof(LightUniforms));
+    _isFrameWritten = true;
+
+    const auto regionOffset = static_cast<GLintptr>(_vbo.getStreamingRegionOffset());
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BINDING, _vbo.getBufferID(), regionOffset, sizeof(FrameUniforms));
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHT_BINDING, _vbo.getBufferID(), regionOffset + _lightDataOffset, sizeof(LightUniforms));
+}
+
+void FrameUniformBuffer::endFrame()
+{
+    if (!_isFrameWritten) {
+        return;
+    }
+
+    _vbo.endStreamingRegion(sizeof(FrameUniforms) + sizeof(LightUniforms));
+    _isFrameWritten = false;
+}
+
+const VertexBufferObject::TransferStats& FrameUniformBuffer::getTransferStats() const
+{
+    return _vbo.getTransferStats();
+}
+
+void FrameUniformBuffer::deleteBuffer()
+{
+    _vbo.deleteVBO();
+    _isFrameWritten = false;
+}
+
+} // namespace static_meshes_3D
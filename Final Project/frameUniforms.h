@@ -0,0 +1,113 @@
+#pragma once
+
+// STL
+#include <cstddef>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "vertexBufferObject.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Data shared by all draws of a frame, in std140 layout of the uniform block:
+ *
+ *     layout(std140) uniform FrameData { mat4 view; mat4 projection; mat4 viewProjection; vec3 viewPosition; };
+ */
+struct FrameUniforms
+{
+    glm::mat4 view = glm::mat4(1.0f); // View matrix
+    glm::mat4 projection = glm::mat4(1.0f); // Projection matrix
+    glm::mat4 viewProjection = glm::mat4(1.0f); // Projection matrix multiplied by view matrix
+    glm::vec3 viewPosition = glm::vec3(0.0f); // Camera position in world space
+    float padding = 0.0f; // Pads the block to multiple of 16 bytes, as std140 does
+};
+
+static_assert(offsetof(FrameUniforms, view) == 0, "FrameUniforms::view must match std140 offset of FrameData.view");
+static_assert(offsetof(FrameUniforms, projection) == 64, "FrameUniforms::projection must match std140 offset of FrameData.projection");
+static_assert(offsetof(FrameUniforms, viewProjection) == 128, "FrameUniforms::viewProjection must match std140 offset of FrameData.viewProjection");
+static_assert(offsetof(FrameUniforms, viewPosition) == 192, "FrameUniforms::viewPosition must match std140 offset of FrameData.viewPosition");
+static_assert(sizeof(FrameUniforms) == 208, "FrameUniforms must match std140 size of FrameData");
+
+/**
+ * Lights of a frame, in std140 layout of the uniform block (every vec3 takes 16 bytes):
+ *
+ *     layout(std140) uniform LightData { vec3 lightColor; vec3 fillLightColor; vec3 keyLightPos; vec3 fillLightPos; };
+ */
+struct LightUniforms
+{
+    glm::vec3 lightColor = glm::vec3(1.0f); // Color of the key light
+    float padding0 = 0.0f;
+    glm::vec3 fillLightColor = glm::vec3(1.0f); // Color of the fill light
+    float padding1 = 0.0f;
+    glm::vec3 keyLightPos = glm::vec3(0.0f); // Position of the key light in world space
+    float padding2 = 0.0f;
+    glm::vec3 fillLightPos = glm::vec3(0.0f); // Position of the fill light in world space
+    float padding3 = 0.0f;
+};
+
+static_assert(offsetof(LightUniforms, lightColor) == 0, "LightUniforms::lightColor must match std140 offset of LightData.lightColor");
+static_assert(offsetof(LightUniforms, fillLightColor) == 16, "LightUniforms::fillLightColor must match std140 offset of LightData.fillLightColor");
+static_assert(offsetof(LightUniforms, keyLightPos) == 32, "LightUniforms::keyLightPos must match std140 offset of LightData.keyLightPos");
+static_assert(offsetof(LightUniforms, fillLightPos) == 48, "LightUniforms::fillLightPos must match std140 offset of LightData.fillLightPos");
+static_assert(sizeof(LightUniforms) == 64, "LightUniforms must match std140 size of LightData");
+
+/**
+ * Frame and light uniform blocks shared by all programs, so that per-frame data are written once per frame instead of
+ * being looked up and uploaded as uniforms of every program. Both blocks are written into the region of the frame in
+ * a persistently mapped ring of uniform buffer regions (see VertexBufferObject::createStreamingVBO) and bound to their
+ * binding points by glBindBufferRange. Region is fenced after the draws of the frame, so CPU never overwrites data
+ * GPU may still read.
+ */
+class FrameUniformBuffer
+{
+public:
+    static const GLuint FRAME_BINDING = 0; // Uniform buffer binding of FrameData block (must match binding in shaders)
+    static const GLuint LIGHT_BINDING = 1; // Uniform buffer binding of LightData block (must match binding in shaders)
+    static const int NUM_REGIONS = 3; // Number of frames in the ring
+
+    ~FrameUniformBuffer();
+
+    /**
+     * Creates the ring of uniform buffer regions.
+     *
+     * @return True, if buffer has been created, false otherwise.
+     */
+    bool create();
+
+    /**
+     * Writes frame and light data into the next region of the ring and binds both blocks to their bindings.
+     * Waits only if GPU still reads the region (frame NUM_REGIONS back has not finished yet).
+     *
+     * @param frame   Frame data
+     * @param lights  Light data
+     */
+    void update(const FrameUniforms& frame, const LightUniforms& lights);
+
+    /**
+     * Fences the region of the frame, must be called after the last draw reading it.
+     */
+    void endFrame();
+
+    /**
+     * Gets statistics of writes and stalls of the ring.
+     */
+    const VertexBufferObject::TransferStats& getTransferStats() const;
+
+    /**
+     * Deletes the buffer.
+     */
+    void deleteBuffer();
+
+private:
+    VertexBufferObject _vbo; // Persistently mapped ring of frame regions
+    size_t _lightDataOffset = 0; // Offset of light data within a region (aligned for glBindBufferRange)
+    bool _isFrameWritten = false; // Flag telling, if region of the current frame has been written and not fenced yet
+};
+
+} // namespace static_meshes_3D
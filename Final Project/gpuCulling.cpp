@@ -0,0 +1,404 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <tuple>
+
+// Project
+#include "gpuCulling.h"
+#include "meshlets.h"
+#include "shaderProgram.h"
+#include "vertexLayout.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+// Compute shader appending commands of objects inside frustum (local size is prepended, as it depends on WORKGROUP_SIZE)
+const char* const CULLING_SHADER_SOURCE = R"(
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+struct CullObject
+{
+    vec4 boundingSphere;
+    DrawCommand command;
+};
+
+layout(std430, binding = 1) readonly buffer Objects
+{
+    CullObject objects[];
+};
+
+layout(std430, binding = 2) writeonly buffer Commands
+{
+    DrawCommand commands[];
+};
+
+layout(std430, binding = 3) buffer DrawCount
+{
+    uint drawCount;
+};
+
+uniform vec4 frustumPlanes[6];
+uniform uint numObjects;
+
+void main()
+{
+    uint objectIndex = gl_GlobalInvocationID.x;
+    if (objectIndex >= numObjects) {
+        return;
+    }
+
+    // Sphere is outside, if it's completely behind any of the frustum planes
+    vec4 sphere = objects[objectIndex].boundingSphere;
+    for (int p = 0; p < 6; p++)
+    {
+        if (dot(frustumPlanes[p].xyz, sphere.xyz) + frustumPlanes[p].w < -sphere.w) {
+            return;
+        }
+    }
+
+    commands[atomicAdd(drawCount, 1u)] = objects[objectIndex].command;
+}
+)";
+
+// Orders commands by all their fields, so that command lists can be compared as sets
+bool isCommandLess(const DrawElementsIndirectCommand& a, const DrawElementsIndirectCommand& b)
+{
+    return std::tie(a.baseInstance, a.firstIndex, a.count, a.baseVertex, a.instanceCount)
+        < std::tie(b.baseInstance, b.firstIndex, b.count, b.baseVertex, b.instanceCount);
+}
+
+} // namespace
+
+GpuCuller::GpuCuller(const StaticMeshIndexed3D* mesh)
+    : _mesh(mesh)
+{
+    static_assert(OBJECTS_BINDING == 1 && COMMANDS_BINDING == 2 && DRAW_COUNT_BINDING == 3, "CULLING_SHADER_SOURCE bindings do not match culler bindings");
+    static_assert(sizeof(CullObject) == 48, "CullObject must match std430 layout of the shader CullObject struct");
+}
+
+GpuCuller::~GpuCuller()
+{
+    deleteCuller();
+}
+
+int GpuCuller::addObject(int rangeIndex, const glm::vec4& boundingSphere, GLuint instanceIndex)
+{
+    if (_mesh == nullptr || rangeIndex < 0 || rangeIndex >= _mesh->getNumIndexRanges())
+    {
+        std::cerr << "Culled object must draw existing index range of the mesh!" << std::endl;
+        return -1;
+    }
+
+    const auto& range = _mesh->getIndexRange(rangeIndex);
+    CullObject object = {};
+    object.boundingSphere = boundingSphere;
+    object.command.count = static_cast<GLuint>(range.numIndices);
+    object.command.instanceCount = 1;
+    object.command.firstIndex = static_cast<GLuint>(range.firstIndex);
+    object.command.baseInstance = instanceIndex;
+    _objects.push_back(object);
+
+    _numInstanceIndices = std::max(_numInstanceIndices, instanceIndex + 1);
+    _areObjectsChanged = _isSetChanged = true;
+    return static_cast<int>(_objects.size()) - 1;
+}
+
+void GpuCuller::setObjectBounds(int object, const glm::vec4& boundingSphere)
+{
+    if (object < 0 || object >= getNumObjects()) {
+        return;
+    }
+
+    _objects[object].boundingSphere = boundingSphere;
+    _areObjectsChanged = true;
+}
+
+void GpuCuller::clear()
+{
+    _objects.clear();
+    _numInstanceIndices = 0;
+    _areObjectsChanged = _isSetChanged = true;
+}
+
+int GpuCuller::getNumObjects() const
+{
+    return static_cast<int>(_objects.size());
+}
+
+bool GpuCuller::cull(const glm::mat4& viewProjection)
+{
+    if (!initialize()) {
+        return false;
+    }
+
+    uploadObjects();
+    if (_objects.empty()) {
+        return true;
+    }
+
+    glm::vec4 frustumPlanes[6];
+    extractFrustumPlanes(viewProjection, frustumPlanes);
+    glUseProgram(_program);
+    glUniform4fv(_frustumPlanesLocation, 6, &frustumPlanes[0][0]);
+    glUniform1ui(_numObjectsLocation, static_cast<GLuint>(_objects.size()));
+
+    // Without GPU draw count all command slots are drawn, so the ones not written by this cull must be empty
+    const GLuint zero = 0;
+    _drawCountVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    if (!isDrawCountSupported())
+    {
+        _commandsVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECTS_BINDING, _objectsVBO.getBufferID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, _commandsVBO.getBufferID());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNT_BINDING, _drawCountVBO.getBufferID());
+    glDispatchCompute(static_cast<GLuint>((_objects.size() + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+
+    // Commands and draw count are read by the following indirect draw
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    return true;
+}
+
+void GpuCuller::render() const
+{
+    if (!_areBuffersCreated || _objects.empty()) {
+        return;
+    }
+
+    const auto isCountSupported = isDrawCountSupported();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandsVBO.getBufferID());
+    if (isCountSupported) {
+        glBindBuffer(GL_PARAMETER_BUFFER, _drawCountVBO.getBufferID());
+    }
+
+    _mesh->renderIndirect(static_cast<GLsizei>(_objects.size()), isCountSupported, _vao);
+}
+
+void GpuCuller::cullOnCpu(const glm::mat4& viewProjection, std::vector<DrawElementsIndirectCommand>& commands) const
+{
+    std::vector<bool> visible, borderline;
+    classifyObjects(viewProjection, 0.0f, visible, borderline);
+
+    commands.clear();
+    for (size_t i = 0; i < _objects.size(); i++)
+    {
+        if (visible[i]) {
+            commands.push_back(_objects[i].command);
+        }
+    }
+}
+
+void GpuCuller::readBackCommands(std::vector<DrawElementsIndirectCommand>& commands) const
+{
+    commands.clear();
+    if (!_areBuffersCreated || _objects.empty()) {
+        return;
+    }
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    GLuint drawCount = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _drawCountVBO.getBufferID());
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &drawCount);
+
+    commands.resize(std::min(static_cast<size_t>(drawCount), _objects.size()));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _commandsVBO.getBufferID());
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+}
+
+bool GpuCuller::validate(const glm::mat4& viewProjection, float tolerance)
+{
+    if (!cull(viewProjection)) {
+        return false;
+    }
+
+    std::vector<DrawElementsIndirectCommand> gpuCommands;
+    readBackCommands(gpuCommands);
+
+    // Commands of borderline objects may be on either side
+    std::vector<bool> visible, borderline;
+    classifyObjects(viewProjection, tolerance, visible, borderline);
+    std::vector<DrawElementsIndirectCommand> requiredCommands, optionalCommands;
+    for (size_t i = 0; i < _objects.size(); i++)
+    {
+        if (borderline[i]) {
+            optionalCommands.push_back(_objects[i].command);
+        }
+        else if (visible[i]) {
+            requiredCommands.push_back(_objects[i].command);
+        }
+    }
+
+    // GPU appends commands in any order, so all lists are compared sorted
+    std::sort(gpuCommands.begin(), gpuCommands.end(), isCommandLess);
+    std::sort(requiredCommands.begin(), requiredCommands.end(), isCommandLess);
+    std::sort(optionalCommands.begin(), optionalCommands.end(), isCommandLess);
+
+    std::vector<DrawElementsIndirectCommand> missingCommands, extraCommands, unexpectedCommands;
+    std::set_difference(requiredCommands.begin(), requiredCommands.end(), gpuCommands.begin(), gpuCommands.end(),
+        std::back_inserter(missingCommands), isCommandLess);
+    std::set_difference(gpuCommands.begin(), gpuCommands.end(), requiredCommands.begin(), requiredCommands.end(),
+        std::back_inserter(extraCommands), isCommandLess);
+    std::set_difference(extraCommands.begin(), extraCommands.end(), optionalCommands.begin(), optionalCommands.end(),
+        std::back_inserter(unexpectedCommands), isCommandLess);
+
+    if (!missingCommands.empty() || !unexpectedCommands.empty())
+    {
+        std::cerr << "GPU culling differs from CPU reference! " << missingCommands.size() << " visible objects missing, "
+                  << unexpectedCommands.size() << " culled objects drawn (" << gpuCommands.size() << " GPU draws, "
+                  << requiredCommands.size() << " CPU draws, " << optionalCommands.size() << " borderline objects)!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool GpuCuller::isDrawCountSupported() const
+{
+    return GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters;
+}
+
+void GpuCuller::deleteCuller()
+{
+    if (_program != 0)
+    {
+        glDeleteProgram(_program);
+        _program = 0;
+    }
+
+    if (_areBuffersCreated)
+    {
+        _objectsVBO.deleteVBO();
+        _commandsVBO.deleteVBO();
+        _drawCountVBO.deleteVBO();
+        _instanceIndicesVBO.deleteVBO();
+        _areBuffersCreated = false;
+    }
+
+    if (_vao != 0)
+    {
+        glDeleteVertexArrays(1, &_vao);
+        _vao = 0;
+    }
+
+    _areObjectsChanged = _isSetChanged = true;
+}
+
+bool GpuCuller::initialize()
+{
+    if (_hasProgramFailed) {
+        return false;
+    }
+
+    if (_program == 0)
+    {
+        const auto source = "#version 430 core\nlayout(local_size_x = " + std::to_string(WORKGROUP_SIZE) + ") in;\n" + CULLING_SHADER_SOURCE;
+        const ShaderStage stage = { GL_COMPUTE_SHADER, source.c_str() };
+        _program = createShaderProgram("culling compute", &stage, 1);
+        if (_program == 0)
+        {
+            _hasProgramFailed = true;
+            return false;
+        }
+
+        _frustumPlanesLocation = glGetUniformLocation(_program, "frustumPlanes");
+        _numObjectsLocation = glGetUniformLocation(_program, "numObjects");
+    }
+
+    if (!_areBuffersCreated)
+    {
+        _objectsVBO.createVBO();
+        _commandsVBO.createVBO();
+        _drawCountVBO.createVBO();
+        _instanceIndicesVBO.createVBO();
+        _areBuffersCreated = true;
+        _areObjectsChanged = _isSetChanged = true;
+    }
+
+    return true;
+}
+
+void GpuCuller::uploadObjects()
+{
+    if (!_areObjectsChanged || _objects.empty()) {
+        return;
+    }
+
+    const auto objectsSize = _objects.size() * sizeof(CullObject);
+    _objectsVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+    if (!_isSetChanged)
+    {
+        // Only bounds moved, buffers keep their sizes
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, objectsSize, _objects.data());
+        _areObjectsChanged = false;
+        return;
+    }
+
+    _objectsVBO.uploadDataToGPU(_objects.data(), objectsSize, GL_DYNAMIC_DRAW);
+    _commandsVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+    _commandsVBO.uploadDataToGPU(nullptr, _objects.size() * sizeof(DrawElementsIndirectCommand), GL_DYNAMIC_COPY);
+    const GLuint zero = 0;
+    _drawCountVBO.bindVBO(GL_SHADER_STORAGE_BUFFER);
+    _drawCountVBO.uploadDataToGPU(&zero, sizeof(zero), GL_DYNAMIC_COPY);
+
+    // Identity buffer - base instance of a command selects instance index equal to it
+    std::vector<GLuint> instanceIndices(_numInstanceIndices);
+    std::iota(instanceIndices.begin(), instanceIndices.end(), 0u);
+    // Mesh may be shared (e.g. from MeshCache), so the attribute goes to culler's own view of its VAO
+    if (_vao != 0) {
+        glDeleteVertexArrays(1, &_vao);
+    }
+
+    _vao = _mesh->createVertexArrayView();
+    glBindVertexArray(_vao);
+    _instanceIndicesVBO.bindVBO(GL_ARRAY_BUFFER);
+    _instanceIndicesVBO.uploadDataToGPU(instanceIndices.data(), instanceIndices.size() * sizeof(GLuint), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(vertex_attributes::InstanceIndex::LOCATION);
+    glVertexAttribIPointer(vertex_attributes::InstanceIndex::LOCATION, vertex_attributes::InstanceIndex::NUM_COMPONENTS, GL_UNSIGNED_INT, 0, nullptr);
+    glVertexAttribDivisor(vertex_attributes::InstanceIndex::LOCATION, 1);
+    glBindVertexArray(0);
+
+    _areObjectsChanged = _isSetChanged = false;
+}
+
+void GpuCuller::classifyObjects(const glm::mat4& viewProjection, float tolerance, std::vector<bool>& visible, std::vector<bool>& borderline) const
+{
+    glm::vec4 frustumPlanes[6];
+    extractFrustumPlanes(viewProjection, frustumPlanes);
+
+    visible.assign(_objects.size(), false);
+    borderline.assign(_objects.size(), false);
+    for (size_t i = 0; i < _objects.size(); i++)
+    {
+        // The same test as in the compute shader, the smallest margin tells how close the sphere is to being culled
+        const auto& sphere = _objects[i].boundingSphere;
+        auto isVisible = true;
+        auto minMargin = std::numeric_limits<float>::max();
+        for (const auto& plane : frustumPlanes)
+        {
+            const auto distance = glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w;
+            isVisible = isVisible && !(distance < -sphere.w);
+            minMargin = std::min(minMargin, distance + sphere.w);
+        }
+
+        visible[i] = isVisible;
+        borderline[i] = std::abs(minMargin) <= tolerance;
+    }
+}
+
+} // namespace static_meshes_3D
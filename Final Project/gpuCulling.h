@@ -0,0 +1,187 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "staticMeshIndexed3D.h"
+#include "vertexBufferObject.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Draw arguments of one indexed indirect draw, in the layout expected by glMultiDrawElementsIndirect.
+ */
+struct DrawElementsIndirectCommand
+{
+    GLuint count; // Number of indices
+    GLuint instanceCount; // Number of instances
+    GLuint firstIndex; // First index in the index buffer
+    GLint baseVertex; // Value added to every index
+    GLuint baseInstance; // First instance (selects instance data through per-instance attribute)
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 5 * sizeof(GLuint), "DrawElementsIndirectCommand must be tightly packed");
+
+/**
+ * Culls objects (index ranges of one mesh with world-space bounding spheres) against the view frustum on the GPU and renders
+ * survivors with one multi-draw indirect call, so that CPU neither tests visibility nor issues draws per object.
+ *
+ * Objects and their draw arguments live in a shader storage buffer (uploaded only when objects change). Compute shader tests
+ * bounding spheres against frustum planes and appends commands of visible objects to the command buffer, counting them
+ * in the draw count buffer. With GL 4.6 or ARB_indirect_parameters, glMultiDrawElementsIndirectCount reads the count
+ * from the GPU, otherwise command buffer is cleared first and glMultiDrawElementsIndirect runs all slots (empty ones draw nothing).
+ *
+ * Every command draws one instance with base instance set to the instance index of its object. InstanceIndex attribute
+ * (divisor 1, identity buffer attached to culler's own view of the mesh VAO, so that the mesh can be shared) turns it into index of instance data for the vertex shader,
+ * which works without ARB_shader_draw_parameters (e.g. on Mesa llvmpipe). CPU reference implementation of the same
+ * culling validates GPU results.
+ */
+class GpuCuller
+{
+public:
+    static const GLuint OBJECTS_BINDING = 1; // Shader storage binding of culled objects
+    static const GLuint COMMANDS_BINDING = 2; // Shader storage binding of output commands
+    static const GLuint DRAW_COUNT_BINDING = 3; // Shader storage binding of output draw count
+    static const int WORKGROUP_SIZE = 64; // Number of objects culled by one compute workgroup
+
+    /**
+     * @param mesh  Mesh, whose index ranges the objects draw (must have own VAO and outlive the culler)
+     */
+    explicit GpuCuller(const StaticMeshIndexed3D* mesh);
+    ~GpuCuller();
+
+    /**
+     * Adds object.
+     *
+     * @param rangeIndex      Index range of the mesh drawn by the object
+     * @param boundingSphere  World-space bounding sphere (center xyz, radius w)
+     * @param instanceIndex   Index of instance data of the object (e.g. in InstanceBuffer)
+     *
+     * @return Index of the object.
+     */
+    int addObject(int rangeIndex, const glm::vec4& boundingSphere, GLuint instanceIndex);
+
+    /**
+     * Changes bounding sphere of the object (e.g. after it has moved).
+     */
+    void setObjectBounds(int object, const glm::vec4& boundingSphere);
+
+    /**
+     * Removes all objects.
+     */
+    void clear();
+
+    /**
+     * Gets number of objects.
+     */
+    int getNumObjects() const;
+
+    /**
+     * Culls objects on the GPU - uploads changed objects, resets draw count and dispatches culling compute shader.
+     * Leaves culling program bound.
+     *
+     * @param viewProjection  View projection matrix
+     *
+     * @return True, if culling has been dispatched, false otherwise (e.g. compute shader could not be compiled).
+     */
+    bool cull(const glm::mat4& viewProjection);
+
+    /**
+     * Renders commands of objects, that survived the last cull, with one multi-draw indirect call. Shader program
+     * reading instance data through InstanceIndex attribute must be bound.
+     */
+    void render() const;
+
+    /**
+     * Culls objects on the CPU with the same test as the compute shader.
+     *
+     * @param viewProjection  View projection matrix
+     * @param commands        Output commands of visible objects, in object order
+     */
+    void cullOnCpu(const glm::mat4& viewProjection, std::vector<DrawElementsIndirectCommand>& commands) const;
+
+    /**
+     * Reads back commands written by the last cull (waits for the GPU).
+     *
+     * @param commands  Output commands of visible objects, in order of GPU appends
+     */
+    void readBackCommands(std::vector<DrawElementsIndirectCommand>& commands) const;
+
+    /**
+     * Culls objects on the GPU and on the CPU and compares the results as sets of commands. Objects, whose bounding sphere
+     * touches a frustum plane within tolerance, may be classified differently due to floating point differences.
+     *
+     * @param viewProjection  View projection matrix
+     * @param tolerance       Distance from frustum plane (in world units), within which results may differ
+     *
+     * @return True, if results match, false otherwise (differences are reported to std::cerr).
+     */
+    bool validate(const glm::mat4& viewProjection, float tolerance = 1e-4f);
+
+    /**
+     * Checks, if draw count is read from the GPU (glMultiDrawElementsIndirectCount is available).
+     */
+    bool isDrawCountSupported() const;
+
+    /**
+     * Deletes compute program and all buffers of the culler.
+     */
+    void deleteCuller();
+
+private:
+    /**
+     * Culled object in std430 layout of the compute shader CullObject struct.
+     */
+    struct CullObject
+    {
+        glm::vec4 boundingSphere; // World-space bounding sphere (center xyz, radius w)
+        DrawElementsIndirectCommand command; // Draw arguments of the object
+        GLuint padding[3]; // Pads the struct to multiple of 16 bytes, as std430 arrays of structs with vec4 do
+    };
+
+    const StaticMeshIndexed3D* _mesh; // Mesh drawn by the objects
+    std::vector<CullObject> _objects; // All objects
+    GLuint _numInstanceIndices = 0; // Size of instance index identity buffer (largest instance index + 1)
+    bool _areObjectsChanged = true; // Flag telling, if objects have to be uploaded again
+    bool _isSetChanged = true; // Flag telling, if number of objects or instance indices changed (buffers are resized)
+
+    GLuint _program = 0; // Culling compute program
+    bool _hasProgramFailed = false; // Flag telling, if compute shader failed to compile, so that it's not retried every frame
+    GLint _frustumPlanesLocation = -1; // Location of frustumPlanes uniform
+    GLint _numObjectsLocation = -1; // Location of numObjects uniform
+    bool _areBuffersCreated = false; // Flag telling, if GPU buffers have been created
+    VertexBufferObject _objectsVBO; // Culled objects
+    VertexBufferObject _commandsVBO; // Commands of visible objects
+    VertexBufferObject _drawCountVBO; // Number of visible objects
+    VertexBufferObject _instanceIndicesVBO; // Identity buffer of instance indices (InstanceIndex attribute)
+    GLuint _vao = 0; // View of the mesh VAO with InstanceIndex attribute (see StaticMeshIndexed3D::createVertexArrayView)
+
+    /**
+     * Compiles culling compute shader and creates buffers (if not done yet).
+     */
+    bool initialize();
+
+    /**
+     * Uploads objects (resizing buffers and attaching instance indices to culler's view of the mesh VAO, if number of objects changed).
+     */
+    void uploadObjects();
+
+    /**
+     * Tests bounding spheres against frustum planes.
+     *
+     * @param viewProjection  View projection matrix
+     * @param tolerance       Tolerance of borderline objects
+     * @param visible         Output visibility of every object
+     * @param borderline      Output flag of every object, telling, if its sphere touches a plane within tolerance
+     */
+    void classifyObjects(const glm::mat4& viewProjection, float tolerance, std::vector<bool>& visible, std::vector<bool>& borderline) const;
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,872 @@
+// STL
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "importedMesh.h"
+#include "meshProcessing.h"
+#include "mappedFile.h"
+#include "timing.h"
+#include "vertexLayout.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+// Marks missing texture coordinate / normal index of OBJ corner
+const int32_t NO_INDEX = std::numeric_limits<int32_t>::min();
+const uint32_t NO_ATTRIBUTE = std::numeric_limits<uint32_t>::max();
+
+// glTF constants
+const uint32_t GLB_MAGIC = 0x46546C67; // glTF
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // JSON
+const uint32_t GLB_CHUNK_BIN = 0x004E4942; // BIN
+const int GLTF_UNSIGNED_BYTE = 5121;
+const int GLTF_UNSIGNED_SHORT = 5123;
+const int GLTF_UNSIGNED_INT = 5125;
+const int GLTF_FLOAT = 5126;
+const int GLTF_TRIANGLES = 4;
+
+// Number of vertices / indices decoded by one glTF task
+const size_t GLTF_TASK_SIZE = 65536;
+
+bool hasExtension(const std::string& fileName, const char* extension)
+{
+    const auto length = strlen(extension);
+    if (fileName.size() < length) {
+        return false;
+    }
+
+    return std::equal(fileName.end() - length, fileName.end(), extension, [](char a, char b) { return tolower(a) == b; });
+}
+
+/******************************** OBJ ********************************/
+
+/**
+ * Index of position, texture coordinate or normal of one triangle corner - absolute (0-based) one, or one relative
+ * to the first element of the chunk (negative OBJ indices, may point before the chunk), NO_INDEX if missing.
+ */
+struct ObjIndex
+{
+    int32_t index;
+    bool isChunkRelative;
+};
+
+/**
+ * Indices of one triangle corner.
+ */
+struct ObjCorner
+{
+    ObjIndex position;
+    ObjIndex textureCoordinate;
+    ObjIndex normal;
+};
+
+/**
+ * Elements parsed from one chunk of OBJ text.
+ */
+struct ObjChunk
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> textureCoordinates;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners; // Triangle corners, three per triangle
+    bool isValid = true; // False, if chunk contains malformed line
+};
+
+const char* skipSpaces(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+
+    return p;
+}
+
+const char* nextLine(const char* p, const char* end)
+{
+    const auto lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+    return lineEnd != nullptr ? lineEnd + 1 : end;
+}
+
+bool parseFloat(const char*& p, const char* end, float& value)
+{
+    p = skipSpaces(p, end);
+    if (p < end && *p == '+') {
+        p++;
+    }
+
+    const auto result = std::from_chars(p, end, value);
+    p = result.ptr;
+    return result.ec == std::errc();
+}
+
+// Parses OBJ index (1-based, or negative relative to the elements parsed so far) and converts it (see ObjIndex)
+bool parseIndex(const char*& p, const char* end, size_t numChunkElements, ObjIndex& index)
+{
+    int32_t value = 0;
+    const auto result = std::from_chars(p, end, value);
+    p = result.ptr;
+    if (result.ec != std::errc() || value == 0) {
+        return false;
+    }
+
+    // Elements parsed by other threads are not known yet, so relative indices are resolved after all chunks are parsed
+    index.isChunkRelative = value < 0;
+    index.index = value > 0 ? value - 1 : static_cast<int32_t>(numChunkElements) + value;
+    return true;
+}
+
+// Parses one "v/vt/vn" face vertex
+bool parseCorner(const char*& p, const char* end, const ObjChunk& chunk, ObjCorner& corner)
+{
+    corner = ObjCorner{ { NO_INDEX, false }, { NO_INDEX, false }, { NO_INDEX, false } };
+    if (!parseIndex(p, end, chunk.positions.size(), corner.position)) {
+        return false;
+    }
+    if (p == end || *p != '/') {
+        return true;
+    }
+
+    p++;
+    if (p < end && *p != '/' && !parseIndex(p, end, chunk.textureCoordinates.size(), corner.textureCoordinate)) {
+        return false;
+    }
+    if (p == end || *p != '/') {
+        return true;
+    }
+
+    p++;
+    return parseIndex(p, end, chunk.normals.size(), corner.normal);
+}
+
+void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+{
+    std::vector<ObjCorner> polygon;
+    for (; p < end && chunk.isValid; p = nextLine(p, end))
+    {
+        p = skipSpaces(p, end);
+        if (end - p < 2) {
+            continue;
+        }
+
+        auto isValid = true;
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            glm::vec3 position;
+            p += 1;
+            isValid = parseFloat(p, end, position.x) && parseFloat(p, end, position.y) && parseFloat(p, end, position.z);
+            chunk.positions.push_back(position);
+        }
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            glm::vec2 textureCoordinate;
+            p += 2;
+            isValid = parseFloat(p, end, textureCoordinate.x) && parseFloat(p, end, textureCoordinate.y);
+            chunk.textureCoordinates.push_back(textureCoordinate);
+        }
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            glm::vec3 normal;
+            p += 2;
+            isValid = parseFloat(p, end, normal.x) && parseFloat(p, end, normal.y) && parseFloat(p, end, normal.z);
+            chunk.normals.push_back(normal);
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            // Polygon is triangulated as a fan around its first corner
+            polygon.clear();
+            p = skipSpaces(p + 1, end);
+            while (isValid && p < end && *p != '\n' && *p != '#')
+            {
+                ObjCorner corner;
+                isValid = parseCorner(p, end, chunk, corner);
+                polygon.push_back(corner);
+                p = skipSpaces(p, end);
+            }
+
+            isValid = isValid && polygon.size() >= 3;
+            for (size_t i = 2; isValid && i < polygon.size(); i++) {
+                chunk.corners.insert(chunk.corners.end(), { polygon[0], polygon[i - 1], polygon[i] });
+            }
+        }
+
+        chunk.isValid = isValid;
+    }
+}
+
+// Resolves encoded OBJ index to absolute one (NO_ATTRIBUTE if missing or out of range)
+uint32_t resolveIndex(const ObjIndex& index, size_t chunkOffset, size_t numElements)
+{
+    if (index.index == NO_INDEX) {
+        return NO_ATTRIBUTE;
+    }
+
+    const auto absoluteIndex = index.isChunkRelative ? static_cast<int64_t>(chunkOffset) + index.index : static_cast<int64_t>(index.index);
+    return absoluteIndex >= 0 && absoluteIndex < static_cast<int64_t>(numElements) ? static_cast<uint32_t>(absoluteIndex) : NO_ATTRIBUTE;
+}
+
+// Gets element with given absolute index from chunk arrays (offsets are prefix sums of chunk array sizes)
+template<typename T>
+const T& getChunkElement(const std::vector<ObjChunk>& chunks, const std::vector<size_t>& offsets, std::vector<T> ObjChunk::* elements, uint32_t index)
+{
+    const auto chunk = static_cast<size_t>(std::upper_bound(offsets.begin(), offsets.end(), size_t(index)) - offsets.begin()) - 1;
+    return (chunks[chunk].*elements)[index - offsets[chunk]];
+}
+
+/******************************** glTF ********************************/
+
+/**
+ * Parsed JSON value, with just as much of JSON as glTF needs (string escapes are kept undecoded).
+ */
+struct JsonValue
+{
+    enum class Type { Null, Boolean, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    double number = 0.0; // Value of number or boolean
+    std::string string; // Value of string
+    std::vector<JsonValue> elements; // Elements of array or member values of object
+    std::vector<std::string> names; // Member names of object
+
+    // Gets member of object, nullptr if missing
+    const JsonValue* find(const char* name) const
+    {
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (names[i] == name) {
+                return &elements[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Gets integer member of object, default value if missing
+    int getInt(const char* name, int defaultValue) const
+    {
+        const auto member = find(name);
+        return member != nullptr && member->type == Type::Number ? static_cast<int>(member->number) : defaultValue;
+    }
+};
+
+/**
+ * Recursive descent JSON parser.
+ */
+class JsonParser
+{
+public:
+    JsonParser(const char* text, size_t size)
+        : _p(text)
+        , _end(text + size) {}
+
+    bool parse(JsonValue& value)
+    {
+        return parseValue(value, 0) && skipWhitespace() == _end;
+    }
+
+private:
+    static const int MAX_DEPTH = 64; // Maximal nesting of arrays and objects
+
+    const char* _p; // Current position
+    const char* _end; // End of the text
+
+    const char* skipWhitespace()
+    {
+        while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n' || *_p == '\0')) {
+            _p++;
+        }
+
+        return _p;
+    }
+
+    bool consume(char c)
+    {
+        if (skipWhitespace() < _end && *_p == c)
+        {
+            _p++;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool parseString(std::string& string)
+    {
+        if (!consume('"')) {
+            return false;
+        }
+
+        const auto start = _p;
+        while (_p < _end && *_p != '"') {
+            _p += *_p == '\\' ? 2 : 1;
+        }
+        if (_p >= _end) {
+            return false;
+        }
+
+        string.assign(start, _p++);
+        return true;
+    }
+
+    bool parseLiteral(const char* literal)
+    {
+        const auto length = strlen(literal);
+        if (static_cast<size_t>(_end - _p) < length || memcmp(_p, literal, length) != 0) {
+            return false;
+        }
+
+        _p += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth)
+    {
+        if (depth > MAX_DEPTH || skipWhitespace() == _end) {
+            return false;
+        }
+
+        switch (*_p)
+        {
+        case '{':
+            value.type = JsonValue::Type::Object;
+            _p++;
+            if (consume('}')) {
+                return true;
+            }
+            do
+            {
+                value.names.emplace_back();
+                value.elements.emplace_back();
+                if (!parseString(value.names.back()) || !consume(':') || !parseValue(value.elements.back(), depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+
+        case '[':
+            value.type = JsonValue::Type::Array;
+            _p++;
+            if (consume(']')) {
+                return true;
+            }
+            do
+            {
+                value.elements.emplace_back();
+                if (!parseValue(value.elements.back(), depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+
+        case '"':
+            value.type = JsonValue::Type::String;
+            return parseString(value.string);
+
+        case 't':
+            value.type = JsonValue::Type::Boolean;
+            value.number = 1.0;
+            return parseLiteral("true");
+
+        case 'f':
+            value.type = JsonValue::Type::Boolean;
+            return parseLiteral("false");
+
+        case 'n':
+            return parseLiteral("null");
+
+        default:
+        {
+            value.type = JsonValue::Type::Number;
+            const auto result = std::from_chars(_p, _end, value.number);
+            _p = result.ptr;
+            return result.ec == std::errc();
+        }
+        }
+    }
+};
+
+/**
+ * Resolved glTF accessor - where its elements are in the binary chunk and how they are stored.
+ */
+struct GltfAccessor
+{
+    const unsigned char* data = nullptr; // First element
+    size_t count = 0; // Number of elements
+    size_t stride = 0; // Byte distance of elements
+    int componentType = 0; // Type of components (GLTF_FLOAT...)
+    int numComponents = 0; // Number of components of one element
+    bool isNormalized = false; // Flag telling, if integer components map to 0..1
+};
+
+/**
+ * Triangle primitive to import, with its place in the merged buffers.
+ */
+struct GltfPrimitive
+{
+    GltfAccessor positions;
+    GltfAccessor textureCoordinates; // count is 0, if missing
+    GltfAccessor normals; // count is 0, if missing
+    GltfAccessor indices; // count is 0, if primitive is not indexed
+    size_t firstVertex = 0; // First vertex of the primitive in the vertex buffer
+    size_t firstIndex = 0; // First index of the primitive in the index buffer
+    size_t numIndices = 0; // Number of indices of the primitive
+};
+
+/**
+ * Slice of one primitive decoded by one thread.
+ */
+struct GltfTask
+{
+    size_t primitive; // Index of the primitive
+    bool isIndexTask; // Flag telling, if the task decodes indices (vertices otherwise)
+    size_t first; // First vertex / index of the slice (relative to the primitive)
+    size_t count; // Number of vertices / indices of the slice
+};
+
+int getNumComponents(const std::string& type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+int getComponentSize(int componentType)
+{
+    switch (componentType)
+    {
+    case GLTF_UNSIGNED_BYTE: return 1;
+    case GLTF_UNSIGNED_SHORT: return 2;
+    case GLTF_UNSIGNED_INT:
+    case GLTF_FLOAT: return 4;
+    default: return 0;
+    }
+}
+
+// Resolves accessor with given index against buffer views and the binary chunk
+bool resolveAccessor(const JsonValue& root, int accessorIndex, const unsigned char* binary, size_t binarySize, GltfAccessor& accessor)
+{
+    const auto accessors = root.find("accessors");
+    const auto bufferViews = root.find("bufferViews");
+    if (accessors == nullptr || bufferViews == nullptr || accessorIndex < 0 || accessorIndex >= static_cast<int>(accessors->elements.size())) {
+        return false;
+    }
+
+    const auto& accessorJson = accessors->elements[accessorIndex];
+    const auto bufferViewIndex = accessorJson.getInt("bufferView", -1);
+    const auto type = accessorJson.find("type");
+    if (bufferViewIndex < 0 || bufferViewIndex >= static_cast<int>(bufferViews->elements.size()) || type == nullptr) {
+        return false;
+    }
+
+    const auto& bufferView = bufferViews->elements[bufferViewIndex];
+    if (bufferView.getInt("buffer", 0) != 0) {
+        return false;
+    }
+
+    accessor.componentType = accessorJson.getInt("componentType", 0);
+    accessor.numComponents = getNumComponents(type->string);
+    accessor.count = static_cast<size_t>(std::max(accessorJson.getInt("count", 0), 0));
+    const auto normalized = accessorJson.find("normalized");
+    accessor.isNormalized = normalized != nullptr && normalized->number != 0.0;
+
+    const auto elementSize = static_cast<size_t>(getComponentSize(accessor.componentType) * accessor.numComponents);
+    const auto byteStride = static_cast<size_t>(std::max(bufferView.getInt("byteStride", 0), 0));
+    accessor.stride = byteStride > 0 ? byteStride : elementSize;
+    const auto offset = static_cast<size_t>(std::max(bufferView.getInt("byteOffset", 0), 0)) + static_cast<size_t>(std::max(accessorJson.getInt("byteOffset", 0), 0));
+    const auto viewEnd = static_cast<size_t>(std::max(bufferView.getInt("byteOffset", 0), 0)) + static_cast<size_t>(std::max(bufferView.getInt("byteLength", 0), 0));
+    const auto accessorEnd = accessor.count > 0 ? offset + (accessor.count - 1) * accessor.stride + elementSize : offset;
+    if (elementSize == 0 || accessorEnd > viewEnd || viewEnd > binarySize) {
+        return false;
+    }
+
+    accessor.data = binary + offset;
+    return true;
+}
+
+// Reads component of accessor element as float (normalized integers map to 0..1)
+float readComponent(const GltfAccessor& accessor, size_t element, int component)
+{
+    const auto source = accessor.data + element * accessor.stride;
+    switch (accessor.componentType)
+    {
+    case GLTF_FLOAT:
+    {
+        float value;
+        memcpy(&value, source + component * sizeof(float), sizeof(value));
+        return value;
+    }
+    case GLTF_UNSIGNED_SHORT:
+    {
+        uint16_t value;
+        memcpy(&value, source + component * sizeof(value), sizeof(value));
+        return accessor.isNormalized ? value / 65535.0f : float(value);
+    }
+    case GLTF_UNSIGNED_BYTE:
+        return accessor.isNormalized ? source[component] / 255.0f : float(source[component]);
+    default:
+        return 0.0f;
+    }
+}
+
+uint32_t readIndex(const GltfAccessor& accessor, size_t element)
+{
+    const auto source = accessor.data + element * accessor.stride;
+    switch (accessor.componentType)
+    {
+    case GLTF_UNSIGNED_INT:
+    {
+        uint32_t value;
+        memcpy(&value, source, sizeof(value));
+        return value;
+    }
+    case GLTF_UNSIGNED_SHORT:
+    {
+        uint16_t value;
+        memcpy(&value, source, sizeof(value));
+        return value;
+    }
+    default:
+        return source[0];
+    }
+}
+
+} // namespace
+
+ImportedMesh::ImportedMesh(const std::string& fileName, VertexStorage vertexStorage)
+    : StaticMeshIndexed3D(Layout(), vertexStorage)
+{
+    const auto importStart = std::chrono::steady_clock::now();
+    MappedFile file;
+    if (!file.open(fileName))
+    {
+        std::cerr << "Could not open mesh file " << fileName << "!" << std::endl;
+        return;
+    }
+
+    _importStats.fileByteSize = file.getSize();
+    auto isImported = false;
+    if (hasExtension(fileName, ".obj")) {
+        isImported = importObj(reinterpret_cast<const char*>(file.getData()), file.getSize());
+    }
+    else if (hasExtension(fileName, ".glb")) {
+        isImported = importGlb(file.getData(), file.getSize());
+    }
+    else {
+        std::cerr << "Mesh file " << fileName << " is neither OBJ nor binary glTF!" << std::endl;
+    }
+
+    if (!isImported)
+    {
+        std::cerr << "Could not import mesh file " << fileName << "!" << std::endl;
+        _vbo.deleteVBO();
+        _indicesVBO.deleteVBO();
+        return;
+    }
+
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+    finalizeIndexedData(GL_STATIC_DRAW);
+    if (_importStats.normalsGenerated) {
+        generateNormals();
+    }
+
+    _importStats.numVertices = static_cast<size_t>(_numVertices);
+    _importStats.numTriangles = static_cast<size_t>(_numIndices) / 3;
+    _importStats.totalMilliseconds = millisecondsSince(importStart);
+    _importStats.parseMegabytesPerSecond = _importStats.parseMilliseconds > 0.0
+        ? _importStats.fileByteSize / (1024.0 * 1024.0) / (_importStats.parseMilliseconds / 1000.0) : 0.0;
+}
+
+bool ImportedMesh::isImported() const
+{
+    return _isInitialized;
+}
+
+const ImportStats& ImportedMesh::getImportStats() const
+{
+    return _importStats;
+}
+
+bool ImportedMesh::importObj(const char* text, size_t size)
+{
+    const auto parseStart = std::chrono::steady_clock::now();
+    const auto end = text + size;
+
+    // Split text into chunks ending at line ends, every thread parses one of them
+    const auto numThreads = getNumThreads(size, PARALLEL_IMPORT_MIN_BYTES);
+    std::vector<const char*> chunkStarts(numThreads + 1, end);
+    chunkStarts[0] = text;
+    for (size_t t = 1; t < numThreads; t++) {
+        chunkStarts[t] = nextLine(std::max(text + size * t / numThreads, chunkStarts[t - 1]), end);
+    }
+
+    std::vector<ObjChunk> chunks(numThreads);
+    runInThreads(numThreads, [&](size_t thread) {
+        parseObjChunk(chunkStarts[thread], chunkStarts[thread + 1], chunks[thread]);
+    });
+
+    // Absolute indices of the first element of every chunk
+    std::vector<size_t> positionOffsets(1, 0), textureCoordinateOffsets(1, 0), normalOffsets(1, 0), cornerOffsets(1, 0);
+    for (const auto& chunk : chunks)
+    {
+        if (!chunk.isValid)
+        {
+            std::cerr << "OBJ file contains malformed line!" << std::endl;
+            return false;
+        }
+
+        positionOffsets.push_back(positionOffsets.back() + chunk.positions.size());
+        textureCoordinateOffsets.push_back(textureCoordinateOffsets.back() + chunk.textureCoordinates.size());
+        normalOffsets.push_back(normalOffsets.back() + chunk.normals.size());
+        cornerOffsets.push_back(cornerOffsets.back() + chunk.corners.size());
+    }
+
+    const auto numCorners = cornerOffsets.back();
+    if (numCorners == 0)
+    {
+        std::cerr << "OBJ file contains no faces!" << std::endl;
+        return false;
+    }
+
+    // Resolve corners to triples of absolute indices
+    std::vector<uint32_t> cornerTriples(numCorners * 3);
+    std::atomic<bool> hasInvalidIndex(false), hasMissingNormal(false);
+    runInThreads(numThreads, [&](size_t thread) {
+        auto triple = cornerTriples.data() + cornerOffsets[thread] * 3;
+        for (const auto& corner : chunks[thread].corners)
+        {
+            *triple++ = resolveIndex(corner.position, positionOffsets[thread], positionOffsets.back());
+            *triple++ = resolveIndex(corner.textureCoordinate, textureCoordinateOffsets[thread], textureCoordinateOffsets.back());
+            *triple++ = resolveIndex(corner.normal, normalOffsets[thread], normalOffsets.back());
+            if (*(triple - 3) == NO_ATTRIBUTE) {
+                hasInvalidIndex = true;
+            }
+            if (*(triple - 1) == NO_ATTRIBUTE) {
+                hasMissingNormal = true;
+            }
+        }
+    });
+
+    if (hasInvalidIndex)
+    {
+        std::cerr << "OBJ file references vertex out of range!" << std::endl;
+        return false;
+    }
+
+    _importStats.numThreads = static_cast<int>(numThreads);
+    _importStats.parseMilliseconds = millisecondsSince(parseStart);
+    _importStats.normalsGenerated = hasMissingNormal;
+
+    // Equal triples are one vertex
+    std::vector<unsigned int> remap;
+    std::vector<size_t> firstCorners;
+    const auto numVertices = deduplicateKeys(cornerTriples.data(), numCorners, 3, remap, firstCorners);
+
+    // Write vertices straight to the in-memory buffer of the VBO, in mesh vertex storage
+    _numVertices = static_cast<int>(numVertices);
+    _numIndices = static_cast<int>(numCorners);
+    _vbo.createVBO();
+    const auto vertexData = static_cast<unsigned char*>(_vbo.appendRawData(numVertices * getVertexByteSize()));
+    const auto chunkSize = (numVertices + numThreads - 1) / numThreads;
+    runInThreads(numThreads, [&](size_t thread) {
+        const auto chunkEnd = std::min(numVertices, (thread + 1) * chunkSize);
+        for (auto vertex = thread * chunkSize; vertex < chunkEnd; vertex++)
+        {
+            const auto triple = cornerTriples.data() + firstCorners[vertex] * 3;
+            const auto textureCoordinate = triple[1] != NO_ATTRIBUTE ? getChunkElement(chunks, textureCoordinateOffsets, &ObjChunk::textureCoordinates, triple[1]) : glm::vec2(0.0f);
+            const auto normal = triple[2] != NO_ATTRIBUTE ? getChunkElement(chunks, normalOffsets, &ObjChunk::normals, triple[2]) : glm::vec3(0.0f);
+            Layout::writeAttribute<vertex_attributes::Position>(vertexData, _vertexStorage, numVertices, vertex, getChunkElement(chunks, positionOffsets, &ObjChunk::positions, triple[0]));
+            Layout::writeAttribute<vertex_attributes::TextureCoordinate>(vertexData, _vertexStorage, numVertices, vertex, textureCoordinate);
+            Layout::writeAttribute<vertex_attributes::Normal>(vertexData, _vertexStorage, numVertices, vertex, normal);
+        }
+    });
+
+    _indicesVBO.createVBO();
+    memcpy(_indicesVBO.appendRawData(sizeof(GLuint) * numCorners), remap.data(), sizeof(GLuint) * numCorners);
+    return true;
+}
+
+bool ImportedMesh::importGlb(const unsigned char* data, size_t size)
+{
+    const auto parseStart = std::chrono::steady_clock::now();
+
+    // Header (magic, version, length) is followed by JSON chunk and optional binary chunk, chunks are 4-byte aligned
+    uint32_t header[3];
+    if (size < sizeof(header) + 8) {
+        return false;
+    }
+
+    memcpy(header, data, sizeof(header));
+    if (header[0] != GLB_MAGIC || header[1] != 2 || header[2] > size)
+    {
+        std::cerr << "File is not binary glTF 2.0!" << std::endl;
+        return false;
+    }
+
+    const unsigned char* json = nullptr;
+    const unsigned char* binary = nullptr;
+    size_t jsonSize = 0, binarySize = 0;
+    for (size_t offset = sizeof(header); offset + 8 <= header[2];)
+    {
+        uint32_t chunkHeader[2];
+        memcpy(chunkHeader, data + offset, sizeof(chunkHeader));
+        offset += sizeof(chunkHeader);
+        if (offset + chunkHeader[0] > header[2]) {
+            return false;
+        }
+
+        if (chunkHeader[1] == GLB_CHUNK_JSON && json == nullptr)
+        {
+            json = data + offset;
+            jsonSize = chunkHeader[0];
+        }
+        else if (chunkHeader[1] == GLB_CHUNK_BIN && binary == nullptr)
+        {
+            binary = data + offset;
+            binarySize = chunkHeader[0];
+        }
+        offset += (chunkHeader[0] + 3) / 4 * 4;
+    }
+
+    JsonValue root;
+    if (json == nullptr || !JsonParser(reinterpret_cast<const char*>(json), jsonSize).parse(root))
+    {
+        std::cerr << "glTF JSON chunk is malformed!" << std::endl;
+        return false;
+    }
+
+    // Gather triangle primitives of all meshes, every one gets its own span of vertices and indices
+    std::vector<GltfPrimitive> primitives;
+    size_t numVertices = 0, numIndices = 0;
+    const auto meshes = root.find("meshes");
+    for (size_t m = 0; meshes != nullptr && m < meshes->elements.size(); m++)
+    {
+        const auto meshPrimitives = meshes->elements[m].find("primitives");
+        for (size_t p = 0; meshPrimitives != nullptr && p < meshPrimitives->elements.size(); p++)
+        {
+            const auto& primitiveJson = meshPrimitives->elements[p];
+            const auto attributes = primitiveJson.find("attributes");
+            if (primitiveJson.getInt("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES || attributes == nullptr) {
+                continue;
+            }
+
+            GltfPrimitive primitive;
+            const auto positionsIndex = attributes->getInt("POSITION", -1);
+            const auto textureCoordinatesIndex = attributes->getInt("TEXCOORD_0", -1);
+            const auto normalsIndex = attributes->getInt("NORMAL", -1);
+            const auto indicesIndex = primitiveJson.getInt("indices", -1);
+            auto isValid = resolveAccessor(root, positionsIndex, binary, binarySize, primitive.positions)
+                && primitive.positions.componentType == GLTF_FLOAT && primitive.positions.numComponents == 3;
+            if (textureCoordinatesIndex >= 0) {
+                isValid = isValid && resolveAccessor(root, textureCoordinatesIndex, binary, binarySize, primitive.textureCoordinates)
+                    && primitive.textureCoordinates.numComponents == 2 && primitive.textureCoordinates.count == primitive.positions.count;
+            }
+            if (normalsIndex >= 0) {
+                isValid = isValid && resolveAccessor(root, normalsIndex, binary, binarySize, primitive.normals)
+                    && primitive.normals.componentType == GLTF_FLOAT && primitive.normals.numComponents == 3 && primitive.normals.count == primitive.positions.count;
+            }
+            if (indicesIndex >= 0) {
+                isValid = isValid && resolveAccessor(root, indicesIndex, binary, binarySize, primitive.indices) && primitive.indices.numComponents == 1
+                    && primitive.indices.componentType != GLTF_FLOAT;
+            }
+            if (!isValid)
+            {
+                std::cerr << "glTF primitive " << p << " of mesh " << m << " has unsupported or broken accessors!" << std::endl;
+                return false;
+            }
+
+            _importStats.normalsGenerated = _importStats.normalsGenerated || normalsIndex < 0;
+            primitive.firstVertex = numVertices;
+            primitive.firstIndex = numIndices;
+            primitive.numIndices = (indicesIndex >= 0 ? primitive.indices.count : primitive.positions.count) / 3 * 3;
+            numVertices += primitive.positions.count;
+            numIndices += primitive.numIndices;
+            primitives.push_back(primitive);
+        }
+    }
+
+    if (numIndices == 0)
+    {
+        std::cerr << "glTF file contains no triangles!" << std::endl;
+        return false;
+    }
+
+    // Slice primitives into tasks, threads take them one by one
+    std::vector<GltfTask> tasks;
+    for (size_t p = 0; p < primitives.size(); p++)
+    {
+        for (size_t first = 0; first < primitives[p].positions.count; first += GLTF_TASK_SIZE) {
+            tasks.push_back({ p, false, first, std::min(GLTF_TASK_SIZE, primitives[p].positions.count - first) });
+        }
+        for (size_t first = 0; first < primitives[p].numIndices; first += GLTF_TASK_SIZE) {
+            tasks.push_back({ p, true, first, std::min(GLTF_TASK_SIZE, primitives[p].numIndices - first) });
+        }
+    }
+
+    _numVertices = static_cast<int>(numVertices);
+    _numIndices = static_cast<int>(numIndices);
+    _vbo.createVBO();
+    _indicesVBO.createVBO();
+    const auto vertexData = static_cast<unsigned char*>(_vbo.appendRawData(numVertices * getVertexByteSize()));
+    const auto indices = static_cast<GLuint*>(_indicesVBO.appendRawData(sizeof(GLuint) * numIndices));
+    std::atomic<size_t> nextTask(0);
+    std::atomic<bool> hasInvalidIndex(false);
+    const auto numThreads = std::min(getNumThreads(size, PARALLEL_IMPORT_MIN_BYTES), tasks.size());
+    runInThreads(numThreads, [&](size_t) {
+        for (auto t = nextTask++; t < tasks.size(); t = nextTask++)
+        {
+            const auto& task = tasks[t];
+            const auto& primitive = primitives[task.primitive];
+            for (auto i = task.first; i < task.first + task.count; i++)
+            {
+                if (task.isIndexTask)
+                {
+                    const auto index = primitive.indices.count > 0 ? readIndex(primitive.indices, i) : static_cast<uint32_t>(i);
+                    hasInvalidIndex = hasInvalidIndex || index >= primitive.positions.count;
+                    indices[primitive.firstIndex + i] = static_cast<GLuint>(primitive.firstVertex + index);
+                    continue;
+                }
+
+                const auto vertex = primitive.firstVertex + i;
+                auto textureCoordinate = glm::vec2(0.0f);
+                auto normal = glm::vec3(0.0f);
+                if (primitive.textureCoordinates.count > 0) {
+                    textureCoordinate = glm::vec2(readComponent(primitive.textureCoordinates, i, 0), readComponent(primitive.textureCoordinates, i, 1));
+                }
+                if (primitive.normals.count > 0) {
+                    normal = glm::vec3(readComponent(primitive.normals, i, 0), readComponent(primitive.normals, i, 1), readComponent(primitive.normals, i, 2));
+                }
+
+                const auto position = glm::vec3(readComponent(primitive.positions, i, 0), readComponent(primitive.positions, i, 1), readComponent(primitive.positions, i, 2));
+                Layout::writeAttribute<vertex_attributes::Position>(vertexData, _vertexStorage, numVertices, vertex, position);
+                Layout::writeAttribute<vertex_attributes::TextureCoordinate>(vertexData, _vertexStorage, numVertices, vertex, textureCoordinate);
+                Layout::writeAttribute<vertex_attributes::Normal>(vertexData, _vertexStorage, numVertices, vertex, normal);
+            }
+        }
+    });
+
+    if (hasInvalidIndex)
+    {
+        std::cerr << "glTF file references vertex out of range!" << std::endl;
+        return false;
+    }
+
+    _importStats.numThreads = static_cast<int>(numThreads);
+    _importStats.parseMilliseconds = millisecondsSince(parseStart);
+    return true;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,80 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <string>
+
+// Project
+#include "staticMeshIndexed3D.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Report of importing mesh from file.
+ */
+struct ImportStats
+{
+    size_t fileByteSize = 0; // Size of the imported file
+    size_t numTriangles = 0; // Number of imported triangles
+    size_t numVertices = 0; // Number of vertices in the vertex buffer (after welding of OBJ corners)
+    int numThreads = 0; // Number of threads the file has been parsed in
+    double parseMilliseconds = 0.0; // Time of parsing the file into vertices and indices
+    double totalMilliseconds = 0.0; // Time of the whole import, including mapping, welding and upload
+    double parseMegabytesPerSecond = 0.0; // Parse throughput (file megabytes per second of parsing)
+    bool normalsGenerated = false; // Flag telling, if some normals were missing in the file and all normals have been generated
+};
+
+/**
+ * Minimal file size, from which files are parsed in multiple threads.
+ */
+const size_t PARALLEL_IMPORT_MIN_BYTES = 1 << 20;
+
+/**
+ * Indexed static mesh imported from Wavefront OBJ or binary glTF (.glb) file. File is memory-mapped and parsed in multiple threads,
+ * vertices are written straight to the vertex buffer in mesh vertex storage. Mesh always has positions, texture coordinates
+ * and normals - missing texture coordinates are zero, normals are generated, if any of them is missing (see generateNormals).
+ *
+ * OBJ - text is split into chunks at line ends, every thread parses one chunk (v, vt, vn and f lines, polygons are triangulated
+ * as fans, negative indices are supported), then unique position / texture coordinate / normal triples are welded into vertices.
+ *
+ * glTF - triangle primitives of all meshes in the embedded binary chunk are merged in file order (node transforms and
+ * materials are ignored), attribute and index accessors are decoded by threads in slices.
+ */
+class ImportedMesh : public StaticMeshIndexed3D
+{
+public:
+    typedef DefaultVertexLayout Layout; // Vertex layout of imported meshes (missing attributes of the file are zero)
+
+    /**
+     * Imports mesh from file, format is chosen by file extension (.obj or .glb).
+     *
+     * @param fileName       Path to the file
+     * @param vertexStorage  How vertex attributes are arranged in the vertex buffer
+     */
+    explicit ImportedMesh(const std::string& fileName, VertexStorage vertexStorage = VertexStorage::Planar);
+
+    /**
+     * Checks, if the mesh has been imported successfully.
+     */
+    bool isImported() const;
+
+    /**
+     * Gets report of the import (sizes, times and parse throughput).
+     */
+    const ImportStats& getImportStats() const;
+
+private:
+    ImportStats _importStats; // Report of the import
+
+    /**
+     * Parses OBJ text and gathers welded vertices and indices in VBOs.
+     */
+    bool importObj(const char* text, size_t size);
+
+    /**
+     * Parses binary glTF and gathers vertices and indices in VBOs.
+     */
+    bool importGlb(const unsigned char* data, size_t size);
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,169 @@
+// STL
+#include <vector>
+
+// GLM
+#include <glm/gtc/matrix_inverse.hpp>
+
+// Project
+#include "instanceBuffer.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+void setNormalMatrix(InstanceData& instance)
+{
+    const auto normalMatrix = glm::inverseTranspose(glm::mat3(instance.model));
+    for (auto column = 0; column < 3; column++) {
+        instance.normalMatrix[column] = glm::vec4(normalMatrix[column], 0.0f);
+    }
+}
+
+} // namespace
+
+InstanceBuffer::~InstanceBuffer()
+{
+    deleteBuffer();
+}
+
+int InstanceBuffer::addInstance(const glm::mat4& model, const glm::vec4& tint, float textureLayer)
+{
+    InstanceData instance;
+    instance.model = model;
+    instance.tint = tint;
+    instance.textureLayer = textureLayer;
+    setNormalMatrix(instance);
+
+    beginSetChange();
+    _changedSetInstances.push_back(instance);
+    return _numInstances++;
+}
+
+void InstanceBuffer::setInstanceModel(int instance, const glm::mat4& model)
+{
+    if (instance < 0 || instance >= getNumInstances()) {
+        return;
+    }
+
+    auto instanceData = getInstance(instance);
+    instanceData.model = model;
+    setNormalMatrix(instanceData);
+    writeInstance(instance, instanceData);
+}
+
+void InstanceBuffer::setInstanceMaterial(int instance, const glm::vec4& tint, float textureLayer)
+{
+    if (instance < 0 || instance >= getNumInstances()) {
+        return;
+    }
+
+    auto instanceData = getInstance(instance);
+    instanceData.tint = tint;
+    instanceData.textureLayer = textureLayer;
+    writeInstance(instance, instanceData);
+}
+
+void InstanceBuffer::removeInstance(int instance)
+{
+    if (instance < 0 || instance >= getNumInstances()) {
+        return;
+    }
+
+    beginSetChange();
+    _changedSetInstances[instance] = _changedSetInstances.back();
+    _changedSetInstances.pop_back();
+    _numInstances--;
+}
+
+void InstanceBuffer::clear()
+{
+    beginSetChange();
+    _changedSetInstances.clear();
+    _numInstances = 0;
+}
+
+int InstanceBuffer::getNumInstances() const
+{
+    return _numInstances;
+}
+
+const InstanceData& InstanceBuffer::getInstance(int instance) const
+{
+    if (_isRebuildNeeded) {
+        return _changedSetInstances[instance];
+    }
+
+    return static_cast<const InstanceData*>(_vbo.getRawDataPointer())[instance];
+}
+
+void InstanceBuffer::bind(GLuint binding)
+{
+    if (!_isBufferCreated)
+    {
+        beginSetChange();
+        _vbo.createVBO();
+        _vbo.setCpuCopyPolicy(VertexBufferObject::CpuCopyPolicy::Keep);
+        _isBufferCreated = true;
+    }
+
+    _vbo.bindVBO(GL_SHADER_STORAGE_BUFFER);
+    if (_isRebuildNeeded)
+    {
+        // Instance count changed - buffer gets new storage of the right size and keeps its instances in memory for later updates
+        _vbo.uploadDataToGPU(_changedSetInstances.data(), _changedSetInstances.size() * sizeof(InstanceData), GL_DYNAMIC_DRAW);
+        std::vector<InstanceData>().swap(_changedSetInstances);
+        _isRebuildNeeded = false;
+        _numUploads++;
+    }
+    else if (_hasDirtyInstances)
+    {
+        _vbo.flushDirtyRanges();
+        _numUploads++;
+    }
+
+    _hasDirtyInstances = false;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, _vbo.getBufferID());
+}
+
+int InstanceBuffer::getNumUploads() const
+{
+    return _numUploads;
+}
+
+void InstanceBuffer::deleteBuffer()
+{
+    if (!_isBufferCreated) {
+        return;
+    }
+
+    // Instances live in the in-memory copy of the buffer, so they are taken back first
+    beginSetChange();
+    _vbo.deleteVBO();
+    _isBufferCreated = false;
+}
+
+void InstanceBuffer::beginSetChange()
+{
+    if (_isRebuildNeeded) {
+        return;
+    }
+
+    const auto instances = static_cast<const InstanceData*>(_vbo.getRawDataPointer());
+    _changedSetInstances.assign(instances, instances + _numInstances);
+    _isRebuildNeeded = true;
+    _hasDirtyInstances = false;
+}
+
+void InstanceBuffer::writeInstance(int instance, const InstanceData& instanceData)
+{
+    if (_isRebuildNeeded)
+    {
+        _changedSetInstances[instance] = instanceData;
+        return;
+    }
+
+    _vbo.updateRawData(instance * sizeof(InstanceData), &instanceData, sizeof(InstanceData));
+    _hasDirtyInstances = true;
+}
+
+} // namespace static_meshes_3D
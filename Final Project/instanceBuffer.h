@@ -0,0 +1,126 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "vertexBufferObject.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Data of one instance, in std430 layout of the shader storage block read by instanced vertex shaders:
+ *
+ *     struct Instance { mat4 model; mat3 normalMatrix; vec4 tint; float textureLayer; };
+ */
+struct InstanceData
+{
+    glm::mat4 model; // Model matrix
+    glm::vec4 normalMatrix[3]; // Columns of normal matrix (inverse transpose of model matrix), padded to vec4 as std430 mat3
+    glm::vec4 tint = glm::vec4(1.0f); // Color multiplying texture color
+    float textureLayer = 0.0f; // Layer of array texture (used only when shader samples array texture)
+    float padding[3] = {}; // Pads the struct to multiple of 16 bytes, as std430 arrays of structs do
+};
+
+static_assert(sizeof(InstanceData) == 144, "InstanceData must match std430 layout of the shader Instance struct");
+
+/**
+ * Per-instance data of many instances of the same mesh (model matrices, tints, texture layers) in a shader storage buffer,
+ * so that all instances are rendered with one instanced draw (see StaticMesh3D::renderInstanced). Shader reads its instance
+ * as instances[gl_InstanceID]. Instance data live in the in-memory copy kept by the buffer (CpuCopyPolicy::Keep) and are
+ * uploaded when the buffer is bound - whole buffer only when instances have been added or removed, otherwise just dirty
+ * ranges of changed instances (VertexBufferObject::flushDirtyRanges), unchanged buffer is not uploaded at all.
+ */
+class InstanceBuffer
+{
+public:
+    static const GLuint DEFAULT_BINDING = 0; // Shader storage binding of instance data (must match binding in instanced shaders)
+
+    ~InstanceBuffer();
+
+    /**
+     * Adds instance.
+     *
+     * @param model         Model matrix of the instance
+     * @param tint          Color multiplying texture color
+     * @param textureLayer  Layer of array texture
+     *
+     * @return Index of the instance (instances keep their indices until removeInstance or clear).
+     */
+    int addInstance(const glm::mat4& model, const glm::vec4& tint = glm::vec4(1.0f), float textureLayer = 0.0f);
+
+    /**
+     * Changes model matrix of the instance.
+     */
+    void setInstanceModel(int instance, const glm::mat4& model);
+
+    /**
+     * Changes tint and texture layer of the instance.
+     */
+    void setInstanceMaterial(int instance, const glm::vec4& tint, float textureLayer);
+
+    /**
+     * Removes instance, last instance is moved to its index.
+     */
+    void removeInstance(int instance);
+
+    /**
+     * Removes all instances.
+     */
+    void clear();
+
+    /**
+     * Gets number of instances.
+     */
+    int getNumInstances() const;
+
+    /**
+     * Gets data of the instance.
+     */
+    const InstanceData& getInstance(int instance) const;
+
+    /**
+     * Uploads changed instance data (if any) and binds the buffer to shader storage binding.
+     *
+     * @param binding  Shader storage binding index
+     */
+    void bind(GLuint binding = DEFAULT_BINDING);
+
+    /**
+     * Gets number of uploads done so far (whole buffer rebuilds and flushes of dirty ranges).
+     */
+    int getNumUploads() const;
+
+    /**
+     * Deletes the GPU buffer (instances stay in memory and are uploaded again with next bind).
+     */
+    void deleteBuffer();
+
+private:
+    std::vector<InstanceData> _changedSetInstances; // Data of all instances while set of instances changes (empty once uploaded)
+    VertexBufferObject _vbo; // Shader storage buffer with instance data, its kept in-memory copy holds data of uploaded instances
+    int _numInstances = 0; // Number of instances
+    bool _isBufferCreated = false; // Flag telling, if the GPU buffer has been created
+    bool _isRebuildNeeded = true; // Flag telling, if set of instances changed since the last upload
+    bool _hasDirtyInstances = false; // Flag telling, if some uploaded instances changed since the last upload
+    int _numUploads = 0; // Number of uploads done so far
+
+    /**
+     * Starts change of the set of instances - data of uploaded instances are taken back from the buffer's in-memory copy,
+     * so that the buffer is rebuilt with next bind.
+     */
+    void beginSetChange();
+
+    /**
+     * Writes data of the instance - to the buffer's in-memory copy as a dirty range, or to the changed set.
+     */
+    void writeInstance(int instance, const InstanceData& instanceData);
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,154 @@
+// STL
+#include <algorithm>
+#include <iostream>
+
+// Project
+#include "lodManager.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+// Distance, below which instance is treated as being at the camera
+const float MIN_LOD_DISTANCE = 1e-4f;
+
+} // namespace
+
+LodManager::LodManager(float maxScreenError, float hysteresis, float fadeDuration)
+    : _maxScreenError(maxScreenError)
+    , _hysteresis(std::min(std::max(hysteresis, 0.0f), 0.99f))
+    , _fadeDuration(fadeDuration)
+{
+    _frameStats.numTrianglesPerLod.assign(ParametricMesh::MAX_LOD_COUNT, 0);
+}
+
+int LodManager::addInstance(const ParametricMesh* mesh)
+{
+    if (mesh == nullptr)
+    {
+        std::cerr << "Cannot add LOD instance of no mesh!" << std::endl;
+        return -1;
+    }
+
+    Instance instance;
+    instance.mesh = mesh;
+    _instances.push_back(instance);
+    return static_cast<int>(_instances.size()) - 1;
+}
+
+void LodManager::beginFrame(const glm::mat4& projection, int viewportHeight, float deltaTime)
+{
+    // Perspective matrix has -1 in w row, its [1][1] is cot(fovy / 2), orthographic one has 2 / height of the view volume
+    _isPerspective = projection[2][3] != 0.0f;
+    _pixelsPerUnit = projection[1][1] * float(viewportHeight) / 2.0f;
+
+    std::fill(_frameStats.numTrianglesPerLod.begin(), _frameStats.numTrianglesPerLod.end(), 0);
+    _frameStats.numTriangles = 0;
+    _frameStats.numFadingInstances = 0;
+
+    const auto fadeStep = _fadeDuration > 0.0f ? deltaTime / _fadeDuration : 1.0f;
+    for (auto& instance : _instances)
+    {
+        if (instance.fadingOutLod < 0) {
+            continue;
+        }
+
+        instance.fadeProgress += fadeStep;
+        if (instance.fadeProgress >= 1.0f)
+        {
+            instance.fadeProgress = 1.0f;
+            instance.fadingOutLod = -1;
+        }
+    }
+}
+
+int LodManager::render(int instanceHandle, const glm::mat4& modelView, GLint lodFadeLocation)
+{
+    if (instanceHandle < 0 || instanceHandle >= static_cast<int>(_instances.size())) {
+        return -1;
+    }
+
+    // Geometric error is in model units, so take the largest scale of the model view transform into account
+    auto& instance = _instances[instanceHandle];
+    const auto scale = std::max(glm::length(glm::vec3(modelView[0])), std::max(glm::length(glm::vec3(modelView[1])), glm::length(glm::vec3(modelView[2]))));
+    const auto distance = std::max(glm::length(glm::vec3(modelView[3])), MIN_LOD_DISTANCE);
+    const auto pixelsPerModelUnit = scale * (_isPerspective ? _pixelsPerUnit / distance : _pixelsPerUnit);
+
+    const auto lod = selectLod(instance, pixelsPerModelUnit);
+    if (lod != instance.lod)
+    {
+        // Switch in the middle of a fade starts new fade from the LOD that was visible more
+        instance.fadingOutLod = _isCrossFadeEnabled ? (instance.fadingOutLod >= 0 && instance.fadeProgress < 0.5f ? instance.fadingOutLod : instance.lod) : -1;
+        instance.fadeProgress = _isCrossFadeEnabled ? 0.0f : 1.0f;
+        instance.lod = lod;
+    }
+
+    if (instance.fadingOutLod >= 0 && instance.fadingOutLod != instance.lod)
+    {
+        _frameStats.numFadingInstances++;
+        renderLod(instance, instance.lod, instance.fadeProgress, lodFadeLocation);
+        renderLod(instance, instance.fadingOutLod, instance.fadeProgress - 1.0f, lodFadeLocation);
+        if (lodFadeLocation != -1) {
+            glUniform1f(lodFadeLocation, 1.0f);
+        }
+    }
+    else {
+        renderLod(instance, instance.lod, 1.0f, -1);
+    }
+
+    return instance.lod;
+}
+
+void LodManager::setCrossFadeEnabled(bool enabled)
+{
+    _isCrossFadeEnabled = enabled;
+}
+
+bool LodManager::isCrossFadeEnabled() const
+{
+    return _isCrossFadeEnabled;
+}
+
+int LodManager::getInstanceLod(int instanceHandle) const
+{
+    if (instanceHandle < 0 || instanceHandle >= static_cast<int>(_instances.size())) {
+        return -1;
+    }
+
+    return _instances[instanceHandle].lod;
+}
+
+const LodFrameStats& LodManager::getFrameStats() const
+{
+    return _frameStats;
+}
+
+int LodManager::selectLod(const Instance& instance, float pixelsPerModelUnit) const
+{
+    // Errors grow with LOD, so the first acceptable LOD from the coarsest one is the coarsest acceptable LOD
+    const auto coarserLimit = _maxScreenError * (1.0f - _hysteresis);
+    const auto finerLimit = _maxScreenError * (1.0f + _hysteresis);
+    for (auto lod = instance.mesh->getLodCount() - 1; lod > 0; lod--)
+    {
+        const auto limit = lod > instance.lod ? coarserLimit : finerLimit;
+        if (instance.mesh->getLodError(lod) * pixelsPerModelUnit <= limit) {
+            return lod;
+        }
+    }
+
+    return 0;
+}
+
+void LodManager::renderLod(const Instance& instance, int lod, float fade, GLint lodFadeLocation)
+{
+    if (lodFadeLocation != -1) {
+        glUniform1f(lodFadeLocation, fade);
+    }
+    instance.mesh->renderLod(lod);
+
+    const auto numTriangles = instance.mesh->getLodTriangleCount(lod);
+    _frameStats.numTrianglesPerLod[lod] += numTriangles;
+    _frameStats.numTriangles += numTriangles;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,123 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "parametricMesh.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Statistics of rendering of one frame.
+ */
+struct LodFrameStats
+{
+    std::vector<int> numTrianglesPerLod; // Rendered triangles of every LOD (cross-faded instances count both LODs)
+    int numTriangles = 0; // Sum of the counts above
+    int numFadingInstances = 0; // Number of instances being cross-faded between two LODs
+};
+
+/**
+ * Selects LOD of parametric mesh instances from their projected screen-space error. LOD of an instance is the coarsest one,
+ * whose geometric error projected to the screen is not larger than given number of pixels. To avoid popping back and forth,
+ * switching to coarser LOD needs the error to be below the limit by hysteresis, switching to finer LOD needs it above by hysteresis.
+ * Optionally, LOD switches are cross-faded - both LODs are rendered with complementary dither patterns.
+ */
+class LodManager
+{
+public:
+    /**
+     * @param maxScreenError  Maximal screen-space error in pixels
+     * @param hysteresis      Relative band around the maximal error, in which current LOD is kept
+     * @param fadeDuration    Duration of cross-fade in seconds
+     */
+    LodManager(float maxScreenError = 1.0f, float hysteresis = 0.25f, float fadeDuration = 0.3f);
+
+    /**
+     * Adds instance of a mesh, mesh must outlive the manager.
+     *
+     * @return Handle of the instance.
+     */
+    int addInstance(const ParametricMesh* mesh);
+
+    /**
+     * Starts new frame - resets statistics and advances cross-fades.
+     *
+     * @param projection      Projection matrix of the frame (perspective or orthographic)
+     * @param viewportHeight  Viewport height in pixels
+     * @param deltaTime       Time since last frame in seconds
+     */
+    void beginFrame(const glm::mat4& projection, int viewportHeight, float deltaTime);
+
+    /**
+     * Selects LOD of the instance and renders it (and LOD being faded out, if any).
+     *
+     * @param instance          Instance handle
+     * @param modelView         Model view matrix of the instance, mesh origin is taken as its center
+     * @param lodFadeLocation   Location of float uniform of the dither fade (1 opaque, 0..1 fading in, -1..0 fading out), -1 if not used
+     *
+     * @return Selected LOD.
+     */
+    int render(int instance, const glm::mat4& modelView, GLint lodFadeLocation);
+
+    /**
+     * Enables or disables cross-fading of LOD switches.
+     */
+    void setCrossFadeEnabled(bool enabled);
+
+    /**
+     * Checks, if LOD switches are cross-faded.
+     */
+    bool isCrossFadeEnabled() const;
+
+    /**
+     * Gets currently selected LOD of the instance.
+     */
+    int getInstanceLod(int instance) const;
+
+    /**
+     * Gets statistics of the current frame.
+     */
+    const LodFrameStats& getFrameStats() const;
+
+private:
+    /**
+     * Instance of a mesh with its LOD state.
+     */
+    struct Instance
+    {
+        const ParametricMesh* mesh; // Rendered mesh
+        int lod = 0; // Currently selected LOD
+        int fadingOutLod = -1; // LOD being faded out (-1 if not fading)
+        float fadeProgress = 1.0f; // Progress of fading in of current LOD
+    };
+
+    float _maxScreenError; // Maximal screen-space error in pixels
+    float _hysteresis; // Relative band around the maximal error
+    float _fadeDuration; // Duration of cross-fade in seconds
+    bool _isCrossFadeEnabled = false; // Flag telling, if LOD switches are cross-faded
+
+    float _pixelsPerUnit = 1.0f; // Pixels per unit at distance 1 (perspective) or at any distance (orthographic)
+    bool _isPerspective = true; // Flag telling, if projection of current frame is perspective
+    std::vector<Instance> _instances; // All instances
+    LodFrameStats _frameStats; // Statistics of the current frame
+
+    /**
+     * Selects LOD of the instance, using hysteresis around its current LOD.
+     */
+    int selectLod(const Instance& instance, float pixelsPerModelUnit) const;
+
+    /**
+     * Renders one LOD with given fade and counts its triangles.
+     */
+    void renderLod(const Instance& instance, int lod, float fade, GLint lodFadeLocation);
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,106 @@
+// Platform
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Project
+#include "mappedFile.h"
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+
+#ifdef _WIN32
+    _fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        _fileHandle = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    _data = _mappingHandle != nullptr ? static_cast<const unsigned char*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    _size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    _fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if (_fileDescriptor < 0) {
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(_fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        close();
+        return false;
+    }
+
+    _size = static_cast<size_t>(fileStatus.st_size);
+    const auto mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+    _data = mapping != MAP_FAILED ? static_cast<const unsigned char*>(mapping) : nullptr;
+#endif
+
+    if (_data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mappingHandle != nullptr) {
+        CloseHandle(_mappingHandle);
+    }
+    if (_fileHandle != nullptr) {
+        CloseHandle(_fileHandle);
+    }
+    _mappingHandle = nullptr;
+    _fileHandle = nullptr;
+#else
+    if (_data != nullptr) {
+        munmap(const_cast<unsigned char*>(_data), _size);
+    }
+    if (_fileDescriptor >= 0) {
+        ::close(_fileDescriptor);
+    }
+    _fileDescriptor = -1;
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+    return _data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return _size;
+}
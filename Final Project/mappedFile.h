@@ -0,0 +1,53 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file. Pages are loaded by the OS on first access, so mapped data can be handed
+ * straight to glBufferData without reading the file into memory first.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /**
+     * Maps given file, closing previously mapped one.
+     *
+     * @param fileName  Path to the file
+     *
+     * @return True, if file has been mapped, false otherwise (missing or empty file).
+     */
+    bool open(const std::string& fileName);
+
+    /**
+     * Unmaps the file.
+     */
+    void close();
+
+    /**
+     * Gets pointer to the mapped file contents (page aligned), nullptr if no file is mapped.
+     */
+    const unsigned char* getData() const;
+
+    /**
+     * Gets size of the mapped file in bytes.
+     */
+    size_t getSize() const;
+
+private:
+    const unsigned char* _data = nullptr; // Mapped file contents
+    size_t _size = 0; // Size of the mapped file
+
+#ifdef _WIN32
+    void* _fileHandle = nullptr; // Handle of the open file
+    void* _mappingHandle = nullptr; // Handle of the file mapping object
+#else
+    int _fileDescriptor = -1; // Descriptor of the open file
+#endif
+};
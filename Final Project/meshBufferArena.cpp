@@ -0,0 +1,339 @@
+// STL
+#include <iostream>
+#include <algorithm>
+
+// Project
+#include "meshBufferArena.h"
+
+namespace static_meshes_3D {
+
+const MeshBufferArena::Handle MeshBufferArena::INVALID_HANDLE = -1;
+
+MeshBufferArena::~MeshBufferArena()
+{
+    deleteArena();
+}
+
+MeshBufferArena::Handle MeshBufferArena::allocate(size_t numVertices)
+{
+    if (numVertices == 0) {
+        return INVALID_HANDLE;
+    }
+
+    // Find best fitting free block across all pages
+    auto pageIndex = -1;
+    auto bestFit = std::pair<size_t, size_t>(0, 0);
+    for (auto i = 0; i < static_cast<int>(_pages.size()); i++)
+    {
+        const auto& freeBySize = _pages[i].freeBySize;
+        const auto it = freeBySize.lower_bound(std::make_pair(numVertices, size_t(0)));
+        if (it != freeBySize.end() && (pageIndex == -1 || it->first < bestFit.first))
+        {
+            pageIndex = i;
+            bestFit = *it;
+        }
+    }
+
+    if (pageIndex == -1)
+    {
+        pageIndex = createPage(std::max(numVertices, _pageSizeVertices));
+        if (pageIndex == -1) {
+            return INVALID_HANDLE;
+        }
+
+        bestFit = *_pages[pageIndex].freeBySize.begin();
+    }
+
+    // Take the beginning of the free block, rest stays free
+    auto& page = _pages[pageIndex];
+    eraseFreeBlock(page, bestFit.second, bestFit.first);
+    if (bestFit.first > numVertices) {
+        insertFreeBlock(page, bestFit.second + numVertices, bestFit.first - numVertices);
+    }
+    page.usedVertices += numVertices;
+
+    Handle handle;
+    if (!_freeHandles.empty())
+    {
+        handle = _freeHandles.back();
+        _freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(_allocations.size());
+        _allocations.emplace_back();
+    }
+
+    auto& allocation = _allocations[handle];
+    allocation.page = pageIndex;
+    allocation.firstVertex = bestFit.second;
+    allocation.numVertices = numVertices;
+
+    return handle;
+}
+
+void MeshBufferArena::upload(Handle handle, const void* interleavedData)
+{
+    const auto& allocation = getAllocation(handle);
+    if (allocation.page == -1)
+    {
+        std::cerr << "Cannot upload data to invalid arena allocation!" << std::endl;
+        return;
+    }
+
+    const auto vertexByteSize = getVertexByteSize();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _pages[allocation.page].buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.firstVertex * vertexByteSize, allocation.numVertices * vertexByteSize, interleavedData);
+}
+
+void MeshBufferArena::download(Handle handle, void* interleavedData) const
+{
+    const auto& allocation = getAllocation(handle);
+    if (allocation.page == -1)
+    {
+        std::cerr << "Cannot download data of invalid arena allocation!" << std::endl;
+        return;
+    }
+
+    const auto vertexByteSize = getVertexByteSize();
+    glBindBuffer(GL_COPY_READ_BUFFER, _pages[allocation.page].buffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, allocation.firstVertex * vertexByteSize, allocation.numVertices * vertexByteSize, interleavedData);
+}
+
+void MeshBufferArena::free(Handle handle)
+{
+    if (handle < 0 || handle >= static_cast<Handle>(_allocations.size()) || _allocations[handle].page == -1) {
+        return;
+    }
+
+    auto& allocation = _allocations[handle];
+    auto& page = _pages[allocation.page];
+    auto firstVertex = allocation.firstVertex;
+    auto numVertices = allocation.numVertices;
+    page.usedVertices -= numVertices;
+
+    // Coalesce with following free block
+    const auto next = page.freeByOffset.find(firstVertex + numVertices);
+    if (next != page.freeByOffset.end())
+    {
+        const auto nextSize = next->second;
+        eraseFreeBlock(page, next->first, nextSize);
+        numVertices += nextSize;
+    }
+
+    // Coalesce with preceding free block
+    auto prev = page.freeByOffset.lower_bound(firstVertex);
+    if (prev != page.freeByOffset.begin())
+    {
+        --prev;
+        if (prev->first + prev->second == firstVertex)
+        {
+            const auto prevFirst = prev->first;
+            const auto prevSize = prev->second;
+            eraseFreeBlock(page, prevFirst, prevSize);
+            firstVertex = prevFirst;
+            numVertices += prevSize;
+        }
+    }
+
+    insertFreeBlock(page, firstVertex, numVertices);
+
+    allocation = Allocation();
+    _freeHandles.push_back(handle);
+}
+
+GLint MeshBufferArena::bindAllocation(Handle handle)
+{
+    const auto& allocation = getAllocation(handle);
+    if (allocation.page == -1) {
+        return 0;
+    }
+
+    // Always bound, VAOs are bound outside of the arena too (meshes with own VAO, GPU culling...), so the arena cannot
+    // know the current binding
+    glBindVertexArray(_pages[allocation.page].vao);
+    _numVAOSwitches++;
+
+    return static_cast<GLint>(allocation.firstVertex);
+}
+
+const MeshBufferArena::Allocation& MeshBufferArena::getAllocation(Handle handle) const
+{
+    static const Allocation invalidAllocation;
+    if (handle < 0 || handle >= static_cast<Handle>(_allocations.size())) {
+        return invalidAllocation;
+    }
+
+    return _allocations[handle];
+}
+
+GLuint MeshBufferArena::getAllocationVAO(Handle handle) const
+{
+    const auto& allocation = getAllocation(handle);
+    return allocation.page != -1 ? _pages[allocation.page].vao : 0;
+}
+
+const VertexFormat& MeshBufferArena::getVertexFormat() const
+{
+    return _vertexFormat;
+}
+
+int MeshBufferArena::getVertexByteSize() const
+{
+    return static_cast<int>(_vertexFormat.stride);
+}
+
+int MeshBufferArena::compact()
+{
+    const auto vertexByteSize = getVertexByteSize();
+    auto numMoved = 0;
+
+    for (auto pageIndex = 0; pageIndex < static_cast<int>(_pages.size()); pageIndex++)
+    {
+        auto& page = _pages[pageIndex];
+
+        // Page is compact, if it has at most one free block and it's at the very end
+        if (page.freeByOffset.empty() || (page.freeByOffset.size() == 1 && page.freeByOffset.begin()->first == page.usedVertices)) {
+            continue;
+        }
+
+        // Gather live allocations of the page in their current order
+        std::vector<Handle> pageHandles;
+        for (auto handle = 0; handle < static_cast<Handle>(_allocations.size()); handle++)
+        {
+            if (_allocations[handle].page == pageIndex) {
+                pageHandles.push_back(handle);
+            }
+        }
+        std::sort(pageHandles.begin(), pageHandles.end(), [this](Handle a, Handle b) {
+            return _allocations[a].firstVertex < _allocations[b].firstVertex;
+        });
+
+        // Copy them packed to a new buffer, so that source and destination ranges never overlap
+        GLuint newBuffer = 0;
+        glGenBuffers(1, &newBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, page.numVertices * vertexByteSize, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, page.buffer);
+
+        size_t packedVertex = 0;
+        for (const auto handle : pageHandles)
+        {
+            auto& allocation = _allocations[handle];
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation.firstVertex * vertexByteSize,
+                packedVertex * vertexByteSize, allocation.numVertices * vertexByteSize);
+            if (allocation.firstVertex != packedVertex) {
+                numMoved++;
+            }
+
+            allocation.firstVertex = packedVertex;
+            packedVertex += allocation.numVertices;
+        }
+
+        glDeleteBuffers(1, &page.buffer);
+        page.buffer = newBuffer;
+        setupPageVAO(page);
+
+        page.freeByOffset.clear();
+        page.freeBySize.clear();
+        if (packedVertex < page.numVertices) {
+            insertFreeBlock(page, packedVertex, page.numVertices - packedVertex);
+        }
+    }
+
+    // Page VAOs have been rebound during compaction
+    glBindVertexArray(0);
+
+    return numMoved;
+}
+
+MeshBufferArena::Stats MeshBufferArena::getStats() const
+{
+    Stats stats;
+    const auto vertexByteSize = getVertexByteSize();
+    size_t freeBytes = 0;
+
+    stats.numPages = static_cast<int>(_pages.size());
+    stats.numAllocations = static_cast<int>(_allocations.size() - _freeHandles.size());
+    for (const auto& page : _pages)
+    {
+        stats.numFreeBlocks += static_cast<int>(page.freeByOffset.size());
+        stats.capacityBytes += page.numVertices * vertexByteSize;
+        stats.usedBytes += page.usedVertices * vertexByteSize;
+        freeBytes += (page.numVertices - page.usedVertices) * vertexByteSize;
+        if (!page.freeBySize.empty()) {
+            stats.largestFreeBlockBytes = std::max(stats.largestFreeBlockBytes, page.freeBySize.rbegin()->first * vertexByteSize);
+        }
+    }
+
+    stats.occupancy = stats.capacityBytes > 0 ? float(stats.usedBytes) / float(stats.capacityBytes) : 0.0f;
+    stats.fragmentation = freeBytes > 0 ? 1.0f - float(stats.largestFreeBlockBytes) / float(freeBytes) : 0.0f;
+    stats.numVAOSwitches = _numVAOSwitches;
+
+    return stats;
+}
+
+void MeshBufferArena::resetFrameStats()
+{
+    _numVAOSwitches = 0;
+}
+
+void MeshBufferArena::deleteArena()
+{
+    for (auto& page : _pages)
+    {
+        glDeleteVertexArrays(1, &page.vao);
+        glDeleteBuffers(1, &page.buffer);
+    }
+
+    _pages.clear();
+    _allocations.clear();
+    _freeHandles.clear();
+}
+
+int MeshBufferArena::createPage(size_t numVertices)
+{
+    Page page;
+    page.numVertices = numVertices;
+
+    // Errors raised before are not caused by the arena, they are cleared, so that only failure of this allocation is checked
+    while (glGetError() != GL_NO_ERROR) {}
+
+    glGenBuffers(1, &page.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, page.buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, numVertices * getVertexByteSize(), nullptr, GL_STATIC_DRAW);
+    if (glGetError() == GL_OUT_OF_MEMORY)
+    {
+        std::cerr << "Could not allocate arena page of " << numVertices << " vertices!" << std::endl;
+        glDeleteBuffers(1, &page.buffer);
+        return -1;
+    }
+
+    glGenVertexArrays(1, &page.vao);
+    setupPageVAO(page);
+    insertFreeBlock(page, 0, numVertices);
+
+    _pages.push_back(std::move(page));
+    return static_cast<int>(_pages.size()) - 1;
+}
+
+void MeshBufferArena::setupPageVAO(Page& page)
+{
+    glBindVertexArray(page.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, page.buffer);
+    _vertexFormat.setAttributePointers(VertexStorage::Interleaved, page.numVertices, 0);
+}
+
+void MeshBufferArena::insertFreeBlock(Page& page, size_t firstVertex, size_t numVertices)
+{
+    page.freeByOffset[firstVertex] = numVertices;
+    page.freeBySize.insert(std::make_pair(numVertices, firstVertex));
+}
+
+void MeshBufferArena::eraseFreeBlock(Page& page, size_t firstVertex, size_t numVertices)
+{
+    page.freeByOffset.erase(firstVertex);
+    page.freeBySize.erase(std::make_pair(numVertices, firstVertex));
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,177 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <map>
+#include <set>
+
+// GLAD
+#include <gl/glew.h>
+
+// Project
+#include "vertexLayout.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Shared GPU buffer arena for static meshes. Holds few large buffers (pages) of interleaved vertices
+ * with one VAO per page and sub-allocates vertex ranges from them, so that many meshes share the same
+ * buffer object and VAO and are rendered just with different first vertex offsets.
+ */
+class MeshBufferArena
+{
+public:
+    typedef int Handle; // Handle of the allocation (stays valid across compaction)
+    static const Handle INVALID_HANDLE; // Handle, that does not represent any allocation (-1)
+
+    /**
+     * Sub-allocated vertex range in one of the arena pages.
+     */
+    struct Allocation
+    {
+        int page = -1; // Index of the page (buffer + VAO), -1 if this allocation slot is unused
+        size_t firstVertex = 0; // First vertex of the range inside the page
+        size_t numVertices = 0; // Number of vertices in the range
+    };
+
+    /**
+     * Statistics about arena occupancy and fragmentation.
+     */
+    struct Stats
+    {
+        int numPages = 0; // Number of allocated GPU buffers
+        int numAllocations = 0; // Number of live allocations
+        int numFreeBlocks = 0; // Number of free blocks in all pages
+        size_t capacityBytes = 0; // Total size of all pages
+        size_t usedBytes = 0; // Bytes occupied by live allocations
+        size_t largestFreeBlockBytes = 0; // Size of the largest free block
+        float occupancy = 0.0f; // Used bytes divided by capacity (0 - 1)
+        float fragmentation = 0.0f; // 1 - largest free block / all free bytes (0 means all free space is contiguous)
+        int numVAOSwitches = 0; // VAO binds done by the arena since last reset
+    };
+
+    /**
+     * Creates an empty arena for interleaved vertices of given layout. No GPU memory is allocated until first allocation.
+     *
+     * @param layout            Vertex layout of the arena, meshes moved to the arena must have the same one
+     * @param pageSizeVertices  Size of one page (GPU buffer), in vertices
+     */
+    template<typename... Attributes>
+    explicit MeshBufferArena(VertexLayout<Attributes...> layout, size_t pageSizeVertices = 1 << 20)
+        : _vertexFormat(VertexLayout<Attributes...>::getFormat())
+        , _pageSizeVertices(pageSizeVertices) {}
+    ~MeshBufferArena();
+
+    /**
+     * Allocates range of vertices, creating a new page if none of existing pages has enough contiguous free space.
+     *
+     * @param numVertices  Number of vertices to allocate
+     *
+     * @return Handle of the new allocation, or INVALID_HANDLE, if something fails.
+     */
+    Handle allocate(size_t numVertices);
+
+    /**
+     * Uploads interleaved vertex data to the allocated range.
+     *
+     * @param handle           Handle of the allocation
+     * @param interleavedData  Interleaved vertex data, getVertexByteSize() * numVertices of the allocation bytes
+     */
+    void upload(Handle handle, const void* interleavedData);
+
+    /**
+     * Reads interleaved vertex data of the allocated range back from the GPU (waits for the GPU).
+     *
+     * @param handle           Handle of the allocation
+     * @param interleavedData  Output interleaved vertex data, getVertexByteSize() * numVertices of the allocation bytes
+     */
+    void download(Handle handle, void* interleavedData) const;
+
+    /**
+     * Frees allocated range, it can be reused by following allocations.
+     *
+     * @param handle  Handle of the allocation
+     */
+    void free(Handle handle);
+
+    /**
+     * Binds VAO of the page containing given allocation.
+     *
+     * @param handle  Handle of the allocation
+     *
+     * @return First vertex of the allocation to be used in draw calls.
+     */
+    GLint bindAllocation(Handle handle);
+
+    /**
+     * Gets allocation description for given handle.
+     */
+    const Allocation& getAllocation(Handle handle) const;
+
+    /**
+     * Gets VAO of the page containing given allocation (0 for invalid handle).
+     */
+    GLuint getAllocationVAO(Handle handle) const;
+
+    /**
+     * Gets vertex format of the arena (its vertex layout).
+     */
+    const VertexFormat& getVertexFormat() const;
+
+    /**
+     * Gets byte size of one interleaved vertex.
+     */
+    int getVertexByteSize() const;
+
+    /**
+     * Moves live allocations of every fragmented page to the beginning of the page, so that all free space
+     * forms one contiguous block. Handles stay valid, only their first vertices change.
+     *
+     * @return Number of allocations moved.
+     */
+    int compact();
+
+    /**
+     * Gets statistics about arena occupancy and fragmentation.
+     */
+    Stats getStats() const;
+
+    /**
+     * Resets VAO switch counter in stats (usually once per frame).
+     */
+    void resetFrameStats();
+
+    /**
+     * Deletes all pages and allocations of the arena.
+     */
+    void deleteArena();
+
+private:
+    /**
+     * One large GPU buffer with its VAO and free blocks.
+     */
+    struct Page
+    {
+        GLuint buffer = 0; // OpenGL buffer ID
+        GLuint vao = 0; // VAO with interleaved attribute pointers to the buffer
+        size_t numVertices = 0; // Capacity of the page, in vertices
+        size_t usedVertices = 0; // Vertices occupied by live allocations
+        std::map<size_t, size_t> freeByOffset; // Free blocks, first vertex -> number of vertices (for coalescing)
+        std::set<std::pair<size_t, size_t>> freeBySize; // Free blocks, (number of vertices, first vertex) (for best fit)
+    };
+
+    const VertexFormat& _vertexFormat; // Vertex layout of the arena
+    size_t _pageSizeVertices; // Default size of a new page, in vertices
+
+    std::vector<Page> _pages; // All pages of the arena
+    std::vector<Allocation> _allocations; // Allocations indexed by handle
+    std::vector<Handle> _freeHandles; // Unused slots in _allocations
+    int _numVAOSwitches = 0; // Counter of VAO binds
+
+    int createPage(size_t numVertices);
+    void setupPageVAO(Page& page);
+    void insertFreeBlock(Page& page, size_t firstVertex, size_t numVertices);
+    void eraseFreeBlock(Page& page, size_t firstVertex, size_t numVertices);
+};
+
+} // namespace static_meshes_3D
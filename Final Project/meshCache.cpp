@@ -0,0 +1,60 @@
+// STL
+#include <cstdint>
+
+// Project
+#include "meshCache.h"
+#include "meshProcessing.h"
+
+namespace static_meshes_3D {
+
+MeshCache::Stats MeshCache::getStats() const
+{
+    auto stats = _stats;
+    for (const auto& entry : _meshes)
+    {
+        if (const auto mesh = entry.second.lock())
+        {
+            stats.numLiveMeshes++;
+            stats.liveBytes += mesh->getGpuByteSize();
+        }
+    }
+
+    return stats;
+}
+
+void MeshCache::resetStats()
+{
+    _stats = Stats();
+}
+
+void MeshCache::purge()
+{
+    for (auto entry = _meshes.begin(); entry != _meshes.end();)
+    {
+        if (entry->second.expired()) {
+            entry = _meshes.erase(entry);
+        }
+        else {
+            ++entry;
+        }
+    }
+}
+
+bool MeshCache::Key::operator==(const Key& other) const
+{
+    return type == other.type && parameters == other.parameters;
+}
+
+size_t MeshCache::KeyHash::operator()(const Key& key) const
+{
+    auto hash = FNV_OFFSET_BASIS ^ static_cast<uint64_t>(key.type.hash_code());
+    for (const auto byte : key.parameters)
+    {
+        hash ^= byte;
+        hash *= FNV_PRIME;
+    }
+
+    return static_cast<size_t>(hash);
+}
+
+} // namespace static_meshes_3D
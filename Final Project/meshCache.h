@@ -0,0 +1,101 @@
+#pragma once
+
+// STL
+#include <memory>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+// Project
+#include "staticMesh3D.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Flyweight cache of procedural meshes. Meshes are keyed on their type and key made by the shape from constructor arguments
+ * (Mesh::cacheKey - shape parameters converted to declared types with defaults applied, vertex layout and storage), so asking
+ * twice for the same mesh returns the same GPU mesh, however its arguments are spelled.
+ * Cache does not own the meshes - every mesh lives as long as somebody holds it and is built again on next request after that.
+ * Shared meshes are const, per-instance variation has to come from transforms.
+ */
+class MeshCache
+{
+public:
+    /**
+     * Statistics of the cache.
+     */
+    struct Stats
+    {
+        int numHits = 0; // Requests served by already built mesh
+        int numMisses = 0; // Requests, that had to build a mesh
+        size_t bytesSaved = 0; // GPU bytes, that would have been allocated by hits without the cache
+        int numLiveMeshes = 0; // Number of meshes currently alive
+        size_t liveBytes = 0; // GPU bytes of meshes currently alive
+    };
+
+    /**
+     * Gets mesh of given type built with given constructor arguments, building it, if there is no live one.
+     * Mesh type must provide static cacheKey taking the same arguments as its constructor (see Cylinder::cacheKey).
+     *
+     * @param arguments  Constructor arguments of the mesh
+     */
+    template<typename Mesh, typename... Arguments>
+    std::shared_ptr<const Mesh> get(Arguments... arguments)
+    {
+        static_assert(std::is_base_of<StaticMesh3D, Mesh>::value, "Mesh cache can hold static meshes only!");
+
+        auto& cachedMesh = _meshes[Key{ typeid(Mesh), Mesh::cacheKey(arguments...) }];
+        if (const auto mesh = cachedMesh.lock())
+        {
+            _stats.numHits++;
+            _stats.bytesSaved += mesh->getGpuByteSize();
+            return std::static_pointer_cast<const Mesh>(mesh);
+        }
+
+        _stats.numMisses++;
+        const auto mesh = std::make_shared<const Mesh>(arguments...);
+        cachedMesh = mesh;
+        return mesh;
+    }
+
+    /**
+     * Gets statistics of the cache (live meshes are counted when called).
+     */
+    Stats getStats() const;
+
+    /**
+     * Resets hit, miss and saved bytes counters.
+     */
+    void resetStats();
+
+    /**
+     * Removes entries of meshes, that are not alive anymore.
+     */
+    void purge();
+
+private:
+    /**
+     * Type of the mesh with key made by the mesh type from its constructor arguments.
+     */
+    struct Key
+    {
+        std::type_index type; // Mesh type
+        std::vector<unsigned char> parameters; // Key made by Mesh::cacheKey
+
+        bool operator==(const Key& other) const;
+    };
+
+    /**
+     * Hash of the key (FNV-1a over parameter bytes, seeded with hash of the type).
+     */
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    std::unordered_map<Key, std::weak_ptr<const StaticMesh3D>, KeyHash> _meshes; // Meshes built so far
+    Stats _stats; // Hit / miss statistics
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,154 @@
+// STL
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Project
+#include "meshFile.h"
+#include "meshProcessing.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+const char MESH_FILE_MAGIC[4] = { 'S', 'M', 'S', 'H' };
+
+size_t alignSize(size_t size)
+{
+    return (size + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+// Hashes header (with zeroed header hash) and index ranges following it, blobs are left out, so that opening does not touch their pages
+uint64_t hashHeader(const unsigned char* data)
+{
+    MeshFileHeader header;
+    memcpy(&header, data, sizeof(header));
+    header.headerHash = 0;
+
+    auto hash = FNV_OFFSET_BASIS;
+    const auto hashBytes = [&hash](const unsigned char* bytes, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+    };
+    hashBytes(reinterpret_cast<const unsigned char*>(&header), sizeof(header));
+    hashBytes(data + sizeof(header), sizeof(MeshFileRange) * header.numIndexRanges);
+    return hash;
+}
+
+} // namespace
+
+bool MeshFile::save(const std::string& fileName, MeshFileHeader header, const MeshFileRange* ranges, const void* vertexData, const void* indexData)
+{
+    const auto rangesSize = sizeof(MeshFileRange) * header.numIndexRanges;
+    const auto vertexDataSize = static_cast<size_t>(header.numVertices) * header.vertexByteSize;
+    const auto indexDataSize = static_cast<size_t>(header.numIndices) * header.indexByteSize;
+    const auto vertexDataOffset = alignSize(sizeof(MeshFileHeader) + rangesSize);
+    const auto indexDataOffset = alignSize(vertexDataOffset + vertexDataSize);
+    const auto fileSize = alignSize(indexDataOffset + indexDataSize);
+    if (fileSize > UINT32_MAX)
+    {
+        std::cerr << "Mesh is too large for mesh file " << fileName << "!" << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> contents(fileSize, 0);
+    memcpy(contents.data() + sizeof(MeshFileHeader), ranges, rangesSize);
+    memcpy(contents.data() + vertexDataOffset, vertexData, vertexDataSize);
+    memcpy(contents.data() + indexDataOffset, indexData, indexDataSize);
+
+    memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+    header.version = MESH_FILE_VERSION;
+    header.fileSize = static_cast<uint32_t>(fileSize);
+    header.vertexDataOffset = static_cast<uint32_t>(vertexDataOffset);
+    header.indexDataOffset = static_cast<uint32_t>(indexDataOffset);
+    memcpy(contents.data(), &header, sizeof(header));
+    header.headerHash = hashHeader(contents.data());
+    memcpy(contents.data(), &header, sizeof(header));
+
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Could not open mesh file " << fileName << " for writing!" << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+    return file.good();
+}
+
+bool MeshFile::open(const std::string& fileName, uint64_t keyHash)
+{
+    if (!_file.open(fileName)) {
+        return false;
+    }
+
+    const auto fileSize = _file.getSize();
+    if (fileSize < sizeof(MeshFileHeader) || fileSize % MESH_FILE_ALIGNMENT != 0)
+    {
+        std::cerr << "File " << fileName << " is not a valid mesh file!" << std::endl;
+        _file.close();
+        return false;
+    }
+
+    const auto& header = getHeader();
+    if (memcmp(header.magic, MESH_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != MESH_FILE_VERSION || header.keyHash != keyHash)
+    {
+        // Files of older versions or other generator parameters are just stale, they get overwritten
+        _file.close();
+        return false;
+    }
+
+    // Ranges are hashed together with the header, so they must fit before the vertex blob first
+    const auto rangesEnd = sizeof(MeshFileHeader) + sizeof(MeshFileRange) * static_cast<size_t>(header.numIndexRanges);
+    const auto vertexDataEnd = header.vertexDataOffset + static_cast<size_t>(header.numVertices) * header.vertexByteSize;
+    const auto indexDataEnd = header.indexDataOffset + static_cast<size_t>(header.numIndices) * header.indexByteSize;
+    const auto isLayoutValid = header.fileSize == fileSize && header.vertexDataOffset % MESH_FILE_ALIGNMENT == 0
+        && header.indexDataOffset % MESH_FILE_ALIGNMENT == 0 && rangesEnd <= header.vertexDataOffset
+        && vertexDataEnd <= header.indexDataOffset && indexDataEnd <= fileSize;
+    if (!isLayoutValid || hashHeader(_file.getData()) != header.headerHash)
+    {
+        std::cerr << "Mesh file " << fileName << " is corrupted!" << std::endl;
+        _file.close();
+        return false;
+    }
+
+    return true;
+}
+
+const MeshFileHeader& MeshFile::getHeader() const
+{
+    return *reinterpret_cast<const MeshFileHeader*>(_file.getData());
+}
+
+const MeshFileRange* MeshFile::getIndexRanges() const
+{
+    return reinterpret_cast<const MeshFileRange*>(_file.getData() + sizeof(MeshFileHeader));
+}
+
+const void* MeshFile::getVertexData() const
+{
+    return _file.getData() + getHeader().vertexDataOffset;
+}
+
+const void* MeshFile::getIndexData() const
+{
+    return _file.getData() + getHeader().indexDataOffset;
+}
+
+uint64_t MeshFile::hashKey(const std::vector<unsigned char>& key)
+{
+    auto hash = FNV_OFFSET_BASIS;
+    for (const auto byte : key)
+    {
+        hash ^= byte;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,117 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Project
+#include "mappedFile.h"
+
+namespace static_meshes_3D {
+
+const uint32_t MESH_FILE_VERSION = 2; // Version of the mesh file format, bump it whenever format or any generator output changes
+const size_t MESH_FILE_ALIGNMENT = 64; // Alignment of the blobs in mesh file (and of the file size)
+
+// Flags of vertex attributes present in mesh file
+const uint32_t MESH_FILE_POSITIONS = 1;
+const uint32_t MESH_FILE_TEXTURE_COORDINATES = 2;
+const uint32_t MESH_FILE_NORMALS = 4;
+
+/**
+ * Header of binary mesh file. It's followed by array of MeshFileRange structures, vertex blob and index blob,
+ * each of them starting at multiple of MESH_FILE_ALIGNMENT. Blobs hold data exactly as they are uploaded to the GPU.
+ */
+struct MeshFileHeader
+{
+    char magic[4]; // Always SMSH
+    uint32_t version; // Version of the file format
+    uint32_t attributeFlags; // Present vertex attributes (MESH_FILE_POSITIONS | MESH_FILE_TEXTURE_COORDINATES | MESH_FILE_NORMALS)
+    uint32_t vertexStorage; // VertexStorage of the vertex blob
+    uint32_t numVertices; // Number of vertices
+    uint32_t vertexByteSize; // Byte size of one vertex
+    uint32_t numIndices; // Number of indices (triangle list)
+    uint32_t indexByteSize; // Byte size of one index (2 or 4)
+    uint32_t numIndexRanges; // Number of index ranges
+    uint32_t fileSize; // Byte size of the whole file (detects truncated writes)
+    uint64_t keyHash; // Hash of the generator key, that the mesh was generated with (0 if none)
+    uint64_t headerHash; // Hash of the header (with this field zeroed) and the index ranges
+    uint32_t vertexDataOffset; // Offset of the vertex blob from the beginning of the file
+    uint32_t indexDataOffset; // Offset of the index blob from the beginning of the file
+};
+
+static_assert(sizeof(MeshFileHeader) == MESH_FILE_ALIGNMENT, "Mesh file header must fill exactly one alignment block");
+
+/**
+ * Index range of mesh stored in mesh file.
+ */
+struct MeshFileRange
+{
+    int32_t firstIndex; // First index of the range
+    int32_t numIndices; // Number of indices in the range
+    float error; // Geometric error of the range (LOD error), 0 if not known
+    uint32_t reserved; // Always 0
+};
+
+/**
+ * Memory-mapped binary mesh file. Opening validates version, file size and hash of the header and index ranges only,
+ * blobs are neither parsed nor hashed (so that their pages are not touched before upload) and can be handed straight
+ * to glBufferData.
+ */
+class MeshFile
+{
+public:
+    /**
+     * Writes mesh file. Magic, version, offsets, file size and hash of the header are filled in.
+     *
+     * @param fileName    Path to the file
+     * @param header      Header with attributes, counts and key hash
+     * @param ranges      Index ranges (header.numIndexRanges of them)
+     * @param vertexData  Vertex blob (header.numVertices * header.vertexByteSize bytes)
+     * @param indexData   Index blob (header.numIndices * header.indexByteSize bytes)
+     *
+     * @return True, if file has been written, false otherwise.
+     */
+    static bool save(const std::string& fileName, MeshFileHeader header, const MeshFileRange* ranges, const void* vertexData, const void* indexData);
+
+    /**
+     * Maps mesh file and validates it.
+     *
+     * @param fileName  Path to the file
+     * @param keyHash   Expected hash of the generator key
+     *
+     * @return True, if file is a valid mesh file generated with given key, false otherwise.
+     */
+    bool open(const std::string& fileName, uint64_t keyHash);
+
+    /**
+     * Gets header of the open file.
+     */
+    const MeshFileHeader& getHeader() const;
+
+    /**
+     * Gets index ranges of the open file.
+     */
+    const MeshFileRange* getIndexRanges() const;
+
+    /**
+     * Gets vertex blob of the open file (aligned to MESH_FILE_ALIGNMENT).
+     */
+    const void* getVertexData() const;
+
+    /**
+     * Gets index blob of the open file (aligned to MESH_FILE_ALIGNMENT).
+     */
+    const void* getIndexData() const;
+
+    /**
+     * Computes hash of the key, that a generator identifies its output with (FNV-1a).
+     */
+    static uint64_t hashKey(const std::vector<unsigned char>& key);
+
+private:
+    MappedFile _file; // Mapped file contents
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,244 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// GLM
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "meshNormals.h"
+#include "meshProcessing.h"
+#include "vertexWelder.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+// Runs function(first, end) for equal shares of items in multiple threads
+template<typename Function>
+void parallelFor(size_t numItems, size_t numThreads, Function&& function)
+{
+    const auto chunkSize = (numItems + numThreads - 1) / numThreads;
+    runInThreads(numThreads, [&](size_t thread) {
+        const auto first = std::min(numItems, thread * chunkSize);
+        function(first, std::min(numItems, first + chunkSize));
+    });
+}
+
+// Gets angle at corner p0 of triangle p0, p1, p2
+float cornerAngle(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+{
+    const auto e1 = p1 - p0;
+    const auto e2 = p2 - p0;
+    const auto lengths = glm::length(e1) * glm::length(e2);
+    return lengths > 0.0f ? std::acos(glm::clamp(glm::dot(e1, e2) / lengths, -1.0f, 1.0f)) : 0.0f;
+}
+
+// Gets any unit vector orthogonal to given unit vector
+glm::vec3 orthogonalVector(const glm::vec3& v)
+{
+    const auto axis = std::abs(v.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    const auto orthogonal = glm::cross(v, axis);
+    const auto length = glm::length(orthogonal);
+    return length > 0.0f ? orthogonal / length : glm::vec3(1.0f, 0.0f, 0.0f);
+}
+
+/**
+ * Corners grouped by key (position or vertex) - corners of key k are corners[offsets[k]] to corners[offsets[k + 1] - 1],
+ * in increasing order.
+ */
+struct CornerAdjacency
+{
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> corners;
+
+    CornerAdjacency(const unsigned int* cornerKeys, size_t numCorners, size_t numKeys)
+        : offsets(numKeys + 1, 0)
+        , corners(numCorners)
+    {
+        for (size_t c = 0; c < numCorners; c++) {
+            offsets[cornerKeys[c] + 1]++;
+        }
+        for (size_t k = 0; k < numKeys; k++) {
+            offsets[k + 1] += offsets[k];
+        }
+
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t c = 0; c < numCorners; c++) {
+            corners[fill[cornerKeys[c]]++] = static_cast<unsigned int>(c);
+        }
+    }
+};
+
+// Number of words of split vertex key - vertex index and bits of its generated normal, vertices are split by these keys
+const size_t SPLIT_KEY_WORDS = 4;
+
+// Gets bits of normal component, both zeros have the same bits
+uint32_t normalComponentKey(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits == 0x80000000u ? 0u : bits;
+}
+
+} // namespace
+
+size_t generateNormals(const glm::vec3* positions, size_t numVertices, const unsigned int* indices, size_t numIndices, float creaseAngle,
+    std::vector<glm::vec3>& normals, std::vector<unsigned int>& vertexSources, std::vector<unsigned int>& splitIndices)
+{
+    normals.clear();
+    vertexSources.clear();
+    splitIndices.clear();
+    const auto numTriangles = numIndices / 3;
+    if (numTriangles == 0 || numVertices == 0) {
+        return 0;
+    }
+
+    // Unit triangle normals and corner weights (triangle area times corner angle)
+    const auto numThreads = getNumThreads(numTriangles, PARALLEL_NORMALS_MIN_TRIANGLES);
+    std::vector<glm::vec3> triangleNormals(numTriangles);
+    std::vector<float> cornerWeights(numTriangles * 3);
+    parallelFor(numTriangles, numThreads, [&](size_t first, size_t end) {
+        for (auto t = first; t < end; t++)
+        {
+            const auto& p0 = positions[indices[t * 3]];
+            const auto& p1 = positions[indices[t * 3 + 1]];
+            const auto& p2 = positions[indices[t * 3 + 2]];
+            const auto cross = glm::cross(p1 - p0, p2 - p0);
+            const auto doubleArea = glm::length(cross);
+            triangleNormals[t] = doubleArea > 0.0f ? cross / doubleArea : glm::vec3(0.0f);
+            cornerWeights[t * 3] = doubleArea * cornerAngle(p0, p1, p2);
+            cornerWeights[t * 3 + 1] = doubleArea * cornerAngle(p1, p2, p0);
+            cornerWeights[t * 3 + 2] = doubleArea * cornerAngle(p2, p0, p1);
+        }
+    });
+
+    // Corners around every distinct position, so that normals ignore attribute seams
+    std::vector<unsigned int> positionIds;
+    const auto numPositions = weldVertices(reinterpret_cast<const unsigned char*>(positions), numVertices, sizeof(glm::vec3), 0.0f, positionIds);
+    const auto numCorners = numTriangles * 3;
+    std::vector<unsigned int> cornerPositions(numCorners);
+    for (size_t c = 0; c < numCorners; c++) {
+        cornerPositions[c] = positionIds[indices[c]];
+    }
+    const CornerAdjacency adjacency(cornerPositions.data(), numCorners, numPositions);
+
+    // Every thread sums normals of its own corners, corners are visited in the same order for every corner of a position,
+    // so corners summing the same triangles get bitwise equal normals
+    const auto minCosine = std::cos(std::min(creaseAngle, glm::pi<float>()));
+    std::vector<glm::vec3> cornerNormals(numCorners);
+    std::vector<uint32_t> splitKeys(numCorners * SPLIT_KEY_WORDS);
+    parallelFor(numCorners, numThreads, [&](size_t first, size_t end) {
+        for (auto c = first; c < end; c++)
+        {
+            const auto& triangleNormal = triangleNormals[c / 3];
+            const auto adjacentBegin = adjacency.corners.begin() + adjacency.offsets[cornerPositions[c]];
+            const auto adjacentEnd = adjacency.corners.begin() + adjacency.offsets[cornerPositions[c] + 1];
+            auto normal = glm::vec3(0.0f);
+            for (auto adjacent = adjacentBegin; adjacent != adjacentEnd; ++adjacent)
+            {
+                const auto& adjacentNormal = triangleNormals[*adjacent / 3];
+                if (glm::dot(adjacentNormal, triangleNormal) >= minCosine) {
+                    normal += adjacentNormal * cornerWeights[*adjacent];
+                }
+            }
+
+            // Degenerate triangle has no normal to compare with, it takes normal of all triangles around
+            if (normal == glm::vec3(0.0f))
+            {
+                for (auto adjacent = adjacentBegin; adjacent != adjacentEnd; ++adjacent) {
+                    normal += triangleNormals[*adjacent / 3] * cornerWeights[*adjacent];
+                }
+            }
+
+            const auto length = glm::length(normal);
+            cornerNormals[c] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+            const auto splitKey = splitKeys.data() + c * SPLIT_KEY_WORDS;
+            splitKey[0] = indices[c];
+            for (auto i = 0; i < 3; i++) {
+                splitKey[i + 1] = normalComponentKey(cornerNormals[c][i]);
+            }
+        }
+    });
+
+    // Corners of the same vertex with equal normals stay one vertex
+    std::vector<size_t> firstCorners;
+    const auto numSplitVertices = deduplicateKeys(splitKeys.data(), numCorners, SPLIT_KEY_WORDS, splitIndices, firstCorners);
+    normals.resize(numSplitVertices);
+    vertexSources.resize(numSplitVertices);
+    for (size_t v = 0; v < numSplitVertices; v++)
+    {
+        normals[v] = cornerNormals[firstCorners[v]];
+        vertexSources[v] = indices[firstCorners[v]];
+    }
+
+    return numSplitVertices;
+}
+
+void generateTangents(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t numVertices,
+    const unsigned int* indices, size_t numIndices, std::vector<glm::vec4>& tangents)
+{
+    tangents.assign(numVertices, glm::vec4(0.0f));
+    const auto numTriangles = numIndices / 3;
+    const auto numThreads = getNumThreads(numTriangles, PARALLEL_NORMALS_MIN_TRIANGLES);
+
+    // Triangle tangents and bitangents - derivatives of position by texture coordinates u and v
+    std::vector<glm::vec3> triangleTangents(numTriangles), triangleBitangents(numTriangles);
+    parallelFor(numTriangles, numThreads, [&](size_t first, size_t end) {
+        for (auto t = first; t < end; t++)
+        {
+            const auto i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+            const auto e1 = positions[i1] - positions[i0];
+            const auto e2 = positions[i2] - positions[i0];
+            const auto uv1 = textureCoordinates[i1] - textureCoordinates[i0];
+            const auto uv2 = textureCoordinates[i2] - textureCoordinates[i0];
+            const auto determinant = uv1.x * uv2.y - uv2.x * uv1.y;
+            if (determinant == 0.0f)
+            {
+                triangleTangents[t] = triangleBitangents[t] = glm::vec3(0.0f);
+                continue;
+            }
+
+            // Only directions matter, so multiplying by sign of determinant is enough instead of dividing by it
+            const auto sign = determinant > 0.0f ? 1.0f : -1.0f;
+            triangleTangents[t] = (e1 * uv2.y - e2 * uv1.y) * sign;
+            triangleBitangents[t] = (e2 * uv1.x - e1 * uv2.x) * sign;
+        }
+    });
+
+    // Every thread gathers tangents of its own vertices from triangles around them
+    const CornerAdjacency adjacency(indices, numTriangles * 3, numVertices);
+    parallelFor(numVertices, numThreads, [&](size_t first, size_t end) {
+        for (auto v = first; v < end; v++)
+        {
+            const auto& normal = normals[v];
+            auto tangent = glm::vec3(0.0f);
+            auto bitangent = glm::vec3(0.0f);
+            for (auto a = adjacency.offsets[v]; a < adjacency.offsets[v + 1]; a++)
+            {
+                const auto corner = adjacency.corners[a];
+                const auto t = corner / 3;
+                const auto k = corner % 3;
+                const auto weight = cornerAngle(positions[indices[t * 3 + k]], positions[indices[t * 3 + (k + 1) % 3]], positions[indices[t * 3 + (k + 2) % 3]]);
+                const auto projectedTangent = triangleTangents[t] - normal * glm::dot(normal, triangleTangents[t]);
+                const auto projectedBitangent = triangleBitangents[t] - normal * glm::dot(normal, triangleBitangents[t]);
+                const auto tangentLength = glm::length(projectedTangent);
+                const auto bitangentLength = glm::length(projectedBitangent);
+                if (tangentLength > 0.0f) {
+                    tangent += projectedTangent * (weight / tangentLength);
+                }
+                if (bitangentLength > 0.0f) {
+                    bitangent += projectedBitangent * (weight / bitangentLength);
+                }
+            }
+
+            tangent -= normal * glm::dot(normal, tangent);
+            const auto length = glm::length(tangent);
+            const auto unitTangent = length > 0.0f ? tangent / length : orthogonalVector(normal);
+            tangents[v] = glm::vec4(unitTangent, glm::dot(glm::cross(normal, unitTangent), bitangent) < 0.0f ? -1.0f : 1.0f);
+        }
+    });
+}
+
+} // namespace static_meshes_3D
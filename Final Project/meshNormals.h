@@ -0,0 +1,60 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+namespace static_meshes_3D {
+
+/**
+ * Minimal number of triangles, for which normals and tangents are generated in multiple threads.
+ */
+const size_t PARALLEL_NORMALS_MIN_TRIANGLES = 16384;
+
+/**
+ * Default crease angle (in radians) - faces meeting at sharper angle get hard edge between them.
+ */
+const float DEFAULT_CREASE_ANGLE = glm::radians(45.0f);
+
+/**
+ * Generates smooth vertex normals of indexed triangle list. Normal of a triangle corner is the sum of normals of triangles
+ * around its position, weighted by triangle area and corner angle. Only triangles, whose normals differ from the normal
+ * of the corner triangle by at most crease angle, are summed, so that sharp edges stay hard. Vertices are compared by position,
+ * so normals are smooth across texture coordinate seams too. Vertex with corners getting different normals is split into
+ * several vertices. Large meshes are processed in multiple threads, result does not depend on the number of threads.
+ *
+ * @param positions      Vertex positions
+ * @param numVertices    Number of vertices
+ * @param indices        Triangle list indices
+ * @param numIndices     Number of indices (multiple of 3)
+ * @param creaseAngle    Maximal angle (in radians) of smoothly joined triangles (pi or more for all-smooth normals)
+ * @param normals        Output vertex normals
+ * @param vertexSources  Output index of the source vertex of every output vertex (to copy its other attributes)
+ * @param splitIndices   Output triangle list indices referencing output vertices (triangle order is kept)
+ *
+ * @return Number of output vertices.
+ */
+size_t generateNormals(const glm::vec3* positions, size_t numVertices, const unsigned int* indices, size_t numIndices, float creaseAngle,
+    std::vector<glm::vec3>& normals, std::vector<unsigned int>& vertexSources, std::vector<unsigned int>& splitIndices);
+
+/**
+ * Generates tangent frames of indexed triangle list in MikkTSpace convention - tangent points in the direction of increasing
+ * texture coordinate u, it is orthogonal to the vertex normal and w holds the sign of bitangent, which is w * cross(normal, tangent).
+ * Triangle tangents are projected to the tangent plane of every corner normal and summed weighted by corner angle.
+ * Vertices without usable texture coordinates get any tangent orthogonal to the normal.
+ *
+ * @param positions           Vertex positions
+ * @param textureCoordinates  Vertex texture coordinates
+ * @param normals             Vertex normals (unit length)
+ * @param numVertices         Number of vertices
+ * @param indices             Triangle list indices
+ * @param numIndices          Number of indices (multiple of 3)
+ * @param tangents            Output vertex tangents (xyz unit tangent, w bitangent sign)
+ */
+void generateTangents(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t numVertices,
+    const unsigned int* indices, size_t numIndices, std::vector<glm::vec4>& tangents);
+
+} // namespace static_meshes_3D
@@ -0,0 +1,300 @@
+// STL
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+// Project
+#include "meshOptimizer.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+const unsigned int UNUSED_VERTEX = ~0u;
+
+/**
+ * Vertex to triangles adjacency in compressed form.
+ */
+struct TriangleAdjacency
+{
+    std::vector<unsigned int> offsets; // First entry of every vertex in triangles (numVertices + 1 entries)
+    std::vector<unsigned int> triangles; // Triangles of all vertices
+
+    TriangleAdjacency(const unsigned int* indices, size_t numIndices, size_t numVertices)
+        : offsets(numVertices + 1, 0)
+        , triangles(numIndices)
+    {
+        for (size_t i = 0; i < numIndices; i++) {
+            offsets[indices[i] + 1]++;
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < numIndices; i++) {
+            triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+    }
+};
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t numIndices, size_t numVertices, int cacheSize)
+{
+    VertexCacheStats stats;
+    if (numIndices < 3) {
+        return stats;
+    }
+
+    // FIFO cache is represented by timestamps - vertex is in the cache, if it entered not more than cacheSize misses ago
+    std::vector<size_t> cacheTimestamps(numVertices, 0);
+    std::vector<bool> isUsed(numVertices, false);
+    size_t numMisses = 0;
+    size_t numUsedVertices = 0;
+    for (size_t i = 0; i < numIndices; i++)
+    {
+        const auto vertex = indices[i];
+        if (cacheTimestamps[vertex] == 0 || numMisses - cacheTimestamps[vertex] + 1 > static_cast<size_t>(cacheSize))
+        {
+            numMisses++;
+            cacheTimestamps[vertex] = numMisses;
+        }
+
+        if (!isUsed[vertex])
+        {
+            isUsed[vertex] = true;
+            numUsedVertices++;
+        }
+    }
+
+    stats.acmr = float(numMisses) / float(numIndices / 3);
+    stats.atvr = numUsedVertices > 0 ? float(numMisses) / float(numUsedVertices) : 0.0f;
+    return stats;
+}
+
+std::vector<size_t> optimizeVertexCache(unsigned int* indices, size_t numIndices, size_t numVertices, int cacheSize)
+{
+    std::vector<size_t> clusterOffsets;
+    const auto numTriangles = numIndices / 3;
+    if (numTriangles == 0) {
+        return clusterOffsets;
+    }
+
+    const TriangleAdjacency adjacency(indices, numIndices, numVertices);
+    std::vector<unsigned int> liveTriangles(numVertices);
+    for (size_t v = 0; v < numVertices; v++) {
+        liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    std::vector<size_t> cacheTimestamps(numVertices, 0);
+    std::vector<bool> isEmitted(numTriangles, false);
+    std::vector<unsigned int> deadEndStack;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(numIndices);
+
+    size_t timestamp = cacheSize + 1;
+    size_t cursor = 0;
+    auto fanningVertex = static_cast<long long>(0);
+    auto isClusterStart = true;
+
+    while (fanningVertex >= 0)
+    {
+        // Emit all not yet emitted triangles of the fanning vertex
+        candidates.clear();
+        const auto vertex = static_cast<unsigned int>(fanningVertex);
+        for (auto a = adjacency.offsets[vertex]; a < adjacency.offsets[vertex + 1]; a++)
+        {
+            const auto triangle = adjacency.triangles[a];
+            if (isEmitted[triangle]) {
+                continue;
+            }
+
+            if (isClusterStart)
+            {
+                clusterOffsets.push_back(result.size());
+                isClusterStart = false;
+            }
+
+            for (auto c = 0; c < 3; c++)
+            {
+                const auto triangleVertex = indices[triangle * 3 + c];
+                result.push_back(triangleVertex);
+                deadEndStack.push_back(triangleVertex);
+                candidates.push_back(triangleVertex);
+                liveTriangles[triangleVertex]--;
+                if (timestamp - cacheTimestamps[triangleVertex] > static_cast<size_t>(cacheSize)) {
+                    cacheTimestamps[triangleVertex] = timestamp++;
+                }
+            }
+
+            isEmitted[triangle] = true;
+        }
+
+        // Choose next fanning vertex - the oldest candidate still in cache after emitting its triangles
+        auto nextVertex = static_cast<long long>(-1);
+        auto bestPriority = static_cast<long long>(-1);
+        for (const auto candidate : candidates)
+        {
+            if (liveTriangles[candidate] == 0) {
+                continue;
+            }
+
+            auto priority = static_cast<long long>(0);
+            const auto age = static_cast<long long>(timestamp - cacheTimestamps[candidate]);
+            if (age + 2 * static_cast<long long>(liveTriangles[candidate]) <= cacheSize) {
+                priority = age;
+            }
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = candidate;
+            }
+        }
+
+        // Dead end - use recently referenced vertices, or just next vertex with live triangles, new cluster starts there
+        if (nextVertex == -1)
+        {
+            isClusterStart = true;
+            while (!deadEndStack.empty() && nextVertex == -1)
+            {
+                const auto deadEndVertex = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveTriangles[deadEndVertex] > 0) {
+                    nextVertex = deadEndVertex;
+                }
+            }
+
+            while (nextVertex == -1 && cursor < numVertices)
+            {
+                if (liveTriangles[cursor] > 0) {
+                    nextVertex = static_cast<long long>(cursor);
+                }
+                cursor++;
+            }
+        }
+
+        fanningVertex = nextVertex;
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+    return clusterOffsets;
+}
+
+int optimizeOverdraw(unsigned int* indices, size_t numIndices, const glm::vec3* positions, const std::vector<size_t>& clusterOffsets)
+{
+    const auto numClusters = clusterOffsets.size();
+    if (numClusters < 2 || positions == nullptr) {
+        return static_cast<int>(numClusters);
+    }
+
+    // Area weighted centroid of the whole mesh
+    glm::vec3 meshCentroid(0.0f);
+    auto meshArea = 0.0f;
+    for (size_t i = 0; i + 2 < numIndices; i += 3)
+    {
+        const auto& p0 = positions[indices[i]];
+        const auto& p1 = positions[indices[i + 1]];
+        const auto& p2 = positions[indices[i + 2]];
+        const auto area = glm::length(glm::cross(p1 - p0, p2 - p0));
+        meshCentroid += (p0 + p1 + p2) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    // Sort key of a cluster - how much is it facing out from the mesh centroid
+    std::vector<float> clusterSortKeys(numClusters);
+    for (size_t c = 0; c < numClusters; c++)
+    {
+        const auto clusterEnd = c + 1 < numClusters ? clusterOffsets[c + 1] : numIndices;
+        glm::vec3 clusterCentroid(0.0f);
+        glm::vec3 clusterNormal(0.0f);
+        auto clusterArea = 0.0f;
+        for (auto i = clusterOffsets[c]; i < clusterEnd; i += 3)
+        {
+            const auto& p0 = positions[indices[i]];
+            const auto& p1 = positions[indices[i + 1]];
+            const auto& p2 = positions[indices[i + 2]];
+            const auto normal = glm::cross(p1 - p0, p2 - p0);
+            const auto area = glm::length(normal);
+            clusterCentroid += (p0 + p1 + p2) * (area / 3.0f);
+            clusterNormal += normal;
+            clusterArea += area;
+        }
+
+        if (clusterArea > 0.0f) {
+            clusterCentroid /= clusterArea;
+        }
+        const auto normalLength = glm::length(clusterNormal);
+        clusterSortKeys[c] = normalLength > 0.0f ? glm::dot(clusterCentroid - meshCentroid, clusterNormal / normalLength) : 0.0f;
+    }
+
+    std::vector<size_t> clusterOrder(numClusters);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), size_t(0));
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](size_t a, size_t b) {
+        return clusterSortKeys[a] > clusterSortKeys[b];
+    });
+
+    std::vector<unsigned int> result;
+    result.reserve(numIndices);
+    for (const auto c : clusterOrder)
+    {
+        const auto clusterEnd = c + 1 < numClusters ? clusterOffsets[c + 1] : numIndices;
+        result.insert(result.end(), indices + clusterOffsets[c], indices + clusterEnd);
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+    return static_cast<int>(numClusters);
+}
+
+std::vector<unsigned int> optimizeVertexFetch(unsigned int* indices, size_t numIndices, size_t numVertices)
+{
+    std::vector<unsigned int> remap(numVertices, UNUSED_VERTEX);
+    unsigned int nextVertex = 0;
+    for (size_t i = 0; i < numIndices; i++)
+    {
+        auto& newIndex = remap[indices[i]];
+        if (newIndex == UNUSED_VERTEX) {
+            newIndex = nextVertex++;
+        }
+
+        indices[i] = newIndex;
+    }
+
+    // Keep unreferenced vertices, just move them to the end
+    for (auto& newIndex : remap)
+    {
+        if (newIndex == UNUSED_VERTEX) {
+            newIndex = nextVertex++;
+        }
+    }
+
+    return remap;
+}
+
+void remapVertices(unsigned char* vertices, size_t numVertices, size_t vertexByteSize, const std::vector<unsigned int>& remap)
+{
+    std::vector<unsigned char> reordered(numVertices * vertexByteSize);
+    for (size_t i = 0; i < numVertices; i++) {
+        memcpy(reordered.data() + remap[i] * vertexByteSize, vertices + i * vertexByteSize, vertexByteSize);
+    }
+
+    memcpy(vertices, reordered.data(), reordered.size());
+}
+
+MeshOptimizationReport optimizeMesh(unsigned int* indices, size_t numIndices, const glm::vec3* positions, size_t numVertices, std::vector<unsigned int>& remap)
+{
+    MeshOptimizationReport report;
+    report.before = analyzeVertexCache(indices, numIndices, numVertices);
+
+    const auto clusterOffsets = optimizeVertexCache(indices, numIndices, numVertices);
+    report.numClusters = optimizeOverdraw(indices, numIndices, positions, clusterOffsets);
+    remap = optimizeVertexFetch(indices, numIndices, numVertices);
+
+    report.after = analyzeVertexCache(indices, numIndices, numVertices);
+    return report;
+}
+
+} // namespace static_meshes_3D
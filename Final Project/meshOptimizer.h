@@ -0,0 +1,106 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+namespace static_meshes_3D {
+
+/**
+ * Post-transform vertex cache efficiency of a triangle list.
+ */
+struct VertexCacheStats
+{
+    float acmr = 0.0f; // Average cache miss ratio - transformed vertices per triangle (0.5 - 3, lower is better)
+    float atvr = 0.0f; // Average transform to vertex ratio - transformed vertices per used vertex (1 is optimal)
+};
+
+/**
+ * Report of the index / vertex order optimization of one mesh.
+ */
+struct MeshOptimizationReport
+{
+    VertexCacheStats before; // Cache efficiency before optimization
+    VertexCacheStats after; // Cache efficiency after optimization
+    int numClusters = 0; // Number of triangle clusters sorted for overdraw
+};
+
+/**
+ * Size of simulated FIFO post-transform vertex cache.
+ */
+const int VERTEX_CACHE_SIZE = 16;
+
+/**
+ * Analyzes post-transform vertex cache efficiency of triangle list by simulating FIFO cache.
+ *
+ * @param indices      Triangle list indices
+ * @param numIndices   Number of indices (multiple of 3)
+ * @param numVertices  Number of vertices referenced by indices
+ * @param cacheSize    Simulated cache size
+ */
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t numIndices, size_t numVertices, int cacheSize = VERTEX_CACHE_SIZE);
+
+/**
+ * Reorders triangles for post-transform vertex cache (Tipsify, Sander et al. 2007), in place.
+ *
+ * @param indices      Triangle list indices
+ * @param numIndices   Number of indices (multiple of 3)
+ * @param numVertices  Number of vertices referenced by indices
+ * @param cacheSize    Targeted cache size
+ *
+ * @return Offsets (in indices) of the cluster boundaries - dead ends, where fanning has to jump elsewhere (first is always 0).
+ */
+std::vector<size_t> optimizeVertexCache(unsigned int* indices, size_t numIndices, size_t numVertices, int cacheSize = VERTEX_CACHE_SIZE);
+
+/**
+ * Reorders triangle clusters to reduce overdraw - clusters facing out of the mesh center go first, in place.
+ * Order of triangles inside clusters is kept, so vertex cache efficiency is preserved.
+ *
+ * @param indices           Triangle list indices
+ * @param numIndices        Number of indices (multiple of 3)
+ * @param positions         Vertex positions
+ * @param clusterOffsets    Cluster boundaries as returned by optimizeVertexCache
+ *
+ * @return Number of sorted clusters.
+ */
+int optimizeOverdraw(unsigned int* indices, size_t numIndices, const glm::vec3* positions, const std::vector<size_t>& clusterOffsets);
+
+/**
+ * Computes vertex order for fetch locality (vertices in order of first use by indices) and remaps indices, in place.
+ * Vertices not referenced by any index are moved to the end.
+ *
+ * @param indices      Triangle list indices
+ * @param numIndices   Number of indices
+ * @param numVertices  Number of vertices
+ *
+ * @return Remap table, new vertex index for every old vertex index.
+ */
+std::vector<unsigned int> optimizeVertexFetch(unsigned int* indices, size_t numIndices, size_t numVertices);
+
+/**
+ * Reorders interleaved vertex records according to remap table.
+ *
+ * @param vertices        Interleaved vertex data, reordered in place
+ * @param numVertices     Number of vertices
+ * @param vertexByteSize  Byte size of one vertex record
+ * @param remap           Remap table from optimizeVertexFetch
+ */
+void remapVertices(unsigned char* vertices, size_t numVertices, size_t vertexByteSize, const std::vector<unsigned int>& remap);
+
+/**
+ * Runs the whole optimization pipeline on triangle list - vertex cache, overdraw (if positions are given) and vertex fetch.
+ *
+ * @param indices          Triangle list indices, reordered in place
+ * @param numIndices       Number of indices (multiple of 3)
+ * @param positions        Vertex positions (or nullptr to skip overdraw optimization)
+ * @param numVertices      Number of vertices
+ * @param remap            Output remap table for vertex data (see remapVertices)
+ *
+ * @return Report with cache efficiency before and after optimization.
+ */
+MeshOptimizationReport optimizeMesh(unsigned int* indices, size_t numIndices, const glm::vec3* positions, size_t numVertices, std::vector<unsigned int>& remap);
+
+} // namespace static_meshes_3D
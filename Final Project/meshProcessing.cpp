@@ -0,0 +1,59 @@
+// STL
+#include <cstring>
+#include <limits>
+
+// Project
+#include "meshProcessing.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+// Gets slot hash of a key (FNV-1a over its words, high bits folded into the low ones used by the table)
+uint64_t hashKey(const uint32_t* key, size_t wordsPerKey)
+{
+    auto hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < wordsPerKey; i++)
+    {
+        hash ^= key[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash ^ (hash >> 32);
+}
+
+} // namespace
+
+size_t deduplicateKeys(const uint32_t* words, size_t numKeys, size_t wordsPerKey, std::vector<unsigned int>& remap, std::vector<size_t>& firstKeys)
+{
+    size_t numSlots = 16;
+    while (numSlots < 2 * numKeys) {
+        numSlots *= 2;
+    }
+
+    const auto noKey = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> slots(numSlots, noKey);
+    remap.resize(numKeys);
+    firstKeys.clear();
+    const auto mask = numSlots - 1;
+    const auto keyByteSize = sizeof(uint32_t) * wordsPerKey;
+    for (size_t k = 0; k < numKeys; k++)
+    {
+        const auto key = words + k * wordsPerKey;
+        auto slot = hashKey(key, wordsPerKey) & mask;
+        while (slots[slot] != noKey && memcmp(words + firstKeys[slots[slot]] * wordsPerKey, key, keyByteSize) != 0) {
+            slot = (slot + 1) & mask;
+        }
+
+        if (slots[slot] == noKey)
+        {
+            slots[slot] = static_cast<unsigned int>(firstKeys.size());
+            firstKeys.push_back(k);
+        }
+        remap[k] = slots[slot];
+    }
+
+    return firstKeys.size();
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,60 @@
+#pragma once
+
+// STL
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace static_meshes_3D {
+
+// 64-bit FNV-1a constants of hashes of mesh data and keys
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+/**
+ * Gets number of threads processing given number of items - all hardware threads for at least minParallelItems items,
+ * one thread (the calling one) for fewer items, that are not worth starting threads.
+ */
+inline size_t getNumThreads(size_t numItems, size_t minParallelItems)
+{
+    return numItems >= minParallelItems ? std::max(size_t(std::thread::hardware_concurrency()), size_t(1)) : size_t(1);
+}
+
+/**
+ * Merges equal keys made of 32-bit words (e.g. triples of indices), keys are compared as integers, so no float rules
+ * (denormals flushed to zero, NaN never equal) apply to them. Keys are looked up in an open-addressing table of distinct
+ * keys (at most half full), distinct keys are numbered in order of their first occurrence.
+ *
+ * @param words        Keys, wordsPerKey words each
+ * @param numKeys      Number of keys
+ * @param wordsPerKey  Number of words of one key
+ * @param remap        Distinct key of every key
+ * @param firstKeys    First occurrence of every distinct key
+ *
+ * @return Number of distinct keys.
+ */
+size_t deduplicateKeys(const uint32_t* words, size_t numKeys, size_t wordsPerKey, std::vector<unsigned int>& remap, std::vector<size_t>& firstKeys);
+
+/**
+ * Runs function(threadIndex) in given number of threads (calling thread is one of them) and waits for all of them.
+ *
+ * @param numThreads  Number of threads (at least 1)
+ * @param function    Function called with thread index (0 to numThreads - 1)
+ */
+template<typename Function>
+void runInThreads(size_t numThreads, Function&& function)
+{
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; t++) {
+        threads.emplace_back(function, t);
+    }
+
+    function(size_t(0));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,554 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+// Project
+#include "meshSimplifier.h"
+#include "meshProcessing.h"
+#include "vertexWelder.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+// Weight of planes perpendicular to boundary edges, relative to squared edge length, keeps outlines in place
+const double BOUNDARY_PLANE_WEIGHT = 10.0;
+
+// Collapses turning normal of any triangle by more than this (cosine) are rejected as flips
+const float MIN_NORMAL_COSINE = 0.2f;
+
+/**
+ * Sum of squared distances from weighted planes, as symmetric 4x4 matrix.
+ */
+struct Quadric
+{
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0; // Quadratic part (normal * normal^T)
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0; // Linear part (normal * distance)
+    double c = 0.0; // Constant part (distance^2)
+    double weight = 0.0; // Sum of plane weights
+
+    void addPlane(const glm::vec3& normal, float distance, double planeWeight)
+    {
+        const double x = normal.x, y = normal.y, z = normal.z, d = distance;
+        a00 += planeWeight * x * x; a01 += planeWeight * x * y; a02 += planeWeight * x * z;
+        a11 += planeWeight * y * y; a12 += planeWeight * y * z; a22 += planeWeight * z * z;
+        b0 += planeWeight * x * d; b1 += planeWeight * y * d; b2 += planeWeight * z * d;
+        c += planeWeight * d * d;
+        weight += planeWeight;
+    }
+
+    void add(const Quadric& other)
+    {
+        a00 += other.a00; a01 += other.a01; a02 += other.a02;
+        a11 += other.a11; a12 += other.a12; a22 += other.a22;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+    }
+
+    // Gets weighted sum of squared distances of the point from the planes
+    double evaluate(const glm::vec3& point) const
+    {
+        const double x = point.x, y = point.y, z = point.z;
+        const auto value = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+            + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(value, 0.0);
+    }
+};
+
+/**
+ * Candidate collapse of one position onto its neighbor.
+ */
+struct Collapse
+{
+    unsigned int from; // Position, that disappears
+    unsigned int to; // Position, that the vertices of the first one collapse onto
+    double cost; // Geometric error squared plus attribute cost
+    double geometricError; // Squared geometric error
+};
+
+// How a position may move
+enum PositionKind : unsigned char
+{
+    MANIFOLD, // Interior of the surface, may collapse along any edge
+    BOUNDARY, // On an open boundary with exactly two boundary edges, may collapse along them only
+    LOCKED // Non-manifold or boundary corner, never collapses
+};
+
+uint64_t edgeKey(unsigned int a, unsigned int b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+// Gets number of triangles sharing the edge (sortedEdges holds one key per triangle edge)
+size_t countEdge(const std::vector<uint64_t>& sortedEdges, unsigned int a, unsigned int b)
+{
+    const auto range = std::equal_range(sortedEdges.begin(), sortedEdges.end(), edgeKey(a, b));
+    return static_cast<size_t>(range.second - range.first);
+}
+
+/**
+ * Mesh being simplified, triangles are kept in position space (welded positions) next to their vertex indices.
+ */
+class Simplifier
+{
+public:
+    Simplifier(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t numVertices,
+        std::vector<unsigned int>& triangles, const SimplificationWeights& weights)
+        : _textureCoordinates(textureCoordinates)
+        , _normals(normals)
+        , _triangles(triangles)
+        , _vertexRemap(numVertices)
+    {
+        _numPositions = weldVertices(reinterpret_cast<const unsigned char*>(positions), numVertices, sizeof(glm::vec3), 0.0f, _positionOfVertex);
+        _positions.resize(_numPositions);
+        for (size_t v = 0; v < numVertices; v++) {
+            _positions[_positionOfVertex[v]] = positions[v];
+        }
+        std::iota(_vertexRemap.begin(), _vertexRemap.end(), 0u);
+
+        // Attribute weights are relative to mesh radius, so that cost of attributes and geometry can be summed
+        auto minimum = glm::vec3(std::numeric_limits<float>::max());
+        auto maximum = -minimum;
+        for (const auto& position : _positions)
+        {
+            minimum = glm::min(minimum, position);
+            maximum = glm::max(maximum, position);
+        }
+        const double radius = _positions.empty() ? 0.0 : glm::length(maximum - minimum) * 0.5f;
+        _textureCoordinateWeight = radius * radius * weights.textureCoordinates * weights.textureCoordinates;
+        _normalWeight = radius * radius * weights.normals * weights.normals;
+
+        removeCollapsedTriangles();
+        initializeQuadrics();
+    }
+
+    /**
+     * Collapses edges in passes, until there are at most given number of triangles or nothing can collapse within the budget.
+     *
+     * @return Largest geometric error of the collapses.
+     */
+    float simplify(size_t targetNumTriangles, float maxError)
+    {
+        const auto maxGeometricError = double(maxError) * double(maxError);
+        double error = 0.0;
+        while (getNumTriangles() > targetNumTriangles)
+        {
+            buildAdjacency();
+            const auto collapses = findCollapses();
+
+            // Collapses of one pass must not touch each other's triangles, every collapse locks its neighborhood
+            std::vector<bool> isTouched(_numPositions, false);
+            auto numTriangles = getNumTriangles();
+            auto numApplied = 0;
+            for (const auto& collapse : collapses)
+            {
+                if (numTriangles <= targetNumTriangles) {
+                    break;
+                }
+                if (isTouched[collapse.from] || isTouched[collapse.to] || collapse.geometricError > maxGeometricError) {
+                    continue;
+                }
+
+                const auto numRemoved = applyCollapse(collapse.from, collapse.to, isTouched);
+                if (numRemoved == 0) {
+                    continue;
+                }
+
+                numTriangles -= numRemoved;
+                error = std::max(error, collapse.geometricError);
+                numApplied++;
+            }
+
+            removeCollapsedTriangles();
+            if (numApplied == 0) {
+                break;
+            }
+        }
+
+        return static_cast<float>(std::sqrt(error));
+    }
+
+private:
+    const glm::vec2* _textureCoordinates; // Vertex texture coordinates (or nullptr)
+    const glm::vec3* _normals; // Vertex normals (or nullptr)
+    std::vector<unsigned int>& _triangles; // Triangle list being simplified (vertex indices)
+    double _textureCoordinateWeight = 0.0; // Cost of squared texture coordinate difference
+    double _normalWeight = 0.0; // Cost of squared normal difference
+
+    size_t _numPositions = 0; // Number of unique positions
+    std::vector<unsigned int> _positionOfVertex; // Unique position of every vertex
+    std::vector<glm::vec3> _positions; // Unique positions
+    std::vector<Quadric> _quadrics; // Quadric of every position, merged on collapses
+    std::vector<unsigned int> _vertexRemap; // Vertex every vertex collapsed onto (itself, if it did not collapse)
+
+    // Adjacency of the current pass
+    std::vector<unsigned int> _triangleOffsets; // Offsets of the triangles around every position in _positionTriangles
+    std::vector<unsigned int> _positionTriangles; // Triangles around positions
+    std::vector<uint64_t> _sortedEdges; // Key of every triangle edge in position space, sorted
+    std::vector<PositionKind> _positionKinds; // How positions may move
+
+    size_t getNumTriangles() const
+    {
+        return _triangles.size() / 3;
+    }
+
+    unsigned int positionOf(size_t corner) const
+    {
+        return _positionOfVertex[_triangles[corner]];
+    }
+
+    // Remaps vertices collapsed in the last pass and removes triangles with two corners at the same position
+    void removeCollapsedTriangles()
+    {
+        size_t numKept = 0;
+        for (size_t i = 0; i < _triangles.size(); i += 3)
+        {
+            const auto a = _vertexRemap[_triangles[i]];
+            const auto b = _vertexRemap[_triangles[i + 1]];
+            const auto c = _vertexRemap[_triangles[i + 2]];
+            const auto positionA = _positionOfVertex[a];
+            const auto positionB = _positionOfVertex[b];
+            const auto positionC = _positionOfVertex[c];
+            if (positionA == positionB || positionB == positionC || positionA == positionC) {
+                continue;
+            }
+
+            _triangles[numKept++] = a;
+            _triangles[numKept++] = b;
+            _triangles[numKept++] = c;
+        }
+
+        _triangles.resize(numKept);
+    }
+
+    // Accumulates planes of triangles (weighted by area) and planes perpendicular to boundary edges into position quadrics
+    void initializeQuadrics()
+    {
+        _quadrics.assign(_numPositions, Quadric());
+        buildAdjacency();
+        for (size_t i = 0; i < _triangles.size(); i += 3)
+        {
+            const unsigned int corners[3] = { positionOf(i), positionOf(i + 1), positionOf(i + 2) };
+            const auto crossProduct = glm::cross(_positions[corners[1]] - _positions[corners[0]], _positions[corners[2]] - _positions[corners[0]]);
+            const auto crossLength = glm::length(crossProduct);
+            if (crossLength == 0.0f) {
+                continue;
+            }
+
+            const auto normal = crossProduct / crossLength;
+            const auto distance = -glm::dot(normal, _positions[corners[0]]);
+            for (const auto corner : corners) {
+                _quadrics[corner].addPlane(normal, distance, crossLength * 0.5f);
+            }
+
+            for (auto e = 0; e < 3; e++)
+            {
+                const auto a = corners[e];
+                const auto b = corners[(e + 1) % 3];
+                if (countEdge(_sortedEdges, a, b) != 1) {
+                    continue;
+                }
+
+                const auto edge = _positions[b] - _positions[a];
+                const auto boundaryNormal = glm::normalize(glm::cross(edge, normal));
+                const auto boundaryDistance = -glm::dot(boundaryNormal, _positions[a]);
+                const auto boundaryWeight = BOUNDARY_PLANE_WEIGHT * glm::dot(edge, edge);
+                _quadrics[a].addPlane(boundaryNormal, boundaryDistance, boundaryWeight);
+                _quadrics[b].addPlane(boundaryNormal, boundaryDistance, boundaryWeight);
+            }
+        }
+    }
+
+    // Builds triangles around every position, sorted edges and position kinds of the current triangles
+    void buildAdjacency()
+    {
+        _triangleOffsets.assign(_numPositions + 1, 0);
+        for (size_t i = 0; i < _triangles.size(); i++) {
+            _triangleOffsets[positionOf(i) + 1]++;
+        }
+        std::partial_sum(_triangleOffsets.begin(), _triangleOffsets.end(), _triangleOffsets.begin());
+
+        std::vector<unsigned int> fill(_triangleOffsets.begin(), _triangleOffsets.end() - 1);
+        _positionTriangles.resize(_triangles.size());
+        _sortedEdges.resize(_triangles.size());
+        for (size_t i = 0; i < _triangles.size(); i++)
+        {
+            const auto triangle = i - i % 3;
+            _positionTriangles[fill[positionOf(i)]++] = static_cast<unsigned int>(triangle / 3);
+            _sortedEdges[i] = edgeKey(positionOf(i), positionOf(triangle + (i + 1) % 3));
+        }
+        std::sort(_sortedEdges.begin(), _sortedEdges.end());
+
+        // Boundary edges belong to one triangle, non-manifold ones to more than two
+        _positionKinds.assign(_numPositions, MANIFOLD);
+        std::vector<unsigned char> numBoundaryEdges(_numPositions, 0);
+        for (size_t i = 0; i < _sortedEdges.size();)
+        {
+            auto j = i + 1;
+            while (j < _sortedEdges.size() && _sortedEdges[j] == _sortedEdges[i]) {
+                j++;
+            }
+
+            const auto a = static_cast<unsigned int>(_sortedEdges[i] >> 32);
+            const auto b = static_cast<unsigned int>(_sortedEdges[i] & 0xFFFFFFFFu);
+            if (j - i > 2)
+            {
+                _positionKinds[a] = LOCKED;
+                _positionKinds[b] = LOCKED;
+            }
+            else if (j - i == 1)
+            {
+                numBoundaryEdges[a] = static_cast<unsigned char>(std::min(numBoundaryEdges[a] + 1, 255));
+                numBoundaryEdges[b] = static_cast<unsigned char>(std::min(numBoundaryEdges[b] + 1, 255));
+            }
+            i = j;
+        }
+
+        for (size_t p = 0; p < _numPositions; p++)
+        {
+            if (_positionKinds[p] != LOCKED && numBoundaryEdges[p] > 0) {
+                _positionKinds[p] = numBoundaryEdges[p] == 2 ? BOUNDARY : LOCKED;
+            }
+        }
+    }
+
+    /**
+     * Maps every vertex at position "from" onto the vertex at position "to" sharing a triangle with it. Collapse is possible
+     * only if every vertex has exactly one such counterpart, so attribute seams move along seam edges only.
+     *
+     * @return False, if the collapse would tear attributes apart.
+     */
+    bool mapVertices(unsigned int from, unsigned int to, std::vector<std::pair<unsigned int, unsigned int>>& vertexPairs) const
+    {
+        vertexPairs.clear();
+        std::vector<unsigned int> unmatchedVertices;
+        for (auto t = _triangleOffsets[from]; t < _triangleOffsets[from + 1]; t++)
+        {
+            const auto triangle = size_t(_positionTriangles[t]) * 3;
+            auto fromVertex = 0u;
+            auto toVertex = std::numeric_limits<unsigned int>::max();
+            for (size_t c = triangle; c < triangle + 3; c++)
+            {
+                if (positionOf(c) == from) {
+                    fromVertex = _triangles[c];
+                }
+                else if (positionOf(c) == to) {
+                    toVertex = _triangles[c];
+                }
+            }
+
+            if (toVertex == std::numeric_limits<unsigned int>::max())
+            {
+                unmatchedVertices.push_back(fromVertex);
+                continue;
+            }
+
+            const auto pair = std::find_if(vertexPairs.begin(), vertexPairs.end(), [&](const auto& p) { return p.first == fromVertex; });
+            if (pair == vertexPairs.end()) {
+                vertexPairs.emplace_back(fromVertex, toVertex);
+            }
+            else if (pair->second != toVertex) {
+                return false;
+            }
+        }
+
+        for (const auto vertex : unmatchedVertices)
+        {
+            if (std::none_of(vertexPairs.begin(), vertexPairs.end(), [&](const auto& p) { return p.first == vertex; })) {
+                return false;
+            }
+        }
+
+        return !vertexPairs.empty();
+    }
+
+    // Gets cost of attribute changes of collapsed vertices
+    double getAttributeCost(const std::vector<std::pair<unsigned int, unsigned int>>& vertexPairs) const
+    {
+        double cost = 0.0;
+        for (const auto& pair : vertexPairs)
+        {
+            if (_textureCoordinates != nullptr)
+            {
+                const auto difference = _textureCoordinates[pair.first] - _textureCoordinates[pair.second];
+                cost += _textureCoordinateWeight * glm::dot(difference, difference);
+            }
+            if (_normals != nullptr)
+            {
+                const auto difference = _normals[pair.first] - _normals[pair.second];
+                cost += _normalWeight * glm::dot(difference, difference);
+            }
+        }
+
+        return cost;
+    }
+
+    // Finds the cheapest collapse of every position (in parallel for large meshes), sorted by cost
+    std::vector<Collapse> findCollapses() const
+    {
+        const auto numThreads = getNumThreads(getNumTriangles(), PARALLEL_SIMPLIFY_MIN_TRIANGLES);
+        std::vector<Collapse> bestCollapses(_numPositions, Collapse{ 0, 0, -1.0, 0.0 });
+        const auto chunkSize = (_numPositions + numThreads - 1) / numThreads;
+        runInThreads(numThreads, [&](size_t thread) {
+            std::vector<std::pair<unsigned int, unsigned int>> vertexPairs;
+            std::vector<unsigned int> evaluatedPositions;
+            const auto chunkEnd = std::min(_numPositions, (thread + 1) * chunkSize);
+            for (auto from = static_cast<unsigned int>(thread * chunkSize); from < chunkEnd; from++)
+            {
+                if (_positionKinds[from] == LOCKED) {
+                    continue;
+                }
+
+                evaluatedPositions.clear();
+                auto& best = bestCollapses[from];
+                for (auto t = _triangleOffsets[from]; t < _triangleOffsets[from + 1]; t++)
+                {
+                    const auto triangle = size_t(_positionTriangles[t]) * 3;
+                    for (size_t c = triangle; c < triangle + 3; c++)
+                    {
+                        const auto to = positionOf(c);
+                        if (to == from || std::find(evaluatedPositions.begin(), evaluatedPositions.end(), to) != evaluatedPositions.end()) {
+                            continue;
+                        }
+
+                        evaluatedPositions.push_back(to);
+                        if (_positionKinds[from] == BOUNDARY && countEdge(_sortedEdges, from, to) != 1) {
+                            continue;
+                        }
+                        if (!mapVertices(from, to, vertexPairs)) {
+                            continue;
+                        }
+
+                        auto quadric = _quadrics[from];
+                        quadric.add(_quadrics[to]);
+                        const auto geometricError = quadric.weight > 0.0 ? quadric.evaluate(_positions[to]) / quadric.weight : 0.0;
+                        const auto cost = geometricError + getAttributeCost(vertexPairs);
+                        if (best.cost < 0.0 || cost < best.cost) {
+                            best = Collapse{ from, to, cost, geometricError };
+                        }
+                    }
+                }
+            }
+        });
+
+        std::vector<Collapse> collapses;
+        for (const auto& collapse : bestCollapses)
+        {
+            if (collapse.cost >= 0.0) {
+                collapses.push_back(collapse);
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            return a.cost != b.cost ? a.cost < b.cost : a.from < b.from;
+        });
+        return collapses;
+    }
+
+    // Gathers positions of the triangles around given position
+    void gatherNeighbors(unsigned int position, std::vector<unsigned int>& neighbors) const
+    {
+        neighbors.clear();
+        for (auto t = _triangleOffsets[position]; t < _triangleOffsets[position + 1]; t++)
+        {
+            const auto triangle = size_t(_positionTriangles[t]) * 3;
+            for (size_t c = triangle; c < triangle + 3; c++)
+            {
+                if (positionOf(c) != position) {
+                    neighbors.push_back(positionOf(c));
+                }
+            }
+        }
+
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+    /**
+     * Collapses position "from" onto position "to", if it keeps the surface manifold and does not flip any triangle.
+     * Triangles around both positions must not have been changed in this pass.
+     *
+     * @return Number of removed triangles (0, if the collapse has been rejected).
+     */
+    size_t applyCollapse(unsigned int from, unsigned int to, std::vector<bool>& isTouched)
+    {
+        // Link condition - positions common to both neighborhoods are exactly the opposite corners of the shared triangles
+        std::vector<unsigned int> fromNeighbors, toNeighbors, commonNeighbors;
+        gatherNeighbors(from, fromNeighbors);
+        gatherNeighbors(to, toNeighbors);
+        std::set_intersection(fromNeighbors.begin(), fromNeighbors.end(), toNeighbors.begin(), toNeighbors.end(), std::back_inserter(commonNeighbors));
+
+        size_t numSharedTriangles = 0;
+        for (auto t = _triangleOffsets[from]; t < _triangleOffsets[from + 1]; t++)
+        {
+            const auto triangle = size_t(_positionTriangles[t]) * 3;
+            const unsigned int corners[3] = { positionOf(triangle), positionOf(triangle + 1), positionOf(triangle + 2) };
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+            {
+                numSharedTriangles++;
+                continue;
+            }
+
+            // Remaining triangles must not flip or collapse when their corner moves
+            glm::vec3 moved[3] = { _positions[corners[0]], _positions[corners[1]], _positions[corners[2]] };
+            const auto before = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+            for (auto c = 0; c < 3; c++)
+            {
+                if (corners[c] == from) {
+                    moved[c] = _positions[to];
+                }
+            }
+
+            const auto after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+            const auto beforeLength = glm::length(before);
+            if (beforeLength > 0.0f && glm::dot(before, after) <= MIN_NORMAL_COSINE * beforeLength * glm::length(after)) {
+                return 0;
+            }
+        }
+
+        if (numSharedTriangles == 0 || commonNeighbors.size() != numSharedTriangles) {
+            return 0;
+        }
+
+        std::vector<std::pair<unsigned int, unsigned int>> vertexPairs;
+        if (!mapVertices(from, to, vertexPairs)) {
+            return 0;
+        }
+
+        for (const auto& pair : vertexPairs) {
+            _vertexRemap[pair.first] = pair.second;
+        }
+        _quadrics[to].add(_quadrics[from]);
+
+        isTouched[from] = true;
+        isTouched[to] = true;
+        for (const auto neighbor : fromNeighbors) {
+            isTouched[neighbor] = true;
+        }
+
+        return numSharedTriangles;
+    }
+};
+
+} // namespace
+
+float simplifyMesh(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t numVertices,
+    const unsigned int* indices, size_t numIndices, size_t targetNumTriangles, float maxError, std::vector<unsigned int>& simplifiedIndices,
+    const SimplificationWeights& weights)
+{
+    simplifiedIndices.assign(indices, indices + numIndices - numIndices % 3);
+    if (numVertices == 0 || simplifiedIndices.size() / 3 <= targetNumTriangles) {
+        return 0.0f;
+    }
+
+    Simplifier simplifier(positions, textureCoordinates, normals, numVertices, simplifiedIndices, weights);
+    return simplifier.simplify(targetNumTriangles, maxError);
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,54 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+namespace static_meshes_3D {
+
+/**
+ * Weights of vertex attributes in the cost of an edge collapse. Attribute difference of 1 costs as much as geometric error
+ * of weight times mesh radius, so that the weights do not depend on the scale of the mesh.
+ */
+struct SimplificationWeights
+{
+    float textureCoordinates = 0.02f; // Weight of texture coordinate difference
+    float normals = 0.05f; // Weight of normal difference
+};
+
+/**
+ * Minimal number of triangles, for which collapses are evaluated in multiple threads.
+ */
+const size_t PARALLEL_SIMPLIFY_MIN_TRIANGLES = 16384;
+
+/**
+ * Simplifies indexed triangle list by edge collapses ordered by quadric error metrics (Garland and Heckbert 1997),
+ * with attribute differences of the collapsed vertices added to the cost. Vertices collapse onto their neighbors, so simplified
+ * indices reference the original vertices and all LODs of a mesh can share one vertex buffer.
+ * Vertices with the same position (attribute seams) collapse together and only along seam edges, vertices on open boundaries
+ * collapse only along boundary edges and non-manifold vertices or boundary corners never move, so seams and outlines are preserved.
+ * Simplification stops, when number of triangles reaches the target, or when no collapse fits the error budget.
+ * Large meshes are processed in multiple threads, result does not depend on the number of threads.
+ *
+ * @param positions           Vertex positions
+ * @param textureCoordinates  Vertex texture coordinates (or nullptr)
+ * @param normals             Vertex normals (or nullptr)
+ * @param numVertices         Number of vertices
+ * @param indices             Triangle list indices
+ * @param numIndices          Number of indices (multiple of 3)
+ * @param targetNumTriangles  Number of triangles to reach
+ * @param maxError            Error budget - maximal geometric error of one collapse in model units
+ * @param simplifiedIndices   Output triangle list indices
+ * @param weights             Weights of vertex attributes in the collapse cost
+ *
+ * @return Geometric error of the simplified mesh - largest distance of collapsed vertices from the original surface
+ *         (root mean square over the planes the vertex quadric accumulated).
+ */
+float simplifyMesh(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t numVertices,
+    const unsigned int* indices, size_t numIndices, size_t targetNumTriangles, float maxError, std::vector<unsigned int>& simplifiedIndices,
+    const SimplificationWeights& weights = SimplificationWeights());
+
+} // namespace static_meshes_3D
@@ -0,0 +1,368 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+// Project
+#include "meshlets.h"
+
+// SSE2 is always present on x64, culling then tests four meshlets with one instruction
+#if defined(_M_X64) || defined(__SSE2__)
+#define MESHLETS_USE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace static_meshes_3D {
+
+namespace {
+
+const char MESHLET_FILE_MAGIC[4] = { 'M', 'S', 'H', 'L' };
+const uint32_t MESHLET_FILE_VERSION = 1;
+const float MIN_CONE_DOT = 0.1f; // Normal cones wider than this (about 84 degrees from axis) are not used for culling
+
+/**
+ * Header of binary meshlet file, followed by array of Meshlet structures.
+ */
+struct MeshletFileHeader
+{
+    char magic[4]; // Always MSHL
+    uint32_t version; // Version of the file format
+    uint32_t numMeshlets; // Number of meshlets stored
+    uint32_t numIndices; // Number of indices of the mesh the meshlets belong to
+};
+
+// Computes bounding sphere (Ritter's algorithm) and normal cone of meshlet triangles
+void computeMeshletBounds(Meshlet& meshlet, const GLuint* indices, const std::vector<GLuint>& vertices, const glm::vec3* positions)
+{
+    // Start with the sphere spanning two distant points, then grow it to contain all the vertices
+    const auto farthestFrom = [&vertices, positions](const glm::vec3& point)
+    {
+        auto result = positions[vertices[0]];
+        auto maxDistance = -1.0f;
+        for (const auto vertex : vertices)
+        {
+            const auto distance = glm::length(positions[vertex] - point);
+            if (distance > maxDistance)
+            {
+                maxDistance = distance;
+                result = positions[vertex];
+            }
+        }
+
+        return result;
+    };
+
+    const auto a = farthestFrom(positions[vertices[0]]);
+    const auto b = farthestFrom(a);
+    auto center = (a + b) * 0.5f;
+    auto radius = glm::length(b - a) * 0.5f;
+    for (const auto vertex : vertices)
+    {
+        const auto distance = glm::length(positions[vertex] - center);
+        if (distance > radius)
+        {
+            const auto newRadius = (radius + distance) * 0.5f;
+            center += (positions[vertex] - center) * ((newRadius - radius) / distance);
+            radius = newRadius;
+        }
+    }
+
+    // Normal cone - average normal and the widest angle any triangle normal has from it
+    std::vector<glm::vec3> normals;
+    glm::vec3 axis(0.0f);
+    for (GLuint t = 0; t < meshlet.numTriangles; t++)
+    {
+        const auto triangle = indices + meshlet.firstIndex + t * 3;
+        const auto normal = glm::cross(positions[triangle[1]] - positions[triangle[0]], positions[triangle[2]] - positions[triangle[0]]);
+        const auto length = glm::length(normal);
+        if (length > 0.0f)
+        {
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+    }
+
+    const auto axisLength = glm::length(axis);
+    axis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+    auto minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+    for (const auto& normal : normals) {
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+
+    memcpy(meshlet.center, &center[0], sizeof(meshlet.center));
+    meshlet.radius = radius;
+    memcpy(meshlet.coneAxis, &axis[0], sizeof(meshlet.coneAxis));
+    meshlet.coneCutoff = minDot > MIN_CONE_DOT ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+}
+
+} // namespace
+
+void extractFrustumPlanes(const glm::mat4& matrix, glm::vec4* planes)
+{
+    const glm::vec4 rowX(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+    const glm::vec4 rowY(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+    const glm::vec4 rowZ(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+    const glm::vec4 rowW(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+    planes[0] = rowW + rowX;
+    planes[1] = rowW - rowX;
+    planes[2] = rowW + rowY;
+    planes[3] = rowW - rowY;
+    planes[4] = rowW + rowZ;
+    planes[5] = rowW - rowZ;
+    for (auto i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+void MeshletSet::build(const GLuint* indices, size_t firstIndex, size_t numIndices, const glm::vec3* positions)
+{
+    Meshlet meshlet = {};
+    meshlet.firstIndex = static_cast<GLuint>(firstIndex);
+    std::vector<GLuint> meshletVertices;
+    meshletVertices.reserve(MESHLET_MAX_VERTICES);
+
+    const auto finishMeshlet = [&]()
+    {
+        if (meshlet.numTriangles == 0) {
+            return;
+        }
+
+        meshlet.numVertices = static_cast<GLuint>(meshletVertices.size());
+        computeMeshletBounds(meshlet, indices, meshletVertices, positions);
+        addMeshlet(meshlet);
+
+        meshlet.firstIndex += meshlet.numTriangles * 3;
+        meshlet.numTriangles = 0;
+        meshletVertices.clear();
+    };
+
+    for (auto i = firstIndex; i + 2 < firstIndex + numIndices; i += 3)
+    {
+        // Triangle goes to the next meshlet, if its new vertices would not fit
+        auto numNewVertices = 0;
+        for (auto c = 0; c < 3; c++)
+        {
+            const auto vertex = indices[i + c];
+            const auto isNewVertex = std::find(meshletVertices.begin(), meshletVertices.end(), vertex) == meshletVertices.end()
+                && std::find(indices + i, indices + i + c, vertex) == indices + i + c;
+            numNewVertices += isNewVertex ? 1 : 0;
+        }
+
+        if (meshletVertices.size() + numNewVertices > MESHLET_MAX_VERTICES || meshlet.numTriangles == MESHLET_MAX_TRIANGLES) {
+            finishMeshlet();
+        }
+
+        for (auto c = 0; c < 3; c++)
+        {
+            const auto vertex = indices[i + c];
+            if (std::find(meshletVertices.begin(), meshletVertices.end(), vertex) == meshletVertices.end()) {
+                meshletVertices.push_back(vertex);
+            }
+        }
+        meshlet.numTriangles++;
+    }
+
+    finishMeshlet();
+}
+
+int MeshletSet::cull(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition, std::vector<DrawRange>& visibleRanges) const
+{
+    visibleRanges.clear();
+    glm::vec4 frustumPlanes[6];
+    extractFrustumPlanes(modelViewProjection, frustumPlanes);
+
+    auto numVisibleMeshlets = 0;
+    for (size_t firstMeshlet = 0; firstMeshlet < _meshlets.size(); firstMeshlet += 4)
+    {
+        const auto visibilityMask = cullFourMeshlets(firstMeshlet, frustumPlanes, cameraPosition);
+        for (size_t i = 0; i < 4 && firstMeshlet + i < _meshlets.size(); i++)
+        {
+            if ((visibilityMask & (1 << i)) == 0) {
+                continue;
+            }
+
+            // Merge with previous range, if meshlets follow each other in the index buffer
+            const auto& meshlet = _meshlets[firstMeshlet + i];
+            const auto firstIndex = static_cast<int>(meshlet.firstIndex);
+            const auto numIndices = static_cast<int>(meshlet.numTriangles * 3);
+            if (!visibleRanges.empty() && visibleRanges.back().firstIndex + visibleRanges.back().numIndices == firstIndex) {
+                visibleRanges.back().numIndices += numIndices;
+            }
+            else {
+                visibleRanges.push_back({ firstIndex, numIndices });
+            }
+
+            numVisibleMeshlets++;
+        }
+    }
+
+    return numVisibleMeshlets;
+}
+
+bool MeshletSet::saveToFile(const std::string& fileName, size_t numIndices) const
+{
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Could not open meshlet file " << fileName << " for writing!" << std::endl;
+        return false;
+    }
+
+    MeshletFileHeader header;
+    memcpy(header.magic, MESHLET_FILE_MAGIC, sizeof(header.magic));
+    header.version = MESHLET_FILE_VERSION;
+    header.numMeshlets = static_cast<uint32_t>(_meshlets.size());
+    header.numIndices = static_cast<uint32_t>(numIndices);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(_meshlets.data()), sizeof(Meshlet) * _meshlets.size());
+
+    return file.good();
+}
+
+bool MeshletSet::loadFromFile(const std::string& fileName, size_t numIndices)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Could not open meshlet file " << fileName << "!" << std::endl;
+        return false;
+    }
+
+    MeshletFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good() || memcmp(header.magic, MESHLET_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != MESHLET_FILE_VERSION)
+    {
+        std::cerr << "File " << fileName << " is not a valid meshlet file!" << std::endl;
+        return false;
+    }
+
+    if (header.numIndices != numIndices)
+    {
+        std::cerr << "Meshlets in file " << fileName << " belong to a different mesh!" << std::endl;
+        return false;
+    }
+
+    std::vector<Meshlet> meshlets(header.numMeshlets);
+    file.read(reinterpret_cast<char*>(meshlets.data()), sizeof(Meshlet) * meshlets.size());
+    if (!file.good())
+    {
+        std::cerr << "Meshlet file " << fileName << " is truncated!" << std::endl;
+        return false;
+    }
+
+    clear();
+    for (const auto& meshlet : meshlets)
+    {
+        if (meshlet.firstIndex + meshlet.numTriangles * 3 > numIndices)
+        {
+            std::cerr << "Meshlet file " << fileName << " references indices out of the mesh!" << std::endl;
+            clear();
+            return false;
+        }
+
+        addMeshlet(meshlet);
+    }
+
+    return true;
+}
+
+void MeshletSet::clear()
+{
+    _meshlets.clear();
+    for (auto boundsArray : { &_centersX, &_centersY, &_centersZ, &_radii, &_coneAxesX, &_coneAxesY, &_coneAxesZ, &_coneCutoffs }) {
+        boundsArray->clear();
+    }
+}
+
+const std::vector<Meshlet>& MeshletSet::getMeshlets() const
+{
+    return _meshlets;
+}
+
+int MeshletSet::getNumMeshlets() const
+{
+    return static_cast<int>(_meshlets.size());
+}
+
+void MeshletSet::addMeshlet(const Meshlet& meshlet)
+{
+    _meshlets.push_back(meshlet);
+
+    // Keep bounds padded to four meshlets, padding is never visible (negative infinite radius)
+    const auto paddedSize = (_meshlets.size() + 3) / 4 * 4;
+    _centersX.resize(paddedSize, 0.0f);
+    _centersY.resize(paddedSize, 0.0f);
+    _centersZ.resize(paddedSize, 0.0f);
+    _radii.resize(paddedSize, -std::numeric_limits<float>::infinity());
+    _coneAxesX.resize(paddedSize, 0.0f);
+    _coneAxesY.resize(paddedSize, 0.0f);
+    _coneAxesZ.resize(paddedSize, 0.0f);
+    _coneCutoffs.resize(paddedSize, 1.0f);
+
+    const auto i = _meshlets.size() - 1;
+    _centersX[i] = meshlet.center[0];
+    _centersY[i] = meshlet.center[1];
+    _centersZ[i] = meshlet.center[2];
+    _radii[i] = meshlet.radius;
+    _coneAxesX[i] = meshlet.coneAxis[0];
+    _coneAxesY[i] = meshlet.coneAxis[1];
+    _coneAxesZ[i] = meshlet.coneAxis[2];
+    _coneCutoffs[i] = meshlet.coneCutoff;
+}
+
+int MeshletSet::cullFourMeshlets(size_t firstMeshlet, const glm::vec4* frustumPlanes, const glm::vec3& cameraPosition) const
+{
+#ifdef MESHLETS_USE_SSE
+    const auto centerX = _mm_loadu_ps(&_centersX[firstMeshlet]);
+    const auto centerY = _mm_loadu_ps(&_centersY[firstMeshlet]);
+    const auto centerZ = _mm_loadu_ps(&_centersZ[firstMeshlet]);
+    const auto radius = _mm_loadu_ps(&_radii[firstMeshlet]);
+    const auto negativeRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+    // Sphere is outside, if it's completely behind any of the frustum planes
+    auto isVisible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (auto p = 0; p < 6; p++)
+    {
+        const auto& plane = frustumPlanes[p];
+        const auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)), _mm_mul_ps(centerY, _mm_set1_ps(plane.y))),
+            _mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+        isVisible = _mm_and_ps(isVisible, _mm_cmpgt_ps(distance, negativeRadius));
+    }
+
+    // Meshlet is back-facing, if the whole sphere is inside the cone opposite to the normal cone
+    const auto toCenterX = _mm_sub_ps(centerX, _mm_set1_ps(cameraPosition.x));
+    const auto toCenterY = _mm_sub_ps(centerY, _mm_set1_ps(cameraPosition.y));
+    const auto toCenterZ = _mm_sub_ps(centerZ, _mm_set1_ps(cameraPosition.z));
+    const auto coneDot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(toCenterX, _mm_loadu_ps(&_coneAxesX[firstMeshlet])),
+        _mm_mul_ps(toCenterY, _mm_loadu_ps(&_coneAxesY[firstMeshlet]))), _mm_mul_ps(toCenterZ, _mm_loadu_ps(&_coneAxesZ[firstMeshlet])));
+    const auto distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toCenterX, toCenterX), _mm_mul_ps(toCenterY, toCenterY)), _mm_mul_ps(toCenterZ, toCenterZ)));
+    const auto isBackFacing = _mm_cmpge_ps(coneDot, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&_coneCutoffs[firstMeshlet]), distance), radius));
+    isVisible = _mm_andnot_ps(isBackFacing, isVisible);
+
+    return _mm_movemask_ps(isVisible);
+#else
+    auto visibilityMask = 0;
+    for (size_t i = firstMeshlet; i < firstMeshlet + 4; i++)
+    {
+        const glm::vec3 center(_centersX[i], _centersY[i], _centersZ[i]);
+        auto isVisible = true;
+        for (auto p = 0; p < 6; p++) {
+            isVisible = isVisible && glm::dot(glm::vec3(frustumPlanes[p]), center) + frustumPlanes[p].w > -_radii[i];
+        }
+
+        const auto toCenter = center - cameraPosition;
+        const glm::vec3 coneAxis(_coneAxesX[i], _coneAxesY[i], _coneAxesZ[i]);
+        isVisible = isVisible && glm::dot(toCenter, coneAxis) < _coneCutoffs[i] * glm::length(toCenter) + _radii[i];
+        visibilityMask |= isVisible ? 1 << (i - firstMeshlet) : 0;
+    }
+
+    return visibilityMask;
+#endif
+}
+
+} // namespace static_meshes_3D
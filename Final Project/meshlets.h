@@ -0,0 +1,130 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+namespace static_meshes_3D {
+
+const int MESHLET_MAX_VERTICES = 64; // Maximal number of unique vertices of one meshlet
+const int MESHLET_MAX_TRIANGLES = 124; // Maximal number of triangles of one meshlet
+
+/**
+ * Extracts normalized frustum planes (a, b, c, d - inside is a*x + b*y + c*z + d > 0) from projection matrix.
+ *
+ * @param matrix  Projection matrix (model view projection to get planes in model space)
+ * @param planes  Output six planes - left, right, bottom, top, near, far
+ */
+void extractFrustumPlanes(const glm::mat4& matrix, glm::vec4* planes);
+
+/**
+ * Cluster of consecutive triangles of indexed mesh with its bounds. Plain data, stored on disk as they are.
+ */
+struct Meshlet
+{
+    GLuint firstIndex; // First index of the meshlet in the mesh index buffer
+    GLuint numTriangles; // Number of triangles (up to MESHLET_MAX_TRIANGLES)
+    GLuint numVertices; // Number of unique vertices referenced by the triangles (up to MESHLET_MAX_VERTICES)
+    float center[3]; // Center of the bounding sphere
+    float radius; // Radius of the bounding sphere
+    float coneAxis[3]; // Average direction of triangle normals
+    float coneCutoff; // Sine of the normal cone half-angle (1 disables back-face culling of the meshlet)
+};
+
+/**
+ * Meshlets of one mesh, with bounds kept in structure-of-arrays form, so that culling tests four meshlets at once.
+ */
+class MeshletSet
+{
+public:
+    /**
+     * Range of indices to draw.
+     */
+    struct DrawRange
+    {
+        int firstIndex; // First index of the range
+        int numIndices; // Number of indices in the range
+    };
+
+    /**
+     * Splits triangle list (part of mesh index buffer) into meshlets of consecutive triangles and appends them.
+     * Triangles are not reordered, so they should be optimized for vertex cache first to get compact meshlets.
+     *
+     * @param indices     Mesh index buffer
+     * @param firstIndex  First index of the triangle list
+     * @param numIndices  Number of indices of the triangle list (multiple of 3)
+     * @param positions   Vertex positions
+     */
+    void build(const GLuint* indices, size_t firstIndex, size_t numIndices, const glm::vec3* positions);
+
+    /**
+     * Culls meshlets against view frustum and normal cones, visible meshlets following each other are merged into one draw range.
+     *
+     * @param modelViewProjection  Model view projection matrix of the mesh
+     * @param cameraPosition       Camera position in model space of the mesh
+     * @param visibleRanges        Output draw ranges of visible meshlets
+     *
+     * @return Number of visible meshlets.
+     */
+    int cull(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition, std::vector<DrawRange>& visibleRanges) const;
+
+    /**
+     * Saves meshlets to binary file.
+     *
+     * @param fileName    Path to the file
+     * @param numIndices  Number of mesh indices, stored to validate that meshlets belong to the mesh when loaded
+     *
+     * @return True, if meshlets have been saved, false otherwise.
+     */
+    bool saveToFile(const std::string& fileName, size_t numIndices) const;
+
+    /**
+     * Loads meshlets from binary file, replacing current ones.
+     *
+     * @param fileName    Path to the file
+     * @param numIndices  Number of mesh indices, meshlets are rejected, if they were saved for different mesh
+     *
+     * @return True, if meshlets have been loaded, false otherwise.
+     */
+    bool loadFromFile(const std::string& fileName, size_t numIndices);
+
+    /**
+     * Removes all meshlets.
+     */
+    void clear();
+
+    /**
+     * Gets all meshlets.
+     */
+    const std::vector<Meshlet>& getMeshlets() const;
+
+    /**
+     * Gets number of meshlets.
+     */
+    int getNumMeshlets() const;
+
+private:
+    std::vector<Meshlet> _meshlets; // Meshlets in order of their triangles
+
+    // Bounds in structure-of-arrays form, padded to multiple of 4 meshlets
+    std::vector<float> _centersX, _centersY, _centersZ, _radii;
+    std::vector<float> _coneAxesX, _coneAxesY, _coneAxesZ, _coneCutoffs;
+
+    /**
+     * Appends meshlet and its bounds.
+     */
+    void addMeshlet(const Meshlet& meshlet);
+
+    /**
+     * Gets bit mask of visibility of four meshlets starting at given one.
+     */
+    int cullFourMeshlets(size_t firstMeshlet, const glm::vec4* frustumPlanes, const glm::vec3& cameraPosition) const;
+};
+
+} // namespace static_meshes_3D
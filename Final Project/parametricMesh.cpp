@@ -0,0 +1,279 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// GLM
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "parametricMesh.h"
+#include "sinCosTable.h"
+#include "vertexLayout.h"
+
+namespace static_meshes_3D {
+
+const int ParametricMesh::MAX_LOD_COUNT = 8;
+std::vector<ParametricMesh::GeneratedVertex> ParametricMesh::_generatedVertices;
+std::vector<GLuint> ParametricMesh::_generatedIndices;
+
+namespace {
+
+// Triangles with sine of the smallest angle below this are considered collapsed
+const float COLLAPSED_TRIANGLE_SINE = 1e-5f;
+
+static_assert(sizeof(glm::vec3) * 2 + sizeof(glm::vec2) == DefaultVertexLayout::STRIDE, "Generated vertices must be interleaved in DefaultVertexLayout!");
+
+} // namespace
+
+ParametricMesh::ParametricMesh(int lodCount, const VertexFormat& vertexFormat, VertexStorage vertexStorage)
+    : StaticMeshIndexed3D(vertexFormat, vertexStorage)
+    , _lodCount(clampLodCount(lodCount)) {}
+
+void ParametricMesh::render() const
+{
+    renderLod(0);
+}
+
+void ParametricMesh::renderPoints() const
+{
+    if (!_isInitialized || _indexRanges.empty()) {
+        return;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    if (isInArena()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    }
+
+    const auto& range = _indexRanges[0];
+    const auto indexOffset = static_cast<size_t>(range.firstIndex) * getIndexByteSize();
+    glDrawElementsBaseVertex(GL_POINTS, range.numIndices, _indexType, reinterpret_cast<void*>(indexOffset), firstVertex);
+}
+
+void ParametricMesh::renderLod(int lod) const
+{
+    renderIndexRange(std::min(std::max(lod, 0), getLodCount() - 1));
+}
+
+void ParametricMesh::renderInstanced(GLsizei numInstances) const
+{
+    renderLodInstanced(0, numInstances);
+}
+
+void ParametricMesh::renderLodInstanced(int lod, GLsizei numInstances) const
+{
+    renderIndexRangeInstanced(std::min(std::max(lod, 0), getLodCount() - 1), numInstances);
+}
+
+int ParametricMesh::getLodCount() const
+{
+    return getNumIndexRanges();
+}
+
+int ParametricMesh::getLodTriangleCount(int lod) const
+{
+    if (lod < 0 || lod >= getLodCount()) {
+        return 0;
+    }
+
+    return _indexRanges[lod].numIndices / 3;
+}
+
+float ParametricMesh::getLodError(int lod) const
+{
+    if (lod < 0 || lod >= getLodCount()) {
+        return 0.0f;
+    }
+
+    return _indexRanges[lod].error;
+}
+
+void ParametricMesh::initializeData()
+{
+    if (_isInitialized) {
+        return;
+    }
+
+    // Shapes with key are looked up in mesh file cache first, generated ones get stored there when finalized
+    auto meshFileKey = getMeshFileKey();
+    if (!meshFileKey.empty())
+    {
+        const auto lodCountBytes = reinterpret_cast<const unsigned char*>(&_lodCount);
+        meshFileKey.insert(meshFileKey.end(), lodCountBytes, lodCountBytes + sizeof(_lodCount));
+        if (loadFromMeshFileCache(meshFileKey)) {
+            return;
+        }
+    }
+
+    // Generate all LODs one after another, every LOD becomes one index range
+    _generatedVertices.clear();
+    _generatedIndices.clear();
+    for (auto lod = 0; lod < _lodCount; lod++)
+    {
+        const auto firstIndex = static_cast<int>(_generatedIndices.size());
+        const auto lodError = generateLod(lod);
+        if (lodError < 0.0f)
+        {
+            _generatedIndices.resize(firstIndex);
+            break;
+        }
+
+        _indexRanges.push_back({ firstIndex, static_cast<int>(_generatedIndices.size()) - firstIndex, lodError });
+    }
+
+    _numVertices = static_cast<int>(_generatedVertices.size());
+    _numIndices = static_cast<int>(_generatedIndices.size());
+
+    // Generated vertices are written straight to the VBO data in mesh vertex storage with the mesh format,
+    // which skips attributes not present in its layout
+    const auto numVertices = _generatedVertices.size();
+    const auto vertexDataSize = numVertices * getVertexByteSize();
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+    _vbo.createVBO(vertexDataSize);
+    _vertexFormat->copyFromDefaultLayout(reinterpret_cast<const unsigned char*>(_generatedVertices.data()),
+        static_cast<unsigned char*>(_vbo.appendRawData(vertexDataSize)), _vertexStorage, numVertices);
+    _indicesVBO.createVBO(sizeof(GLuint) * _generatedIndices.size());
+    _indicesVBO.addRawData(_generatedIndices.data(), sizeof(GLuint) * _generatedIndices.size());
+    finalizeIndexedData(GL_STATIC_DRAW);
+}
+
+std::vector<unsigned char> ParametricMesh::getMeshFileKey() const
+{
+    return std::vector<unsigned char>();
+}
+
+int ParametricMesh::getLodSegments(int segments, int minSegments, int lod)
+{
+    return std::max(segments >> lod, minSegments);
+}
+
+float ParametricMesh::getChordError(float radius, int segments)
+{
+    return radius * (1.0f - std::cos(glm::pi<float>() / float(segments)));
+}
+
+void ParametricMesh::addSurface(int segmentsU, int segmentsV, bool isClosedU, bool isClosedV, const SurfaceFunction& surface)
+{
+    const auto numVerticesU = segmentsU + 1;
+    const auto firstVertex = addVertices((segmentsV + 1) * numVerticesU);
+    const auto vertices = _generatedVertices.data() + firstVertex;
+    for (auto j = 0; j <= segmentsV; j++)
+    {
+        const auto row = j * numVerticesU;
+        for (auto i = 0; i <= segmentsU; i++)
+        {
+            auto& vertex = vertices[row + i];
+            vertex.textureCoordinate = glm::vec2(float(i) / float(segmentsU), float(j) / float(segmentsV));
+
+            // Seam vertices copy their counterparts, so that no cracks appear due to rounding of the surface function
+            if (isClosedU && i == segmentsU)
+            {
+                vertex.position = vertices[row].position;
+                vertex.normal = vertices[row].normal;
+            }
+            else if (isClosedV && j == segmentsV)
+            {
+                vertex.position = vertices[i].position;
+                vertex.normal = vertices[i].normal;
+            }
+            else {
+                surface(i, j, vertex.position, vertex.normal);
+            }
+        }
+    }
+
+    _generatedIndices.reserve(_generatedIndices.size() + segmentsU * segmentsV * 6);
+    for (auto j = 0; j < segmentsV; j++)
+    {
+        for (auto i = 0; i < segmentsU; i++)
+        {
+            const auto a = firstVertex + j * numVerticesU + i;
+            const auto b = a + 1;
+            const auto c = a + numVerticesU;
+            const auto d = c + 1;
+            addTriangle(a, c, b);
+            addTriangle(b, c, d);
+        }
+    }
+}
+
+void ParametricMesh::addDisk(const glm::vec3& center, const glm::vec3& normal, const glm::vec3& tangent, float radius, int segments)
+{
+    // Center vertex followed by the rim, rim angles come from the shared table
+    const auto bitangent = glm::cross(normal, tangent);
+    const auto& sinCosTable = getSinCosTable(segments);
+    const auto sines = sinCosTable.getSines();
+    const auto cosines = sinCosTable.getCosines();
+    const auto centerVertex = addVertices(segments + 2);
+    const auto vertices = _generatedVertices.data() + centerVertex;
+    vertices[0] = { center, glm::vec2(0.5f, 0.5f), normal };
+    for (auto i = 0; i <= segments; i++)
+    {
+        vertices[i + 1] = { center + (tangent * cosines[i] + bitangent * sines[i]) * radius,
+            glm::vec2(0.5f + cosines[i] * 0.5f, 0.5f + sines[i] * 0.5f), normal };
+    }
+
+    _generatedIndices.reserve(_generatedIndices.size() + segments * 3);
+    for (auto i = 0; i < segments; i++) {
+        addTriangle(centerVertex, centerVertex + i + 1, centerVertex + i + 2);
+    }
+}
+
+GLuint ParametricMesh::addVertexData(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t count)
+{
+    const auto firstVertex = addVertices(static_cast<int>(count));
+    const auto vertices = _generatedVertices.data() + firstVertex;
+    for (size_t i = 0; i < count; i++)
+    {
+        vertices[i] = { positions[i], textureCoordinates != nullptr ? textureCoordinates[i] : glm::vec2(0.0f),
+            normals != nullptr ? normals[i] : glm::vec3(0.0f) };
+    }
+
+    return firstVertex;
+}
+
+void ParametricMesh::addTriangles(const GLuint* indices, size_t numIndices, GLuint firstVertex)
+{
+    _generatedIndices.reserve(_generatedIndices.size() + numIndices);
+    for (size_t i = 0; i < numIndices; i++) {
+        _generatedIndices.push_back(firstVertex + indices[i]);
+    }
+}
+
+int ParametricMesh::clampLodCount(int lodCount)
+{
+    return std::min(std::max(lodCount, 1), MAX_LOD_COUNT);
+}
+
+GLuint ParametricMesh::addVertices(int count)
+{
+    const auto firstVertex = _generatedVertices.size();
+    _generatedVertices.resize(firstVertex + count);
+    return static_cast<GLuint>(firstVertex);
+}
+
+void ParametricMesh::addTriangle(GLuint a, GLuint b, GLuint c)
+{
+    const auto& vertexA = _generatedVertices[a];
+    const auto& vertexB = _generatedVertices[b];
+    const auto& vertexC = _generatedVertices[c];
+    const auto edgeAB = vertexB.position - vertexA.position;
+    const auto edgeAC = vertexC.position - vertexA.position;
+    const auto faceNormal = glm::cross(edgeAB, edgeAC);
+    const auto edgeLengthsSquared = glm::dot(edgeAB, edgeAB) * glm::dot(edgeAC, edgeAC);
+    if (glm::dot(faceNormal, faceNormal) <= edgeLengthsSquared * COLLAPSED_TRIANGLE_SINE * COLLAPSED_TRIANGLE_SINE) {
+        return;
+    }
+
+    if (glm::dot(faceNormal, vertexA.normal + vertexB.normal + vertexC.normal) < 0.0f) {
+        std::swap(b, c);
+    }
+
+    _generatedIndices.push_back(a);
+    _generatedIndices.push_back(b);
+    _generatedIndices.push_back(c);
+}
+
+} // namespace static_meshes_3D
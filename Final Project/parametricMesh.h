@@ -0,0 +1,198 @@
+#pragma once
+
+// STL
+#include <functional>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "staticMeshIndexed3D.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Base of indexed meshes with chain of progressively coarser versions (LODs) - procedurally generated shapes
+ * or simplified meshes. All LODs are stored in one vertex and one index buffer, every LOD is one index range.
+ */
+class ParametricMesh : public StaticMeshIndexed3D
+{
+public:
+    static const int MAX_LOD_COUNT; // Maximal number of LODs of one mesh
+
+    /**
+     * Renders the finest LOD.
+     */
+    void render() const override;
+
+    /**
+     * Renders vertices of the finest LOD as points.
+     */
+    void renderPoints() const override;
+
+    /**
+     * Renders given LOD.
+     *
+     * @param lod  LOD to render (0 is the finest one, clamped to available LODs)
+     */
+    void renderLod(int lod) const;
+
+    /**
+     * Renders given number of instances of the finest LOD.
+     */
+    void renderInstanced(GLsizei numInstances) const override;
+
+    /**
+     * Renders given number of instances of given LOD with one instanced draw.
+     *
+     * @param lod           LOD to render (0 is the finest one, clamped to available LODs)
+     * @param numInstances  Number of rendered instances
+     */
+    void renderLodInstanced(int lod, GLsizei numInstances) const;
+
+    /**
+     * Gets number of generated LODs.
+     */
+    int getLodCount() const;
+
+    /**
+     * Gets number of triangles of given LOD.
+     */
+    int getLodTriangleCount(int lod) const;
+
+    /**
+     * Gets geometric error of given LOD - maximal distance of its triangles from the exact surface (in model units).
+     */
+    float getLodError(int lod) const;
+
+protected:
+    /**
+     * Function evaluating surface point of grid vertex [i, j].
+     */
+    typedef std::function<void(int i, int j, glm::vec3& position, glm::vec3& normal)> SurfaceFunction;
+
+    /**
+     * Creates mesh with given vertex layout, generated vertices are written with its format (see VertexFormat::copyFromDefaultLayout).
+     */
+    template<typename... Attributes>
+    ParametricMesh(int lodCount, VertexLayout<Attributes...> layout, VertexStorage vertexStorage)
+        : StaticMeshIndexed3D(layout, vertexStorage)
+        , _lodCount(clampLodCount(lodCount)) {}
+
+    /**
+     * Creates mesh with format of another mesh (e.g. simplified version of it).
+     */
+    ParametricMesh(int lodCount, const VertexFormat& vertexFormat, VertexStorage vertexStorage);
+
+    /**
+     * Generates all LODs (until generateLod ends the chain), uploads them and finalizes the mesh. Shapes call it from their constructors.
+     */
+    void initializeData() override;
+
+    /**
+     * Generates geometry of one LOD with addSurface / addDisk.
+     *
+     * @param lod  LOD to generate (0 is the finest one)
+     *
+     * @return Geometric error of the generated LOD (see getLodError), negative to end the chain without this LOD.
+     */
+    virtual float generateLod(int lod) = 0;
+
+    /**
+     * Gets key identifying generated LODs in the mesh file cache (see makeMeshFileKey), number of LODs is appended to it.
+     * Default implementation returns empty key, so the mesh is always generated.
+     */
+    virtual std::vector<unsigned char> getMeshFileKey() const;
+
+    /**
+     * Gets number of segments for given LOD - every LOD halves the number of segments, down to given minimum.
+     */
+    static int getLodSegments(int segments, int minSegments, int lod);
+
+    /**
+     * Gets distance between circular arc and its chord, when full circle of given radius is split into given number of segments.
+     */
+    static float getChordError(float radius, int segments);
+
+    /**
+     * Adds grid surface of (segmentsU + 1) x (segmentsV + 1) vertices with texture coordinates (i / segmentsU, j / segmentsV).
+     * Seams of closed surfaces get duplicated vertices with exactly the same position and normal (only texture coordinate differs),
+     * collapsed triangles (poles, apexes) are skipped and all triangles are wound counter-clockwise when looking against vertex normals.
+     *
+     * @param segmentsU  Number of segments in U direction
+     * @param segmentsV  Number of segments in V direction
+     * @param isClosedU  Flag telling, if last column of vertices is the seam of the first one
+     * @param isClosedV  Flag telling, if last row of vertices is the seam of the first one
+     * @param surface    Function evaluating the surface
+     */
+    void addSurface(int segmentsU, int segmentsV, bool isClosedU, bool isClosedV, const SurfaceFunction& surface);
+
+    /**
+     * Adds flat disk made of center vertex and ring of vertices (first and last one are seam vertices).
+     *
+     * @param center    Center of the disk
+     * @param normal    Normal of the disk
+     * @param tangent   Direction of the first ring vertex (perpendicular to normal)
+     * @param radius    Radius of the disk
+     * @param segments  Number of ring segments
+     */
+    void addDisk(const glm::vec3& center, const glm::vec3& normal, const glm::vec3& tangent, float radius, int segments);
+
+    /**
+     * Adds vertices given by their attributes.
+     *
+     * @param positions           Vertex positions
+     * @param textureCoordinates  Vertex texture coordinates (or nullptr for zero ones)
+     * @param normals             Vertex normals (or nullptr for zero ones)
+     * @param count               Number of vertices
+     *
+     * @return Index of the first added vertex.
+     */
+    GLuint addVertexData(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t count);
+
+    /**
+     * Adds triangles as they are, without skipping collapsed ones or fixing their winding.
+     *
+     * @param indices      Triangle list indices, relative to the first vertex
+     * @param numIndices   Number of indices (multiple of 3)
+     * @param firstVertex  Vertex, that index 0 refers to
+     */
+    void addTriangles(const GLuint* indices, size_t numIndices, GLuint firstVertex);
+
+    /**
+     * Clamps requested number of LODs to 1..MAX_LOD_COUNT.
+     */
+    static int clampLodCount(int lodCount);
+
+private:
+    /**
+     * Generated vertex, interleaved in DefaultVertexLayout. Positions and normals are needed during generation
+     * (winding and collapse checks), so all attributes are generated and the mesh layout picks its ones when uploading.
+     */
+    struct GeneratedVertex
+    {
+        glm::vec3 position;
+        glm::vec2 textureCoordinate;
+        glm::vec3 normal;
+    };
+
+    int _lodCount; // Number of LODs to generate
+
+    // Geometry being generated - scratch buffers shared by all parametric meshes (meshes are generated one at a time
+    // on the GL thread), so their capacity is reused and generation of further meshes allocates nothing
+    static std::vector<GeneratedVertex> _generatedVertices;
+    static std::vector<GLuint> _generatedIndices;
+
+    /**
+     * Appends given number of generated vertices (to be filled in by the caller) and returns index of the first one.
+     */
+    GLuint addVertices(int count);
+
+    /**
+     * Adds triangle, unless it's collapsed, wound counter-clockwise when looking against vertex normals.
+     */
+    void addTriangle(GLuint a, GLuint b, GLuint c);
+};
+
+} // namespace static_meshes_3D
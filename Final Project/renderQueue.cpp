@@ -0,0 +1,231 @@
+// STL
+#include <algorithm>
+#include <cstring>
+
+// Project
+#include "renderQueue.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+const int RADIX_BITS = 8;
+const int RADIX_SIZE = 1 << RADIX_BITS;
+const int NUM_RADIX_DIGITS = 64 / RADIX_BITS;
+
+constexpr ResourceName MODEL_UNIFORM("model");
+constexpr ResourceName LOD_FADE_UNIFORM("lodFade");
+
+bool isSameQuantization(const QuantizationParameters& a, const QuantizationParameters& b)
+{
+    return a.positionScale == b.positionScale && a.positionBias == b.positionBias && a.uvScale == b.uvScale
+        && a.uvBias == b.uvBias && a.octahedralNormals == b.octahedralNormals;
+}
+
+// Gets 16-bit depth key - high bits of non-negative float keep its order
+uint64_t getDepthKey(float depth)
+{
+    const auto clampedDepth = std::max(depth, 0.0f);
+    uint32_t bits;
+    memcpy(&bits, &clampedDepth, sizeof(bits));
+    return bits >> 16;
+}
+
+} // namespace
+
+RenderProgram getRenderProgram(const ShaderReflection& reflection)
+{
+    RenderProgram program;
+    program.programId = reflection.getProgramId();
+    program.model = reflection.getUniform<glm::mat4>(MODEL_UNIFORM);
+    program.lodFade = reflection.getUniform<float>(LOD_FADE_UNIFORM);
+    program.dequantization = getDequantizationUniforms(reflection);
+    return program;
+}
+
+void RenderQueue::begin(const glm::mat4& view)
+{
+    _view = view;
+    _items.clear();
+    _keys.clear();
+    _submissionOrderChanges = RenderStateChanges();
+}
+
+void RenderQueue::submit(const StaticMeshIndexed3D* mesh, int rangeIndex, const RenderMaterial& material, const glm::mat4& model, int pass)
+{
+    if (mesh != nullptr && material.program != nullptr) {
+        addItem(Item{ mesh, rangeIndex, 0, nullptr, -1, material, model }, pass);
+    }
+}
+
+void RenderQueue::submitRanges(const StaticMeshIndexed3D* mesh, unsigned int rangeMask, const RenderMaterial& material, const glm::mat4& model, int pass)
+{
+    if (mesh != nullptr && material.program != nullptr && rangeMask != 0) {
+        addItem(Item{ mesh, -1, rangeMask, nullptr, -1, material, model }, pass);
+    }
+}
+
+void RenderQueue::submitLod(LodManager& lodManager, int instance, const ParametricMesh* mesh, const RenderMaterial& material, const glm::mat4& model, int pass)
+{
+    if (mesh != nullptr && material.program != nullptr) {
+        addItem(Item{ mesh, -1, 0, &lodManager, instance, material, model }, pass);
+    }
+}
+
+void RenderQueue::flush()
+{
+    sortKeys();
+
+    // Uniforms are set through handles of the program, resolved before rendering
+    const Item* previous = nullptr;
+    auto isLodFadeOpaque = false;
+    _frameStats = RenderQueueStats();
+    for (const auto& sortKey : _keys)
+    {
+        const auto& item = _items[sortKey.item];
+        const auto& program = *item.material.program;
+        const auto isProgramChanged = previous == nullptr || previous->material.program->programId != program.programId;
+        if (isProgramChanged)
+        {
+            glUseProgram(program.programId);
+            isLodFadeOpaque = false;
+            _frameStats.stateChanges.numProgramChanges++;
+        }
+        if (previous == nullptr || previous->material.textureId != item.material.textureId)
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, item.material.textureId);
+            _frameStats.stateChanges.numTextureChanges++;
+        }
+        if (previous == nullptr || previous->mesh->getVertexArrayID() != item.mesh->getVertexArrayID()) {
+            _frameStats.stateChanges.numVertexArrayChanges++;
+        }
+        if (isProgramChanged || memcmp(&previous->model, &item.model, sizeof(glm::mat4)) != 0)
+        {
+            program.model.set(item.model);
+            _frameStats.stateChanges.numTransformUploads++;
+        }
+        if (isProgramChanged || !isSameQuantization(previous->mesh->getQuantizationParameters(), item.mesh->getQuantizationParameters()))
+        {
+            setDequantizationUniforms(program.dequantization, item.mesh->getQuantizationParameters());
+            _frameStats.stateChanges.numDequantizationUploads++;
+        }
+
+        if (item.lodManager != nullptr)
+        {
+            item.lodManager->render(item.lodInstance, _view * item.model, program.lodFade.getLocation());
+            isLodFadeOpaque = false;
+        }
+        else
+        {
+            // LOD manager may have left the fade of a dithered LOD in the uniform
+            if (!isLodFadeOpaque && program.lodFade.isActive())
+            {
+                program.lodFade.set(1.0f);
+                isLodFadeOpaque = true;
+            }
+
+            if (item.rangeMask != 0) {
+                item.mesh->renderIndexRanges(item.rangeMask);
+            }
+            else if (item.rangeIndex >= 0) {
+                item.mesh->renderIndexRange(item.rangeIndex);
+            }
+            else {
+                item.mesh->render();
+            }
+        }
+
+        previous = &item;
+    }
+
+    _frameStats.numItems = static_cast<int>(_items.size());
+    auto& avoided = _frameStats.stateChangesAvoided;
+    avoided.numProgramChanges = _submissionOrderChanges.numProgramChanges - _frameStats.stateChanges.numProgramChanges;
+    avoided.numTextureChanges = _submissionOrderChanges.numTextureChanges - _frameStats.stateChanges.numTextureChanges;
+    avoided.numVertexArrayChanges = _submissionOrderChanges.numVertexArrayChanges - _frameStats.stateChanges.numVertexArrayChanges;
+    avoided.numTransformUploads = _submissionOrderChanges.numTransformUploads - _frameStats.stateChanges.numTransformUploads;
+    avoided.numDequantizationUploads = _submissionOrderChanges.numDequantizationUploads - _frameStats.stateChanges.numDequantizationUploads;
+}
+
+const RenderQueueStats& RenderQueue::getFrameStats() const
+{
+    return _frameStats;
+}
+
+void RenderQueue::addItem(const Item& item, int pass)
+{
+    // Count state changes the item would need right after the previously submitted one
+    if (_items.empty())
+    {
+        _submissionOrderChanges.numProgramChanges++;
+        _submissionOrderChanges.numTextureChanges++;
+        _submissionOrderChanges.numVertexArrayChanges++;
+        _submissionOrderChanges.numTransformUploads++;
+        _submissionOrderChanges.numDequantizationUploads++;
+    }
+    else
+    {
+        const auto& previous = _items.back();
+        const auto isProgramChanged = previous.material.program->programId != item.material.program->programId;
+        _submissionOrderChanges.numProgramChanges += isProgramChanged ? 1 : 0;
+        _submissionOrderChanges.numTextureChanges += previous.material.textureId != item.material.textureId ? 1 : 0;
+        _submissionOrderChanges.numVertexArrayChanges += previous.mesh->getVertexArrayID() != item.mesh->getVertexArrayID() ? 1 : 0;
+        _submissionOrderChanges.numTransformUploads += isProgramChanged || memcmp(&previous.model, &item.model, sizeof(glm::mat4)) != 0 ? 1 : 0;
+        _submissionOrderChanges.numDequantizationUploads += isProgramChanged
+            || !isSameQuantization(previous.mesh->getQuantizationParameters(), item.mesh->getQuantizationParameters()) ? 1 : 0;
+    }
+
+    const auto viewPosition = _view * item.model[3];
+    const auto key = (static_cast<uint64_t>(std::min(std::max(pass, 0), MAX_PASSES - 1)) << 60)
+        | (static_cast<uint64_t>(item.material.program->programId & 0xFFF) << 48)
+        | (static_cast<uint64_t>(item.material.textureId & 0xFFFF) << 32)
+        | (static_cast<uint64_t>(item.mesh->getVertexArrayID() & 0xFFFF) << 16)
+        | getDepthKey(-viewPosition.z);
+
+    _keys.push_back(SortKey{ key, static_cast<uint32_t>(_items.size()) });
+    _items.push_back(item);
+}
+
+void RenderQueue::sortKeys()
+{
+    const auto numKeys = _keys.size();
+    if (numKeys < 2) {
+        return;
+    }
+
+    // Histograms of all digits are gathered in one pass over the keys
+    size_t histograms[NUM_RADIX_DIGITS][RADIX_SIZE] = {};
+    for (const auto& sortKey : _keys)
+    {
+        for (auto digit = 0; digit < NUM_RADIX_DIGITS; digit++) {
+            histograms[digit][(sortKey.key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+        }
+    }
+
+    // Every pass is stable, so items with equal keys stay in submission order
+    _sortScratch.resize(numKeys);
+    for (auto digit = 0; digit < NUM_RADIX_DIGITS; digit++)
+    {
+        const auto shift = digit * RADIX_BITS;
+        auto& histogram = histograms[digit];
+        if (histogram[(_keys[0].key >> shift) & (RADIX_SIZE - 1)] == numKeys) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (auto& count : histogram)
+        {
+            const auto bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+
+        for (const auto& sortKey : _keys) {
+            _sortScratch[histogram[(sortKey.key >> shift) & (RADIX_SIZE - 1)]++] = sortKey;
+        }
+        _keys.swap(_sortScratch);
+    }
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,179 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "lodManager.h"
+#include "shaderReflection.h"
+#include "staticMeshIndexed3D.h"
+#include "vertexQuantization.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Shader program of rendered items with handles of the uniforms set by render queue, resolved once from program reflection.
+ */
+struct RenderProgram
+{
+    GLuint programId = 0; // Shader program
+    UniformHandle<glm::mat4> model; // Handle of model matrix uniform
+    UniformHandle<float> lodFade; // Handle of LOD fade uniform
+    DequantizationUniforms dequantization; // Handles of dequantization uniforms
+};
+
+/**
+ * Resolves handles of uniforms set by render queue.
+ *
+ * @param reflection  Reflection of linked shader program
+ */
+RenderProgram getRenderProgram(const ShaderReflection& reflection);
+
+/**
+ * Material of rendered item - shader program and texture bound to texture unit 0.
+ */
+struct RenderMaterial
+{
+    const RenderProgram* program = nullptr; // Shader program (must live until the queue is flushed)
+    GLuint textureId = 0; // 2D texture bound to texture unit 0
+};
+
+/**
+ * Numbers of state changes of one frame, by kind of state.
+ */
+struct RenderStateChanges
+{
+    int numProgramChanges = 0; // Changes of shader program
+    int numTextureChanges = 0; // Changes of bound texture
+    int numVertexArrayChanges = 0; // Changes of VAO
+    int numTransformUploads = 0; // Uploads of model matrix uniform
+    int numDequantizationUploads = 0; // Uploads of dequantization uniforms of the mesh
+};
+
+/**
+ * Statistics of rendering of one frame by render queue.
+ */
+struct RenderQueueStats
+{
+    int numItems = 0; // Number of rendered items
+    RenderStateChanges stateChanges; // State changes done when rendering items in sorted order
+    RenderStateChanges stateChangesAvoided; // State changes saved compared to rendering items in submission order
+};
+
+/**
+ * Collects draws of a frame (mesh, material, transform) and renders them sorted by 64-bit keys, so that items sharing
+ * state are rendered together and state is changed only when it really differs. Key packs (from the most significant bits)
+ * pass (4 bits), program (12 bits), texture (16 bits), VAO (16 bits) and view depth (16 bits, front to back for early depth test).
+ * OpenGL names are truncated to their bit widths, colliding names only group worse, rendering stays correct.
+ *
+ * Queue sets model matrix ("model" uniform), LOD fade ("lodFade" uniform) and dequantization uniforms of the meshes
+ * through handles of the render program (no uniform lookups when rendering), other uniforms of the programs must be set by the caller (camera and lights come from frame uniform blocks, see
+ * FrameUniformBuffer). Keys are sorted by LSD radix sort with buffers kept between frames, so that rendering does not
+ * allocate once the queue has grown.
+ */
+class RenderQueue
+{
+public:
+    static const int MAX_PASSES = 16; // Number of passes distinguished by the key (pass 0 is rendered first)
+
+    /**
+     * Starts new frame - forgets items of the previous frame.
+     *
+     * @param view  View matrix of the frame (depth of items is measured in view space)
+     */
+    void begin(const glm::mat4& view);
+
+    /**
+     * Adds draw of a mesh, or of one index range of it.
+     *
+     * @param mesh        Mesh to render (must live until the queue is flushed)
+     * @param rangeIndex  Index range to render (-1 for the whole mesh)
+     * @param material    Program and texture of the draw
+     * @param model       Model matrix of the draw
+     * @param pass        Pass of the draw (0 to MAX_PASSES - 1)
+     */
+    void submit(const StaticMeshIndexed3D* mesh, int rangeIndex, const RenderMaterial& material, const glm::mat4& model, int pass = 0);
+
+    /**
+     * Adds draw of a subset of index ranges of a mesh, rendered with one multi-draw call (see StaticMeshIndexed3D::renderIndexRanges).
+     *
+     * @param mesh       Mesh to render (must live until the queue is flushed)
+     * @param rangeMask  Bitmask of index ranges to render (bit i is range i), nothing is added for empty mask
+     * @param material   Program and texture of the draw
+     * @param model      Model matrix of the draw
+     * @param pass       Pass of the draw (0 to MAX_PASSES - 1)
+     */
+    void submitRanges(const StaticMeshIndexed3D* mesh, unsigned int rangeMask, const RenderMaterial& material, const glm::mat4& model, int pass = 0);
+
+    /**
+     * Adds draw of a LOD instance, its LOD is selected by LOD manager when rendered.
+     *
+     * @param lodManager  LOD manager of the instance (its frame must have begun before the queue is flushed)
+     * @param instance    Instance handle
+     * @param mesh        Mesh of the instance
+     * @param material    Program and texture of the draw
+     * @param model       Model matrix of the draw
+     * @param pass        Pass of the draw (0 to MAX_PASSES - 1)
+     */
+    void submitLod(LodManager& lodManager, int instance, const ParametricMesh* mesh, const RenderMaterial& material, const glm::mat4& model, int pass = 0);
+
+    /**
+     * Sorts submitted items and renders them. Leaves the last used program, texture and VAO bound.
+     */
+    void flush();
+
+    /**
+     * Gets statistics of the last flushed frame.
+     */
+    const RenderQueueStats& getFrameStats() const;
+
+private:
+    /**
+     * Submitted draw.
+     */
+    struct Item
+    {
+        const StaticMeshIndexed3D* mesh; // Rendered mesh
+        int rangeIndex; // Rendered index range (-1 for the whole mesh or ranges of rangeMask)
+        unsigned int rangeMask; // Bitmask of rendered index ranges (0, if rangeIndex is rendered)
+        LodManager* lodManager; // LOD manager selecting LOD of the mesh (nullptr for plain meshes)
+        int lodInstance; // Instance handle in the LOD manager
+        RenderMaterial material; // Program and texture
+        glm::mat4 model; // Model matrix
+    };
+
+    /**
+     * Sort key with index of its item.
+     */
+    struct SortKey
+    {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    glm::mat4 _view = glm::mat4(1.0f); // View matrix of the frame
+    std::vector<Item> _items; // Items submitted in this frame
+    std::vector<SortKey> _keys; // Keys of the items (sorted in flush)
+    std::vector<SortKey> _sortScratch; // Second buffer of radix sort
+    RenderStateChanges _submissionOrderChanges; // State changes items would need in submission order
+    RenderQueueStats _frameStats; // Statistics of the last flushed frame
+
+    /**
+     * Adds item with its key and counts state changes it needs after the previously submitted item.
+     */
+    void addItem(const Item& item, int pass);
+
+    /**
+     * Sorts keys by LSD radix sort over 8-bit digits, digits equal in all keys are skipped.
+     */
+    void sortKeys();
+};
+
+} // namespace static_meshes_3D
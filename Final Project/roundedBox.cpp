@@ -0,0 +1,92 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// GLM
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "roundedBox.h"
+
+namespace static_meshes_3D {
+
+glm::vec3 RoundedBox::getSize() const
+{
+    return _size;
+}
+
+float RoundedBox::getCornerRadius() const
+{
+    return _cornerRadius;
+}
+
+int RoundedBox::getCornerSegments() const
+{
+    return _cornerSegments;
+}
+
+float RoundedBox::generateLod(int lod)
+{
+    // Every face is a grid over the box of half extents, grid points are projected onto the rounded box - points
+    // of flat part stay, points of rounded part go to the sphere around nearest point of the inner box.
+    // Grid coordinates of rounded part are tangents of equal angle steps, so that edges are split evenly.
+    const auto cornerSegments = getLodSegments(_cornerSegments, 1, lod);
+    const auto halfSize = _size / 2.0f;
+    const auto innerHalfSize = halfSize - glm::vec3(_cornerRadius);
+    std::vector<float> gridCoordinates[3];
+    for (auto axis = 0; axis < 3; axis++)
+    {
+        auto& coordinates = gridCoordinates[axis];
+        const auto inner = innerHalfSize[axis];
+        if (_cornerRadius <= 0.0f)
+        {
+            coordinates = { -halfSize[axis], halfSize[axis] };
+            continue;
+        }
+
+        for (auto k = cornerSegments; k > 0; k--) {
+            coordinates.push_back(-inner - _cornerRadius * std::tan(0.25f * glm::pi<float>() * float(k) / float(cornerSegments)));
+        }
+        coordinates.push_back(-inner);
+        coordinates.push_back(inner);
+        for (auto k = 1; k <= cornerSegments; k++) {
+            coordinates.push_back(inner + _cornerRadius * std::tan(0.25f * glm::pi<float>() * float(k) / float(cornerSegments)));
+        }
+    }
+
+    for (auto faceAxis = 0; faceAxis < 3; faceAxis++)
+    {
+        const auto axisU = (faceAxis + 1) % 3;
+        const auto axisV = (faceAxis + 2) % 3;
+        const auto& coordinatesU = gridCoordinates[axisU];
+        const auto& coordinatesV = gridCoordinates[axisV];
+        for (auto side = -1; side <= 1; side += 2)
+        {
+            auto faceNormal = glm::vec3(0.0f);
+            faceNormal[faceAxis] = float(side);
+            const auto segmentsU = static_cast<int>(coordinatesU.size()) - 1;
+            const auto segmentsV = static_cast<int>(coordinatesV.size()) - 1;
+            addSurface(segmentsU, segmentsV, false, false, [&](int i, int j, glm::vec3& position, glm::vec3& normal)
+            {
+                glm::vec3 gridPoint;
+                gridPoint[faceAxis] = halfSize[faceAxis] * float(side);
+                gridPoint[axisU] = coordinatesU[i];
+                gridPoint[axisV] = coordinatesV[j];
+
+                const auto innerPoint = glm::clamp(gridPoint, -innerHalfSize, innerHalfSize);
+                normal = _cornerRadius > 0.0f ? glm::normalize(gridPoint - innerPoint) : faceNormal;
+                position = innerPoint + normal * _cornerRadius;
+            });
+        }
+    }
+
+    return getChordError(_cornerRadius, 4 * cornerSegments);
+}
+
+std::vector<unsigned char> RoundedBox::getMeshFileKey() const
+{
+    return makeMeshFileKey("RoundedBox", _size, _cornerRadius, _cornerSegments);
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,77 @@
+#pragma once
+
+// STL
+#include <algorithm>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "parametricMesh.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Box centered at origin with edges and corners rounded by given radius.
+ */
+class RoundedBox : public ParametricMesh
+{
+public:
+    /**
+     * Creates rounded box with compile-time vertex layout (all float attributes by default), attributes not present in the layout are not stored.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    RoundedBox(const glm::vec3& size, float cornerRadius, int cornerSegments, int lodCount = 1,
+        Layout layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+        : ParametricMesh(lodCount, layout, vertexStorage)
+        , _size(size)
+        , _cornerRadius(clampCornerRadius(size, cornerRadius))
+        , _cornerSegments(cornerSegments)
+    {
+        initializeData();
+    }
+
+    /**
+     * Makes MeshCache key of the box created with given constructor arguments (see Cylinder::cacheKey), number of LODs is part of it.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    static std::vector<unsigned char> cacheKey(const glm::vec3& size, float cornerRadius, int cornerSegments, int lodCount = 1,
+        Layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+    {
+        return makeGeneratorKey("RoundedBox", Layout::getFormat(), vertexStorage, size, clampCornerRadius(size, cornerRadius), cornerSegments, clampLodCount(lodCount));
+    }
+
+    /**
+     * Gets size of the box (full extents).
+     */
+    glm::vec3 getSize() const;
+
+    /**
+     * Gets radius of rounded edges (clamped to half of the smallest extent).
+     */
+    float getCornerRadius() const;
+
+    /**
+     * Gets number of segments of one rounded edge of the finest LOD.
+     */
+    int getCornerSegments() const;
+
+protected:
+    float generateLod(int lod) override;
+    std::vector<unsigned char> getMeshFileKey() const override;
+
+private:
+    glm::vec3 _size; // Full extents of the box
+    float _cornerRadius; // Radius of rounded edges and corners
+    int _cornerSegments; // Number of segments of one rounded edge
+
+    /**
+     * Clamps radius of rounded edges to half of the smallest extent of the box.
+     */
+    static float clampCornerRadius(const glm::vec3& size, float cornerRadius)
+    {
+        return std::max(0.0f, std::min(cornerRadius, std::min(size.x, std::min(size.y, size.z)) / 2.0f));
+    }
+};
+
+} // namespace static_meshes_3D
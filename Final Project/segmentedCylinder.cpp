@@ -0,0 +1,50 @@
+// Project
+#include "segmentedCylinder.h"
+#include "sinCosTable.h"
+
+namespace static_meshes_3D {
+
+float SegmentedCylinder::getRadius() const
+{
+    return _radius;
+}
+
+float SegmentedCylinder::getHeight() const
+{
+    return _height;
+}
+
+int SegmentedCylinder::getRadialSegments() const
+{
+    return _radialSegments;
+}
+
+int SegmentedCylinder::getHeightSegments() const
+{
+    return _heightSegments;
+}
+
+float SegmentedCylinder::generateLod(int lod)
+{
+    const auto radialSegments = getLodSegments(_radialSegments, 3, lod);
+    const auto heightSegments = getLodSegments(_heightSegments, 1, lod);
+    const auto halfHeight = _height / 2.0f;
+    const auto& sliceTable = getSinCosTable(radialSegments);
+    addSurface(radialSegments, heightSegments, true, false, [this, heightSegments, halfHeight, &sliceTable](int i, int j, glm::vec3& position, glm::vec3& normal)
+    {
+        normal = glm::vec3(sliceTable.getCosines()[i], 0.0f, sliceTable.getSines()[i]);
+        position = glm::vec3(normal.x * _radius, halfHeight - _height * float(j) / float(heightSegments), normal.z * _radius);
+    });
+
+    addDisk(glm::vec3(0.0f, halfHeight, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), _radius, radialSegments);
+    addDisk(glm::vec3(0.0f, -halfHeight, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), _radius, radialSegments);
+
+    return getChordError(_radius, radialSegments);
+}
+
+std::vector<unsigned char> SegmentedCylinder::getMeshFileKey() const
+{
+    return makeMeshFileKey("SegmentedCylinder", _radius, _height, _radialSegments, _heightSegments);
+}
+
+} // namespace static_meshes_3D
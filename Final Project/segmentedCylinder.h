@@ -0,0 +1,70 @@
+#pragma once
+
+// Project
+#include "parametricMesh.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Indexed cylinder along Y axis with side split into height segments and both covers.
+ */
+class SegmentedCylinder : public ParametricMesh
+{
+public:
+    /**
+     * Creates cylinder with compile-time vertex layout (all float attributes by default), attributes not present in the layout are not stored.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    SegmentedCylinder(float radius, float height, int radialSegments, int heightSegments = 1, int lodCount = 1,
+        Layout layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+        : ParametricMesh(lodCount, layout, vertexStorage)
+        , _radius(radius)
+        , _height(height)
+        , _radialSegments(radialSegments)
+        , _heightSegments(heightSegments)
+    {
+        initializeData();
+    }
+
+    /**
+     * Makes MeshCache key of the cylinder created with given constructor arguments (see Cylinder::cacheKey), number of LODs is part of it.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    static std::vector<unsigned char> cacheKey(float radius, float height, int radialSegments, int heightSegments = 1, int lodCount = 1,
+        Layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+    {
+        return makeGeneratorKey("SegmentedCylinder", Layout::getFormat(), vertexStorage, radius, height, radialSegments, heightSegments, clampLodCount(lodCount));
+    }
+
+    /**
+     * Gets cylinder radius.
+     */
+    float getRadius() const;
+
+    /**
+     * Gets cylinder height.
+     */
+    float getHeight() const;
+
+    /**
+     * Gets number of radial segments of the finest LOD.
+     */
+    int getRadialSegments() const;
+
+    /**
+     * Gets number of height segments of the finest LOD.
+     */
+    int getHeightSegments() const;
+
+protected:
+    float generateLod(int lod) override;
+    std::vector<unsigned char> getMeshFileKey() const override;
+
+private:
+    float _radius; // Cylinder radius
+    float _height; // Cylinder height
+    int _radialSegments; // Number of segments around Y axis
+    int _heightSegments; // Number of segments along Y axis
+};
+
+} // namespace static_meshes_3D
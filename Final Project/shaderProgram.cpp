@@ -0,0 +1,53 @@
+// STL
+#include <iostream>
+
+// Project
+#include "shaderProgram.h"
+
+namespace static_meshes_3D {
+
+GLuint createShaderProgram(const char* programName, const ShaderStage* stages, size_t numStages)
+{
+    GLint success = GL_FALSE;
+    GLchar infoLog[512];
+    const auto programId = glCreateProgram();
+    for (size_t i = 0; i < numStages; i++)
+    {
+        const auto shaderId = glCreateShader(stages[i].type);
+        glShaderSource(shaderId, 1, &stages[i].source, nullptr);
+        glCompileShader(shaderId);
+        glGetShaderiv(shaderId, GL_COMPILE_STATUS, &success);
+        if (success != GL_TRUE)
+        {
+            glGetShaderInfoLog(shaderId, sizeof(infoLog), nullptr, infoLog);
+            std::cerr << "Could not compile shader " << i << " of " << programName << " program!\n" << infoLog << std::endl;
+            glDeleteShader(shaderId);
+            glDeleteProgram(programId);
+            return 0;
+        }
+
+        // Attached shader is deleted together with the program
+        glAttachShader(programId, shaderId);
+        glDeleteShader(shaderId);
+    }
+
+    glLinkProgram(programId);
+    glGetProgramiv(programId, GL_LINK_STATUS, &success);
+    if (success != GL_TRUE)
+    {
+        glGetProgramInfoLog(programId, sizeof(infoLog), nullptr, infoLog);
+        std::cerr << "Could not link " << programName << " program!\n" << infoLog << std::endl;
+        glDeleteProgram(programId);
+        return 0;
+    }
+
+    return programId;
+}
+
+GLuint createShaderProgram(const char* programName, const char* vertexShaderSource, const char* fragmentShaderSource)
+{
+    const ShaderStage stages[] = { { GL_VERTEX_SHADER, vertexShaderSource }, { GL_FRAGMENT_SHADER, fragmentShaderSource } };
+    return createShaderProgram(programName, stages, 2);
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,43 @@
+#pragma once
+
+// STL
+#include <cstddef>
+
+// GLAD
+#include <gl/glew.h>
+
+namespace static_meshes_3D {
+
+/**
+ * Source of one shader stage of a program.
+ */
+struct ShaderStage
+{
+    GLenum type; // Shader type, e.g. GL_VERTEX_SHADER
+    const char* source; // GLSL source code
+};
+
+/**
+ * Compiles shader stages and links them into a program. Compilation and linking errors are reported to std::cerr
+ * together with the name of the program.
+ *
+ * @param programName  Name of the program used in error messages
+ * @param stages       Shader stages of the program
+ * @param numStages    Number of shader stages
+ *
+ * @return OpenGL ID of the program or 0, if any stage could not be compiled or the program could not be linked.
+ */
+GLuint createShaderProgram(const char* programName, const ShaderStage* stages, size_t numStages);
+
+/**
+ * Compiles and links program of a vertex and a fragment shader (see createShaderProgram above).
+ *
+ * @param programName           Name of the program used in error messages
+ * @param vertexShaderSource    GLSL source code of the vertex shader
+ * @param fragmentShaderSource  GLSL source code of the fragment shader
+ *
+ * @return OpenGL ID of the program or 0, if it could not be built.
+ */
+GLuint createShaderProgram(const char* programName, const char* vertexShaderSource, const char* fragmentShaderSource);
+
+} // namespace static_meshes_3D
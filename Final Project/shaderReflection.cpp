@@ -0,0 +1,217 @@
+// STL
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Project
+#include "shaderReflection.h"
+
+namespace static_meshes_3D {
+
+uint64_t ShaderReflection::_numLookupsEliminated = 0;
+
+namespace {
+
+const GLenum SAMPLER_TYPES[] = {
+    GL_SAMPLER_1D, GL_SAMPLER_2D, GL_SAMPLER_3D, GL_SAMPLER_CUBE, GL_SAMPLER_1D_ARRAY, GL_SAMPLER_2D_ARRAY,
+    GL_SAMPLER_2D_SHADOW, GL_SAMPLER_CUBE_SHADOW, GL_SAMPLER_2D_ARRAY_SHADOW, GL_SAMPLER_2D_MULTISAMPLE, GL_SAMPLER_BUFFER
+};
+
+bool isSamplerType(GLenum type)
+{
+    for (const auto samplerType : SAMPLER_TYPES)
+    {
+        if (samplerType == type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Int handles set also samplers and bools, as glUniform1i does
+bool isCompatibleUniformType(GLenum uniformType, GLenum handleType)
+{
+    if (uniformType == handleType) {
+        return true;
+    }
+    return handleType == GL_INT && (uniformType == GL_BOOL || isSamplerType(uniformType));
+}
+
+// Resources of different kinds may share names (e.g. block and its instance), so kind is mixed into the slot hash
+uint32_t getSlotHash(ShaderResourceKind kind, uint32_t nameHash)
+{
+    return nameHash ^ (static_cast<uint32_t>(kind) * 0x9E3779B9u);
+}
+
+} // namespace
+
+bool ShaderReflection::reflect(GLuint programId)
+{
+    _programId = 0;
+    _resources.clear();
+    _slots.clear();
+
+    GLint isLinked = GL_FALSE;
+    glGetProgramiv(programId, GL_LINK_STATUS, &isLinked);
+    if (isLinked != GL_TRUE)
+    {
+        std::cerr << "Cannot reflect shader program " << programId << ", it's not linked!" << std::endl;
+        return false;
+    }
+
+    _programId = programId;
+    reflectInterface(GL_UNIFORM, ShaderResourceKind::Uniform);
+    reflectInterface(GL_UNIFORM_BLOCK, ShaderResourceKind::UniformBlock);
+    reflectInterface(GL_SHADER_STORAGE_BLOCK, ShaderResourceKind::StorageBlock);
+    reflectInterface(GL_PROGRAM_INPUT, ShaderResourceKind::Attribute);
+    buildSlots();
+    return true;
+}
+
+GLuint ShaderReflection::getProgramId() const
+{
+    return _programId;
+}
+
+GLint ShaderReflection::getUniformBlockBinding(ResourceName name) const
+{
+    const auto resource = findResource(ShaderResourceKind::UniformBlock, name);
+    return resource != nullptr ? resource->location : -1;
+}
+
+GLint ShaderReflection::getStorageBlockBinding(ResourceName name) const
+{
+    const auto resource = findResource(ShaderResourceKind::StorageBlock, name);
+    return resource != nullptr ? resource->location : -1;
+}
+
+GLint ShaderReflection::getAttributeLocation(ResourceName name) const
+{
+    const auto resource = findResource(ShaderResourceKind::Attribute, name);
+    return resource != nullptr ? resource->location : -1;
+}
+
+const ShaderResource* ShaderReflection::findResource(ShaderResourceKind kind, ResourceName name) const
+{
+    if (_slots.empty()) {
+        return nullptr;
+    }
+
+    // Linear probing ends at the first empty slot, table is at most half full
+    const auto mask = _slots.size() - 1;
+    for (auto slot = getSlotHash(kind, name.getHash()) & mask; _slots[slot] != -1; slot = (slot + 1) & mask)
+    {
+        const auto& resource = _resources[_slots[slot]];
+        if (resource.nameHash == name.getHash() && resource.kind == kind && resource.name == name.getName()) {
+            return &resource;
+        }
+    }
+
+    return nullptr;
+}
+
+const std::vector<ShaderResource>& ShaderReflection::getResources() const
+{
+    return _resources;
+}
+
+uint64_t ShaderReflection::getNumLookupsEliminated()
+{
+    return _numLookupsEliminated;
+}
+
+void ShaderReflection::resetNumLookupsEliminated()
+{
+    _numLookupsEliminated = 0;
+}
+
+void ShaderReflection::reflectInterface(GLenum programInterface, ShaderResourceKind kind)
+{
+    GLint numResources = 0;
+    GLint maxNameLength = 0;
+    glGetProgramInterfaceiv(_programId, programInterface, GL_ACTIVE_RESOURCES, &numResources);
+    glGetProgramInterfaceiv(_programId, programInterface, GL_MAX_NAME_LENGTH, &maxNameLength);
+    std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+
+    const auto isBlock = kind == ShaderResourceKind::UniformBlock || kind == ShaderResourceKind::StorageBlock;
+    for (auto index = 0; index < numResources; index++)
+    {
+        ShaderResource resource;
+        resource.kind = kind;
+        if (isBlock)
+        {
+            const GLenum properties[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+            GLint values[2];
+            glGetProgramResourceiv(_programId, programInterface, index, 2, properties, 2, nullptr, values);
+            resource.type = 0;
+            resource.location = values[0];
+            resource.size = values[1];
+        }
+        else
+        {
+            const GLenum properties[] = { GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE };
+            GLint values[3];
+            glGetProgramResourceiv(_programId, programInterface, index, 3, properties, 3, nullptr, values);
+            resource.type = static_cast<GLenum>(values[0]);
+            resource.location = values[1];
+            resource.size = values[2];
+
+            // Members of uniform blocks have no location, they are accessed through their block
+            if (resource.location == -1) {
+                continue;
+            }
+        }
+
+        GLsizei nameLength = 0;
+        glGetProgramResourceName(_programId, programInterface, index, static_cast<GLsizei>(nameBuffer.size()), &nameLength, nameBuffer.data());
+        resource.name.assign(nameBuffer.data(), nameLength);
+
+        // Arrays are reported as name[0], but they are set by their name
+        const auto arraySuffixLength = strlen("[0]");
+        if (resource.name.size() > arraySuffixLength && resource.name.compare(resource.name.size() - arraySuffixLength, arraySuffixLength, "[0]") == 0) {
+            resource.name.resize(resource.name.size() - arraySuffixLength);
+        }
+
+        resource.nameHash = hashResourceName(resource.name.c_str());
+        _resources.push_back(resource);
+    }
+}
+
+void ShaderReflection::buildSlots()
+{
+    size_t numSlots = 16;
+    while (numSlots < 2 * _resources.size()) {
+        numSlots *= 2;
+    }
+
+    _slots.assign(numSlots, -1);
+    const auto mask = numSlots - 1;
+    for (auto index = 0; index < static_cast<int>(_resources.size()); index++)
+    {
+        const auto& resource = _resources[index];
+        auto slot = getSlotHash(resource.kind, resource.nameHash) & mask;
+        while (_slots[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        _slots[slot] = index;
+    }
+}
+
+GLint ShaderReflection::findUniformLocation(ResourceName name, GLenum type) const
+{
+    const auto resource = findResource(ShaderResourceKind::Uniform, name);
+    if (resource == nullptr) {
+        return -1;
+    }
+
+    if (!isCompatibleUniformType(resource->type, type))
+    {
+        std::cerr << "Uniform " << name.getName() << " of shader program " << _programId << " has type 0x" << std::hex << resource->type
+                  << ", but its handle has type 0x" << type << std::dec << "!" << std::endl;
+        return -1;
+    }
+
+    return resource->location;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,278 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+namespace static_meshes_3D {
+
+/**
+ * Gets FNV-1a hash of shader resource name. It's constexpr, so hashes of literal names are computed at compile time.
+ */
+constexpr uint32_t hashResourceName(const char* name)
+{
+    uint32_t hash = 2166136261u;
+    for (; *name != '\0'; name++) {
+        hash = (hash ^ static_cast<uint8_t>(*name)) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Name of shader resource (uniform, block or attribute) together with its hash. Declared as constexpr constant
+ * (e.g. constexpr ResourceName MODEL_UNIFORM("model")), the name is hashed at compile time.
+ */
+class ResourceName
+{
+public:
+    /**
+     * @param name  Resource name (must outlive this object, string literals do)
+     */
+    constexpr ResourceName(const char* name)
+        : _name(name)
+        , _hash(hashResourceName(name))
+    {
+    }
+
+    constexpr const char* getName() const { return _name; }
+    constexpr uint32_t getHash() const { return _hash; }
+
+private:
+    const char* _name; // Resource name
+    uint32_t _hash; // Hash of the name
+};
+
+/**
+ * Maps C++ type of uniform to its OpenGL type and glUniform* call. Samplers are set as int.
+ */
+template<typename T> struct UniformType;
+
+template<> struct UniformType<bool>
+{
+    static const GLenum OPENGL_TYPE = GL_BOOL;
+    static void upload(GLint location, bool value) { glUniform1i(location, value ? 1 : 0); }
+};
+
+template<> struct UniformType<int>
+{
+    static const GLenum OPENGL_TYPE = GL_INT;
+    static void upload(GLint location, int value) { glUniform1i(location, value); }
+};
+
+template<> struct UniformType<float>
+{
+    static const GLenum OPENGL_TYPE = GL_FLOAT;
+    static void upload(GLint location, float value) { glUniform1f(location, value); }
+};
+
+template<> struct UniformType<glm::vec2>
+{
+    static const GLenum OPENGL_TYPE = GL_FLOAT_VEC2;
+    static void upload(GLint location, const glm::vec2& value) { glUniform2fv(location, 1, &value[0]); }
+};
+
+template<> struct UniformType<glm::vec3>
+{
+    static const GLenum OPENGL_TYPE = GL_FLOAT_VEC3;
+    static void upload(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, &value[0]); }
+};
+
+template<> struct UniformType<glm::vec4>
+{
+    static const GLenum OPENGL_TYPE = GL_FLOAT_VEC4;
+    static void upload(GLint location, const glm::vec4& value) { glUniform4fv(location, 1, &value[0]); }
+};
+
+template<> struct UniformType<glm::mat3>
+{
+    static const GLenum OPENGL_TYPE = GL_FLOAT_MAT3;
+    static void upload(GLint location, const glm::mat3& value) { glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]); }
+};
+
+template<> struct UniformType<glm::mat4>
+{
+    static const GLenum OPENGL_TYPE = GL_FLOAT_MAT4;
+    static void upload(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]); }
+};
+
+/**
+ * Typed handle of uniform of the default block, resolved once by ShaderReflection::getUniform. Setting it costs just
+ * the glUniform* call. Handle of uniform, that is not active in the program, is valid to set and does nothing.
+ */
+template<typename T>
+class UniformHandle
+{
+public:
+    UniformHandle() = default;
+    explicit UniformHandle(GLint location) : _location(location) {}
+
+    /**
+     * Sets the uniform of the currently used program.
+     */
+    void set(const T& value) const;
+
+    /**
+     * Checks, if the uniform is active in the program.
+     */
+    bool isActive() const { return _location != -1; }
+
+    /**
+     * Gets uniform location (-1 if the uniform is not active).
+     */
+    GLint getLocation() const { return _location; }
+
+private:
+    GLint _location = -1; // Uniform location
+};
+
+/**
+ * Kind of shader resource.
+ */
+enum class ShaderResourceKind
+{
+    Uniform, // Uniform of the default block
+    UniformBlock, // Uniform block
+    StorageBlock, // Shader storage block
+    Attribute // Vertex shader input
+};
+
+/**
+ * Active resource of linked program, as enumerated by program interface query.
+ */
+struct ShaderResource
+{
+    std::string name; // Name (without [0] suffix of arrays)
+    uint32_t nameHash; // Hash of the name
+    ShaderResourceKind kind; // Kind of the resource
+    GLenum type; // OpenGL type of uniforms and attributes (0 for blocks)
+    GLint location; // Location of uniforms and attributes, binding of blocks
+    GLint size; // Array size of uniforms and attributes, data size of blocks (in bytes)
+};
+
+/**
+ * Reflection of linked shader program - active uniforms, uniform and storage blocks and attributes, enumerated once
+ * after linking (glGetProgramInterfaceiv / glGetProgramResourceiv) into a flat open-addressing hash table keyed by
+ * name hashes. Uniforms are then set through typed handles resolved once, so neither strings nor glGetUniformLocation
+ * calls are needed when rendering. Every set of an active handle counts as an eliminated lookup, i.e. a glGetUniformLocation
+ * call setting the uniform by name would have needed (inactive handles set nothing, so they save nothing).
+ */
+class ShaderReflection
+{
+public:
+    /**
+     * Enumerates active resources of the program (forgets previously reflected program).
+     *
+     * @param programId  Linked shader program
+     *
+     * @return True, if program has been reflected, false otherwise (program is not linked).
+     */
+    bool reflect(GLuint programId);
+
+    /**
+     * Gets reflected shader program.
+     */
+    GLuint getProgramId() const;
+
+    /**
+     * Resolves typed handle of uniform of the default block. Uniform of other type than T is reported to std::cerr
+     * and gets inactive handle, missing uniform (e.g. optimized out by the compiler) gets inactive handle silently.
+     *
+     * @param name  Uniform name
+     */
+    template<typename T>
+    UniformHandle<T> getUniform(ResourceName name) const
+    {
+        return UniformHandle<T>(findUniformLocation(name, UniformType<T>::OPENGL_TYPE));
+    }
+
+    /**
+     * Gets binding of uniform block (-1 if the block is not active).
+     */
+    GLint getUniformBlockBinding(ResourceName name) const;
+
+    /**
+     * Gets binding of shader storage block (-1 if the block is not active).
+     */
+    GLint getStorageBlockBinding(ResourceName name) const;
+
+    /**
+     * Gets location of vertex shader input (-1 if the attribute is not active).
+     */
+    GLint getAttributeLocation(ResourceName name) const;
+
+    /**
+     * Finds active resource.
+     *
+     * @param kind  Kind of the resource
+     * @param name  Name of the resource
+     *
+     * @return Resource, or nullptr if it's not active in the program.
+     */
+    const ShaderResource* findResource(ShaderResourceKind kind, ResourceName name) const;
+
+    /**
+     * Gets all active resources of the program.
+     */
+    const std::vector<ShaderResource>& getResources() const;
+
+    /**
+     * Counts one uniform set through an active handle (done by UniformHandle::set).
+     */
+    static void countEliminatedLookup();
+
+    /**
+     * Gets number of uniform sets done through active handles since the last reset, each of them saved a glGetUniformLocation call.
+     */
+    static uint64_t getNumLookupsEliminated();
+
+    /**
+     * Resets number of eliminated lookups (e.g. every frame).
+     */
+    static void resetNumLookupsEliminated();
+
+private:
+    GLuint _programId = 0; // Reflected program
+    std::vector<ShaderResource> _resources; // Active resources of the program
+    std::vector<int> _slots; // Open-addressing hash table of resource indices (-1 for empty slot), size is power of two
+
+    static uint64_t _numLookupsEliminated; // Number of uniform sets done through active handles since the last reset
+
+    /**
+     * Enumerates active resources of one program interface.
+     */
+    void reflectInterface(GLenum programInterface, ShaderResourceKind kind);
+
+    /**
+     * Builds hash table of all resources.
+     */
+    void buildSlots();
+
+    /**
+     * Finds location of uniform of the default block and checks its type.
+     */
+    GLint findUniformLocation(ResourceName name, GLenum type) const;
+};
+
+template<typename T>
+void UniformHandle<T>::set(const T& value) const
+{
+    if (_location != -1)
+    {
+        UniformType<T>::upload(_location, value);
+        ShaderReflection::countEliminatedLookup();
+    }
+}
+
+inline void ShaderReflection::countEliminatedLookup()
+{
+    _numLookupsEliminated++;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,57 @@
+// STL
+#include <iostream>
+
+// Project
+#include "simplifiedMesh.h"
+
+namespace static_meshes_3D {
+
+SimplifiedMesh::SimplifiedMesh(StaticMeshIndexed3D& source, int rangeIndex, int lodCount, float triangleRatio, float maxError, const SimplificationWeights& weights)
+    : ParametricMesh(lodCount, source.getVertexFormat(), source.getVertexStorage())
+    , _triangleRatio(triangleRatio)
+    , _maxError(maxError)
+    , _weights(weights)
+{
+    if (!source.hasPositions() || !source.readGeometry(_sourcePositions, _sourceTextureCoordinates, _sourceNormals, _sourceIndices, rangeIndex))
+    {
+        std::cerr << "Mesh geometry could not be read for simplification!" << std::endl;
+        return;
+    }
+
+    initializeData();
+
+    // Source geometry lives on the GPU now
+    std::vector<glm::vec3>().swap(_sourcePositions);
+    std::vector<glm::vec2>().swap(_sourceTextureCoordinates);
+    std::vector<glm::vec3>().swap(_sourceNormals);
+    std::vector<GLuint>().swap(_sourceIndices);
+}
+
+float SimplifiedMesh::generateLod(int lod)
+{
+    if (lod == 0)
+    {
+        _firstVertex = addVertexData(_sourcePositions.data(), _sourceTextureCoordinates.empty() ? nullptr : _sourceTextureCoordinates.data(),
+            _sourceNormals.empty() ? nullptr : _sourceNormals.data(), _sourcePositions.size());
+        addTriangles(_sourceIndices.data(), _sourceIndices.size(), _firstVertex);
+        return 0.0f;
+    }
+
+    // Every LOD is simplified from the source, so that errors don't accumulate over the chain
+    const auto previousNumTriangles = static_cast<size_t>(getLodTriangleCount(lod - 1));
+    const auto targetNumTriangles = static_cast<size_t>(previousNumTriangles * _triangleRatio);
+    std::vector<GLuint> simplifiedIndices;
+    const auto error = simplifyMesh(_sourcePositions.data(), _sourceTextureCoordinates.empty() ? nullptr : _sourceTextureCoordinates.data(),
+        _sourceNormals.empty() ? nullptr : _sourceNormals.data(), _sourcePositions.size(), _sourceIndices.data(), _sourceIndices.size(),
+        targetNumTriangles, _maxError, simplifiedIndices, _weights);
+
+    const auto numTriangles = simplifiedIndices.size() / 3;
+    if (numTriangles == 0 || numTriangles >= previousNumTriangles) {
+        return -1.0f;
+    }
+
+    addTriangles(simplifiedIndices.data(), simplifiedIndices.size(), _firstVertex);
+    return error;
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,50 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// Project
+#include "parametricMesh.h"
+#include "meshSimplifier.h"
+
+namespace static_meshes_3D {
+
+/**
+ * LOD chain of an arbitrary indexed mesh (e.g. imported or welded from triangle soup), made by quadric error simplification.
+ * LOD 0 is the source mesh, every next LOD is simplified from the source to a fraction of triangles of the previous one.
+ * All LODs share vertices of the source, so the chain adds only indices. Chain ends early, when the mesh can't be simplified
+ * further within the error budget (seams, boundaries and hard edges are preserved, so e.g. flat shaded box does not simplify at all).
+ */
+class SimplifiedMesh : public ParametricMesh
+{
+public:
+    /**
+     * Creates LOD chain of finalized mesh (or one of its index ranges), with the same vertex attributes and storage.
+     *
+     * @param source         Mesh to simplify (triangle list with float vertices, see readGeometry)
+     * @param rangeIndex     Index range of the source to simplify (-1 for the whole mesh)
+     * @param lodCount       Maximal number of LODs including the source one
+     * @param triangleRatio  Number of triangles of every LOD relative to the previous one
+     * @param maxError       Error budget - maximal geometric error of one collapse in model units
+     * @param weights        Weights of vertex attributes in the collapse cost
+     */
+    SimplifiedMesh(StaticMeshIndexed3D& source, int rangeIndex = -1, int lodCount = MAX_LOD_COUNT, float triangleRatio = 0.5f,
+        float maxError = 1.0f, const SimplificationWeights& weights = SimplificationWeights());
+
+protected:
+    float generateLod(int lod) override;
+
+private:
+    float _triangleRatio; // Number of triangles of every LOD relative to the previous one
+    float _maxError; // Error budget in model units
+    SimplificationWeights _weights; // Weights of vertex attributes in the collapse cost
+    GLuint _firstVertex = 0; // First vertex of the source among generated vertices
+
+    // Source geometry, released after upload
+    std::vector<glm::vec3> _sourcePositions;
+    std::vector<glm::vec2> _sourceTextureCoordinates;
+    std::vector<glm::vec3> _sourceNormals;
+    std::vector<GLuint> _sourceIndices;
+};
+
+} // namespace static_meshes_3D
@@ -0,0 +1,184 @@
+// STL
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Project
+#include "sinCosTable.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Taylor series of sine and cosine, precise to double for |x| <= pi / 4
+constexpr double taylorSin(double x)
+{
+    auto term = x;
+    auto sum = x;
+    for (auto k = 1; k < 12; k++)
+    {
+        term *= -x * x / double((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+
+constexpr double taylorCos(double x)
+{
+    auto term = 1.0;
+    auto sum = 1.0;
+    for (auto k = 1; k < 12; k++)
+    {
+        term *= -x * x / double((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+// Sine and cosine of 2 * pi * i / n, reduced to first octant with integer arithmetic, so that symmetric entries are
+// exactly symmetric and quadrant angles give exact zeros and ones
+constexpr void exactSinCos(int i, int n, float& sine, float& cosine)
+{
+    const auto quadrant = (4 * i) / n;
+    const auto remainder = 4 * i - quadrant * n;
+    const auto isUpperOctant = 2 * remainder > n;
+    const auto reducedAngle = PI / 2.0 * double(isUpperOctant ? n - remainder : remainder) / double(n);
+    auto s = isUpperOctant ? taylorCos(reducedAngle) : taylorSin(reducedAngle);
+    auto c = isUpperOctant ? taylorSin(reducedAngle) : taylorCos(reducedAngle);
+    for (auto q = 0; q < quadrant % 4; q++)
+    {
+        const auto rotatedSine = c;
+        c = -s;
+        s = rotatedSine;
+    }
+
+    sine = float(s);
+    cosine = float(c);
+}
+
+/**
+ * Table of sines and cosines evaluated at compile time.
+ */
+template<int NumSegments>
+struct PrecomputedSinCos
+{
+    float sines[NumSegments + 1] = {};
+    float cosines[NumSegments + 1] = {};
+
+    constexpr PrecomputedSinCos()
+    {
+        for (auto i = 0; i < NumSegments; i++) {
+            exactSinCos(i, NumSegments, sines[i], cosines[i]);
+        }
+
+        sines[NumSegments] = sines[0];
+        cosines[NumSegments] = cosines[0];
+    }
+};
+
+template<int NumSegments>
+constexpr PrecomputedSinCos<NumSegments> PRECOMPUTED_SIN_COS{};
+
+// Common numbers of slices and their halvings in LOD chains
+const SinCosTable PRECOMPUTED_TABLES[] = {
+    SinCosTable(3, PRECOMPUTED_SIN_COS<3>.sines, PRECOMPUTED_SIN_COS<3>.cosines),
+    SinCosTable(4, PRECOMPUTED_SIN_COS<4>.sines, PRECOMPUTED_SIN_COS<4>.cosines),
+    SinCosTable(6, PRECOMPUTED_SIN_COS<6>.sines, PRECOMPUTED_SIN_COS<6>.cosines),
+    SinCosTable(8, PRECOMPUTED_SIN_COS<8>.sines, PRECOMPUTED_SIN_COS<8>.cosines),
+    SinCosTable(9, PRECOMPUTED_SIN_COS<9>.sines, PRECOMPUTED_SIN_COS<9>.cosines),
+    SinCosTable(12, PRECOMPUTED_SIN_COS<12>.sines, PRECOMPUTED_SIN_COS<12>.cosines),
+    SinCosTable(16, PRECOMPUTED_SIN_COS<16>.sines, PRECOMPUTED_SIN_COS<16>.cosines),
+    SinCosTable(18, PRECOMPUTED_SIN_COS<18>.sines, PRECOMPUTED_SIN_COS<18>.cosines),
+    SinCosTable(24, PRECOMPUTED_SIN_COS<24>.sines, PRECOMPUTED_SIN_COS<24>.cosines),
+    SinCosTable(32, PRECOMPUTED_SIN_COS<32>.sines, PRECOMPUTED_SIN_COS<32>.cosines),
+    SinCosTable(36, PRECOMPUTED_SIN_COS<36>.sines, PRECOMPUTED_SIN_COS<36>.cosines),
+    SinCosTable(48, PRECOMPUTED_SIN_COS<48>.sines, PRECOMPUTED_SIN_COS<48>.cosines),
+    SinCosTable(64, PRECOMPUTED_SIN_COS<64>.sines, PRECOMPUTED_SIN_COS<64>.cosines),
+    SinCosTable(72, PRECOMPUTED_SIN_COS<72>.sines, PRECOMPUTED_SIN_COS<72>.cosines),
+};
+
+} // namespace
+
+SinCosTable::SinCosTable(int numSegments)
+    : _numSegments(numSegments)
+    , _storage(static_cast<size_t>(numSegments + 1) * 2)
+    , _sines(_storage.data())
+    , _cosines(_storage.data() + numSegments + 1)
+{
+    const auto sines = _storage.data();
+    const auto cosines = sines + numSegments + 1;
+    computeSinCos(0.0, 2.0 * PI / double(numSegments), numSegments, sines, cosines);
+    sines[numSegments] = sines[0];
+    cosines[numSegments] = cosines[0];
+}
+
+SinCosTable::SinCosTable(int numSegments, const float* sines, const float* cosines)
+    : _numSegments(numSegments)
+    , _sines(sines)
+    , _cosines(cosines) {}
+
+int SinCosTable::getNumSegments() const
+{
+    return _numSegments;
+}
+
+const float* SinCosTable::getSines() const
+{
+    return _sines;
+}
+
+const float* SinCosTable::getCosines() const
+{
+    return _cosines;
+}
+
+const SinCosTable& getSinCosTable(int numSegments)
+{
+    for (const auto& table : PRECOMPUTED_TABLES)
+    {
+        if (table.getNumSegments() == numSegments) {
+            return table;
+        }
+    }
+
+    if (numSegments < 1)
+    {
+        std::cerr << "Sine / cosine table needs at least one segment!" << std::endl;
+        numSegments = 1;
+    }
+
+    static std::mutex cacheMutex;
+    static std::unordered_map<int, std::unique_ptr<SinCosTable>> cachedTables;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto& table = cachedTables[numSegments];
+    if (!table) {
+        table = std::make_unique<SinCosTable>(numSegments);
+    }
+
+    return *table;
+}
+
+void computeSinCos(double startAngle, double angleStep, int count, float* sines, float* cosines)
+{
+    const auto stepSine = std::sin(angleStep);
+    const auto stepCosine = std::cos(angleStep);
+    auto sine = std::sin(startAngle);
+    auto cosine = std::cos(startAngle);
+    for (auto i = 0; i < count; i++)
+    {
+        sines[i] = float(sine);
+        cosines[i] = float(cosine);
+
+        const auto nextSine = sine * stepCosine + cosine * stepSine;
+        cosine = cosine * stepCosine - sine * stepSine;
+        sine = nextSine;
+    }
+}
+
+} // namespace static_meshes_3D
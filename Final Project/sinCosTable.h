@@ -0,0 +1,70 @@
+#pragma once
+
+// STL
+#include <vector>
+
+namespace static_meshes_3D {
+
+/**
+ * Sines and cosines of angles splitting full circle into equal segments. Angle of entry i is 2 * pi * i / numSegments
+ * for i = 0..numSegments, so that the last entry closes the circle and equals the first one exactly.
+ */
+class SinCosTable
+{
+public:
+    /**
+     * Computes the table for given number of segments.
+     */
+    explicit SinCosTable(int numSegments);
+
+    /**
+     * Wraps precomputed data of numSegments + 1 sines and cosines (data are not copied).
+     */
+    SinCosTable(int numSegments, const float* sines, const float* cosines);
+
+    SinCosTable(const SinCosTable&) = delete;
+    SinCosTable& operator=(const SinCosTable&) = delete;
+
+    /**
+     * Gets number of segments of the circle (table has one entry more).
+     */
+    int getNumSegments() const;
+
+    /**
+     * Gets all numSegments + 1 sines.
+     */
+    const float* getSines() const;
+
+    /**
+     * Gets all numSegments + 1 cosines.
+     */
+    const float* getCosines() const;
+
+private:
+    int _numSegments; // Number of segments of the circle
+    std::vector<float> _storage; // Computed sines followed by cosines (empty for wrapped precomputed data)
+    const float* _sines; // Sines of the table
+    const float* _cosines; // Cosines of the table
+};
+
+/**
+ * Gets table for given number of segments. Tables of common numbers of segments are computed at compile time,
+ * others are computed on first use and cached until program exit. Safe to call from multiple threads.
+ *
+ * @param numSegments  Number of segments of the circle (at least 1)
+ */
+const SinCosTable& getSinCosTable(int numSegments);
+
+/**
+ * Computes sines and cosines of angles startAngle + i * angleStep with angle-addition recurrence (one sin / cos pair
+ * for the whole span), accumulated in double precision, so that the error does not grow noticeably with count.
+ *
+ * @param startAngle  Angle of the first entry in radians
+ * @param angleStep   Difference of two consecutive angles in radians
+ * @param count       Number of entries to compute
+ * @param sines       Output sines (count entries)
+ * @param cosines     Output cosines (count entries)
+ */
+void computeSinCos(double startAngle, double angleStep, int count, float* sines, float* cosines);
+
+} // namespace static_meshes_3D
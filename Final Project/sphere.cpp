@@ -0,0 +1,51 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "sinCosTable.h"
+#include "sphere.h"
+
+namespace static_meshes_3D {
+
+float Sphere::getRadius() const
+{
+    return _radius;
+}
+
+int Sphere::getSlices() const
+{
+    return _numSlices;
+}
+
+int Sphere::getStacks() const
+{
+    return _numStacks;
+}
+
+float Sphere::generateLod(int lod)
+{
+    // Stack angles go over half circle, so they are taken from table of twice as many segments
+    const auto numSlices = getLodSegments(_numSlices, 3, lod);
+    const auto numStacks = getLodSegments(_numStacks, 2, lod);
+    const auto& sliceTable = getSinCosTable(numSlices);
+    const auto& stackTable = getSinCosTable(2 * numStacks);
+    addSurface(numSlices, numStacks, true, false, [this, numStacks, &sliceTable, &stackTable](int i, int j, glm::vec3& position, glm::vec3& normal)
+    {
+        // Poles are exact, so that their triangles collapse and get skipped
+        const auto isPole = j == 0 || j == numStacks;
+        const auto stackSine = isPole ? 0.0f : stackTable.getSines()[j];
+        const auto stackCosine = j == 0 ? 1.0f : (j == numStacks ? -1.0f : stackTable.getCosines()[j]);
+
+        normal = glm::vec3(sliceTable.getCosines()[i] * stackSine, stackCosine, sliceTable.getSines()[i] * stackSine);
+        position = normal * _radius;
+    });
+
+    return std::max(getChordError(_radius, numSlices), getChordError(_radius, 2 * numStacks));
+}
+
+std::vector<unsigned char> Sphere::getMeshFileKey() const
+{
+    return makeMeshFileKey("Sphere", _radius, _numSlices, _numStacks);
+}
+
+} // namespace static_meshes_3D
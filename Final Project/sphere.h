@@ -0,0 +1,63 @@
+#pragma once
+
+// Project
+#include "parametricMesh.h"
+
+namespace static_meshes_3D {
+
+/**
+ * UV sphere with given radius, number of slices (around Y axis) and stacks (from top pole to bottom one).
+ */
+class Sphere : public ParametricMesh
+{
+public:
+    /**
+     * Creates sphere with compile-time vertex layout (all float attributes by default), attributes not present in the layout are not stored.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    Sphere(float radius, int numSlices, int numStacks, int lodCount = 1,
+        Layout layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+        : ParametricMesh(lodCount, layout, vertexStorage)
+        , _radius(radius)
+        , _numSlices(numSlices)
+        , _numStacks(numStacks)
+    {
+        initializeData();
+    }
+
+    /**
+     * Makes MeshCache key of the sphere created with given constructor arguments (see Cylinder::cacheKey), number of LODs is part of it.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    static std::vector<unsigned char> cacheKey(float radius, int numSlices, int numStacks, int lodCount = 1,
+        Layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+    {
+        return makeGeneratorKey("Sphere", Layout::getFormat(), vertexStorage, radius, numSlices, numStacks, clampLodCount(lodCount));
+    }
+
+    /**
+     * Gets sphere radius.
+     */
+    float getRadius() const;
+
+    /**
+     * Gets number of slices of the finest LOD.
+     */
+    int getSlices() const;
+
+    /**
+     * Gets number of stacks of the finest LOD.
+     */
+    int getStacks() const;
+
+protected:
+    float generateLod(int lod) override;
+    std::vector<unsigned char> getMeshFileKey() const override;
+
+private:
+    float _radius; // Sphere radius
+    int _numSlices; // Number of slices around Y axis
+    int _numStacks; // Number of stacks from pole to pole
+};
+
+} // namespace static_meshes_3D
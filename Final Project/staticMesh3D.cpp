@@ -1,3 +1,8 @@
+// STL
+#include <iostream>
+#include <vector>
+#include <cstring>
+
 // GLM
 #include <glm/glm.hpp>
 
@@ -6,14 +11,13 @@
 
 namespace static_meshes_3D {
 
-const int StaticMesh3D::POSITION_ATTRIBUTE_INDEX           = 0;
-const int StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX = 1;
-const int StaticMesh3D::NORMAL_ATTRIBUTE_INDEX             = 2;
+const int StaticMesh3D::POSITION_ATTRIBUTE_INDEX           = vertex_attributes::Position::LOCATION;
+const int StaticMesh3D::TEXTURE_COORDINATE_ATTRIBUTE_INDEX = vertex_attributes::TextureCoordinate::LOCATION;
+const int StaticMesh3D::NORMAL_ATTRIBUTE_INDEX             = vertex_attributes::Normal::LOCATION;
 
-StaticMesh3D::StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals)
-    : _hasPositions(withPositions)
-    , _hasTextureCoordinates(withTextureCoordinates)
-    , _hasNormals(withNormals) {}
+StaticMesh3D::StaticMesh3D(const VertexFormat& vertexFormat, VertexStorage vertexStorage)
+    : _vertexFormat(&vertexFormat)
+    , _vertexStorage(vertexStorage) {}
 
 StaticMesh3D::~StaticMesh3D()
 {
@@ -26,6 +30,13 @@ void StaticMesh3D::deleteMesh()
         return;
     }
 
+    if (isInArena())
+    {
+        _arena->free(_arenaHandle);
+        _arena = nullptr;
+        _arenaHandle = MeshBufferArena::INVALID_HANDLE;
+    }
+
     glDeleteVertexArrays(1, &_vao);
     _vbo.deleteVBO();
 
@@ -34,61 +45,175 @@ void StaticMesh3D::deleteMesh()
 
 bool StaticMesh3D::hasPositions() const
 {
-    return _hasPositions;
+    return _vertexFormat->hasPositions;
 }
 
 bool StaticMesh3D::hasTextureCoordinates() const
 {
-    return _hasTextureCoordinates;
+    return _vertexFormat->hasTextureCoordinates;
 }
 
 bool StaticMesh3D::hasNormals() const
 {
-    return _hasNormals;
+    return _vertexFormat->hasNormals;
+}
+
+const VertexFormat& StaticMesh3D::getVertexFormat() const
+{
+    return *_vertexFormat;
 }
 
 int StaticMesh3D::getVertexByteSize() const
 {
-    int result = 0;
-    if (hasPositions()) {
-        result += sizeof(glm::vec3);
+    return isQuantized() ? sizeof(QuantizedVertex) : static_cast<int>(_vertexFormat->stride);
+}
+
+VertexStorage StaticMesh3D::getVertexStorage() const
+{
+    return _vertexStorage;
+}
+
+void StaticMesh3D::setVertexAttributesPointers(int numVertices)
+{
+    _vertexFormat->setAttributePointers(_vertexStorage, numVertices, 0);
+}
+
+bool StaticMesh3D::moveToArena(MeshBufferArena& arena)
+{
+    if (!_isInitialized || isInArena()) {
+        return false;
     }
-    if (hasTextureCoordinates()) {
-        result += sizeof(glm::vec2);
+
+    const auto vertexByteSize = getVertexByteSize();
+    if (isQuantized() || arena.getVertexFormat().attributeOrder != _vertexFormat->attributeOrder)
+    {
+        std::cerr << "Arena vertex format does not match the mesh vertex format!" << std::endl;
+        return false;
     }
-    if (hasNormals()) {
-        result += sizeof(glm::vec3);
+
+    std::vector<unsigned char> meshData;
+    readVertexData(meshData);
+    const auto dataSize = meshData.size();
+    const auto numVertices = dataSize / vertexByteSize;
+
+    // Interleave attributes, as arena pages hold interleaved vertices
+    std::vector<unsigned char> interleavedData(dataSize);
+    _vertexFormat->convertStorage(meshData.data(), _vertexStorage, interleavedData.data(), VertexStorage::Interleaved, numVertices);
+
+    const auto handle = arena.allocate(numVertices);
+    if (handle == MeshBufferArena::INVALID_HANDLE) {
+        return false;
     }
 
-    return result;
+    arena.upload(handle, interleavedData.data());
+
+    // Own VAO and VBO are not needed anymore
+    glDeleteVertexArrays(1, &_vao);
+    _vao = 0;
+    _vbo.deleteVBO();
+    _arena = &arena;
+    _arenaHandle = handle;
+    _vertexStorage = VertexStorage::Interleaved;
+
+    return true;
 }
 
-void StaticMesh3D::setVertexAttributesPointers(int numVertices)
+bool StaticMesh3D::isInArena() const
 {
-    uint64_t offset = 0;
-    if (hasPositions())
-    {
-        glEnableVertexAttribArray(POSITION_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(POSITION_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(offset));
+    return _arena != nullptr;
+}
 
-        offset += sizeof(glm::vec3)*numVertices;
+GLuint StaticMesh3D::getVertexArrayID() const
+{
+    return isInArena() ? _arena->getAllocationVAO(_arenaHandle) : _vao;
+}
+
+bool StaticMesh3D::quantize()
+{
+    if (!_isInitialized || isInArena() || isQuantized()) {
+        return false;
     }
 
-    if (hasTextureCoordinates())
-    {
-        glEnableVertexAttribArray(TEXTURE_COORDINATE_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(TEXTURE_COORDINATE_ATTRIBUTE_INDEX, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(offset));
+    // Get float vertex data as attribute arrays, attributes missing in the mesh are passed as nullptr
+    std::vector<unsigned char> meshData;
+    readVertexData(meshData);
+    const auto numVertices = meshData.size() / getVertexByteSize();
+    std::vector<glm::vec3> positions(hasPositions() ? numVertices : 0);
+    std::vector<glm::vec2> textureCoordinates(hasTextureCoordinates() ? numVertices : 0);
+    std::vector<glm::vec3> normals(hasNormals() ? numVertices : 0);
+    _vertexFormat->readAttributes(meshData.data(), _vertexStorage, numVertices, nullptr, numVertices, positions.data(), textureCoordinates.data(), normals.data());
+
+    std::vector<QuantizedVertex> quantizedVertices(numVertices);
+    quantizeVertices(positions.empty() ? nullptr : positions.data(), textureCoordinates.empty() ? nullptr : textureCoordinates.data(),
+        normals.empty() ? nullptr : normals.data(), numVertices, quantizedVertices.data(), _quantizationParameters, &_quantizationError);
+
+    // Replace GPU data with quantized ones and point attributes to them
+    glBindVertexArray(_vao);
+    _vbo.bindVBO();
+    _vbo.beginDirectUpload(sizeof(QuantizedVertex) * numVertices, GL_STATIC_DRAW);
+    _vbo.addRawData(quantizedVertices.data(), sizeof(QuantizedVertex) * numVertices);
+    _vbo.finishDirectUpload();
+    setQuantizedAttributePointers(hasPositions(), hasTextureCoordinates(), hasNormals());
+
+    _vertexStorage = VertexStorage::Interleaved;
+    _isQuantized = true;
+
+    return true;
+}
+
+bool StaticMesh3D::isQuantized() const
+{
+    return _isQuantized;
+}
+
+const QuantizationParameters& StaticMesh3D::getQuantizationParameters() const
+{
+    return _quantizationParameters;
+}
+
+const QuantizationError& StaticMesh3D::getQuantizationError() const
+{
+    return _quantizationError;
+}
+
+size_t StaticMesh3D::getGpuByteSize() const
+{
+    if (isInArena()) {
+        return _arena->getAllocation(_arenaHandle).numVertices * _arena->getVertexByteSize();
+    }
 
-        offset += sizeof(glm::vec2)*numVertices;
+    return _vbo.getBufferSize();
+}
+
+void StaticMesh3D::readVertexData(std::vector<unsigned char>& data)
+{
+    if (isInArena())
+    {
+        data.resize(getGpuByteSize());
+        _arena->download(_arenaHandle, data.data());
+        return;
     }
 
-    if (hasNormals())
+    const auto dataSize = _vbo.getBufferSize();
+    data.resize(dataSize);
+    if (_vbo.getCpuCopySize() >= dataSize) {
+        memcpy(data.data(), _vbo.getRawDataPointer(), dataSize);
+    }
+    else
     {
-        glEnableVertexAttribArray(NORMAL_ATTRIBUTE_INDEX);
-        glVertexAttribPointer(NORMAL_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(offset));
+        _vbo.bindVBO();
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, dataSize, data.data());
+    }
+}
 
-        offset += sizeof(glm::vec3)*numVertices;
+GLint StaticMesh3D::bindVertexArray() const
+{
+    if (isInArena()) {
+        return _arena->bindAllocation(_arenaHandle);
     }
+
+    glBindVertexArray(_vao);
+    return 0;
 }
 
 } // namespace static_meshes_3D
\ No newline at end of file
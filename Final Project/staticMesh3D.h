@@ -1,7 +1,13 @@
 #pragma once
 
+// STL
+#include <vector>
+
 // Project
 #include "vertexBufferObject.h"
+#include "meshBufferArena.h"
+#include "vertexLayout.h"
+#include "vertexQuantization.h"
 
 namespace static_meshes_3D {
 
@@ -12,10 +18,16 @@ class StaticMesh3D
 {
 public:
 	static const int POSITION_ATTRIBUTE_INDEX; // Vertex attribute index of vertex position (0)
-	static const int TEXTURE_COORDINATE_ATTRIBUTE_INDEX; // Vertex attribute index of texture coordinate (1)
-	static const int NORMAL_ATTRIBUTE_INDEX; // Vertex attribute index of vertex normal (2)
+	static const int TEXTURE_COORDINATE_ATTRIBUTE_INDEX; // Vertex attribute index of texture coordinate (2)
+	static const int NORMAL_ATTRIBUTE_INDEX; // Vertex attribute index of vertex normal (1)
 
-	StaticMesh3D(bool withPositions, bool withTextureCoordinates, bool withNormals);
+	/**
+	 * Creates static mesh with attributes given by compile-time vertex layout, e.g. StaticMesh3D(VertexLayout<Position, Normal>()).
+	 * Mesh keeps the format of the layout, so its attributes are stored in the layout order and missing ones are compiled out.
+	 */
+	template<typename... Attributes>
+	explicit StaticMesh3D(VertexLayout<Attributes...>, VertexStorage vertexStorage = VertexStorage::Planar)
+		: StaticMesh3D(VertexLayout<Attributes...>::getFormat(), vertexStorage) {}
 	virtual ~StaticMesh3D();
 
 	/**
@@ -29,6 +41,14 @@ public:
 	 */
 	virtual void renderPoints() const {}
 
+	/**
+	 * Renders given number of instances of static mesh with one instanced draw, shader takes per-instance data
+	 * from gl_InstanceID (see InstanceBuffer). Every mesh type knows its own draw call, so there's no default.
+	 *
+	 * @param numInstances  Number of rendered instances
+	 */
+	virtual void renderInstanced(GLsizei numInstances) const = 0;
+
 	/**
 	 * Deletes static mesh data.
 	 */
@@ -49,19 +69,87 @@ public:
 	 */
 	bool hasNormals() const;
 
+	/**
+	 * Gets vertex format of the mesh (its vertex layout).
+	 */
+	const VertexFormat& getVertexFormat() const;
+
 	/**
 	 * Gets byte size of one vertex (depending on present vertex attributes).
 	 */
 	int getVertexByteSize() const;
 
+	/**
+	 * Gets how vertex attributes are arranged in the vertex buffer (planar, interleaved or split position).
+	 */
+	VertexStorage getVertexStorage() const;
+
+	/**
+	 * Moves mesh vertex data to a slice of shared buffer arena and deletes mesh's own VAO and VBO.
+	 * Arena must have the same vertex layout as the mesh, vertices become interleaved (as arena pages hold them).
+	 *
+	 * @param arena  Arena to move vertex data to (must outlive the mesh)
+	 *
+	 * @return True, if data have been moved successfully, false otherwise.
+	 */
+	bool moveToArena(MeshBufferArena& arena);
+
+	/**
+	 * Checks, if mesh vertex data live in a shared buffer arena.
+	 */
+	bool isInArena() const;
+
+	/**
+	 * Gets ID of the VAO the mesh is rendered from (its own one, or the one of its arena page).
+	 */
+	GLuint getVertexArrayID() const;
+
+	/**
+	 * Converts mesh vertex data to packed quantized vertices (snorm16 positions, octahedral normals, unorm16
+	 * texture coordinates - 16 bytes per vertex) and uploads them again. Shader must decode the vertices
+	 * with parameters from getQuantizationParameters (see setDequantizationUniforms).
+	 *
+	 * @return True, if mesh has been quantized, false otherwise.
+	 */
+	bool quantize();
+
+	/**
+	 * Checks, if mesh vertex data are quantized.
+	 */
+	bool isQuantized() const;
+
+	/**
+	 * Gets dequantization parameters of the mesh (identity ones, if mesh is not quantized).
+	 */
+	const QuantizationParameters& getQuantizationParameters() const;
+
+	/**
+	 * Gets report of maximal errors introduced by quantization of the mesh.
+	 */
+	const QuantizationError& getQuantizationError() const;
+
+	/**
+	 * Gets number of bytes the mesh occupies on the GPU (its vertex data, or its slice of the arena).
+	 */
+	virtual size_t getGpuByteSize() const;
+
 protected:
-	bool _hasPositions = false; // Flag telling, if we have vertex positions
-	bool _hasTextureCoordinates = false; // Flag telling, if we have texture coordinates
-	bool _hasNormals = false; // Flag telling, if we have vertex normals
+	const VertexFormat* _vertexFormat; // Vertex layout of the mesh (its attributes in stored order and operations on them)
+	VertexStorage _vertexStorage = VertexStorage::Planar; // How vertex attributes are arranged in the VBO
 
 	bool _isInitialized = false; // Is mesh initialized flag
 	GLuint _vao = 0; // VAO ID from OpenGL
 	VertexBufferObject _vbo; // Our VBO wrapper class holding static mesh data
+	MeshBufferArena* _arena = nullptr; // Shared buffer arena holding mesh data instead of own VAO / VBO (if any)
+	MeshBufferArena::Handle _arenaHandle = MeshBufferArena::INVALID_HANDLE; // Slice of the shared buffer arena
+	bool _isQuantized = false; // Flag telling, if vertex data are quantized
+	QuantizationParameters _quantizationParameters; // Dequantization parameters for the shader
+	QuantizationError _quantizationError; // Errors introduced by quantization
+
+	/**
+	 * Creates static mesh with format of another mesh (e.g. one derived from it).
+	 */
+	StaticMesh3D(const VertexFormat& vertexFormat, VertexStorage vertexStorage);
 
 	/**
 	 * Initializes vertex data. Default implementation does nothing as its not needed for all classes
@@ -69,11 +157,25 @@ protected:
 	virtual void initializeData() {}
 
 	/**
-	* Sets vertex attribute pointers in a standard way.
+	* Sets vertex attribute pointers in a standard way, according to vertex storage of the mesh.
 	*
 	* @param numVertices  Number of vertices present in the buffer
 	*/
 	void setVertexAttributesPointers(int numVertices);
+
+	/**
+	 * Binds VAO holding mesh data (own one, or the one of arena page) before rendering.
+	 *
+	 * @return First vertex of the mesh data, that has to be added to all draw call offsets.
+	 */
+	GLint bindVertexArray() const;
+
+	/**
+	 * Reads back vertex data of the mesh (from in-memory copy if kept, otherwise from the GPU or its arena slice).
+	 *
+	 * @param data  Output vertex data, in mesh vertex storage
+	 */
+	void readVertexData(std::vector<unsigned char>& data);
 };
 
 }; // namespace static_meshes_3D
\ No newline at end of file
@@ -1,10 +1,35 @@
+// STL
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+// GLM
+#include <glm/glm.hpp>
+
 // Project
 #include "staticMeshIndexed3D.h"
+#include "meshFile.h"
 
 namespace static_meshes_3D {
 
-StaticMeshIndexed3D::StaticMeshIndexed3D(bool withPositions, bool withTextureCoordinates, bool withNormals)
-    : StaticMesh3D(withPositions, withTextureCoordinates, withNormals) {}
+const int StaticMeshIndexed3D::MAX_MASKED_INDEX_RANGES;
+std::string StaticMeshIndexed3D::_meshFileCacheDirectory;
+
+namespace {
+
+// Gets path of the cache file of mesh with given key hash
+std::string getMeshFileName(const std::string& directory, uint64_t keyHash)
+{
+    std::ostringstream fileName;
+    fileName << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << keyHash << ".mesh";
+    return fileName.str();
+}
+
+} // namespace
 
 StaticMeshIndexed3D::~StaticMeshIndexed3D()
 {
@@ -14,6 +39,162 @@ StaticMeshIndexed3D::~StaticMeshIndexed3D()
     }
 }
 
+void StaticMeshIndexed3D::render() const
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    if (isInArena()) {
+        // Arena page VAO is shared by many meshes, so attach our element buffer to it
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    }
+
+    glDrawElementsBaseVertex(_primitiveType, _numIndices, _indexType, nullptr, firstVertex);
+}
+
+void StaticMeshIndexed3D::renderPoints() const
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    glDrawArrays(GL_POINTS, firstVertex, _numVertices);
+}
+
+void StaticMeshIndexed3D::renderIndexRange(int rangeIndex) const
+{
+    if (!_isInitialized || rangeIndex < 0 || rangeIndex >= getNumIndexRanges()) {
+        return;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    if (isInArena()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    }
+
+    const auto& range = _indexRanges[rangeIndex];
+    const auto indexOffset = static_cast<size_t>(range.firstIndex) * getIndexByteSize();
+    glDrawElementsBaseVertex(_primitiveType, range.numIndices, _indexType, reinterpret_cast<void*>(indexOffset), firstVertex);
+}
+
+void StaticMeshIndexed3D::renderInstanced(GLsizei numInstances) const
+{
+    if (!_isInitialized || numInstances <= 0) {
+        return;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    if (isInArena()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    }
+
+    glDrawElementsInstancedBaseVertex(_primitiveType, _numIndices, _indexType, nullptr, numInstances, firstVertex);
+}
+
+void StaticMeshIndexed3D::renderIndexRangeInstanced(int rangeIndex, GLsizei numInstances) const
+{
+    if (!_isInitialized || rangeIndex < 0 || rangeIndex >= getNumIndexRanges() || numInstances <= 0) {
+        return;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    if (isInArena()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    }
+
+    const auto& range = _indexRanges[rangeIndex];
+    const auto indexOffset = static_cast<size_t>(range.firstIndex) * getIndexByteSize();
+    glDrawElementsInstancedBaseVertex(_primitiveType, range.numIndices, _indexType, reinterpret_cast<void*>(indexOffset), numInstances, firstVertex);
+}
+
+void StaticMeshIndexed3D::renderIndexRanges(unsigned int rangeMask) const
+{
+    const auto maskedRanges = rangeMask & static_cast<unsigned int>(_rangeDrawLists.size() - 1);
+    if (!_isInitialized || _rangeDrawLists.empty() || maskedRanges == 0) {
+        return;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    if (isInArena()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    }
+
+    // Base vertices of all lists change only when mesh data move within their arena
+    if (firstVertex != _rangeDrawBaseVertex)
+    {
+        std::fill(_rangeDrawBaseVertices.begin(), _rangeDrawBaseVertices.end(), firstVertex);
+        _rangeDrawBaseVertex = firstVertex;
+    }
+
+    const auto& drawList = _rangeDrawLists[maskedRanges];
+    glMultiDrawElementsBaseVertex(_primitiveType, _rangeDrawCounts.data() + drawList.firstDraw, _indexType,
+        _rangeDrawOffsets.data() + drawList.firstDraw, drawList.numDraws, _rangeDrawBaseVertices.data() + drawList.firstDraw);
+}
+
+int StaticMeshIndexed3D::getNumIndexRanges() const
+{
+    return static_cast<int>(_indexRanges.size());
+}
+
+const StaticMeshIndexed3D::IndexRange& StaticMeshIndexed3D::getIndexRange(int rangeIndex) const
+{
+    return _indexRanges[rangeIndex];
+}
+
+void StaticMeshIndexed3D::renderIndirect(GLsizei maxDrawCount, bool isDrawCountInParameters, GLuint vertexArrayID) const
+{
+    if (!_isInitialized || maxDrawCount <= 0) {
+        return;
+    }
+
+    if (isInArena())
+    {
+        std::cerr << "Mesh in buffer arena cannot be rendered indirectly!" << std::endl;
+        return;
+    }
+
+    if (vertexArrayID != 0) {
+        glBindVertexArray(vertexArrayID);
+    }
+    else {
+        bindVertexArray();
+    }
+
+    if (!isDrawCountInParameters) {
+        glMultiDrawElementsIndirect(_primitiveType, _indexType, nullptr, maxDrawCount, 0);
+    }
+    else if (GLEW_VERSION_4_6) {
+        glMultiDrawElementsIndirectCount(_primitiveType, _indexType, nullptr, 0, maxDrawCount, 0);
+    }
+    else {
+        glMultiDrawElementsIndirectCountARB(_primitiveType, _indexType, nullptr, 0, maxDrawCount, 0);
+    }
+}
+
+GLuint StaticMeshIndexed3D::createVertexArrayView() const
+{
+    if (!_isInitialized || isInArena()) {
+        return 0;
+    }
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo.getBufferID());
+    if (isQuantized()) {
+        setQuantizedAttributePointers(hasPositions(), hasTextureCoordinates(), hasNormals());
+    }
+    else {
+        _vertexFormat->setAttributePointers(_vertexStorage, _numVertices, 0);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    glBindVertexArray(0);
+    return vao;
+}
+
 void StaticMeshIndexed3D::deleteMesh()
 {
     if (_isInitialized) {
@@ -22,4 +203,553 @@ void StaticMeshIndexed3D::deleteMesh()
     }
 }
 
+GLenum StaticMeshIndexed3D::getIndexType() const
+{
+    return _indexType;
+}
+
+int StaticMeshIndexed3D::getIndexByteSize() const
+{
+    return _indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+size_t StaticMeshIndexed3D::getGpuByteSize() const
+{
+    return StaticMesh3D::getGpuByteSize() + _indicesVBO.getBufferSize();
+}
+
+void StaticMeshIndexed3D::setOptimizeOnFinalize(bool optimizeOnFinalize)
+{
+    _optimizeOnFinalize = optimizeOnFinalize;
+}
+
+bool StaticMeshIndexed3D::optimize()
+{
+    if (!_isInitialized || isInArena() || _primitiveType != GL_TRIANGLES) {
+        return false;
+    }
+
+    std::vector<unsigned char> vertexData;
+    readVertexData(vertexData);
+    std::vector<GLuint> indices;
+    readIndices(indices);
+
+    optimizeData(vertexData.data(), indices.data());
+
+    // Meshlets reference triangles in the old order
+    _meshlets.clear();
+
+    // Sizes have not changed, so attribute pointers stay valid (element buffer binding is part of VAO state)
+    glBindVertexArray(_vao);
+    _vbo.bindVBO();
+    _vbo.beginDirectUpload(vertexData.size(), GL_STATIC_DRAW);
+    _vbo.addRawData(vertexData.data(), vertexData.size());
+    _vbo.finishDirectUpload();
+    uploadIndices(indices.data(), GL_STATIC_DRAW);
+
+    return true;
+}
+
+const MeshOptimizationReport& StaticMeshIndexed3D::getOptimizationReport() const
+{
+    return _optimizationReport;
+}
+
+bool StaticMeshIndexed3D::generateNormals(float creaseAngle)
+{
+    if (!_isInitialized || isInArena() || isQuantized() || _primitiveType != GL_TRIANGLES || !hasPositions() || !hasNormals()) {
+        return false;
+    }
+
+    std::vector<unsigned char> vertexData;
+    readVertexData(vertexData);
+    std::vector<GLuint> indices;
+    readIndices(indices);
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> textureCoordinates;
+    extractAttributes(vertexData.data(), positions, textureCoordinates, normals);
+
+    std::vector<glm::vec3> newNormals;
+    std::vector<unsigned int> vertexSources, newIndices;
+    const auto numVertices = static_meshes_3D::generateNormals(positions.data(), positions.size(), indices.data(), indices.size(), creaseAngle,
+        newNormals, vertexSources, newIndices);
+    if (numVertices == 0) {
+        return false;
+    }
+
+    // Split vertices copy other attributes from their source vertices, triangle order is kept, so index ranges stay valid
+    std::vector<glm::vec3> newPositions(numVertices);
+    std::vector<glm::vec2> newTextureCoordinates(textureCoordinates.empty() ? 0 : numVertices);
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        newPositions[i] = positions[vertexSources[i]];
+        if (!textureCoordinates.empty()) {
+            newTextureCoordinates[i] = textureCoordinates[vertexSources[i]];
+        }
+    }
+
+    std::vector<unsigned char> newVertexData(numVertices * getVertexByteSize());
+    _vertexFormat->writeAttributes(newVertexData.data(), _vertexStorage, numVertices, 0, numVertices, newPositions.data(), newTextureCoordinates.data(), newNormals.data());
+
+    _numVertices = static_cast<int>(numVertices);
+    if (_optimizeOnFinalize) {
+        optimizeData(newVertexData.data(), newIndices.data());
+    }
+    updateIndexType();
+    _meshlets.clear();
+
+    // Number of vertices has changed, so attribute pointers have to be set again
+    glBindVertexArray(_vao);
+    _vbo.bindVBO();
+    _vbo.beginDirectUpload(newVertexData.size(), GL_STATIC_DRAW);
+    _vbo.addRawData(newVertexData.data(), newVertexData.size());
+    _vbo.finishDirectUpload();
+    setVertexAttributesPointers(_numVertices);
+    uploadIndices(newIndices.data(), GL_STATIC_DRAW);
+    buildRangeDrawLists();
+
+    return true;
+}
+
+bool StaticMeshIndexed3D::readGeometry(std::vector<glm::vec3>& positions, std::vector<glm::vec2>& textureCoordinates, std::vector<glm::vec3>& normals,
+    std::vector<GLuint>& indices, int rangeIndex)
+{
+    if (!_isInitialized || isQuantized() || _primitiveType != GL_TRIANGLES || rangeIndex >= getNumIndexRanges()) {
+        return false;
+    }
+
+    std::vector<unsigned char> vertexData;
+    readVertexData(vertexData);
+    std::vector<GLuint> allIndices;
+    readIndices(allIndices);
+
+    // Vertices of the range get new numbers in order of first use
+    const auto firstIndex = rangeIndex >= 0 ? _indexRanges[rangeIndex].firstIndex : 0;
+    const auto numIndices = rangeIndex >= 0 ? _indexRanges[rangeIndex].numIndices : _numIndices;
+    const auto unused = std::numeric_limits<GLuint>::max();
+    std::vector<GLuint> remap(_numVertices, unused);
+    std::vector<GLuint> usedVertices;
+    indices.resize(numIndices);
+    for (auto i = 0; i < numIndices; i++)
+    {
+        auto& newIndex = remap[allIndices[firstIndex + i]];
+        if (newIndex == unused)
+        {
+            newIndex = static_cast<GLuint>(usedVertices.size());
+            usedVertices.push_back(allIndices[firstIndex + i]);
+        }
+        indices[i] = newIndex;
+    }
+
+    positions.assign(hasPositions() ? usedVertices.size() : 0, glm::vec3(0.0f));
+    textureCoordinates.assign(hasTextureCoordinates() ? usedVertices.size() : 0, glm::vec2(0.0f));
+    normals.assign(hasNormals() ? usedVertices.size() : 0, glm::vec3(0.0f));
+    _vertexFormat->readAttributes(vertexData.data(), _vertexStorage, _numVertices, usedVertices.data(), usedVertices.size(),
+        positions.data(), textureCoordinates.data(), normals.data());
+
+    return true;
+}
+
+bool StaticMeshIndexed3D::buildMeshlets()
+{
+    if (!_isInitialized || _primitiveType != GL_TRIANGLES) {
+        return false;
+    }
+
+    std::vector<unsigned char> vertexData;
+    readVertexData(vertexData);
+    std::vector<glm::vec3> positions;
+    extractPositions(vertexData.data(), positions);
+    if (positions.empty()) {
+        return false;
+    }
+
+    std::vector<GLuint> indices;
+    readIndices(indices);
+
+    // Meshlets never cross index ranges, so that every range can still be culled and rendered on its own
+    _meshlets.clear();
+    if (_indexRanges.empty()) {
+        _meshlets.build(indices.data(), 0, _numIndices, positions.data());
+    }
+    for (const auto& range : _indexRanges) {
+        _meshlets.build(indices.data(), range.firstIndex, range.numIndices, positions.data());
+    }
+
+    return true;
+}
+
+const MeshletSet& StaticMeshIndexed3D::getMeshlets() const
+{
+    return _meshlets;
+}
+
+bool StaticMeshIndexed3D::saveMeshlets(const std::string& fileName) const
+{
+    return _meshlets.saveToFile(fileName, _numIndices);
+}
+
+bool StaticMeshIndexed3D::loadMeshlets(const std::string& fileName)
+{
+    return _meshlets.loadFromFile(fileName, _numIndices);
+}
+
+int StaticMeshIndexed3D::renderVisibleMeshlets(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition) const
+{
+    if (!_isInitialized || _meshlets.getNumMeshlets() == 0) {
+        return 0;
+    }
+
+    const auto numVisibleMeshlets = _meshlets.cull(modelViewProjection, cameraPosition, _visibleMeshletRanges);
+    if (_visibleMeshletRanges.empty()) {
+        return 0;
+    }
+
+    const auto firstVertex = bindVertexArray();
+    if (isInArena()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO.getBufferID());
+    }
+
+    // All visible ranges go to the GPU with one multi-draw call
+    const auto numRanges = _visibleMeshletRanges.size();
+    _meshletDrawCounts.resize(numRanges);
+    _meshletDrawOffsets.resize(numRanges);
+    _meshletDrawBaseVertices.assign(numRanges, firstVertex);
+    for (size_t i = 0; i < numRanges; i++)
+    {
+        _meshletDrawCounts[i] = _visibleMeshletRanges[i].numIndices;
+        _meshletDrawOffsets[i] = reinterpret_cast<void*>(static_cast<size_t>(_visibleMeshletRanges[i].firstIndex) * getIndexByteSize());
+    }
+
+    glMultiDrawElementsBaseVertex(_primitiveType, _meshletDrawCounts.data(), _indexType, _meshletDrawOffsets.data(),
+        static_cast<GLsizei>(numRanges), _meshletDrawBaseVertices.data());
+
+    return numVisibleMeshlets;
+}
+
+void StaticMeshIndexed3D::finalizeIndexedData(GLenum usageHint)
+{
+    // Take gathered indices out of the VBO, as they may be uploaded narrowed to 16 bits
+    const auto gatheredIndices = static_cast<const GLuint*>(_indicesVBO.getRawDataPointer());
+    std::vector<GLuint> indices(gatheredIndices, gatheredIndices + _numIndices);
+    if (_optimizeOnFinalize && _primitiveType == GL_TRIANGLES) {
+        optimizeData(static_cast<unsigned char*>(_vbo.getRawDataPointer()), indices.data());
+    }
+
+    updateIndexType();
+    if (!_meshFileCacheKey.empty()) {
+        saveToMeshFileCache(static_cast<const unsigned char*>(_vbo.getRawDataPointer()), indices.data());
+    }
+
+    _vbo.bindVBO();
+    _vbo.uploadDataToGPU(usageHint);
+    setVertexAttributesPointers(_numVertices);
+    uploadIndices(indices.data(), usageHint);
+    buildRangeDrawLists();
+
+    _isInitialized = true;
+}
+
+unsigned char* StaticMeshIndexed3D::beginDirectIndexedUpload(GLenum usageHint, void*& indexData)
+{
+    updateIndexType();
+
+    // Buffers are bound to the VAO right away, so that the element buffer binding becomes part of its state
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+    _vbo.createVBO();
+    _vbo.bindVBO();
+    _vbo.beginDirectUpload(static_cast<size_t>(getVertexByteSize()) * _numVertices, usageHint);
+    _indicesVBO.createVBO();
+    _indicesVBO.bindVBO(GL_ELEMENT_ARRAY_BUFFER);
+    _indicesVBO.beginDirectUpload(static_cast<size_t>(getIndexByteSize()) * _numIndices, usageHint);
+
+    // Without mapping, both buffers gather the data in memory and upload them when finished
+    indexData = _indicesVBO.appendRawData(static_cast<size_t>(getIndexByteSize()) * _numIndices);
+    return static_cast<unsigned char*>(_vbo.appendRawData(static_cast<size_t>(getVertexByteSize()) * _numVertices));
+}
+
+void StaticMeshIndexed3D::finishDirectIndexedUpload()
+{
+    _vbo.bindVBO();
+    _vbo.finishDirectUpload();
+    setVertexAttributesPointers(_numVertices);
+    _indicesVBO.bindVBO(GL_ELEMENT_ARRAY_BUFFER);
+    _indicesVBO.finishDirectUpload();
+
+    // Mapped memory is write-only, so data to store are read back (only when the mesh is not in the cache yet)
+    if (!_meshFileCacheKey.empty())
+    {
+        std::vector<unsigned char> vertexData;
+        readVertexData(vertexData);
+        std::vector<GLuint> indices;
+        readIndices(indices);
+        saveToMeshFileCache(vertexData.data(), indices.data());
+    }
+
+    buildRangeDrawLists();
+    _isInitialized = true;
+}
+
+void StaticMeshIndexed3D::buildRangeDrawLists()
+{
+    _rangeDrawLists.clear();
+    _rangeDrawCounts.clear();
+    _rangeDrawOffsets.clear();
+    _rangeDrawBaseVertices.clear();
+    const auto numMaskedRanges = std::min(getNumIndexRanges(), MAX_MASKED_INDEX_RANGES);
+    if (numMaskedRanges == 0) {
+        return;
+    }
+
+    // Ranges following each other in the index buffer are drawn as one range
+    _rangeDrawLists.resize(size_t(1) << numMaskedRanges);
+    for (size_t mask = 1; mask < _rangeDrawLists.size(); mask++)
+    {
+        auto& drawList = _rangeDrawLists[mask];
+        drawList.firstDraw = static_cast<int>(_rangeDrawCounts.size());
+        auto drawEnd = -1;
+        for (auto r = 0; r < numMaskedRanges; r++)
+        {
+            const auto& range = _indexRanges[r];
+            if ((mask & (size_t(1) << r)) == 0) {
+                continue;
+            }
+
+            if (drawList.numDraws > 0 && range.firstIndex == drawEnd) {
+                _rangeDrawCounts.back() += range.numIndices;
+            }
+            else
+            {
+                _rangeDrawCounts.push_back(range.numIndices);
+                _rangeDrawOffsets.push_back(reinterpret_cast<const void*>(static_cast<size_t>(range.firstIndex) * getIndexByteSize()));
+                drawList.numDraws++;
+            }
+            drawEnd = range.firstIndex + range.numIndices;
+        }
+    }
+
+    _rangeDrawBaseVertex = 0;
+    _rangeDrawBaseVertices.assign(_rangeDrawCounts.size(), _rangeDrawBaseVertex);
+}
+
+void StaticMeshIndexed3D::setMeshFileCacheDirectory(const std::string& directory)
+{
+    _meshFileCacheDirectory = directory;
+}
+
+const std::string& StaticMeshIndexed3D::getMeshFileCacheDirectory()
+{
+    return _meshFileCacheDirectory;
+}
+
+bool StaticMeshIndexed3D::loadFromMeshFileCache(const std::vector<unsigned char>& key)
+{
+    _meshFileCacheKey.clear();
+    if (_meshFileCacheDirectory.empty() || _isInitialized) {
+        return false;
+    }
+
+    const auto keyHash = MeshFile::hashKey(key);
+    const auto fileName = getMeshFileName(_meshFileCacheDirectory, keyHash);
+    MeshFile meshFile;
+    if (!meshFile.open(fileName, keyHash))
+    {
+        _meshFileCacheKey = key;
+        return false;
+    }
+
+    const auto& header = meshFile.getHeader();
+    if (header.attributeFlags != getMeshFileAttributeFlags() || header.vertexStorage != static_cast<uint32_t>(_vertexStorage)
+        || header.vertexByteSize != static_cast<uint32_t>(getVertexByteSize()) || (header.indexByteSize != sizeof(GLushort) && header.indexByteSize != sizeof(GLuint)))
+    {
+        std::cerr << "Mesh file " << fileName << " does not match its mesh!" << std::endl;
+        _meshFileCacheKey = key;
+        return false;
+    }
+
+    _numVertices = static_cast<int>(header.numVertices);
+    _numIndices = static_cast<int>(header.numIndices);
+    _indexType = header.indexByteSize == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    _primitiveType = GL_TRIANGLES;
+    _indexRanges.clear();
+    for (uint32_t i = 0; i < header.numIndexRanges; i++)
+    {
+        const auto& range = meshFile.getIndexRanges()[i];
+        _indexRanges.push_back({ range.firstIndex, range.numIndices, range.error });
+    }
+
+    // Mapped blobs are in GPU format already, pages get read in by the driver copying them
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+    _vbo.createVBO();
+    _vbo.bindVBO();
+    _vbo.uploadDataToGPU(meshFile.getVertexData(), static_cast<size_t>(header.numVertices) * header.vertexByteSize, GL_STATIC_DRAW);
+    setVertexAttributesPointers(_numVertices);
+    _indicesVBO.createVBO();
+    _indicesVBO.bindVBO(GL_ELEMENT_ARRAY_BUFFER);
+    _indicesVBO.uploadDataToGPU(meshFile.getIndexData(), static_cast<size_t>(header.numIndices) * header.indexByteSize, GL_STATIC_DRAW);
+    buildRangeDrawLists();
+
+    _isInitialized = true;
+    return true;
+}
+
+uint32_t StaticMeshIndexed3D::getMeshFileAttributeFlags() const
+{
+    return (hasPositions() ? MESH_FILE_POSITIONS : 0) | (hasTextureCoordinates() ? MESH_FILE_TEXTURE_COORDINATES : 0) | (hasNormals() ? MESH_FILE_NORMALS : 0);
+}
+
+void StaticMeshIndexed3D::saveToMeshFileCache(const unsigned char* vertexData, const GLuint* indices)
+{
+    MeshFileHeader header = {};
+    header.attributeFlags = getMeshFileAttributeFlags();
+    header.vertexStorage = static_cast<uint32_t>(_vertexStorage);
+    header.numVertices = static_cast<uint32_t>(_numVertices);
+    header.vertexByteSize = static_cast<uint32_t>(getVertexByteSize());
+    header.numIndices = static_cast<uint32_t>(_numIndices);
+    header.indexByteSize = static_cast<uint32_t>(getIndexByteSize());
+    header.numIndexRanges = static_cast<uint32_t>(_indexRanges.size());
+    header.keyHash = MeshFile::hashKey(_meshFileCacheKey);
+
+    std::vector<MeshFileRange> ranges;
+    for (const auto& range : _indexRanges) {
+        ranges.push_back({ range.firstIndex, range.numIndices, range.error, 0 });
+    }
+
+    // Indices are stored in the type they are uploaded in
+    const auto fileName = getMeshFileName(_meshFileCacheDirectory, header.keyHash);
+    if (_indexType == GL_UNSIGNED_SHORT)
+    {
+        const std::vector<GLushort> shortIndices(indices, indices + _numIndices);
+        MeshFile::save(fileName, header, ranges.data(), vertexData, shortIndices.data());
+    }
+    else {
+        MeshFile::save(fileName, header, ranges.data(), vertexData, indices);
+    }
+
+    _meshFileCacheKey.clear();
+}
+
+void StaticMeshIndexed3D::readIndices(std::vector<GLuint>& indices)
+{
+    indices.resize(_numIndices);
+    const auto indicesSize = static_cast<size_t>(getIndexByteSize()) * _numIndices;
+    std::vector<unsigned char> indexData(indicesSize);
+    if (_indicesVBO.getCpuCopySize() >= indicesSize) {
+        memcpy(indexData.data(), _indicesVBO.getRawDataPointer(), indicesSize);
+    }
+    else
+    {
+        // Copy read target does not touch element buffer binding of any VAO
+        _indicesVBO.bindVBO(GL_COPY_READ_BUFFER);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, indicesSize, indexData.data());
+    }
+
+    if (_indexType == GL_UNSIGNED_SHORT)
+    {
+        const auto shortIndices = reinterpret_cast<const GLushort*>(indexData.data());
+        std::copy(shortIndices, shortIndices + _numIndices, indices.begin());
+    }
+    else {
+        memcpy(indices.data(), indexData.data(), indicesSize);
+    }
+}
+
+void StaticMeshIndexed3D::extractAttributes(const unsigned char* vertexData, std::vector<glm::vec3>& positions, std::vector<glm::vec2>& textureCoordinates,
+    std::vector<glm::vec3>& normals) const
+{
+    positions.clear();
+    textureCoordinates.clear();
+    normals.clear();
+    if (isQuantized()) {
+        return;
+    }
+
+    positions.resize(hasPositions() ? _numVertices : 0);
+    textureCoordinates.resize(hasTextureCoordinates() ? _numVertices : 0);
+    normals.resize(hasNormals() ? _numVertices : 0);
+    _vertexFormat->readAttributes(vertexData, _vertexStorage, _numVertices, nullptr, _numVertices, positions.data(), textureCoordinates.data(), normals.data());
+}
+
+void StaticMeshIndexed3D::updateIndexType()
+{
+    // 16-bit indices are enough, if all vertices (and primitive restart index) fit into them
+    const auto maxShortIndex = static_cast<int>(0xFFFF);
+    _indexType = _numVertices <= maxShortIndex && _primitiveRestartIndex <= maxShortIndex ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+void StaticMeshIndexed3D::extractPositions(const unsigned char* vertexData, std::vector<glm::vec3>& positions) const
+{
+    positions.clear();
+    if (isQuantized()) {
+        return;
+    }
+
+    if (hasPositions())
+    {
+        positions.resize(_numVertices);
+        _vertexFormat->readAttributes(vertexData, _vertexStorage, _numVertices, nullptr, _numVertices, positions.data(), nullptr, nullptr);
+    }
+}
+
+void StaticMeshIndexed3D::uploadIndices(const GLuint* indices, GLenum usageHint)
+{
+    _indicesVBO.bindVBO(GL_ELEMENT_ARRAY_BUFFER);
+    _indicesVBO.beginDirectUpload(static_cast<size_t>(getIndexByteSize()) * _numIndices, usageHint);
+    if (_indexType == GL_UNSIGNED_SHORT)
+    {
+        const std::vector<GLushort> shortIndices(indices, indices + _numIndices);
+        _indicesVBO.addRawData(shortIndices.data(), sizeof(GLushort) * _numIndices);
+    }
+    else {
+        _indicesVBO.addRawData(indices, sizeof(GLuint) * _numIndices);
+    }
+    _indicesVBO.finishDirectUpload();
+}
+
+void StaticMeshIndexed3D::optimizeData(unsigned char* vertexData, GLuint* indices)
+{
+    const auto numVertices = static_cast<size_t>(_numVertices);
+    const auto vertexByteSize = static_cast<size_t>(getVertexByteSize());
+
+    // Optimizer reorders whole interleaved vertices and needs positions as plain array (quantized vertices are interleaved already)
+    std::vector<unsigned char> interleavedData(vertexData, vertexData + numVertices * vertexByteSize);
+    std::vector<glm::vec3> positions;
+    extractPositions(vertexData, positions);
+    if (!isQuantized())
+    {
+        _vertexFormat->convertStorage(vertexData, _vertexStorage, interleavedData.data(), VertexStorage::Interleaved, numVertices);
+    }
+
+    // Triangles are reordered only within index ranges, so that ranges can still be rendered on their own
+    std::vector<unsigned int> remap;
+    if (_indexRanges.empty()) {
+        _optimizationReport = optimizeMesh(indices, _numIndices, positions.empty() ? nullptr : positions.data(), numVertices, remap);
+    }
+    else
+    {
+        _optimizationReport = MeshOptimizationReport();
+        _optimizationReport.before = analyzeVertexCache(indices, _numIndices, numVertices);
+        for (const auto& range : _indexRanges)
+        {
+            const auto rangeIndices = indices + range.firstIndex;
+            const auto clusterOffsets = optimizeVertexCache(rangeIndices, range.numIndices, numVertices);
+            _optimizationReport.numClusters += optimizeOverdraw(rangeIndices, range.numIndices, positions.empty() ? nullptr : positions.data(), clusterOffsets);
+        }
+
+        remap = optimizeVertexFetch(indices, _numIndices, numVertices);
+        _optimizationReport.after = analyzeVertexCache(indices, _numIndices, numVertices);
+    }
+    remapVertices(interleavedData.data(), numVertices, vertexByteSize, remap);
+
+    if (isQuantized())
+    {
+        memcpy(vertexData, interleavedData.data(), interleavedData.size());
+        return;
+    }
+
+    _vertexFormat->convertStorage(interleavedData.data(), VertexStorage::Interleaved, vertexData, _vertexStorage, numVertices);
+}
+
 } // namespace static_meshes_3D
\ No newline at end of file
@@ -1,7 +1,17 @@
 #pragma once
 
+// STL
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 // Project
 #include "staticMesh3D.h"
+#include "meshNormals.h"
+#include "meshOptimizer.h"
+#include "meshlets.h"
 
 namespace static_meshes_3D {
 
@@ -11,17 +21,365 @@ namespace static_meshes_3D {
 class StaticMeshIndexed3D : public StaticMesh3D
 {
 public:
-    StaticMeshIndexed3D(bool withPositions, bool withTextureCoordinates, bool withNormals);
+    /**
+     * Range of indices rendered on its own (e.g. part of the mesh with its own texture or transform).
+     */
+    struct IndexRange
+    {
+        int firstIndex = 0; // First index of the range
+        int numIndices = 0; // Number of indices in the range
+        float error = 0.0f; // Geometric error of the range (LOD error of parametric meshes), 0 if not known
+    };
+
+    static const int MAX_MASKED_INDEX_RANGES = 6; // Number of index ranges, whose subsets have precomputed draw lists (64 bitmasks)
+
+    /**
+     * Creates indexed static mesh with attributes given by compile-time vertex layout.
+     */
+    template<typename... Attributes>
+    explicit StaticMeshIndexed3D(VertexLayout<Attributes...> layout, VertexStorage vertexStorage = VertexStorage::Planar)
+        : StaticMesh3D(layout, vertexStorage) {}
     virtual ~StaticMeshIndexed3D();
 
+    /**
+     * Renders all indices of the mesh.
+     */
+    void render() const override;
+
+    /**
+     * Renders all vertices of the mesh as points.
+     */
+    void renderPoints() const override;
+
+    /**
+     * Renders one index range of the mesh.
+     *
+     * @param rangeIndex  Index of the range (0 to getNumIndexRanges() - 1)
+     */
+    void renderIndexRange(int rangeIndex) const;
+
+    /**
+     * Renders all indices of given number of instances of the mesh with one instanced draw.
+     */
+    void renderInstanced(GLsizei numInstances) const override;
+
+    /**
+     * Renders one index range of given number of instances of the mesh with one instanced draw.
+     *
+     * @param rangeIndex    Index of the range (0 to getNumIndexRanges() - 1)
+     * @param numInstances  Number of rendered instances
+     */
+    void renderIndexRangeInstanced(int rangeIndex, GLsizei numInstances) const;
+
+    /**
+     * Renders subset of index ranges with one multi-draw call. Draw lists of all subsets of the first MAX_MASKED_INDEX_RANGES
+     * ranges are precomputed when the mesh is finalized (adjacent ranges merged into one draw), so rendering looks one of them up.
+     *
+     * @param rangeMask  Bitmask of ranges to render (bit i is range i, bits of ranges from MAX_MASKED_INDEX_RANGES on are ignored)
+     */
+    void renderIndexRanges(unsigned int rangeMask) const;
+
+    /**
+     * Gets number of index ranges rendered on their own (0, if the whole mesh is rendered at once).
+     */
+    int getNumIndexRanges() const;
+
+    /**
+     * Gets index range rendered on its own.
+     *
+     * @param rangeIndex  Index of the range (0 to getNumIndexRanges() - 1)
+     */
+    const IndexRange& getIndexRange(int rangeIndex) const;
+
+    /**
+     * Renders draws of indirect commands (DrawElementsIndirectCommand with first indices and base vertices in this mesh)
+     * from buffer bound to GL_DRAW_INDIRECT_BUFFER with one multi-draw call. Only meshes with own VAO can be rendered indirectly.
+     *
+     * @param maxDrawCount             Number of commands, or maximal number of them, if actual count is read from GPU
+     * @param isDrawCountInParameters  Read actual number of commands from offset 0 of buffer bound to GL_PARAMETER_BUFFER
+     * @param vertexArrayID            VAO to render from (see createVertexArrayView), 0 renders from the mesh VAO
+     */
+    void renderIndirect(GLsizei maxDrawCount, bool isDrawCountInParameters, GLuint vertexArrayID = 0) const;
+
+    /**
+     * Creates new VAO referencing vertex and index buffers of the mesh with the same attribute pointers as the mesh VAO.
+     * Users of shared meshes (e.g. from MeshCache) attach their own attributes to it instead of changing the mesh VAO
+     * seen by everybody else. Quantized meshes get quantized attribute pointers. Caller owns the VAO, it's valid until
+     * mesh data are uploaded again (e.g. by quantize).
+     *
+     * @return ID of the new VAO, 0 if mesh is not initialized or lives in a buffer arena.
+     */
+    GLuint createVertexArrayView() const;
+
     void deleteMesh() override;
 
+    /**
+     * Gets type of the indices (GL_UNSIGNED_SHORT, if all vertices can be addressed with 16 bits, GL_UNSIGNED_INT otherwise).
+     */
+    GLenum getIndexType() const;
+
+    /**
+     * Gets byte size of one index.
+     */
+    int getIndexByteSize() const;
+
+    /**
+     * Gets number of bytes the mesh occupies on the GPU, including indices.
+     */
+    size_t getGpuByteSize() const override;
+
+    /**
+     * Sets, if triangles and vertices get reordered for vertex cache, overdraw and vertex fetch when mesh is finalized (default is true).
+     */
+    void setOptimizeOnFinalize(bool optimizeOnFinalize);
+
+    /**
+     * Reorders triangles and vertices of already finalized mesh for vertex cache, overdraw and vertex fetch and uploads them again.
+     * Only triangle lists with own VAO (not in arena) can be optimized.
+     *
+     * @return True, if mesh has been optimized, false otherwise.
+     */
+    bool optimize();
+
+    /**
+     * Gets report of the last optimization (ACMR / ATVR before and after).
+     */
+    const MeshOptimizationReport& getOptimizationReport() const;
+
+    /**
+     * Reads back geometry of the mesh as separate attribute arrays and 32-bit indices. When reading one index range,
+     * vertices not referenced by the range are left out. Only triangle lists with float vertices can be read (also from arena).
+     *
+     * @param positions           Output vertex positions (empty, if mesh has none)
+     * @param textureCoordinates  Output texture coordinates (empty, if mesh has none)
+     * @param normals             Output vertex normals (empty, if mesh has none)
+     * @param indices             Output triangle list indices
+     * @param rangeIndex          Index range to read (-1 for the whole mesh)
+     *
+     * @return True, if geometry has been read, false otherwise.
+     */
+    bool readGeometry(std::vector<glm::vec3>& positions, std::vector<glm::vec2>& textureCoordinates, std::vector<glm::vec3>& normals,
+        std::vector<GLuint>& indices, int rangeIndex = -1);
+
+    /**
+     * Replaces normals of finalized mesh by smooth normals generated from its triangles (see generateNormals in meshNormals.h).
+     * Vertices get split at hard edges, so number of vertices may grow. Meshlets have to be built again afterwards.
+     * Only triangle lists with own VAO, float vertices and normals can be processed.
+     *
+     * @param creaseAngle  Maximal angle (in radians) of smoothly joined triangles
+     *
+     * @return True, if normals have been generated, false otherwise.
+     */
+    bool generateNormals(float creaseAngle = DEFAULT_CREASE_ANGLE);
+
+    /**
+     * Splits finalized mesh into meshlets (up to MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles)
+     * with bounding spheres and normal cones, so that they can be culled before rendering. Only triangle lists with positions can be split.
+     *
+     * @return True, if meshlets have been built, false otherwise.
+     */
+    bool buildMeshlets();
+
+    /**
+     * Gets meshlets of the mesh (empty, if they have not been built or loaded).
+     */
+    const MeshletSet& getMeshlets() const;
+
+    /**
+     * Saves meshlets of the mesh to binary file, so that they don't have to be built next time.
+     */
+    bool saveMeshlets(const std::string& fileName) const;
+
+    /**
+     * Loads meshlets of the mesh from binary file saved with saveMeshlets.
+     */
+    bool loadMeshlets(const std::string& fileName);
+
+    /**
+     * Renders only meshlets in view frustum, that are not back-facing, with one multi-draw call.
+     *
+     * @param modelViewProjection  Model view projection matrix of the mesh
+     * @param cameraPosition       Camera position in model space of the mesh
+     *
+     * @return Number of rendered meshlets.
+     */
+    int renderVisibleMeshlets(const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition) const;
+
+    /**
+     * Sets directory of the mesh file cache. Generators look for their output there before generating and store it there after
+     * generating, so that next start loads memory-mapped vertex and index data straight to the GPU. Empty directory disables the cache.
+     */
+    static void setMeshFileCacheDirectory(const std::string& directory);
+
+    /**
+     * Gets directory of the mesh file cache (empty, if the cache is disabled).
+     */
+    static const std::string& getMeshFileCacheDirectory();
+
 protected:
+    /**
+     * Creates indexed static mesh with format of another mesh (e.g. one derived from it).
+     */
+    StaticMeshIndexed3D(const VertexFormat& vertexFormat, VertexStorage vertexStorage)
+        : StaticMesh3D(vertexFormat, vertexStorage) {}
+
     VertexBufferObject _indicesVBO; // Our VBO wrapper class holding indices data
 
     int _numVertices = 0; // Holds the total number of generated vertices
     int _numIndices = 0; // Holds the number of generated indices used for rendering
     int _primitiveRestartIndex = 0; // Index of primitive restart
+    GLenum _primitiveType = GL_TRIANGLES; // Primitive type the indices describe (only triangle lists get optimized)
+    GLenum _indexType = GL_UNSIGNED_INT; // Type of the indices on the GPU, chosen from number of vertices when finalized
+    std::vector<IndexRange> _indexRanges; // Index ranges rendered on their own (triangle order is optimized within ranges only)
+    bool _optimizeOnFinalize = true; // Flag telling, if mesh gets optimized when finalized
+    MeshOptimizationReport _optimizationReport; // Report of the last optimization
+    MeshletSet _meshlets; // Meshlets of the mesh (if built or loaded)
+
+    /**
+     * Draws of one subset of index ranges - span of _rangeDrawCounts / _rangeDrawOffsets / _rangeDrawBaseVertices.
+     */
+    struct RangeDrawList
+    {
+        int firstDraw = 0; // First draw of the list
+        int numDraws = 0; // Number of draws of the list
+    };
+
+    std::vector<RangeDrawList> _rangeDrawLists; // Draw lists of all range bitmasks (indexed by bitmask)
+    std::vector<GLsizei> _rangeDrawCounts; // Index counts of draws of all draw lists
+    std::vector<const void*> _rangeDrawOffsets; // Byte offsets of draws of all draw lists
+    mutable std::vector<GLint> _rangeDrawBaseVertices; // Base vertices of draws of all draw lists (first vertex of the mesh data)
+    mutable GLint _rangeDrawBaseVertex = 0; // First vertex of the mesh data _rangeDrawBaseVertices hold (changes, when moved in an arena)
+
+    // Scratch buffers of meshlet multi-draw rendering, kept to avoid allocations every frame
+    mutable std::vector<MeshletSet::DrawRange> _visibleMeshletRanges;
+    mutable std::vector<GLsizei> _meshletDrawCounts;
+    mutable std::vector<void*> _meshletDrawOffsets;
+    mutable std::vector<GLint> _meshletDrawBaseVertices;
+
+    /**
+     * Finalizes mesh - optionally optimizes vertex data and indices gathered in memory (_vbo and _indicesVBO, unsigned int indices),
+     * uploads them to the GPU (indices as 16-bit ones, if possible) and sets vertex attribute pointers. Mesh VAO must be bound.
+     *
+     * @param usageHint  Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+     */
+    void finalizeIndexedData(GLenum usageHint = GL_STATIC_DRAW);
+
+    /**
+     * Starts writing vertices and indices of the mesh straight to the GPU memory (see VertexBufferObject::beginDirectUpload) -
+     * creates VAO and buffers of _numVertices vertices and _numIndices indices of the type chosen from number of vertices.
+     * Data written this way are not optimized when finalized.
+     *
+     * @param usageHint  Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+     * @param indexData  Output pointer to the indices to write (GLushort or GLuint ones, see getIndexType)
+     *
+     * @return Pointer to the vertex data to write (in mesh vertex storage).
+     */
+    unsigned char* beginDirectIndexedUpload(GLenum usageHint, void*& indexData);
+
+    /**
+     * Finishes direct upload started with beginDirectIndexedUpload and finalizes the mesh. Mesh VAO must be bound.
+     * If the mesh is to be stored in the mesh file cache, its data are read back from the GPU for that.
+     */
+    void finishDirectIndexedUpload();
+
+    /**
+     * Builds draw lists of all subsets of the first MAX_MASKED_INDEX_RANGES index ranges (see renderIndexRanges).
+     */
+    void buildRangeDrawLists();
+
+    /**
+     * Makes key identifying generator output - generator name, vertex layout, vertex storage and given parameters.
+     *
+     * @param generatorName  Name of the generator (usually class name)
+     * @param parameters     Generator parameters (trivially copyable)
+     */
+    template<typename... Parameters>
+    std::vector<unsigned char> makeMeshFileKey(const char* generatorName, const Parameters&... parameters) const
+    {
+        return makeGeneratorKey(generatorName, *_vertexFormat, _vertexStorage, parameters...);
+    }
+
+    /**
+     * Makes key identifying generator output before the mesh exists (see makeMeshFileKey), shapes make their MeshCache
+     * keys with it. Parameters must be passed with their declared types and without padding, so that equal meshes get equal keys.
+     *
+     * @param generatorName  Name of the generator (usually class name)
+     * @param vertexFormat   Vertex format of the mesh
+     * @param vertexStorage  Vertex storage of the mesh
+     * @param parameters     Generator parameters (trivially copyable)
+     */
+    template<typename... Parameters>
+    static std::vector<unsigned char> makeGeneratorKey(const char* generatorName, const VertexFormat& vertexFormat, VertexStorage vertexStorage,
+        const Parameters&... parameters)
+    {
+        std::vector<unsigned char> key(generatorName, generatorName + strlen(generatorName) + 1);
+        const auto appendBytes = [&key](const auto& value)
+        {
+            static_assert(std::is_trivially_copyable<std::decay_t<decltype(value)>>::value, "Mesh file key parameters must be trivially copyable");
+            const auto bytes = reinterpret_cast<const unsigned char*>(&value);
+            key.insert(key.end(), bytes, bytes + sizeof(value));
+        };
+
+        appendBytes(vertexFormat.attributeOrder);
+        appendBytes(vertexStorage);
+        (appendBytes(parameters), ...);
+        return key;
+    }
+
+    /**
+     * Loads mesh generated with given key from the mesh file cache, creating VAO and uploading mapped data without any processing.
+     * If the cache is enabled, but has no valid file for the key, the key is remembered and finalizeIndexedData stores the mesh.
+     *
+     * @param key  Key identifying generator output (see makeMeshFileKey)
+     *
+     * @return True, if mesh has been loaded and is initialized, false, if it has to be generated.
+     */
+    bool loadFromMeshFileCache(const std::vector<unsigned char>& key);
+
+private:
+    static std::string _meshFileCacheDirectory; // Directory of the mesh file cache (empty if disabled)
+    std::vector<unsigned char> _meshFileCacheKey; // Key of the mesh to store in the cache, when finalized (empty if none)
+
+    /**
+     * Gets flags of present vertex attributes in mesh file form.
+     */
+    uint32_t getMeshFileAttributeFlags() const;
+
+    /**
+     * Stores finalized data (in mesh vertex storage, 32-bit indices) to the mesh file cache under remembered key.
+     */
+    void saveToMeshFileCache(const unsigned char* vertexData, const GLuint* indices);
+
+    /**
+     * Reorders indices and vertex data (in mesh vertex storage) in place and stores the report.
+     */
+    void optimizeData(unsigned char* vertexData, GLuint* indices);
+
+    /**
+     * Reads back indices of the mesh (from in-memory copy if kept, otherwise from the GPU) as 32-bit ones.
+     */
+    void readIndices(std::vector<GLuint>& indices);
+
+    /**
+     * Extracts float vertex attributes from vertex data in mesh vertex storage, in vertex order (arrays of missing attributes are empty).
+     */
+    void extractAttributes(const unsigned char* vertexData, std::vector<glm::vec3>& positions, std::vector<glm::vec2>& textureCoordinates,
+        std::vector<glm::vec3>& normals) const;
+
+    /**
+     * Chooses type of the indices from number of vertices (16-bit ones, if all vertices and primitive restart index fit into them).
+     */
+    void updateIndexType();
+
+    /**
+     * Extracts vertex positions from vertex data in mesh vertex storage (empty, if mesh has no float positions).
+     */
+    void extractPositions(const unsigned char* vertexData, std::vector<glm::vec3>& positions) const;
+
+    /**
+     * Uploads indices to the element buffer of mesh VAO (which must be bound), converted to mesh index type.
+     */
+    void uploadIndices(const GLuint* indices, GLenum usageHint);
 };
 
 }; // namespace static_meshes_3D
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+// STL
+#include <chrono>
+
+namespace static_meshes_3D {
+
+/**
+ * Gets milliseconds elapsed since given time point of the steady clock.
+ */
+inline double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,127 @@
+// Runs diagnostics of the project (see diagnostics.h) in a headless OpenGL context - EGL surfaceless context on
+// Mesa (llvmpipe works), so that they run in CI without a display or window system.
+//
+// Build: cmake -S tools -B build && cmake --build build
+// Run:   build/headlessDiagnostics --validate-gpu-culling --benchmark-streaming
+
+// STL
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// GLAD
+#include <GL/glew.h>
+
+// EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+// Project
+#include "diagnostics.h"
+
+namespace {
+
+// Checks, if space-separated extension string contains the extension
+bool hasExtension(const char* extensions, const char* extension)
+{
+    if (extensions == nullptr) {
+        return false;
+    }
+
+    const auto length = strlen(extension);
+    for (auto position = strstr(extensions, extension); position != nullptr; position = strstr(position + length, extension))
+    {
+        const auto isStart = position == extensions || position[-1] == ' ';
+        const auto isEnd = position[length] == ' ' || position[length] == '\0';
+        if (isStart && isEnd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Creates OpenGL 4.5 core context without any surface and makes it current
+bool createHeadlessContext()
+{
+    // Surfaceless platform needs no display at all, default display is used where it's not available
+    EGLDisplay display = EGL_NO_DISPLAY;
+    const auto clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay != nullptr && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cerr << "Could not initialize EGL display!" << std::endl;
+        return false;
+    }
+
+    if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        std::cerr << "EGL display does not support surfaceless contexts!" << std::endl;
+        return false;
+    }
+
+    // No surface is created, so config of any surface type will do (surfaceless platform has pbuffer configs only)
+    const EGLint configAttributes[] = { EGL_SURFACE_TYPE, 0, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &numConfigs) || numConfigs == 0 || !eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "EGL display has no OpenGL config!" << std::endl;
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    const auto context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cerr << "Could not create OpenGL 4.5 core context!" << std::endl;
+        return false;
+    }
+
+    // GLEW built for GLX loads all OpenGL functions first and only then fails on missing GLX display, which is fine here
+    glewExperimental = GL_TRUE;
+    const auto glewResult = glewInit();
+    if (glewResult != GLEW_OK && glewResult != GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        std::cerr << glewGetErrorString(glewResult) << std::endl;
+        return false;
+    }
+
+    std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << " (" << glGetString(GL_RENDERER) << ")" << std::endl;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <diagnostic switch>... (e.g. --validate-gpu-culling, --benchmark-streaming)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!createHeadlessContext()) {
+        return EXIT_FAILURE;
+    }
+
+    auto isSuccessful = true;
+    for (auto i = 1; i < argc; i++)
+    {
+        isSuccessful = static_meshes_3D::runDiagnostic(argv[i]) && isSuccessful;
+    }
+
+    return isSuccessful ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,55 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "sinCosTable.h"
+#include "torus.h"
+
+namespace static_meshes_3D {
+
+float Torus::getMainRadius() const
+{
+    return _mainRadius;
+}
+
+float Torus::getTubeRadius() const
+{
+    return _tubeRadius;
+}
+
+int Torus::getMainSegments() const
+{
+    return _mainSegments;
+}
+
+int Torus::getTubeSegments() const
+{
+    return _tubeSegments;
+}
+
+float Torus::generateLod(int lod)
+{
+    const auto mainSegments = getLodSegments(_mainSegments, 3, lod);
+    const auto tubeSegments = getLodSegments(_tubeSegments, 3, lod);
+    const auto& mainTable = getSinCosTable(mainSegments);
+    const auto& tubeTable = getSinCosTable(tubeSegments);
+    addSurface(mainSegments, tubeSegments, true, true, [this, &mainTable, &tubeTable](int i, int j, glm::vec3& position, glm::vec3& normal)
+    {
+        const auto mainCosine = mainTable.getCosines()[i];
+        const auto mainSine = mainTable.getSines()[i];
+        const auto tubeCosine = tubeTable.getCosines()[j];
+
+        const auto tubeCenter = glm::vec3(mainCosine, 0.0f, mainSine) * _mainRadius;
+        normal = glm::vec3(tubeCosine * mainCosine, tubeTable.getSines()[j], tubeCosine * mainSine);
+        position = tubeCenter + normal * _tubeRadius;
+    });
+
+    return std::max(getChordError(_mainRadius + _tubeRadius, mainSegments), getChordError(_tubeRadius, tubeSegments));
+}
+
+std::vector<unsigned char> Torus::getMeshFileKey() const
+{
+    return makeMeshFileKey("Torus", _mainRadius, _tubeRadius, _mainSegments, _tubeSegments);
+}
+
+} // namespace static_meshes_3D
@@ -0,0 +1,70 @@
+#pragma once
+
+// Project
+#include "parametricMesh.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Torus lying in XZ plane with given main radius (center of the tube) and tube radius.
+ */
+class Torus : public ParametricMesh
+{
+public:
+    /**
+     * Creates torus with compile-time vertex layout (all float attributes by default), attributes not present in the layout are not stored.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    Torus(float mainRadius, float tubeRadius, int mainSegments, int tubeSegments, int lodCount = 1,
+        Layout layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+        : ParametricMesh(lodCount, layout, vertexStorage)
+        , _mainRadius(mainRadius)
+        , _tubeRadius(tubeRadius)
+        , _mainSegments(mainSegments)
+        , _tubeSegments(tubeSegments)
+    {
+        initializeData();
+    }
+
+    /**
+     * Makes MeshCache key of the torus created with given constructor arguments (see Cylinder::cacheKey), number of LODs is part of it.
+     */
+    template<typename Layout = DefaultVertexLayout>
+    static std::vector<unsigned char> cacheKey(float mainRadius, float tubeRadius, int mainSegments, int tubeSegments, int lodCount = 1,
+        Layout = Layout(), VertexStorage vertexStorage = VertexStorage::Planar)
+    {
+        return makeGeneratorKey("Torus", Layout::getFormat(), vertexStorage, mainRadius, tubeRadius, mainSegments, tubeSegments, clampLodCount(lodCount));
+    }
+
+    /**
+     * Gets distance from the torus center to the center of the tube.
+     */
+    float getMainRadius() const;
+
+    /**
+     * Gets radius of the tube.
+     */
+    float getTubeRadius() const;
+
+    /**
+     * Gets number of segments around torus center of the finest LOD.
+     */
+    int getMainSegments() const;
+
+    /**
+     * Gets number of segments around the tube of the finest LOD.
+     */
+    int getTubeSegments() const;
+
+protected:
+    float generateLod(int lod) override;
+    std::vector<unsigned char> getMeshFileKey() const override;
+
+private:
+    float _mainRadius; // Distance from the torus center to the center of the tube
+    float _tubeRadius; // Radius of the tube
+    int _mainSegments; // Number of segments around torus center
+    int _tubeSegments; // Number of segments around the tube
+};
+
+} // namespace static_meshes_3D
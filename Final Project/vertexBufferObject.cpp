@@ -1,9 +1,16 @@
 // STL
 #include <iostream>
 #include <cstring>
+#include <chrono>
+#include <algorithm>
 
 // Project
 #include "vertexBufferObject.h"
+#include "timing.h"
+
+const size_t VertexBufferObject::STREAMING_REGION_ALIGNMENT = 256;
+
+using static_meshes_3D::millisecondsSince;
 
 void VertexBufferObject::createVBO(size_t reserveSizeBytes)
 {
@@ -14,11 +21,52 @@ void VertexBufferObject::createVBO(size_t reserveSizeBytes)
     }
 
     glGenBuffers(1, &_bufferID);
-    _rawData.reserve(reserveSizeBytes > 0 ? reserveSizeBytes : 1024);
+    if (reserveSizeBytes > 0) {
+        _rawData.reserve(reserveSizeBytes);
+    }
 
     _isBufferCreated = true;
 }
 
+void VertexBufferObject::createStreamingVBO(GLenum bufferType, size_t regionSizeBytes, int numRegions)
+{
+    if (_isBufferCreated)
+    {
+        std::cerr << "This buffer is already created! You need to delete it before re-creating it!" << std::endl;
+        return;
+    }
+
+    if (regionSizeBytes == 0 || numRegions < 1)
+    {
+        std::cerr << "Streaming buffer needs at least one non-empty region!" << std::endl;
+        return;
+    }
+
+    // Round region size up, so that every region can be bound with glBindBufferRange
+    _streamingRegionSize = (regionSizeBytes + STREAMING_REGION_ALIGNMENT - 1) / STREAMING_REGION_ALIGNMENT * STREAMING_REGION_ALIGNMENT;
+    const auto totalSize = _streamingRegionSize * numRegions;
+
+    // Immutable storage stays mapped for the whole lifetime of the buffer, coherent mapping needs no explicit flushes
+    const GLbitfield storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &_bufferID);
+    _bufferType = bufferType;
+    glBindBuffer(_bufferType, _bufferID);
+    glBufferStorage(_bufferType, totalSize, nullptr, storageFlags);
+    _persistentMapping = static_cast<unsigned char*>(glMapBufferRange(_bufferType, 0, totalSize, storageFlags));
+    if (_persistentMapping == nullptr)
+    {
+        std::cerr << "Could not map streaming buffer persistently!" << std::endl;
+        glDeleteBuffers(1, &_bufferID);
+        return;
+    }
+
+    _regionFences.assign(numRegions, nullptr);
+    _currentRegion = -1;
+    _uploadedDataSize = totalSize;
+    _isBufferCreated = true;
+    _isDataUploaded = true;
+}
+
 void VertexBufferObject::bindVBO(GLenum bufferType)
 {
     if (!_isBufferCreated)
@@ -33,26 +81,123 @@ void VertexBufferObject::bindVBO(GLenum bufferType)
 
 void VertexBufferObject::addRawData(const void* ptrData, size_t dataSize, int repeat)
 {
-    const auto bytesToAdd = dataSize * repeat;
+    auto destination = static_cast<unsigned char*>(appendRawData(dataSize * repeat));
+    if (destination == nullptr) {
+        return;
+    }
+
+    for (int i = 0; i < repeat; i++, destination += dataSize) {
+        memcpy(destination, ptrData, dataSize);
+    }
+}
+
+void* VertexBufferObject::appendRawData(size_t bytesToAdd)
+{
+    if (_directWritePointer != nullptr)
+    {
+        if (_bytesAdded + bytesToAdd > _directUploadSize)
+        {
+            std::cerr << "Direct upload overflow! Trying to write more data than announced in beginDirectUpload!" << std::endl;
+            return nullptr;
+        }
+
+        const auto destination = _directWritePointer + _bytesAdded;
+        _bytesAdded += bytesToAdd;
+        return destination;
+    }
+
     if (_bytesAdded + bytesToAdd > _rawData.capacity())
     {
-        const auto newCapacity = _rawData.capacity() * 2;
+        auto newCapacity = _rawData.capacity() > 0 ? _rawData.capacity() * 2 : 1024;
+        while (newCapacity < _bytesAdded + bytesToAdd) {
+            newCapacity *= 2;
+        }
+
         std::vector<unsigned char> newRawData;
         newRawData.reserve(newCapacity);
         memcpy(newRawData.data(), _rawData.data(), _bytesAdded);
         _rawData = std::move(newRawData);
     }
 
-    for (int i = 0; i < repeat; i++)
+    const auto destination = _rawData.data() + _bytesAdded;
+    _bytesAdded += bytesToAdd;
+    return destination;
+}
+
+void* VertexBufferObject::getRawDataPointer()
+{
+    return _directWritePointer != nullptr ? _directWritePointer : _rawData.data();
+}
+
+const void* VertexBufferObject::getRawDataPointer() const
+{
+    return _directWritePointer != nullptr ? _directWritePointer : _rawData.data();
+}
+
+void VertexBufferObject::setCpuCopyPolicy(CpuCopyPolicy policy)
+{
+    _cpuCopyPolicy = policy;
+}
+
+VertexBufferObject::CpuCopyPolicy VertexBufferObject::getCpuCopyPolicy() const
+{
+    return _cpuCopyPolicy;
+}
+
+void* VertexBufferObject::beginDirectUpload(size_t totalSizeBytes, GLenum usageHint)
+{
+    if (!_isBufferCreated)
+    {
+        std::cerr << "This buffer is not created yet! Call createVBO before uploading data to GPU!" << std::endl;
+        return nullptr;
+    }
+
+    _directUploadSize = totalSizeBytes;
+    _directUploadUsageHint = usageHint;
+    _bytesAdded = 0;
+
+    // Kept in-memory copy has to be written anyway (write-only mapping cannot fill it), so data are gathered right in it
+    // and uploaded from it at the end, as in the fallback
+    if (_cpuCopyPolicy == CpuCopyPolicy::Keep)
     {
-        memcpy(_rawData.data() + _bytesAdded, ptrData, dataSize);
-        _bytesAdded += dataSize;
+        _rawData.reserve(totalSizeBytes);
+        return nullptr;
+    }
+
+    // Allocate final storage and map it whole, previous contents can be thrown away
+    glBufferData(_bufferType, totalSizeBytes, nullptr, usageHint);
+    _directWritePointer = static_cast<unsigned char*>(glMapBufferRange(_bufferType, 0, totalSizeBytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    // Old in-memory copy does not describe the buffer anymore, fallback gathers the data in memory and uploads them at the end as usual
+    if (_directWritePointer != nullptr) {
+        std::vector<unsigned char>().swap(_rawData);
+    }
+    else if (_rawData.capacity() < totalSizeBytes) {
+        _rawData.reserve(totalSizeBytes);
     }
+
+    return _directWritePointer;
 }
 
-void* VertexBufferObject::getRawDataPointer()
+void VertexBufferObject::finishDirectUpload()
 {
-    return _rawData.data();
+    if (_directWritePointer == nullptr)
+    {
+        uploadDataToGPU(_directUploadUsageHint);
+        return;
+    }
+
+    if (_bytesAdded != _directUploadSize) {
+        std::cerr << "Direct upload finished with " << _bytesAdded << " bytes out of " << _directUploadSize << " written!" << std::endl;
+    }
+
+    glUnmapBuffer(_bufferType);
+    _directWritePointer = nullptr;
+    _isDataUploaded = true;
+    _uploadedDataSize = _directUploadSize;
+    _usageHint = _directUploadUsageHint;
+    _bytesAdded = 0;
 }
 
 void VertexBufferObject::uploadDataToGPU(GLenum usageHint)
@@ -66,7 +211,36 @@ void VertexBufferObject::uploadDataToGPU(GLenum usageHint)
     glBufferData(_bufferType, _bytesAdded, _rawData.data(), usageHint);
     _isDataUploaded = true;
     _uploadedDataSize = _bytesAdded;
+    _usageHint = usageHint;
+    _bytesAdded = 0;
+    _dirtyRanges.clear();
+
+    if (_cpuCopyPolicy == CpuCopyPolicy::Release) {
+        std::vector<unsigned char>().swap(_rawData);
+    }
+}
+
+void VertexBufferObject::uploadDataToGPU(const void* ptrData, size_t dataSizeBytes, GLenum usageHint)
+{
+    if (!_isBufferCreated)
+    {
+        std::cerr << "This buffer is not created yet! Call createVBO before uploading data to GPU!" << std::endl;
+        return;
+    }
+
+    glBufferData(_bufferType, dataSizeBytes, ptrData, usageHint);
+    _isDataUploaded = true;
+    _uploadedDataSize = dataSizeBytes;
+    _usageHint = usageHint;
     _bytesAdded = 0;
+    _dirtyRanges.clear();
+
+    std::vector<unsigned char>().swap(_rawData);
+    if (_cpuCopyPolicy == CpuCopyPolicy::Keep)
+    {
+        _rawData.reserve(dataSizeBytes);
+        memcpy(_rawData.data(), ptrData, dataSizeBytes);
+    }
 }
 
 void* VertexBufferObject::mapBufferToMemory(GLenum usageHint)
@@ -76,7 +250,13 @@ void* VertexBufferObject::mapBufferToMemory(GLenum usageHint)
         return nullptr;
     }
 
-    return glMapBuffer(_bufferType, usageHint);
+    // glMapBuffer implicitly synchronizes with the GPU, so measure time spent there
+    const auto mapStart = std::chrono::steady_clock::now();
+    auto result = glMapBuffer(_bufferType, usageHint);
+    _transferStats.stallMilliseconds += millisecondsSince(mapStart);
+    _mappedLength = _uploadedDataSize;
+
+    return result;
 }
 
 void* VertexBufferObject::mapSubBufferToMemory(GLenum usageHint, size_t offset, size_t length)
@@ -86,31 +266,271 @@ void* VertexBufferObject::mapSubBufferToMemory(GLenum usageHint, size_t offset,
         return nullptr;
     }
 
-    return glMapBufferRange(_bufferType, offset, length, usageHint);
+    const auto mapStart = std::chrono::steady_clock::now();
+    auto result = glMapBufferRange(_bufferType, offset, length, usageHint);
+    _transferStats.stallMilliseconds += millisecondsSince(mapStart);
+    _mappedLength = length;
+
+    return result;
 }
 
 void VertexBufferObject::unmapBuffer()
 {
     glUnmapBuffer(_bufferType);
+
+    _transferStats.bytesLastFrame = _mappedLength;
+    _transferStats.bytesTotal += _mappedLength;
+    _transferStats.numFrames++;
+    _mappedLength = 0;
 }
 
-GLuint VertexBufferObject::getBufferID()
+void VertexBufferObject::updateRawData(size_t offset, const void* ptrData, size_t dataSizeBytes)
+{
+    if (!isUpdatableRange(offset, dataSizeBytes))
+    {
+        std::cerr << "Cannot update data outside of uploaded buffer with kept in-memory copy!" << std::endl;
+        return;
+    }
+
+    memcpy(_rawData.data() + offset, ptrData, dataSizeBytes);
+    markDirty(offset, dataSizeBytes);
+}
+
+void VertexBufferObject::markDirty(size_t offset, size_t sizeBytes)
+{
+    if (sizeBytes == 0) {
+        return;
+    }
+
+    // Flush copies dirty ranges from the in-memory copy into the buffer, so both must hold the whole range
+    if (!isUpdatableRange(offset, sizeBytes))
+    {
+        std::cerr << "Cannot mark data outside of uploaded buffer with kept in-memory copy dirty!" << std::endl;
+        return;
+    }
+
+    _dirtyRanges.emplace_back(offset, offset + sizeBytes);
+}
+
+bool VertexBufferObject::isUpdatableRange(size_t offset, size_t sizeBytes) const
+{
+    if (!_isDataUploaded || isStreaming()) {
+        return false;
+    }
+
+    // Compared without offset + sizeBytes, that could overflow
+    const auto updatableSize = std::min(_uploadedDataSize, getCpuCopySize());
+    return offset <= updatableSize && sizeBytes <= updatableSize - offset;
+}
+
+void VertexBufferObject::flushDirtyRanges()
+{
+    if (_dirtyRanges.empty()) {
+        return;
+    }
+
+    if (!_isDataUploaded || isStreaming() || getCpuCopySize() < _uploadedDataSize)
+    {
+        std::cerr << "Dirty ranges can be flushed only for uploaded buffer with kept in-memory copy!" << std::endl;
+        _dirtyRanges.clear();
+        return;
+    }
+
+    // Merge overlapping and adjacent ranges
+    std::sort(_dirtyRanges.begin(), _dirtyRanges.end());
+    size_t numMergedRanges = 0;
+    size_t dirtyBytes = 0;
+    for (const auto& range : _dirtyRanges)
+    {
+        auto& lastRange = _dirtyRanges[numMergedRanges > 0 ? numMergedRanges - 1 : 0];
+        if (numMergedRanges > 0 && range.first <= lastRange.second) {
+            lastRange.second = std::max(lastRange.second, range.second);
+        }
+        else {
+            _dirtyRanges[numMergedRanges++] = range;
+        }
+    }
+    _dirtyRanges.resize(numMergedRanges);
+    for (const auto& range : _dirtyRanges) {
+        dirtyBytes += range.second - range.first;
+    }
+
+    size_t bytesUploaded = 0;
+    if (dirtyBytes >= _orphanThreshold * _uploadedDataSize)
+    {
+        // Most of the buffer changed - let the driver give us fresh storage instead of synchronizing with draws using the old one
+        glBufferData(_bufferType, _uploadedDataSize, nullptr, _usageHint);
+        glBufferSubData(_bufferType, 0, _uploadedDataSize, _rawData.data());
+        bytesUploaded = _uploadedDataSize;
+        _transferStats.numOrphans++;
+        numMergedRanges = 1;
+    }
+    else if (_dirtyUploadMethod == DirtyUploadMethod::FlushMappedRange)
+    {
+        const auto spanBegin = _dirtyRanges.front().first;
+        const auto spanEnd = _dirtyRanges.back().second;
+        const auto mapStart = std::chrono::steady_clock::now();
+        auto mappedSpan = static_cast<unsigned char*>(glMapBufferRange(_bufferType, spanBegin, spanEnd - spanBegin,
+            GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+        _transferStats.stallMilliseconds += millisecondsSince(mapStart);
+        if (mappedSpan == nullptr)
+        {
+            std::cerr << "Could not map buffer range for dirty ranges upload!" << std::endl;
+            return;
+        }
+
+        for (const auto& range : _dirtyRanges)
+        {
+            memcpy(mappedSpan + range.first - spanBegin, _rawData.data() + range.first, range.second - range.first);
+            glFlushMappedBufferRange(_bufferType, range.first - spanBegin, range.second - range.first);
+        }
+
+        glUnmapBuffer(_bufferType);
+        bytesUploaded = dirtyBytes;
+    }
+    else
+    {
+        for (const auto& range : _dirtyRanges) {
+            glBufferSubData(_bufferType, range.first, range.second - range.first, _rawData.data() + range.first);
+        }
+        bytesUploaded = dirtyBytes;
+    }
+
+    _transferStats.bytesLastFrame = bytesUploaded;
+    _transferStats.bytesTotal += bytesUploaded;
+    _transferStats.numRangesLastFrame = static_cast<int>(numMergedRanges);
+    _transferStats.numFrames++;
+    _dirtyRanges.clear();
+}
+
+void VertexBufferObject::setDirtyUploadMethod(DirtyUploadMethod method)
+{
+    _dirtyUploadMethod = method;
+}
+
+VertexBufferObject::DirtyUploadMethod VertexBufferObject::getDirtyUploadMethod() const
+{
+    return _dirtyUploadMethod;
+}
+
+void VertexBufferObject::setOrphanThreshold(float fraction)
+{
+    _orphanThreshold = fraction;
+}
+
+void* VertexBufferObject::beginStreamingRegion()
+{
+    if (!isStreaming())
+    {
+        std::cerr << "This buffer is not a streaming buffer! Call createStreamingVBO before writing frame regions!" << std::endl;
+        return nullptr;
+    }
+
+    _currentRegion = (_currentRegion + 1) % static_cast<int>(_regionFences.size());
+
+    // Wait only if GPU has not finished reading this region yet (that's the case of the frame numRegions back)
+    auto& fence = _regionFences[_currentRegion];
+    if (fence != nullptr)
+    {
+        auto waitResult = glClientWaitSync(fence, 0, 0);
+        if (waitResult == GL_TIMEOUT_EXPIRED)
+        {
+            const auto waitStart = std::chrono::steady_clock::now();
+            do {
+                waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (waitResult == GL_TIMEOUT_EXPIRED);
+
+            _transferStats.stallMilliseconds += millisecondsSince(waitStart);
+            _transferStats.numStalls++;
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    return _persistentMapping + getStreamingRegionOffset();
+}
+
+void VertexBufferObject::endStreamingRegion(size_t bytesWritten)
+{
+    if (!isStreaming() || _currentRegion < 0) {
+        return;
+    }
+
+    _regionFences[_currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    _transferStats.bytesLastFrame = bytesWritten;
+    _transferStats.bytesTotal += bytesWritten;
+    _transferStats.numFrames++;
+}
+
+size_t VertexBufferObject::getStreamingRegionOffset() const
+{
+    return _currentRegion < 0 ? 0 : _streamingRegionSize * _currentRegion;
+}
+
+size_t VertexBufferObject::getStreamingRegionSize() const
+{
+    return _streamingRegionSize;
+}
+
+bool VertexBufferObject::isStreaming() const
+{
+    return _persistentMapping != nullptr;
+}
+
+const VertexBufferObject::TransferStats& VertexBufferObject::getTransferStats() const
+{
+    return _transferStats;
+}
+
+void VertexBufferObject::resetTransferStats()
+{
+    _transferStats = TransferStats();
+}
+
+GLuint VertexBufferObject::getBufferID() const
 {
     return _bufferID;
 }
 
-size_t VertexBufferObject::getBufferSize()
+size_t VertexBufferObject::getBufferSize() const
 {
     return _isDataUploaded ? _uploadedDataSize : _bytesAdded;
 }
 
+size_t VertexBufferObject::getCpuCopySize() const
+{
+    return _rawData.capacity();
+}
+
 void VertexBufferObject::deleteVBO()
 {
     if (!_isBufferCreated) {
         return;
     }
 
+    if (isStreaming())
+    {
+        for (auto& fence : _regionFences)
+        {
+            if (fence != nullptr) {
+                glDeleteSync(fence);
+            }
+        }
+
+        _regionFences.clear();
+        glBindBuffer(_bufferType, _bufferID);
+        glUnmapBuffer(_bufferType);
+        _persistentMapping = nullptr;
+        _streamingRegionSize = 0;
+        _currentRegion = -1;
+    }
+
     glDeleteBuffers(1, &_bufferID);
+    std::vector<unsigned char>().swap(_rawData);
+    _dirtyRanges.clear();
+    _bytesAdded = 0;
     _isDataUploaded = false;
     _isBufferCreated = false;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 // STL
+#include <utility>
 #include <vector>
 
 // GLAD
@@ -12,6 +13,24 @@
 class VertexBufferObject
 {
 public:
+    /**
+     * Policy telling, what happens with in-memory (CPU) copy of the data after uploading them to the GPU.
+     */
+    enum class CpuCopyPolicy
+    {
+        Release, // In-memory data are freed right after upload (default)
+        Keep // In-memory data are kept alive for the life of the VBO (needed when data are read back on CPU)
+    };
+
+    /**
+     * Method of uploading dirty ranges of the in-memory copy to the GPU.
+     */
+    enum class DirtyUploadMethod
+    {
+        BufferSubData, // Every merged range is uploaded with glBufferSubData (default)
+        FlushMappedRange // Span of all ranges is mapped once, every merged range is flushed with glFlushMappedBufferRange
+    };
+
     /**
      * Creates a new VBO, with optional reserved buffer size.
      *
@@ -19,6 +38,17 @@ public:
      */
     void createVBO(size_t reserveSizeBytes = 0);
 
+    /**
+     * Creates a new streaming VBO - persistently mapped ring buffer with immutable storage, split into frame regions.
+     * Every frame writes into the next region, which is guarded by a fence, so that CPU only waits, if GPU
+     * is still reading the region written numRegions frames ago.
+     *
+     * @param bufferType       Type of the buffer (GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER...)
+     * @param regionSizeBytes  Size of one frame region, in bytes (rounded up to STREAMING_REGION_ALIGNMENT)
+     * @param numRegions       Number of frame regions in the ring (default is 3, so that frame N+2 never waits for frame N)
+     */
+    void createStreamingVBO(GLenum bufferType, size_t regionSizeBytes, int numRegions = 3);
+
     /**
      * Binds this vertex buffer object (makes current).
      *
@@ -48,10 +78,56 @@ public:
     }
 
     /**
-     * Gets pointer to the raw data from in-memory buffer (only before uploading them).
+     * Appends uninitialized bytes to the in-memory buffer (or to the mapped GPU memory during direct upload),
+     * so that the caller can write data in place instead of copying them from elsewhere.
+     *
+     * @param dataSizeBytes  Number of bytes to append
+     *
+     * @return Pointer to the appended bytes (valid until next addition), or nullptr, if direct upload would overflow.
+     */
+    void* appendRawData(size_t dataSizeBytes);
+
+    /**
+     * Gets pointer to the raw data from in-memory buffer (only before uploading them, or after uploading
+     * with CpuCopyPolicy::Keep). During direct upload, it points to the mapped GPU memory.
      */
     void* getRawDataPointer();
 
+    /**
+     * Gets pointer to the raw data from in-memory buffer for reading (see getRawDataPointer).
+     */
+    const void* getRawDataPointer() const;
+
+    /**
+     * Sets policy for in-memory copy of the data after upload. It's applied with the next upload.
+     *
+     * @param policy  Whether to release or keep in-memory copy
+     */
+    void setCpuCopyPolicy(CpuCopyPolicy policy);
+
+    /**
+     * Gets policy for in-memory copy of the data after upload.
+     */
+    CpuCopyPolicy getCpuCopyPolicy() const;
+
+    /**
+     * Starts direct upload - allocates GPU buffer of final size and maps it, so that all subsequent addRawData / addData
+     * calls write straight to the GPU memory, with no intermediate in-memory copy. Buffer must be bound.
+     * If mapping fails, data are gathered in memory as usual and uploaded in finishDirectUpload. With CpuCopyPolicy::Keep,
+     * data are gathered in the kept in-memory copy the same way, so that they can be updated later (see updateRawData).
+     *
+     * @param totalSizeBytes  Final size of the buffer data, in bytes
+     * @param usageHint       Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+     *
+     * @return Pointer to the mapped data, or nullptr, if data are gathered in memory instead.
+     */
+    void* beginDirectUpload(size_t totalSizeBytes, GLenum usageHint);
+
+    /**
+     * Finishes direct upload started with beginDirectUpload. Now the VBO is ready to be used.
+     */
+    void finishDirectUpload();
+
     /** 
      * Uploads gathered data to the GPU memory. Now the VBO is ready to be used.
      *
@@ -59,6 +135,16 @@ public:
      */
     void uploadDataToGPU(GLenum usageHint);
 
+    /**
+     * Uploads data straight from given memory (e.g. memory-mapped file) to the GPU, replacing gathered data. Buffer must be bound.
+     * In-memory copy is made only with CpuCopyPolicy::Keep.
+     *
+     * @param ptrData        Pointer to the data
+     * @param dataSizeBytes  Size of the data (in bytes)
+     * @param usageHint      Hint for OpenGL, how is the data intended to be used (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+     */
+    void uploadDataToGPU(const void* ptrData, size_t dataSizeBytes, GLenum usageHint);
+
     /**
      * Maps buffer data to a memory pointer.
      * 
@@ -84,21 +170,129 @@ public:
      */
     void unmapBuffer();
 
+    /**
+     * Updates part of already uploaded data in the in-memory copy and marks it dirty, so that it's uploaded
+     * with the next flushDirtyRanges call. In-memory copy must be kept (CpuCopyPolicy::Keep).
+     *
+     * @param offset         Byte offset of the updated data
+     * @param ptrData        Pointer to the new data
+     * @param dataSizeBytes  Size of the updated data (in bytes)
+     */
+    void updateRawData(size_t offset, const void* ptrData, size_t dataSizeBytes);
+
+    /**
+     * Marks part of the in-memory copy dirty (e.g. after writing to it through getRawDataPointer). Range outside of
+     * the uploaded buffer or its in-memory copy is reported to std::cerr and ignored.
+     *
+     * @param offset     Byte offset of the dirty data
+     * @param sizeBytes  Size of the dirty data (in bytes)
+     */
+    void markDirty(size_t offset, size_t sizeBytes);
+
+    /**
+     * Uploads dirty ranges of the in-memory copy to the GPU, buffer must be bound. Adjacent and overlapping ranges are merged first.
+     * If dirty data make at least orphan threshold of the buffer, whole buffer is orphaned and uploaded at once instead.
+     * Every flush counts as one frame in transfer statistics.
+     */
+    void flushDirtyRanges();
+
+    /**
+     * Checks, if range lies within both the uploaded buffer and its in-memory copy, i.e. it can be updated and flushed.
+     */
+    bool isUpdatableRange(size_t offset, size_t sizeBytes) const;
+
+    /**
+     * Sets method of uploading dirty ranges (glBufferSubData per range or mapping with explicit flushes).
+     */
+    void setDirtyUploadMethod(DirtyUploadMethod method);
+
+    /**
+     * Gets method of uploading dirty ranges.
+     */
+    DirtyUploadMethod getDirtyUploadMethod() const;
+
+    /**
+     * Sets dirty fraction of the buffer, from which whole buffer gets orphaned and uploaded instead of single ranges.
+     *
+     * @param fraction  Fraction of the buffer size (default is 0.5, values above 1 disable orphaning)
+     */
+    void setOrphanThreshold(float fraction);
+
+    /**
+     * Starts writing of the next frame region of streaming VBO. If GPU still uses that region, waits for its fence.
+     *
+     * @return Pointer to the beginning of the region, or nullptr, if this is not a streaming VBO.
+     */
+    void* beginStreamingRegion();
+
+    /**
+     * Ends writing of the current frame region and fences it. Call it after the draw calls reading the region have been issued.
+     *
+     * @param bytesWritten  Number of bytes written to the region (used for transfer statistics)
+     */
+    void endStreamingRegion(size_t bytesWritten);
+
+    /**
+     * Gets byte offset of the current frame region of streaming VBO (to use in draw calls or glBindBufferRange).
+     */
+    size_t getStreamingRegionOffset() const;
+
+    /**
+     * Gets byte size of one frame region of streaming VBO.
+     */
+    size_t getStreamingRegionSize() const;
+
+    /**
+     * Checks, if this VBO is a persistently mapped streaming VBO.
+     */
+    bool isStreaming() const;
+
+    /**
+     * Transfer statistics, gathered both for streaming regions and for map / unmap path, so that they can be compared.
+     */
+    struct TransferStats
+    {
+        size_t bytesLastFrame = 0; // Bytes written in the last finished frame region / mapping
+        size_t bytesTotal = 0; // Bytes written since last reset
+        int numFrames = 0; // Number of finished frame regions / mappings since last reset
+        int numStalls = 0; // How many times CPU had to wait for the GPU
+        double stallMilliseconds = 0.0; // Total time CPU has spent waiting for the GPU (fence waits or inside glMapBuffer*)
+        int numRangesLastFrame = 0; // Number of merged dirty ranges uploaded by the last flush
+        int numOrphans = 0; // How many flushes orphaned and uploaded the whole buffer
+    };
+
+    /**
+     * Gets transfer statistics of this VBO.
+     */
+    const TransferStats& getTransferStats() const;
+
+    /**
+     * Resets transfer statistics of this VBO.
+     */
+    void resetTransferStats();
+
     /**
      * Gets OpenGL-assigned buffer ID.
      */
-    GLuint getBufferID();
+    GLuint getBufferID() const;
+
+    /**
+     * Gets buffer size (in bytes). Before upload, it's the size of gathered data, after upload the size of GPU buffer.
+     */
+    size_t getBufferSize() const;
 
     /**
-     * Gets buffer size (in bytes).
+     * Gets number of bytes held by in-memory (CPU) copy of the data. After upload, it's zero unless CpuCopyPolicy::Keep is set.
      */
-    size_t getBufferSize();
+    size_t getCpuCopySize() const;
 
     /**
      * Deletes VBO and frees memory and internal structures.
      */
     void deleteVBO();
 
+    static const size_t STREAMING_REGION_ALIGNMENT; // Alignment of streaming regions (satisfies uniform / storage buffer offset alignments)
+
 private:
     GLuint _bufferID = 0; // OpenGL assigned buffer ID
     int _bufferType; // Buffer type (GL_ARRAY_BUFFER, GL_ELEMENT_BUFFER...)
@@ -109,4 +303,22 @@ private:
 
     bool _isBufferCreated = false; // Flag telling if the buffer has been created
     bool _isDataUploaded = false; // Flag telling, if data has been uploaded to GPU already.
+
+    CpuCopyPolicy _cpuCopyPolicy = CpuCopyPolicy::Release; // What happens with in-memory data after upload
+    unsigned char* _directWritePointer = nullptr; // Pointer to mapped GPU memory during direct upload
+    size_t _directUploadSize = 0; // Final size of the data being uploaded directly
+    GLenum _directUploadUsageHint = GL_STATIC_DRAW; // Usage hint of direct upload (for fallback upload)
+    GLenum _usageHint = GL_STATIC_DRAW; // Usage hint of the last upload (used again when orphaning)
+
+    std::vector<std::pair<size_t, size_t>> _dirtyRanges; // Dirty byte ranges (begin, end) of the in-memory copy, not merged yet
+    DirtyUploadMethod _dirtyUploadMethod = DirtyUploadMethod::BufferSubData; // How dirty ranges get to the GPU
+    float _orphanThreshold = 0.5f; // Dirty fraction of the buffer, from which whole buffer is orphaned and uploaded
+
+    unsigned char* _persistentMapping = nullptr; // Pointer to persistently mapped storage of streaming VBO
+    size_t _streamingRegionSize = 0; // Byte size of one frame region of streaming VBO
+    int _currentRegion = -1; // Index of frame region being currently written (-1 if none yet)
+    std::vector<GLsync> _regionFences; // Fences guarding every frame region of streaming VBO
+    size_t _mappedLength = 0; // Byte length of the current map / unmap mapping (for statistics)
+
+    TransferStats _transferStats; // Statistics of data transfers to this VBO
 };
\ No newline at end of file
@@ -0,0 +1,514 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+namespace static_meshes_3D {
+
+namespace vertex_attributes {
+
+/**
+ * Vertex position attribute. Locations are the single source of truth for all vertex shaders.
+ */
+struct Position
+{
+    typedef glm::vec3 ValueType;
+    static constexpr GLuint LOCATION = 0; // Must match layout(location = 0) in vertex shaders
+    static constexpr GLint NUM_COMPONENTS = 3;
+};
+
+/**
+ * Vertex normal attribute.
+ */
+struct Normal
+{
+    typedef glm::vec3 ValueType;
+    static constexpr GLuint LOCATION = 1; // Must match layout(location = 1) in vertex shaders
+    static constexpr GLint NUM_COMPONENTS = 3;
+};
+
+/**
+ * Vertex texture coordinate attribute.
+ */
+struct TextureCoordinate
+{
+    typedef glm::vec2 ValueType;
+    static constexpr GLuint LOCATION = 2; // Must match layout(location = 2) in vertex shaders
+    static constexpr GLint NUM_COMPONENTS = 2;
+};
+
+/**
+ * Per-instance index of instance data (divisor 1, so that base instance of indirect draws selects it). It is not stored
+ * in mesh vertices, GPU culling attaches it to VAOs of the meshes it renders.
+ */
+struct InstanceIndex
+{
+    typedef GLuint ValueType;
+    static constexpr GLuint LOCATION = 3; // Must match layout(location = 3) in vertex shaders
+    static constexpr GLint NUM_COMPONENTS = 1;
+};
+
+} // namespace vertex_attributes
+
+/**
+ * How vertex attributes are arranged in the vertex buffer.
+ */
+enum class VertexStorage
+{
+    Planar, // All positions, then all next attributes (each attribute in its own span)
+    Interleaved, // All attributes of one vertex together
+    SplitPosition // Span of positions, then span of interleaved remaining attributes (good for depth-only passes)
+};
+
+/**
+ * Vertex layout of a mesh, that is not a template itself - flags, stride and operations of one VertexLayout instantiated
+ * at compile time (see VertexLayout::getFormat), so attributes not present in the layout are compiled out of them.
+ * All meshes with the same layout share one format.
+ */
+struct VertexFormat
+{
+    bool hasPositions; // Layout contains positions
+    bool hasTextureCoordinates; // Layout contains texture coordinates
+    bool hasNormals; // Layout contains normals
+    size_t stride; // Byte size of one vertex
+    uint32_t attributeOrder; // Locations of attributes (plus one) in stored order, 4 bits each - tells apart layouts with the same attributes
+
+    // See VertexLayout::setAttributePointers
+    void (*setAttributePointers)(VertexStorage storage, size_t numVertices, size_t baseOffset);
+
+    // See VertexLayout::convertStorage
+    void (*convertStorage)(const unsigned char* source, VertexStorage sourceStorage, unsigned char* destination, VertexStorage destinationStorage, size_t numVertices);
+
+    // See VertexLayout::readAttributes
+    void (*readAttributes)(const unsigned char* data, VertexStorage storage, size_t numVertices, const GLuint* vertexIndices, size_t count,
+        glm::vec3* positions, glm::vec2* textureCoordinates, glm::vec3* normals);
+
+    // See VertexLayout::writeAttributes
+    void (*writeAttributes)(unsigned char* data, VertexStorage storage, size_t numVertices, size_t firstIndex, size_t count,
+        const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals);
+
+    // See VertexLayout::copyFromLayout, source vertices are interleaved in DefaultVertexLayout
+    void (*copyFromDefaultLayout)(const unsigned char* source, unsigned char* destination, VertexStorage destinationStorage, size_t numVertices);
+};
+
+/**
+ * Compile-time description of vertex attributes, in the order they are stored. Stride, offsets and attribute
+ * setup are computed at compile time, writing of attributes not present in the layout compiles to nothing
+ * and asking for offset of missing attribute fails to compile.
+ */
+template<typename... Attributes>
+struct VertexLayout
+{
+    static_assert(sizeof...(Attributes) > 0, "Vertex layout needs at least one attribute!");
+
+    static constexpr int NUM_ATTRIBUTES = sizeof...(Attributes); // Number of attributes in the layout
+    static constexpr size_t STRIDE = (size_t(0) + ... + sizeof(typename Attributes::ValueType)); // Byte size of one interleaved vertex
+
+    /**
+     * Checks, if layout contains given attribute.
+     */
+    template<typename Attribute>
+    static constexpr bool has()
+    {
+        return (std::is_same<Attribute, Attributes>::value || ...);
+    }
+
+    /**
+     * Checks, if layout contains all attributes of another layout (e.g. inputs of a shader).
+     */
+    template<typename OtherLayout>
+    static constexpr bool provides()
+    {
+        return OtherLayout::template isProvidedBy<VertexLayout>();
+    }
+
+    /**
+     * Checks, if all attributes of this layout are contained in another layout.
+     */
+    template<typename OtherLayout>
+    static constexpr bool isProvidedBy()
+    {
+        return (OtherLayout::template has<Attributes>() && ...);
+    }
+
+    /**
+     * Gets byte offset of the attribute inside interleaved vertex.
+     */
+    template<typename Attribute>
+    static constexpr size_t offsetOf()
+    {
+        static_assert(has<Attribute>(), "Vertex layout does not contain requested attribute!");
+
+        constexpr bool matches[] = { std::is_same<Attribute, Attributes>::value... };
+        constexpr size_t sizes[] = { sizeof(typename Attributes::ValueType)... };
+        size_t offset = 0;
+        for (size_t i = 0; !matches[i]; i++) {
+            offset += sizes[i];
+        }
+
+        return offset;
+    }
+
+    /**
+     * Gets byte offset of the attribute span inside planar data (all positions, then all next attributes...).
+     *
+     * @param numVertices  Number of vertices in the planar data
+     */
+    template<typename Attribute>
+    static constexpr size_t planarOffsetOf(size_t numVertices)
+    {
+        return offsetOf<Attribute>() * numVertices;
+    }
+
+    /**
+     * Writes attribute value of one interleaved vertex. Does nothing, if layout does not contain the attribute.
+     *
+     * @param vertex  Pointer to the beginning of the interleaved vertex
+     * @param value   Attribute value
+     */
+    template<typename Attribute>
+    static void write(unsigned char* vertex, const typename Attribute::ValueType& value)
+    {
+        if constexpr (has<Attribute>()) {
+            memcpy(vertex + offsetOf<Attribute>(), &value, sizeof(value));
+        }
+    }
+
+    /**
+     * Writes attribute value of i-th vertex in planar data. Does nothing, if layout does not contain the attribute.
+     *
+     * @param data         Pointer to the beginning of planar data
+     * @param numVertices  Number of vertices in the planar data
+     * @param index        Index of the vertex
+     * @param value        Attribute value
+     */
+    template<typename Attribute>
+    static void writePlanar(unsigned char* data, size_t numVertices, size_t index, const typename Attribute::ValueType& value)
+    {
+        if constexpr (has<Attribute>()) {
+            memcpy(data + planarOffsetOf<Attribute>(numVertices) + index * sizeof(value), &value, sizeof(value));
+        }
+    }
+
+    /**
+     * Gets byte offset of the attribute of i-th vertex in the buffer with given storage.
+     *
+     * @param storage      How attributes are arranged in the buffer
+     * @param numVertices  Number of vertices in the buffer
+     * @param index        Index of the vertex
+     */
+    template<typename Attribute>
+    static constexpr size_t attributeOffset(VertexStorage storage, size_t numVertices, size_t index)
+    {
+        return attributeBaseOffset<Attribute>(storage, numVertices) + index * attributeStride<Attribute>(storage);
+    }
+
+    /**
+     * Gets byte distance between attribute values of two consecutive vertices in the buffer with given storage.
+     */
+    template<typename Attribute>
+    static constexpr size_t attributeStride(VertexStorage storage)
+    {
+        if (storage == VertexStorage::Planar || (storage == VertexStorage::SplitPosition && isSplitAttribute<Attribute>())) {
+            return sizeof(typename Attribute::ValueType);
+        }
+
+        return storage == VertexStorage::Interleaved ? STRIDE : STRIDE - splitAttributeSize();
+    }
+
+    /**
+     * Writes attribute value of i-th vertex in the buffer with given storage. Does nothing, if layout does not contain the attribute.
+     *
+     * @param data         Pointer to the beginning of vertex data
+     * @param storage      How attributes are arranged in the buffer
+     * @param numVertices  Number of vertices in the buffer
+     * @param index        Index of the vertex
+     * @param value        Attribute value
+     */
+    template<typename Attribute>
+    static void writeAttribute(unsigned char* data, VertexStorage storage, size_t numVertices, size_t index, const typename Attribute::ValueType& value)
+    {
+        if constexpr (has<Attribute>()) {
+            memcpy(data + attributeOffset<Attribute>(storage, numVertices, index), &value, sizeof(value));
+        }
+    }
+
+    /**
+     * Writes attribute values of consecutive vertices in the buffer with given storage - planar spans are copied at once.
+     * Does nothing, if layout does not contain the attribute.
+     *
+     * @param data         Pointer to the beginning of vertex data
+     * @param storage      How attributes are arranged in the buffer
+     * @param numVertices  Number of vertices in the buffer
+     * @param firstIndex   Index of the first vertex to write
+     * @param values       Attribute values
+     * @param count        Number of values to write
+     */
+    template<typename Attribute>
+    static void writeAttributeSpan(unsigned char* data, VertexStorage storage, size_t numVertices, size_t firstIndex, const typename Attribute::ValueType* values, size_t count)
+    {
+        if constexpr (has<Attribute>())
+        {
+            const auto stride = attributeStride<Attribute>(storage);
+            auto destination = data + attributeOffset<Attribute>(storage, numVertices, firstIndex);
+            if (stride == sizeof(*values))
+            {
+                memcpy(destination, values, count * sizeof(*values));
+                return;
+            }
+
+            for (size_t i = 0; i < count; i++, destination += stride) {
+                memcpy(destination, values + i, sizeof(*values));
+            }
+        }
+    }
+
+    /**
+     * Copies vertex data, rearranging attributes from one storage to another.
+     *
+     * @param source              Source vertex data
+     * @param sourceStorage       How attributes are arranged in source data
+     * @param destination         Destination vertex data (STRIDE * numVertices bytes)
+     * @param destinationStorage  How attributes should be arranged in destination data
+     * @param numVertices         Number of vertices
+     */
+    static void convertStorage(const unsigned char* source, VertexStorage sourceStorage, unsigned char* destination, VertexStorage destinationStorage, size_t numVertices)
+    {
+        (convertAttributeStorage<Attributes>(source, sourceStorage, destination, destinationStorage, numVertices), ...);
+    }
+
+    /**
+     * Writes attribute values of consecutive vertices computed by given function straight to the buffer with given storage,
+     * so that generators need no temporary arrays. Does nothing (function is not even called), if layout does not contain the attribute.
+     *
+     * @param data         Pointer to the beginning of vertex data
+     * @param storage      How attributes are arranged in the buffer
+     * @param numVertices  Number of vertices in the buffer
+     * @param firstIndex   Index of the first vertex to write
+     * @param count        Number of values to write
+     * @param valueOf      Function returning attribute value of i-th written vertex (i from 0 to count - 1)
+     */
+    template<typename Attribute, typename Function>
+    static void generateAttributeSpan(unsigned char* data, VertexStorage storage, size_t numVertices, size_t firstIndex, size_t count, const Function& valueOf)
+    {
+        if constexpr (has<Attribute>())
+        {
+            const auto stride = attributeStride<Attribute>(storage);
+            auto destination = data + attributeOffset<Attribute>(storage, numVertices, firstIndex);
+            for (size_t i = 0; i < count; i++, destination += stride)
+            {
+                const typename Attribute::ValueType value = valueOf(i);
+                memcpy(destination, &value, sizeof(value));
+            }
+        }
+    }
+
+    /**
+     * Copies interleaved vertices of another layout (e.g. hardcoded vertex arrays or generated vertices) to the buffer with given storage.
+     * Source layout must contain all attributes of this layout, attributes not present in this layout are dropped.
+     *
+     * @param source              Source interleaved vertices in SourceLayout
+     * @param destination         Destination vertex data (STRIDE * numVertices bytes)
+     * @param destinationStorage  How attributes should be arranged in destination data
+     * @param numVertices         Number of vertices
+     */
+    template<typename SourceLayout>
+    static void copyFromLayout(const unsigned char* source, unsigned char* destination, VertexStorage destinationStorage, size_t numVertices)
+    {
+        static_assert(isProvidedBy<SourceLayout>(), "Source vertex layout does not contain all attributes of destination layout!");
+        (generateAttributeSpan<Attributes>(destination, destinationStorage, numVertices, 0, numVertices, [source](size_t i)
+        {
+            typename Attributes::ValueType value;
+            memcpy(&value, source + i * SourceLayout::STRIDE + SourceLayout::template offsetOf<Attributes>(), sizeof(value));
+            return value;
+        }), ...);
+    }
+
+    /**
+     * Reads float attributes of vertices from the buffer with given storage to attribute arrays. Arrays of attributes not present
+     * in the layout are left untouched, nullptr arrays are skipped (so that only some attributes can be read).
+     *
+     * @param data                Pointer to the beginning of vertex data
+     * @param storage             How attributes are arranged in the buffer
+     * @param numVertices         Number of vertices in the buffer
+     * @param vertexIndices       Indices of the vertices to read (nullptr to read vertices 0 to count - 1)
+     * @param count               Number of vertices to read
+     * @param positions           Output positions (count values)
+     * @param textureCoordinates  Output texture coordinates (count values)
+     * @param normals             Output normals (count values)
+     */
+    static void readAttributes(const unsigned char* data, VertexStorage storage, size_t numVertices, const GLuint* vertexIndices, size_t count,
+        glm::vec3* positions, glm::vec2* textureCoordinates, glm::vec3* normals)
+    {
+        readAttribute<vertex_attributes::Position>(data, storage, numVertices, vertexIndices, count, positions);
+        readAttribute<vertex_attributes::TextureCoordinate>(data, storage, numVertices, vertexIndices, count, textureCoordinates);
+        readAttribute<vertex_attributes::Normal>(data, storage, numVertices, vertexIndices, count, normals);
+    }
+
+    /**
+     * Writes float attributes of consecutive vertices from attribute arrays to the buffer with given storage (see writeAttributeSpan).
+     * Arrays of attributes not present in the layout are ignored (they may be nullptr), the other ones must be given.
+     *
+     * @param data                Pointer to the beginning of vertex data
+     * @param storage             How attributes are arranged in the buffer
+     * @param numVertices         Number of vertices in the buffer
+     * @param firstIndex          Index of the first vertex to write
+     * @param count               Number of vertices to write
+     * @param positions           Vertex positions (count values)
+     * @param textureCoordinates  Vertex texture coordinates (count values)
+     * @param normals             Vertex normals (count values)
+     */
+    static void writeAttributes(unsigned char* data, VertexStorage storage, size_t numVertices, size_t firstIndex, size_t count,
+        const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals)
+    {
+        writeAttributeSpan<vertex_attributes::Position>(data, storage, numVertices, firstIndex, positions, count);
+        writeAttributeSpan<vertex_attributes::TextureCoordinate>(data, storage, numVertices, firstIndex, textureCoordinates, count);
+        writeAttributeSpan<vertex_attributes::Normal>(data, storage, numVertices, firstIndex, normals, count);
+    }
+
+    /**
+     * Gets format of this layout, that meshes keep, so that they don't have to be templates themselves.
+     */
+    static const VertexFormat& getFormat()
+    {
+        using namespace vertex_attributes;
+
+        static const VertexFormat format = { has<Position>(), has<TextureCoordinate>(), has<Normal>(), STRIDE, attributeOrder(),
+            &setAttributePointers, &convertStorage, &readAttributes, &writeAttributes,
+            &copyFromLayout<VertexLayout<Position, TextureCoordinate, Normal>> };
+        return format;
+    }
+
+    /**
+     * Sets vertex attribute pointers of currently bound VAO for vertices with given storage in currently bound GL_ARRAY_BUFFER.
+     *
+     * @param storage      How attributes are arranged in the buffer
+     * @param numVertices  Number of vertices present in the buffer
+     * @param baseOffset   Byte offset of the vertex data in the buffer
+     */
+    static void setAttributePointers(VertexStorage storage, size_t numVertices, size_t baseOffset = 0)
+    {
+        (setAttributePointer<Attributes>(static_cast<GLsizei>(attributeStride<Attributes>(storage)),
+            baseOffset + attributeBaseOffset<Attributes>(storage, numVertices)), ...);
+    }
+
+    /**
+     * Sets vertex attribute pointers of currently bound VAO for interleaved vertices in currently bound GL_ARRAY_BUFFER.
+     *
+     * @param baseOffset  Byte offset of the first vertex in the buffer
+     */
+    static void setInterleavedAttributePointers(size_t baseOffset = 0)
+    {
+        (setAttributePointer<Attributes>(static_cast<GLsizei>(STRIDE), baseOffset + offsetOf<Attributes>()), ...);
+    }
+
+    /**
+     * Sets vertex attribute pointers of currently bound VAO for planar vertices in currently bound GL_ARRAY_BUFFER.
+     *
+     * @param numVertices  Number of vertices present in the buffer
+     */
+    static void setPlanarAttributePointers(size_t numVertices)
+    {
+        (setAttributePointer<Attributes>(static_cast<GLsizei>(sizeof(typename Attributes::ValueType)), planarOffsetOf<Attributes>(numVertices)), ...);
+    }
+
+private:
+    // Checks, if attribute gets its own span in VertexStorage::SplitPosition
+    template<typename Attribute>
+    static constexpr bool isSplitAttribute()
+    {
+        return std::is_same<Attribute, vertex_attributes::Position>::value;
+    }
+
+    // Byte size of the attribute with its own span in VertexStorage::SplitPosition (0 if layout has no positions)
+    static constexpr size_t splitAttributeSize()
+    {
+        return has<vertex_attributes::Position>() ? sizeof(vertex_attributes::Position::ValueType) : 0;
+    }
+
+    // Byte offset of the attribute of the first vertex in the buffer with given storage
+    template<typename Attribute>
+    static constexpr size_t attributeBaseOffset(VertexStorage storage, size_t numVertices)
+    {
+        if (storage == VertexStorage::Planar) {
+            return planarOffsetOf<Attribute>(numVertices);
+        }
+        if (storage == VertexStorage::Interleaved) {
+            return offsetOf<Attribute>();
+        }
+
+        // Split position - positions first, then the rest interleaved without positions
+        if (isSplitAttribute<Attribute>()) {
+            return 0;
+        }
+
+        auto offset = offsetOf<Attribute>();
+        if constexpr (has<vertex_attributes::Position>())
+        {
+            if (offsetOf<vertex_attributes::Position>() < offset) {
+                offset -= splitAttributeSize();
+            }
+        }
+
+        return splitAttributeSize() * numVertices + offset;
+    }
+
+    // Locations of attributes plus one, in stored order, 4 bits each (first attribute in the highest bits)
+    static constexpr uint32_t attributeOrder()
+    {
+        uint32_t order = 0;
+        ((order = order * 16 + Attributes::LOCATION + 1), ...);
+        return order;
+    }
+
+    template<typename Attribute>
+    static void readAttribute(const unsigned char* data, VertexStorage storage, size_t numVertices, const GLuint* vertexIndices, size_t count,
+        typename Attribute::ValueType* values)
+    {
+        if constexpr (has<Attribute>())
+        {
+            for (size_t i = 0; values != nullptr && i < count; i++)
+            {
+                const auto index = vertexIndices != nullptr ? vertexIndices[i] : i;
+                memcpy(values + i, data + attributeOffset<Attribute>(storage, numVertices, index), sizeof(*values));
+            }
+        }
+    }
+
+    template<typename Attribute>
+    static void convertAttributeStorage(const unsigned char* source, VertexStorage sourceStorage, unsigned char* destination, VertexStorage destinationStorage, size_t numVertices)
+    {
+        const auto size = sizeof(typename Attribute::ValueType);
+        const auto sourceOffset = attributeBaseOffset<Attribute>(sourceStorage, numVertices);
+        const auto sourceStride = attributeStride<Attribute>(sourceStorage);
+        const auto destinationOffset = attributeBaseOffset<Attribute>(destinationStorage, numVertices);
+        const auto destinationStride = attributeStride<Attribute>(destinationStorage);
+        for (size_t i = 0; i < numVertices; i++) {
+            memcpy(destination + destinationOffset + i * destinationStride, source + sourceOffset + i * sourceStride, size);
+        }
+    }
+
+    template<typename Attribute>
+    static void setAttributePointer(GLsizei stride, size_t offset)
+    {
+        glEnableVertexAttribArray(Attribute::LOCATION);
+        glVertexAttribPointer(Attribute::LOCATION, Attribute::NUM_COMPONENTS, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offset));
+    }
+};
+
+/**
+ * Layout of vertex data with all float attributes (positions, texture coordinates and normals), used by meshes
+ * that do not ask for a specific one (e.g. imported meshes).
+ */
+typedef VertexLayout<vertex_attributes::Position, vertex_attributes::TextureCoordinate, vertex_attributes::Normal> DefaultVertexLayout;
+
+} // namespace static_meshes_3D
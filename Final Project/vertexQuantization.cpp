@@ -0,0 +1,217 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// GLM
+#include <glm/gtc/constants.hpp>
+
+// Project
+#include "vertexQuantization.h"
+#include "vertexLayout.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+const float SNORM16_MAX = 32767.0f;
+const float UNORM16_MAX = 65535.0f;
+const float MIN_QUANTIZATION_RANGE = 1e-8f;
+
+constexpr ResourceName POSITION_SCALE_UNIFORM("positionScale");
+constexpr ResourceName POSITION_BIAS_UNIFORM("positionBias");
+constexpr ResourceName UV_SCALE_UNIFORM("uvScale");
+constexpr ResourceName UV_BIAS_UNIFORM("uvBias");
+constexpr ResourceName OCTAHEDRAL_NORMALS_UNIFORM("octahedralNormals");
+
+int16_t toSnorm16(float value)
+{
+    return static_cast<int16_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+}
+
+uint16_t toUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.0f, 1.0f) * UNORM16_MAX));
+}
+
+float fromSnorm16(int16_t value)
+{
+    // Same as OpenGL normalized fixed point conversion
+    return std::max(float(value) / SNORM16_MAX, -1.0f);
+}
+
+float signNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+} // namespace
+
+void encodeOctahedralNormal(const glm::vec3& normal, int16_t* encoded)
+{
+    const auto l1Norm = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    auto x = l1Norm > 0.0f ? normal.x / l1Norm : 0.0f;
+    auto y = l1Norm > 0.0f ? normal.y / l1Norm : 0.0f;
+
+    // Fold lower hemisphere over the diagonals
+    if (normal.z < 0.0f)
+    {
+        const auto foldedX = (1.0f - std::fabs(y)) * signNotZero(x);
+        const auto foldedY = (1.0f - std::fabs(x)) * signNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    encoded[0] = toSnorm16(x);
+    encoded[1] = toSnorm16(y);
+}
+
+glm::vec3 decodeOctahedralNormal(const int16_t* encoded)
+{
+    const auto x = fromSnorm16(encoded[0]);
+    const auto y = fromSnorm16(encoded[1]);
+    glm::vec3 result(x, y, 1.0f - std::fabs(x) - std::fabs(y));
+    if (result.z < 0.0f)
+    {
+        result.x = (1.0f - std::fabs(y)) * signNotZero(x);
+        result.y = (1.0f - std::fabs(x)) * signNotZero(y);
+    }
+
+    return glm::normalize(result);
+}
+
+void quantizeVertices(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t numVertices,
+    QuantizedVertex* quantizedVertices, QuantizationParameters& parameters, QuantizationError* error)
+{
+    parameters = QuantizationParameters();
+    memset(quantizedVertices, 0, sizeof(QuantizedVertex) * numVertices);
+    if (numVertices == 0) {
+        return;
+    }
+
+    // Positions are mapped from their bounding box to [-1, 1]
+    if (positions != nullptr)
+    {
+        auto minPosition = positions[0];
+        auto maxPosition = positions[0];
+        for (size_t i = 1; i < numVertices; i++)
+        {
+            minPosition = glm::min(minPosition, positions[i]);
+            maxPosition = glm::max(maxPosition, positions[i]);
+        }
+
+        parameters.positionBias = (minPosition + maxPosition) * 0.5f;
+        parameters.positionScale = glm::max((maxPosition - minPosition) * 0.5f, glm::vec3(MIN_QUANTIZATION_RANGE));
+    }
+
+    // Texture coordinates are mapped from their bounding rectangle to [0, 1]
+    if (textureCoordinates != nullptr)
+    {
+        auto minUV = textureCoordinates[0];
+        auto maxUV = textureCoordinates[0];
+        for (size_t i = 1; i < numVertices; i++)
+        {
+            minUV = glm::min(minUV, textureCoordinates[i]);
+            maxUV = glm::max(maxUV, textureCoordinates[i]);
+        }
+
+        parameters.uvBias = minUV;
+        parameters.uvScale = glm::max(maxUV - minUV, glm::vec2(MIN_QUANTIZATION_RANGE));
+    }
+
+    parameters.octahedralNormals = normals != nullptr;
+
+    QuantizationError maxError;
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        auto& vertex = quantizedVertices[i];
+        if (positions != nullptr)
+        {
+            const auto normalized = (positions[i] - parameters.positionBias) / parameters.positionScale;
+            glm::vec3 dequantized;
+            for (auto c = 0; c < 3; c++)
+            {
+                vertex.position[c] = toSnorm16(normalized[c]);
+                dequantized[c] = parameters.positionBias[c] + parameters.positionScale[c] * fromSnorm16(vertex.position[c]);
+            }
+
+            maxError.maxPositionError = std::max(maxError.maxPositionError, glm::length(dequantized - positions[i]));
+        }
+
+        if (textureCoordinates != nullptr)
+        {
+            const auto normalized = (textureCoordinates[i] - parameters.uvBias) / parameters.uvScale;
+            glm::vec2 dequantized;
+            for (auto c = 0; c < 2; c++)
+            {
+                vertex.textureCoordinate[c] = toUnorm16(normalized[c]);
+                dequantized[c] = parameters.uvBias[c] + parameters.uvScale[c] * (float(vertex.textureCoordinate[c]) / UNORM16_MAX);
+            }
+
+            maxError.maxTextureCoordinateError = std::max(maxError.maxTextureCoordinateError, glm::length(dequantized - textureCoordinates[i]));
+        }
+
+        if (normals != nullptr)
+        {
+            encodeOctahedralNormal(normals[i], vertex.normal);
+            const auto originalLength = glm::length(normals[i]);
+            if (originalLength > 0.0f)
+            {
+                const auto cosAngle = glm::clamp(glm::dot(decodeOctahedralNormal(vertex.normal), normals[i] / originalLength), -1.0f, 1.0f);
+                maxError.maxNormalErrorDegrees = std::max(maxError.maxNormalErrorDegrees, std::acos(cosAngle) * 180.0f / glm::pi<float>());
+            }
+        }
+    }
+
+    if (error != nullptr) {
+        *error = maxError;
+    }
+}
+
+void setQuantizedAttributePointers(bool withPositions, bool withTextureCoordinates, bool withNormals, size_t baseOffset)
+{
+    const auto stride = static_cast<GLsizei>(sizeof(QuantizedVertex));
+    if (withPositions)
+    {
+        glEnableVertexAttribArray(vertex_attributes::Position::LOCATION);
+        glVertexAttribPointer(vertex_attributes::Position::LOCATION, 3, GL_SHORT, GL_TRUE, stride,
+            reinterpret_cast<void*>(baseOffset + offsetof(QuantizedVertex, position)));
+    }
+
+    if (withTextureCoordinates)
+    {
+        glEnableVertexAttribArray(vertex_attributes::TextureCoordinate::LOCATION);
+        glVertexAttribPointer(vertex_attributes::TextureCoordinate::LOCATION, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+            reinterpret_cast<void*>(baseOffset + offsetof(QuantizedVertex, textureCoordinate)));
+    }
+
+    if (withNormals)
+    {
+        // Only two components are fetched, shader decodes the third one from octahedral encoding
+        glEnableVertexAttribArray(vertex_attributes::Normal::LOCATION);
+        glVertexAttribPointer(vertex_attributes::Normal::LOCATION, 2, GL_SHORT, GL_TRUE, stride,
+            reinterpret_cast<void*>(baseOffset + offsetof(QuantizedVertex, normal)));
+    }
+}
+
+DequantizationUniforms getDequantizationUniforms(const ShaderReflection& reflection)
+{
+    DequantizationUniforms uniforms;
+    uniforms.positionScale = reflection.getUniform<glm::vec3>(POSITION_SCALE_UNIFORM);
+    uniforms.positionBias = reflection.getUniform<glm::vec3>(POSITION_BIAS_UNIFORM);
+    uniforms.uvScale = reflection.getUniform<glm::vec2>(UV_SCALE_UNIFORM);
+    uniforms.uvBias = reflection.getUniform<glm::vec2>(UV_BIAS_UNIFORM);
+    uniforms.octahedralNormals = reflection.getUniform<bool>(OCTAHEDRAL_NORMALS_UNIFORM);
+    return uniforms;
+}
+
+void setDequantizationUniforms(const DequantizationUniforms& uniforms, const QuantizationParameters& parameters)
+{
+    uniforms.positionScale.set(parameters.positionScale);
+    uniforms.positionBias.set(parameters.positionBias);
+    uniforms.uvScale.set(parameters.uvScale);
+    uniforms.uvBias.set(parameters.uvBias);
+    uniforms.octahedralNormals.set(parameters.octahedralNormals);
+}
+
+} // namespace static_meshes_3D
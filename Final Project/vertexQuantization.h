@@ -0,0 +1,114 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <cstddef>
+
+// GLAD
+#include <gl/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "shaderReflection.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Packed vertex, 16 bytes instead of 32 bytes of float position, texture coordinate and normal.
+ */
+struct QuantizedVertex
+{
+    int16_t position[4]; // Position as snorm16, dequantized with per-mesh scale and bias (last component is padding)
+    int16_t normal[2]; // Octahedral-encoded normal as snorm16
+    uint16_t textureCoordinate[2]; // Texture coordinate as unorm16, dequantized with per-mesh scale and bias
+};
+
+static_assert(sizeof(QuantizedVertex) == 16, "Quantized vertex must be tightly packed");
+
+/**
+ * Per-mesh dequantization parameters. Default values represent float (not quantized) vertices.
+ * Shader decodes vertices with uniforms of the same names:
+ * position = positionBias + positionScale * position, textureCoordinate = uvBias + uvScale * textureCoordinate
+ * and normal is decoded from octahedral encoding, if octahedralNormals is set.
+ */
+struct QuantizationParameters
+{
+    glm::vec3 positionScale = glm::vec3(1.0f); // Scale of dequantized positions
+    glm::vec3 positionBias = glm::vec3(0.0f); // Bias of dequantized positions
+    glm::vec2 uvScale = glm::vec2(1.0f); // Scale of dequantized texture coordinates
+    glm::vec2 uvBias = glm::vec2(0.0f); // Bias of dequantized texture coordinates
+    bool octahedralNormals = false; // Flag telling, if normals are octahedral-encoded
+};
+
+/**
+ * Handles of dequantization uniforms of one shader program.
+ */
+struct DequantizationUniforms
+{
+    UniformHandle<glm::vec3> positionScale; // Handle of positionScale uniform
+    UniformHandle<glm::vec3> positionBias; // Handle of positionBias uniform
+    UniformHandle<glm::vec2> uvScale; // Handle of uvScale uniform
+    UniformHandle<glm::vec2> uvBias; // Handle of uvBias uniform
+    UniformHandle<bool> octahedralNormals; // Handle of octahedralNormals uniform
+};
+
+/**
+ * Report of maximal errors introduced by quantization.
+ */
+struct QuantizationError
+{
+    float maxPositionError = 0.0f; // Maximal distance between original and dequantized position
+    float maxNormalErrorDegrees = 0.0f; // Maximal angle between original and decoded normal, in degrees
+    float maxTextureCoordinateError = 0.0f; // Maximal distance between original and dequantized texture coordinate
+};
+
+/**
+ * Encodes unit vector with octahedral encoding to two snorm16 values.
+ */
+void encodeOctahedralNormal(const glm::vec3& normal, int16_t* encoded);
+
+/**
+ * Decodes unit vector from two octahedral-encoded snorm16 values (same math as in the vertex shader).
+ */
+glm::vec3 decodeOctahedralNormal(const int16_t* encoded);
+
+/**
+ * Quantizes float vertex attributes. Any of the attribute arrays can be nullptr, then it's left zeroed.
+ *
+ * @param positions           Vertex positions (or nullptr)
+ * @param textureCoordinates  Vertex texture coordinates (or nullptr)
+ * @param normals             Vertex normals (or nullptr)
+ * @param numVertices         Number of vertices
+ * @param quantizedVertices   Output array of numVertices quantized vertices
+ * @param parameters          Output dequantization parameters for the shader
+ * @param error               Output report of quantization errors (optional)
+ */
+void quantizeVertices(const glm::vec3* positions, const glm::vec2* textureCoordinates, const glm::vec3* normals, size_t numVertices,
+    QuantizedVertex* quantizedVertices, QuantizationParameters& parameters, QuantizationError* error = nullptr);
+
+/**
+ * Sets vertex attribute pointers of currently bound VAO for quantized vertices in currently bound GL_ARRAY_BUFFER.
+ *
+ * @param withPositions           Set pointer for positions
+ * @param withTextureCoordinates  Set pointer for texture coordinates
+ * @param withNormals             Set pointer for normals
+ * @param baseOffset              Byte offset of the first vertex in the buffer
+ */
+void setQuantizedAttributePointers(bool withPositions, bool withTextureCoordinates, bool withNormals, size_t baseOffset = 0);
+
+/**
+ * Resolves handles of dequantization uniforms of reflected shader program.
+ */
+DequantizationUniforms getDequantizationUniforms(const ShaderReflection& reflection);
+
+/**
+ * Passes dequantization parameters to the uniforms of currently used shader program.
+ *
+ * @param uniforms    Handles of dequantization uniforms of the program
+ * @param parameters  Dequantization parameters of the mesh being rendered
+ */
+void setDequantizationUniforms(const DequantizationUniforms& uniforms, const QuantizationParameters& parameters);
+
+} // namespace static_meshes_3D
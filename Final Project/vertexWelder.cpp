@@ -0,0 +1,69 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Project
+#include "vertexWelder.h"
+#include "meshProcessing.h"
+
+namespace static_meshes_3D {
+
+namespace {
+
+// Writes integer key of float component - its bits (both zeros are equal) or index of nearest point of epsilon grid
+// split into low and high word, as grid index of far away component does not fit into one word
+uint32_t* writeComponentKey(float value, float epsilon, uint32_t* key)
+{
+    if (epsilon > 0.0f)
+    {
+        const auto gridIndex = static_cast<uint64_t>(std::llround(value / epsilon));
+        *key++ = static_cast<uint32_t>(gridIndex);
+        *key++ = static_cast<uint32_t>(gridIndex >> 32);
+        return key;
+    }
+
+    uint32_t bits = 0;
+    if (value != 0.0f) {
+        memcpy(&bits, &value, sizeof(bits));
+    }
+    *key++ = bits;
+    return key;
+}
+
+} // namespace
+
+size_t weldVertices(const unsigned char* vertices, size_t numVertices, size_t vertexByteSize, float epsilon, std::vector<unsigned int>& remap)
+{
+    remap.clear();
+    if (numVertices == 0) {
+        return 0;
+    }
+
+    // Build integer keys of all vertices, every thread takes continuous chunk
+    const auto numComponents = vertexByteSize / sizeof(float);
+    const auto wordsPerKey = numComponents * (epsilon > 0.0f ? 2 : 1);
+    const auto numThreads = getNumThreads(numVertices, PARALLEL_WELD_MIN_VERTICES);
+    std::vector<uint32_t> keys(numVertices * wordsPerKey);
+    const auto chunkSize = (numVertices + numThreads - 1) / numThreads;
+    runInThreads(numThreads, [&](size_t thread) {
+        const auto chunkEnd = std::min(numVertices, (thread + 1) * chunkSize);
+        for (auto i = thread * chunkSize; i < chunkEnd; i++)
+        {
+            auto key = keys.data() + i * wordsPerKey;
+            for (size_t c = 0; c < numComponents; c++)
+            {
+                float value;
+                memcpy(&value, vertices + i * vertexByteSize + c * sizeof(float), sizeof(value));
+                key = writeComponentKey(value, epsilon, key);
+            }
+        }
+    });
+
+    // Equal keys are merged the same way as importers merge their attribute index tuples
+    std::vector<size_t> firstVertices;
+    return deduplicateKeys(keys.data(), numVertices, wordsPerKey, remap, firstVertices);
+}
+
+} // namespace static_meshes_3D
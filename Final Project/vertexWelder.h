@@ -0,0 +1,42 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <vector>
+
+namespace static_meshes_3D {
+
+/**
+ * Report of welding triangle soup into indexed mesh.
+ */
+struct WeldStats
+{
+    size_t numSoupVertices = 0; // Number of vertices of the triangle soup
+    size_t numWeldedVertices = 0; // Number of unique vertices after welding
+    size_t soupByteSize = 0; // Byte size of the triangle soup vertex data
+    size_t weldedByteSize = 0; // Byte size of welded vertex data plus indices
+    long long bytesSaved = 0; // Difference of the two sizes above (negative, if nothing could be welded)
+};
+
+/**
+ * Minimal number of vertices, for which welding runs in multiple threads.
+ */
+const size_t PARALLEL_WELD_MIN_VERTICES = 16384;
+
+/**
+ * Finds unique vertices of triangle soup. Vertices are compared as whole tuples of float components (all attributes).
+ * With zero epsilon, components must be equal, otherwise components are snapped to the grid of epsilon
+ * and vertices snapping to the same grid point are welded. Vertices are turned into integer keys (in multiple threads
+ * for large soups) and merged by deduplicateKeys (see meshProcessing.h), so the result does not depend on the number of threads.
+ *
+ * @param vertices        Interleaved vertices made of floats
+ * @param numVertices     Number of vertices
+ * @param vertexByteSize  Byte size of one vertex (multiple of sizeof(float))
+ * @param epsilon         Welding tolerance (0 for exact match)
+ * @param remap           Output unique vertex index for every soup vertex, unique vertices are numbered in order of first occurrence
+ *
+ * @return Number of unique vertices.
+ */
+size_t weldVertices(const unsigned char* vertices, size_t numVertices, size_t vertexByteSize, float epsilon, std::vector<unsigned int>& remap);
+
+} // namespace static_meshes_3D
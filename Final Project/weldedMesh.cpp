@@ -0,0 +1,68 @@
+// STL
+#include <iostream>
+#include <cstring>
+
+// Project
+#include "weldedMesh.h"
+
+namespace static_meshes_3D {
+
+const WeldStats& WeldedMesh::getWeldStats() const
+{
+    return _weldStats;
+}
+
+void WeldedMesh::initializeFromSoup(const unsigned char* vertices, size_t numSoupVertices, const std::vector<int>& partSizes, float epsilon)
+{
+    if (numSoupVertices == 0 || numSoupVertices % 3 != 0)
+    {
+        std::cerr << "Triangle soup must consist of whole triangles!" << std::endl;
+        return;
+    }
+
+    // Parts of the soup become index ranges, as soup vertex i is referenced by index i
+    auto firstIndex = 0;
+    for (const auto partSize : partSizes)
+    {
+        _indexRanges.push_back({ firstIndex, partSize });
+        firstIndex += partSize;
+    }
+
+    if (!partSizes.empty() && firstIndex != static_cast<int>(numSoupVertices))
+    {
+        std::cerr << "Triangle soup parts do not cover the whole soup!" << std::endl;
+        _indexRanges.clear();
+        return;
+    }
+
+    std::vector<unsigned int> remap;
+    const auto vertexByteSize = static_cast<size_t>(getVertexByteSize());
+    const auto numWeldedVertices = weldVertices(vertices, numSoupVertices, vertexByteSize, epsilon, remap);
+    _numVertices = static_cast<int>(numWeldedVertices);
+    _numIndices = static_cast<int>(numSoupVertices);
+
+    // Gather unique vertices (interleaved) and rearrange them to mesh vertex storage
+    std::vector<unsigned char> weldedVertices(numWeldedVertices * vertexByteSize);
+    for (size_t i = 0; i < numSoupVertices; i++) {
+        memcpy(weldedVertices.data() + remap[i] * vertexByteSize, vertices + i * vertexByteSize, vertexByteSize);
+    }
+
+    std::vector<unsigned char> storedVertices(weldedVertices.size());
+    _vertexFormat->convertStorage(weldedVertices.data(), VertexStorage::Interleaved, storedVertices.data(), _vertexStorage, numWeldedVertices);
+
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+    _vbo.createVBO(storedVertices.size());
+    _vbo.addRawData(storedVertices.data(), storedVertices.size());
+    _indicesVBO.createVBO(sizeof(GLuint) * numSoupVertices);
+    _indicesVBO.addRawData(remap.data(), sizeof(GLuint) * numSoupVertices);
+    finalizeIndexedData(GL_STATIC_DRAW);
+
+    _weldStats.numSoupVertices = numSoupVertices;
+    _weldStats.numWeldedVertices = numWeldedVertices;
+    _weldStats.soupByteSize = numSoupVertices * vertexByteSize;
+    _weldStats.weldedByteSize = numWeldedVertices * vertexByteSize + numSoupVertices * getIndexByteSize();
+    _weldStats.bytesSaved = static_cast<long long>(_weldStats.soupByteSize) - static_cast<long long>(_weldStats.weldedByteSize);
+}
+
+} // namespace static_meshes_3D
\ No newline at end of file
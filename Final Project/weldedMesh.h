@@ -0,0 +1,53 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// Project
+#include "staticMeshIndexed3D.h"
+#include "vertexWelder.h"
+
+namespace static_meshes_3D {
+
+/**
+ * Indexed static mesh created from triangle soup (e.g. hardcoded vertex array rendered with glDrawArrays),
+ * repeated vertices are welded into one, so that vertex buffer is compact and indices reference them.
+ */
+class WeldedMesh : public StaticMeshIndexed3D
+{
+public:
+    /**
+     * Creates mesh from interleaved triangle soup in given layout. Soup may consist of several parts (consecutive
+     * runs of vertices), each part becomes index range, that can be rendered on its own with renderIndexRange.
+     *
+     * @param layout           Vertex layout of the soup, e.g. VertexLayout<Position, Normal, TextureCoordinate>()
+     * @param soupVertices     Interleaved soup vertices
+     * @param numSoupVertices  Number of soup vertices (multiple of 3)
+     * @param partSizes        Numbers of vertices of the soup parts, in soup order (empty for one part)
+     * @param epsilon          Welding tolerance (0 for exact match, see weldVertices)
+     * @param vertexStorage    How vertex attributes are arranged in the vertex buffer
+     */
+    template<typename... Attributes>
+    WeldedMesh(VertexLayout<Attributes...> layout, const void* soupVertices, size_t numSoupVertices, const std::vector<int>& partSizes = std::vector<int>(),
+        float epsilon = 0.0f, VertexStorage vertexStorage = VertexStorage::Planar)
+        : StaticMeshIndexed3D(layout, vertexStorage)
+    {
+        // Mesh keeps the layout of the soup, so soup vertices are welded as they are
+        initializeFromSoup(static_cast<const unsigned char*>(soupVertices), numSoupVertices, partSizes, epsilon);
+    }
+
+    /**
+     * Gets report of the welding (vertex counts and memory saved).
+     */
+    const WeldStats& getWeldStats() const;
+
+private:
+    WeldStats _weldStats; // Report of the welding
+
+    /**
+     * Welds soup vertices (interleaved, in mesh vertex layout), creates VAO and finalizes the mesh.
+     */
+    void initializeFromSoup(const unsigned char* vertices, size_t numSoupVertices, const std::vector<int>& partSizes, float epsilon);
+};
+
+} // namespace static_meshes_3D